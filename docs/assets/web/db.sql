@@ -8,10 +8,14 @@ CREATE TABLE IF NOT EXISTS `Device` (
 );
 
 CREATE TABLE IF NOT EXISTS `Reading` (
-    `id` INT AUTO_INCREMENT PRIMARY KEY,
+    `id` INT AUTO_INCREMENT,
     `device_id` INT NOT NULL,
-    `timestamp` TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-    FOREIGN KEY (`device_id`) REFERENCES `Device`(`id`) ON DELETE CASCADE
+    `timestamp` TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (`id`, `timestamp`),
+    KEY `idx_device_timestamp` (`device_id`, `timestamp`)
+)
+PARTITION BY RANGE (UNIX_TIMESTAMP(`timestamp`)) (
+    PARTITION `p_future` VALUES LESS THAN MAXVALUE
 );
 
 CREATE TABLE IF NOT EXISTS `Sensor` (
@@ -21,15 +25,51 @@ CREATE TABLE IF NOT EXISTS `Sensor` (
     `unit` VARCHAR(10) NOT NULL
 );
 
-CREATE TABLE IF NOT EXISTS `SensorData` ( 
-    `id` INT AUTO_INCREMENT PRIMARY KEY,
+CREATE TABLE IF NOT EXISTS `SensorData` (
+    `id` INT AUTO_INCREMENT,
     `reading_id` INT NOT NULL,
     `sensor_id` INT NOT NULL,
+    `captured_at` INT UNSIGNED NOT NULL,
     `value` DECIMAL(7,2) NOT NULL,
-    FOREIGN KEY (`reading_id`) REFERENCES `Reading`(`id`) ON DELETE CASCADE,
+    `min_value` DECIMAL(7,2) NULL,
+    `max_value` DECIMAL(7,2) NULL,
+    `sample_count` SMALLINT UNSIGNED NULL,
+    PRIMARY KEY (`id`, `captured_at`),
+    KEY `idx_sensor_data_reading` (`reading_id`),
+    KEY `idx_sensor_data_sensor` (`sensor_id`)
+)
+PARTITION BY RANGE (`captured_at`) (
+    PARTITION `p_future` VALUES LESS THAN MAXVALUE
+);
+
+CREATE TABLE IF NOT EXISTS `DeviceLatest` (
+    `device_id` INT NOT NULL,
+    `sensor_id` INT NOT NULL,
+    `reading_id` INT NOT NULL,
+    `value` DECIMAL(7,2) NOT NULL,
+    `timestamp` TIMESTAMP NOT NULL,
+    PRIMARY KEY (`device_id`, `sensor_id`),
+    FOREIGN KEY (`device_id`) REFERENCES `Device`(`id`) ON DELETE CASCADE,
     FOREIGN KEY (`sensor_id`) REFERENCES `Sensor`(`id`) ON DELETE CASCADE
 );
 
+CREATE TABLE IF NOT EXISTS `SensorRollup` (
+    `device_id` INT NOT NULL,
+    `sensor_id` INT NOT NULL,
+    `resolution` INT UNSIGNED NOT NULL,
+    `bucket_start` INT UNSIGNED NOT NULL,
+    `min_value` DECIMAL(7,2) NOT NULL,
+    `max_value` DECIMAL(7,2) NOT NULL,
+    `sum_value` DECIMAL(14,2) NOT NULL,
+    `sample_count` INT UNSIGNED NOT NULL,
+    PRIMARY KEY (`device_id`, `sensor_id`, `resolution`, `bucket_start`)
+)
+PARTITION BY RANGE COLUMNS (`resolution`, `bucket_start`) (
+    PARTITION `p60_future` VALUES LESS THAN (60, MAXVALUE),
+    PARTITION `p3600_future` VALUES LESS THAN (3600, MAXVALUE),
+    PARTITION `p86400_future` VALUES LESS THAN (86400, MAXVALUE)
+);
+
 CREATE TABLE IF NOT EXISTS `Setting` (
     `id` INT AUTO_INCREMENT PRIMARY KEY,
     `key` VARCHAR(50) UNIQUE NOT NULL,
@@ -38,11 +78,42 @@ CREATE TABLE IF NOT EXISTS `Setting` (
     `default_value` DECIMAL(10,4) NOT NULL
 );
 
+CREATE TABLE IF NOT EXISTS `TableVersion` (
+    `name` VARCHAR(50) PRIMARY KEY,
+    `version` BIGINT UNSIGNED NOT NULL,
+    `updated_at` TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP
+);
+
+INSERT IGNORE INTO `TableVersion` (`name`, `version`) VALUES
+    ('device', FLOOR(1 + RAND() * 281474976710655)),
+    ('devicelatest', FLOOR(1 + RAND() * 281474976710655)),
+    ('reading', FLOOR(1 + RAND() * 281474976710655)),
+    ('sensor', FLOOR(1 + RAND() * 281474976710655)),
+    ('sensordata', FLOOR(1 + RAND() * 281474976710655)),
+    ('sensorrollup', FLOOR(1 + RAND() * 281474976710655)),
+    ('setting', FLOOR(1 + RAND() * 281474976710655));
+
+CREATE TRIGGER IF NOT EXISTS `device_version_insert` AFTER INSERT ON `Device`
+    FOR EACH ROW UPDATE `TableVersion` SET `version` = `version` + 1 WHERE `name` = 'device';
+CREATE TRIGGER IF NOT EXISTS `device_version_update` AFTER UPDATE ON `Device`
+    FOR EACH ROW UPDATE `TableVersion` SET `version` = `version` + 1 WHERE `name` = 'device';
+CREATE TRIGGER IF NOT EXISTS `device_version_delete` AFTER DELETE ON `Device`
+    FOR EACH ROW UPDATE `TableVersion` SET `version` = `version` + 1 WHERE `name` = 'device';
+CREATE TRIGGER IF NOT EXISTS `sensor_version_insert` AFTER INSERT ON `Sensor`
+    FOR EACH ROW UPDATE `TableVersion` SET `version` = `version` + 1 WHERE `name` = 'sensor';
+CREATE TRIGGER IF NOT EXISTS `sensor_version_update` AFTER UPDATE ON `Sensor`
+    FOR EACH ROW UPDATE `TableVersion` SET `version` = `version` + 1 WHERE `name` = 'sensor';
+CREATE TRIGGER IF NOT EXISTS `sensor_version_delete` AFTER DELETE ON `Sensor`
+    FOR EACH ROW UPDATE `TableVersion` SET `version` = `version` + 1 WHERE `name` = 'sensor';
+CREATE TRIGGER IF NOT EXISTS `setting_version_insert` AFTER INSERT ON `Setting`
+    FOR EACH ROW UPDATE `TableVersion` SET `version` = `version` + 1 WHERE `name` = 'setting';
+CREATE TRIGGER IF NOT EXISTS `setting_version_update` AFTER UPDATE ON `Setting`
+    FOR EACH ROW UPDATE `TableVersion` SET `version` = `version` + 1 WHERE `name` = 'setting';
+CREATE TRIGGER IF NOT EXISTS `setting_version_delete` AFTER DELETE ON `Setting`
+    FOR EACH ROW UPDATE `TableVersion` SET `version` = `version` + 1 WHERE `name` = 'setting';
+
 CREATE INDEX `idx_sensor_key` ON `Sensor` (`key`);
 CREATE INDEX `idx_setting_key` ON `Setting` (`key`);
-CREATE INDEX `idx_device_timestamp` ON `Reading` (`device_id`, `timestamp`);
-CREATE INDEX `idx_sensor_data_reading` ON `SensorData` (`reading_id`);
-CREATE INDEX `idx_sensor_data_sensor` ON `SensorData` (`sensor_id`);
 
 INSERT INTO `Sensor` (`key`, `name`, `unit`) VALUES
     ('ky_015_temperature', 'KY-015 Temperature Sensor', '°C'),
@@ -77,21 +148,106 @@ INSERT INTO `Setting` (`key`, `name`, `value`, `default_value`) VALUES
     ('background_brightness_max', 'Maximum Background Brightness', NULL, 1),
 
     ('color_temperature_threshold', 'Temperature Threshold for Color Changes', NULL, 10),
-    ('color_humidity_brightness_factor', 'Impact of Humidity on Color Brightness', NULL, 1);
+    ('color_humidity_brightness_factor', 'Impact of Humidity on Color Brightness', NULL, 1),
 
-CREATE VIEW LatestDeviceReadings AS
+    ('retention_raw_days', 'Retention: Raw Readings in Days (0 = Keep)', NULL, 90),
+    ('retention_minute_days', 'Retention: Minute Rollups in Days (0 = Keep)', NULL, 30),
+    ('retention_hour_days', 'Retention: Hour Rollups in Days (0 = Keep)', NULL, 730),
+    ('retention_day_days', 'Retention: Day Rollups in Days (0 = Keep)', NULL, 0),
+
+    ('sound_default_track', 'Sound: Track When No Rule Matches', NULL, 6),
+    ('sound_01_track', 'Sound Rule 1: Track (Rainstorm)', NULL, 1),
+    ('sound_01_water_gt', 'Sound Rule 1: Water Above', NULL, 500),
+    ('sound_02_track', 'Sound Rule 2: Track (Blizzard Wind)', NULL, 2),
+    ('sound_02_temp_lt', 'Sound Rule 2: Temperature Below', NULL, 5),
+    ('sound_02_pressure_lt', 'Sound Rule 2: Pressure Below', NULL, 1000),
+    ('sound_03_track', 'Sound Rule 3: Track (Cold Sunset Wind)', NULL, 4),
+    ('sound_03_temp_lt', 'Sound Rule 3: Temperature Below', NULL, 5),
+    ('sound_03_pressure_ge', 'Sound Rule 3: Pressure At Least', NULL, 1000),
+    ('sound_03_lux_le', 'Sound Rule 3: Light At Most', NULL, 200),
+    ('sound_04_track', 'Sound Rule 4: Track (Cold Winter Day)', NULL, 3),
+    ('sound_04_temp_lt', 'Sound Rule 4: Temperature Below', NULL, 5),
+    ('sound_04_pressure_ge', 'Sound Rule 4: Pressure At Least', NULL, 1000),
+    ('sound_05_track', 'Sound Rule 5: Track (Calm Night Crickets)', NULL, 9),
+    ('sound_05_temp_le', 'Sound Rule 5: Temperature At Most', NULL, 20),
+    ('sound_05_lux_lt', 'Sound Rule 5: Light Below', NULL, 50),
+    ('sound_06_track', 'Sound Rule 6: Track (Mild Storm Wind)', NULL, 5),
+    ('sound_06_temp_lt', 'Sound Rule 6: Temperature Below', NULL, 20),
+    ('sound_06_pressure_lt', 'Sound Rule 6: Pressure Below', NULL, 1000),
+    ('sound_07_track', 'Sound Rule 7: Track (Spring Morning Birds)', NULL, 6),
+    ('sound_07_temp_lt', 'Sound Rule 7: Temperature Below', NULL, 20),
+    ('sound_07_pressure_ge', 'Sound Rule 7: Pressure At Least', NULL, 1000),
+    ('sound_07_lux_gt', 'Sound Rule 7: Light Above', NULL, 400),
+    ('sound_08_track', 'Sound Rule 8: Track (Spring Evening Chill)', NULL, 8),
+    ('sound_08_temp_lt', 'Sound Rule 8: Temperature Below', NULL, 20),
+    ('sound_08_lux_lt', 'Sound Rule 8: Light Below', NULL, 200),
+    ('sound_08_lux_ge', 'Sound Rule 8: Light At Least', NULL, 50),
+    ('sound_09_track', 'Sound Rule 9: Track (Mild Day Breeze)', NULL, 7),
+    ('sound_09_temp_lt', 'Sound Rule 9: Temperature Below', NULL, 25),
+    ('sound_09_pressure_le', 'Sound Rule 9: Pressure At Most', NULL, 1015),
+    ('sound_09_hum_lt', 'Sound Rule 9: Humidity Below', NULL, 80),
+    ('sound_10_track', 'Sound Rule 10: Track (Humid Storm Build)', NULL, 10),
+    ('sound_10_temp_lt', 'Sound Rule 10: Temperature Below', NULL, 28),
+    ('sound_10_pressure_lt', 'Sound Rule 10: Pressure Below', NULL, 1000),
+    ('sound_10_hum_gt', 'Sound Rule 10: Humidity Above', NULL, 80),
+    ('sound_11_track', 'Sound Rule 11: Track (Warm Morning Birds)', NULL, 11),
+    ('sound_11_temp_ge', 'Sound Rule 11: Temperature At Least', NULL, 20),
+    ('sound_11_temp_lt', 'Sound Rule 11: Temperature Below', NULL, 28),
+    ('sound_11_lux_ge', 'Sound Rule 11: Light At Least', NULL, 200),
+    ('sound_11_lux_lt', 'Sound Rule 11: Light Below', NULL, 1000),
+    ('sound_12_track', 'Sound Rule 12: Track (Summer Cicadas)', NULL, 12),
+    ('sound_12_temp_ge', 'Sound Rule 12: Temperature At Least', NULL, 28),
+    ('sound_12_lux_gt', 'Sound Rule 12: Light Above', NULL, 1000),
+    ('sound_13_track', 'Sound Rule 13: Track (Summer Night Crickets)', NULL, 13),
+    ('sound_13_temp_ge', 'Sound Rule 13: Temperature At Least', NULL, 28),
+    ('sound_13_lux_lt', 'Sound Rule 13: Light Below', NULL, 200);
+
+CREATE OR REPLACE VIEW LatestDeviceReadings AS
 SELECT
     d.id AS device_id,
     d.name AS device_name,
+    dl.sensor_id,
     s.name AS sensor_name,
     s.unit AS sensor_unit,
-    sd.value,
-    r.timestamp
+    dl.value,
+    dl.reading_id,
+    dl.timestamp
+FROM DeviceLatest dl
+JOIN Device d ON dl.device_id = d.id
+JOIN Sensor s ON dl.sensor_id = s.id
+ORDER BY dl.timestamp DESC;
+
+-- Fills DeviceLatest from existing readings when upgrading a database that
+-- already holds data; a no-op on a fresh one.
+INSERT IGNORE INTO `DeviceLatest` (`device_id`, `sensor_id`, `reading_id`, `value`, `timestamp`)
+SELECT device_id, sensor_id, reading_id, value, timestamp
+FROM (
+    SELECT
+        r.device_id,
+        sd.sensor_id,
+        sd.reading_id,
+        sd.value,
+        r.timestamp,
+        ROW_NUMBER() OVER (PARTITION BY r.device_id, sd.sensor_id ORDER BY r.timestamp DESC, sd.id DESC) AS position
+    FROM SensorData sd
+    JOIN Reading r ON sd.reading_id = r.id
+) ranked
+WHERE position = 1;
+
+-- Builds the rollups from existing readings when upgrading; skipped once
+-- the API has written any.
+INSERT INTO `SensorRollup` (`device_id`, `sensor_id`, `resolution`, `bucket_start`, `min_value`, `max_value`, `sum_value`, `sample_count`)
+SELECT
+    r.device_id,
+    sd.sensor_id,
+    res.resolution,
+    UNIX_TIMESTAMP(r.timestamp) DIV res.resolution * res.resolution AS bucket,
+    MIN(COALESCE(sd.min_value, sd.value)),
+    MAX(COALESCE(sd.max_value, sd.value)),
+    SUM(sd.value),
+    COUNT(*)
 FROM SensorData sd
 JOIN Reading r ON sd.reading_id = r.id
-JOIN Device d ON r.device_id = d.id
-JOIN Sensor s ON sd.sensor_id = s.id
-WHERE r.timestamp = (
-    SELECT MAX(r2.timestamp) FROM Reading r2 WHERE r2.device_id = d.id
-)
-ORDER BY r.timestamp DESC;
\ No newline at end of file
+CROSS JOIN (SELECT 60 AS resolution UNION ALL SELECT 3600 UNION ALL SELECT 86400) res
+WHERE NOT EXISTS (SELECT 1 FROM SensorRollup)
+GROUP BY r.device_id, sd.sensor_id, res.resolution, bucket;
\ No newline at end of file
@@ -5,12 +5,19 @@
 // Copyright (c) 2025 Yanis Deplazes
 // Description: Implementation of HTTPS client logic to communicate with API
 //              for retrieving latest sensor data from all registered devices.
+//              Runs in the network task: the whole fleet is refreshed with
+//              one snapshot request and handed to the LED task, the
+//              soundscape rules are handed to the audio task. Responses are
+//              parsed straight from the TLS stream, without copying them, and
+//              revalidated with their ETag, so unchanged ones are not sent.
 // ============================================================================
 
 #include "Client.h"
 #include "Server.h"
-#include "LEDManager.h"
-#include "DFPlayerManager.h"
+#include "DeviceCache.h"
+#include "SharedState.h"
+#include "Soundscape.h"
+#include "Metrics.h"
 #include <Arduino.h>
 #include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
@@ -20,53 +27,51 @@
 // ----------------------------------------------------------------------------
 #define API_HOST "yanisdeplazes.loca.lt"
 #define API_PORT 443
-#define API_DEVICES_PATH "/api/device"
-#define API_LATEST_READING_PATH "/api/views/LatestDeviceReadings?device_id="
-#define API_INDEX_UPDATE_PATH "/api/installation/publish"
+#define API_SNAPSHOT_PATH "/api/snapshot"
+#define API_SOUNDSCAPE_PATH "/api/soundscape"
 
-#define DOC_BUFFER_SIZE 4096
+#define SNAPSHOT_TIMEOUT_MS 5000
+#define NO_CHARACTER -1
 #define HEADER_END_LINE "\r"
-
-#define JSON_ARRAY_OFFSET 2
-#define JSON_ARRAY_OPEN_INDEX 0
+#define STATUS_CODE_OFFSET 9  // "HTTP/1.0 " precedes the status code
+#define HTTP_STATUS_OK 200
+#define HTTP_STATUS_NOT_MODIFIED 304
+#define HTTP_STATUS_NONE 0
+#define ETAG_HEADER "etag:"
+#define ETAG_SIZE 48  // Longer validators are not stored
+
+#define FIRST_SENSOR_ID 1
+#define SENSOR_KEY_SIZE 4
 #define LOOP_START_INDEX 0
 
 #define FLOAT_DECIMAL_PRECISION 2
 
-#define SENSOR_NAME_TEMP "DHT11 Temperature Sensor"
-#define SENSOR_NAME_HUM "DHT11 Humidity Sensor"
-#define SENSOR_NAME_LUX "BH1750 Light Sensor"
-#define SENSOR_NAME_WATER "Analog Water Sensor"
-#define SENSOR_NAME_PRESS "BMP180 Pressure Sensor"
-#define SENSOR_NAME_TEMP_BMP "BMP180 Temperature Sensor"
+#define MS_PER_SECOND 1000LL
 
 #define NO_DEVICES 0
-#define INDEX_INCREMENT 1
-#define INDEX_DECREMENT 1
 
 // ----------------------------------------------------------------------------
 // State
 // ----------------------------------------------------------------------------
 
 WiFiClientSecure secureClient;
-static StaticJsonDocument<DOC_BUFFER_SIZE> deviceListBuffer;
-static StaticJsonDocument<DOC_BUFFER_SIZE> readingBuffer;
+static JsonDocument soundscapeBuffer;  // ArduinoJson 7: grows on the heap, limits are checked after parsing
+static SoundscapeTable soundscape;  // Last published table, too large for the task stack
+static unsigned long requestStartMs = 0;
 
-int deviceCount = 0;
-float latestTempDHT = 0;
-float latestHumDHT = 0;
-float latestLux = 0;
-float latestWater = 0;
-float latestTempBMP = 0;
-float latestPressure = 0;
+static char responseEtag[ETAG_SIZE];    // ETag of the last GET response
+static char snapshotEtag[ETAG_SIZE];    // Validator of the snapshot in the cache
+static char soundscapeEtag[ETAG_SIZE];  // Validator of the current soundscape
 
 /**
- * Writes standard HTTP headers for GET/POST requests.
+ * Writes the headers of a GET request. HTTP/1.0 keeps the server from
+ * sending a chunked body, so it can be parsed from the stream. A non-empty
+ * ifNoneMatch makes the request conditional.
  */
-void writeCommonHeaders(const String& method, const String& path, const String& contentType = "", size_t contentLength = 0) {
-  secureClient.print(method + " ");
+static void writeGetHeaders(const String& path, const char* ifNoneMatch) {
+  secureClient.print("GET ");
   secureClient.print(path);
-  secureClient.println(" HTTP/1.1");
+  secureClient.println(" HTTP/1.0");
 
   secureClient.print("Host: ");
   secureClient.println(API_HOST);
@@ -74,206 +79,366 @@ void writeCommonHeaders(const String& method, const String& path, const String&
   secureClient.println("bypass-tunnel-reminder: true");
   secureClient.println("Connection: close");
 
-  if (method == "POST") {
-    secureClient.print("Content-Type: ");
-    secureClient.println(contentType);
-    secureClient.print("Content-Length: ");
-    secureClient.println(contentLength);
+  if (ifNoneMatch[0] != '\0') {
+    secureClient.print("If-None-Match: ");
+    secureClient.println(ifNoneMatch);
   }
 
   secureClient.println();  // End of headers
 }
 
 /**
- * Skips HTTP headers in the response stream.
+ * Skips the HTTP headers in the response stream, keeping the ETag in
+ * responseEtag.
  */
-void skipHttpHeaders() {
+static void readGetHeaders() {
+  responseEtag[0] = '\0';
+  size_t nameLength = strlen(ETAG_HEADER);
+
   while (secureClient.connected()) {
     String line = secureClient.readStringUntil('\n');
     if (line == HEADER_END_LINE) break;
+
+    if (line.length() > nameLength && strncasecmp(line.c_str(), ETAG_HEADER, nameLength) == 0) {
+      String value = line.substring(nameLength);
+      value.trim();
+      if (value.length() < ETAG_SIZE) strlcpy(responseEtag, value.c_str(), ETAG_SIZE);
+    }
   }
 }
 
 /**
- * httpGET(path)
- * -------------
- * Performs a HTTPS GET request to the specified API path.
- * 
+ * Closes the connection after the body of a beginGET() request was read
+ * and records the request duration.
+ */
+static void endGET() {
+  secureClient.stop();
+  metricsObserve(HISTOGRAM_HTTP_GET_MS, millis() - requestStartMs);
+}
+
+/**
+ * beginGET(path, etag)
+ * --------------------
+ * Sends a HTTPS GET request and reads the status line and headers, so the
+ * body can be parsed straight from secureClient. The caller stops the
+ * client once the body is read. The request is conditional if an ETag is
+ * given; a 304 has no body and is finished right here. The ETag of the
+ * response is left in responseEtag.
+ *
  * @param path Relative API path to request.
- * @return Response body as String.
+ * @param etag Validator of the cached copy, or "" if there is none.
+ * @return HTTP_STATUS_OK, HTTP_STATUS_NOT_MODIFIED or HTTP_STATUS_NONE.
  */
-String httpGET(const String& path) {
+static int beginGET(const String& path, const char* etag) {
   Serial.println("GET " + path);
 
+  requestStartMs = millis();
   secureClient.setInsecure();  // Skip cert validation
   if (!secureClient.connect(API_HOST, API_PORT)) {
     Serial.println("Connection failed");
-    return "";
+    return HTTP_STATUS_NONE;
   }
+  metricsObserve(HISTOGRAM_TLS_CONNECT_MS, millis() - requestStartMs);
 
-  writeCommonHeaders("GET", path);
-  skipHttpHeaders();
+  writeGetHeaders(path, etag);
 
-  String responseBody;
-  while (secureClient.available()) {
-    responseBody += (char)secureClient.read();
-  }
+  String status = secureClient.readStringUntil('\n');
+  int code = status.length() > STATUS_CODE_OFFSET ? status.substring(STATUS_CODE_OFFSET).toInt() : 0;
+  readGetHeaders();
 
-  secureClient.stop();
-  return responseBody;
+  if (code == HTTP_STATUS_NOT_MODIFIED) {
+    endGET();
+    metricsCount(COUNTER_HTTP_NOT_MODIFIED);
+    return code;
+  }
+  if (code != HTTP_STATUS_OK) {
+    Serial.print("HTTP status: ");
+    Serial.println(code);
+    secureClient.stop();
+    return HTTP_STATUS_NONE;
+  }
+  return code;
 }
 
 /**
- * httpPOST(path, payload, contentType)
- * ------------------------------------
- * Performs a HTTPS POST request with a JSON payload.
- * 
- * @param path Relative API path.
- * @param payload JSON-formatted string.
- * @param contentType Content type header value.
- * @return Response body as String.
+ * Applies the values of a JSON object keyed by sensor_id to a cache entry.
  */
-String httpPOST(const String& path, const String& payload, const String& contentType) {
-  Serial.println("POST " + path);
-
-  secureClient.setInsecure();
-  if (!secureClient.connect(API_HOST, API_PORT)) {
-    Serial.println("Connection failed");
-    return "";
+static void applyValues(CachedDevice* entry, JsonObject values) {
+  for (JsonPair value : values) {
+    deviceCacheSetValue(entry, atoi(value.key().c_str()), value.value().as<float>());
   }
+}
 
-  writeCommonHeaders("POST", path, contentType, payload.length());
-  secureClient.println(payload);
-  skipHttpHeaders();
-
-  String responseBody;
-  while (secureClient.available()) {
-    responseBody += (char)secureClient.read();
+/**
+ * publishFleet()
+ * --------------
+ * Copies the device cache into the fleet snapshot read by the LED task.
+ */
+static void publishFleet() {
+  static FleetSnapshot fleet;  // Too large for the task stack
+  fleet.count = deviceCacheCount();
+  for (size_t i = LOOP_START_INDEX; i < fleet.count; i++) {
+    fleet.devices[i] = *deviceCacheAt(i);
   }
+  fleetState.write(fleet);
+}
 
-  secureClient.stop();
-  return responseBody;
+/**
+ * Builds the filter for one snapshot element: only the fields the cache
+ * uses, and only values of sensor ids it has a slot for.
+ */
+static void buildSnapshotFilter(JsonDocument& filter) {
+  filter["id"] = true;
+  filter["reading_id"] = true;
+  filter["updated_at"] = true;
+
+  JsonObject values = filter["values"].to<JsonObject>();
+  char key[SENSOR_KEY_SIZE];
+  for (int sensorId = FIRST_SENSOR_ID; sensorId <= DEVICE_CACHE_SENSORS; sensorId++) {
+    snprintf(key, sizeof(key), "%d", sensorId);
+    values[key] = true;  // Copied, key is not a literal
+  }
 }
 
 /**
- * getDeviceCount()
- * ----------------
- * Loads the list of devices and populates deviceListBuffer.
- * 
- * @return True if successful, false otherwise.
+ * Waits for the next non-whitespace character of the body and returns it
+ * without consuming it.
+ *
+ * @return The character, or NO_CHARACTER on timeout or disconnect.
  */
-bool getDeviceCount() {
-  String raw = httpGET(API_DEVICES_PATH);
+static int peekBody() {
+  unsigned long start = millis();
+  while (millis() - start < SNAPSHOT_TIMEOUT_MS) {
+    int c = secureClient.peek();
+    if (c == NO_CHARACTER) {
+      if (!secureClient.connected()) break;
+      delay(1);
+      continue;
+    }
+    if (!isspace(c)) return c;
+    secureClient.read();
+  }
+  return NO_CHARACTER;
+}
 
-  int start = raw.indexOf("[{");
-  int end = raw.lastIndexOf("}]") + JSON_ARRAY_OFFSET;
+/**
+ * Parses the snapshot array from the stream one device at a time, so the
+ * memory needed does not grow with the fleet, and applies each device to
+ * the cache right away.
+ *
+ * @return True if the whole array was read.
+ */
+static bool parseSnapshot(unsigned long now) {
+  static JsonDocument filter;
+  static JsonDocument device;  // Reused for every element, holds one device at a time
+  if (filter.isNull()) buildSnapshotFilter(filter);
 
-  if (start == JSON_ARRAY_OPEN_INDEX || end <= start) {
-    Serial.println("JSON array not found");
+  if (peekBody() != '[') {
+    Serial.println("Snapshot parse error: not an array");
     return false;
   }
+  secureClient.read();
+  if (peekBody() == ']') return true;  // No devices
+
+  size_t index = LOOP_START_INDEX;
+  int separator;
+  do {
+    DeserializationError err = deserializeJson(device, secureClient, DeserializationOption::Filter(filter));
+    if (err) {
+      Serial.printf("Snapshot parse error at device %u: %s\n", (unsigned)index, err.c_str());
+      return false;
+    }
 
-  String json = raw.substring(start, end);
-  DeserializationError err = deserializeJson(deviceListBuffer, json);
-  if (err) {
-    Serial.print("JSON parse error: ");
-    Serial.println(err.c_str());
+    CachedDevice* entry = deviceCacheUpsert(device["id"].as<int32_t>(), now);  // nullptr past the cache capacity
+    if (entry && !device["reading_id"].isNull() &&
+        deviceCacheBeginUpdate(entry, device["reading_id"].as<uint32_t>(), device["updated_at"].as<uint32_t>())) {
+      applyValues(entry, device["values"].as<JsonObject>());
+    }
+    index++;
+
+    separator = peekBody();
+    secureClient.read();
+  } while (separator == ',');
+
+  if (separator != ']') {
+    Serial.printf("Snapshot parse error after device %u: array not closed\n", (unsigned)index);
     return false;
   }
-
-  deviceCount = deviceListBuffer.size();
   return true;
 }
 
 /**
- * getLatestReadingForCurrentDevice()
- * ----------------------------------
- * Fetches latest sensor readings for the current device.
- * 
+ * refreshSnapshot()
+ * -----------------
+ * Loads the latest values of all devices in one request, refreshes the
+ * cache and publishes it to the LED task. Devices missing from several
+ * snapshots in a row age out of it. The body is parsed from the stream
+ * one device at a time through a filter, so neither the fleet size nor
+ * fields and sensors the cache has no use for take up memory. An unchanged
+ * snapshot is answered with 304 and only confirms the cached devices.
+ *
  * @return True if successful, false otherwise.
  */
-bool getLatestReadingForCurrentDevice() {
-  if (deviceCount == NO_DEVICES || !deviceListBuffer[currentIndex].containsKey("id")) {
-    Serial.println("No device loaded");
-    return false;
+bool refreshSnapshot() {
+  unsigned long now = millis();
+  int code = beginGET(API_SNAPSHOT_PATH, snapshotEtag);
+  if (code == HTTP_STATUS_NOT_MODIFIED) {
+    deviceCacheRefreshAll(now);
+    return true;
   }
+  if (code != HTTP_STATUS_OK) return false;
 
-  String deviceId = deviceListBuffer[currentIndex]["id"].as<String>();
-  String raw = httpGET(API_LATEST_READING_PATH + deviceId);
-
-  int start = raw.indexOf("[{");
-  int end = raw.lastIndexOf("}]") + JSON_ARRAY_OFFSET;
+  bool parsed = parseSnapshot(now);
+  endGET();
 
-  if (start == JSON_ARRAY_OPEN_INDEX || end <= start) {
-    Serial.println("JSON array not found");
-    return false;
+  if (!parsed) {
+    metricsCount(COUNTER_JSON_PARSE_FAILURES);
+    return false;  // Devices read so far stay cached; the ETag is kept so the next request is a full one
   }
 
-  String json = raw.substring(start, end);
-  DeserializationError err = deserializeJson(readingBuffer, json);
-  if (err) {
-    Serial.print("JSON parse error: ");
-    Serial.println(err.c_str());
+  deviceCacheRemoveStale(now);
+  publishFleet();
+  strlcpy(snapshotEtag, responseEtag, ETAG_SIZE);
+
+  Serial.printf("Snapshot heap: free %lu, lowest %lu bytes\n", (unsigned long)ESP.getFreeHeap(),
+                (unsigned long)ESP.getMinFreeHeap());
+  return true;
+}
+
+/**
+ * initSoundscape()
+ * ----------------
+ * Publishes the built-in rules, so the audio task has a table before the
+ * first request completes or when the API is unreachable.
+ */
+void initSoundscape() {
+  soundscapeLoadDefaults(soundscape);
+  soundscapeState.write(soundscape);
+}
+
+/**
+ * Compiles the {"version", "default_track", "rules"} response into table
+ * and logs why a table that does not fit the firmware is rejected.
+ *
+ * @return False if the table was rejected.
+ */
+static bool compileSoundscape(JsonObject response, SoundscapeTable& table) {
+  soundscapeBegin(table, response["version"].as<uint32_t>(), response["default_track"].as<uint8_t>());
+
+  JsonArray rules = response["rules"].as<JsonArray>();
+  if (rules.size() > SOUNDSCAPE_MAX_RULES) {
+    Serial.printf("Soundscape rejected: %u rules, at most %u\n", (unsigned)rules.size(), (unsigned)SOUNDSCAPE_MAX_RULES);
     return false;
   }
 
-  JsonArray arr = readingBuffer.as<JsonArray>();
-  for (JsonObject obj : arr) {
-    String name = obj["sensor_name"].as<String>();
-    float value = obj["value"].as<float>();
-
-    if (name == SENSOR_NAME_TEMP) {
-      latestTempDHT = value;
-    } else if (name == SENSOR_NAME_HUM) {
-      latestHumDHT = value;
-    } else if (name == SENSOR_NAME_LUX) {
-      latestLux = value;
-    } else if (name == SENSOR_NAME_WATER) {
-      latestWater = value;
-    } else if (name == SENSOR_NAME_TEMP_BMP) {
-      latestTempBMP = value;
-    } else if (name == SENSOR_NAME_PRESS) {
-      latestPressure = value;
+  size_t index = LOOP_START_INDEX;
+  for (JsonObject rule : rules) {
+    SoundCondition conditions[SOUND_MAX_CONDITIONS];
+    size_t count = 0;
+
+    for (JsonArray condition : rule["when"].as<JsonArray>()) {
+      const char* inputName = condition[0].as<const char*>();
+      const char* opName = condition[1].as<const char*>();
+      int input = soundInputFromName(inputName);
+      int op = soundOpFromName(opName);
+      if (input == SOUND_UNKNOWN || op == SOUND_UNKNOWN) {
+        Serial.printf("Soundscape rejected: rule %u compares unknown \"%s\" \"%s\"\n", (unsigned)index,
+                      inputName ? inputName : "", opName ? opName : "");
+        return false;
+      }
+      if (count >= SOUND_MAX_CONDITIONS) {
+        Serial.printf("Soundscape rejected: rule %u has more than %u conditions\n", (unsigned)index, (unsigned)SOUND_MAX_CONDITIONS);
+        return false;
+      }
+      conditions[count++] = { (uint8_t)input, (uint8_t)op, condition[2].as<float>() };
     }
-  }
 
-  sendCurrentIndexUpdate(currentIndex);
-  playBasedOnSensorData(latestTempDHT, latestHumDHT, latestLux, latestWater, latestPressure);
-  showColor(latestTempDHT);
+    if (!soundscapeAddRule(table, rule["track"].as<uint8_t>(), conditions, count)) {
+      Serial.printf("Soundscape rejected: rule %u needs more than %u distinct comparisons\n", (unsigned)index,
+                    (unsigned)SOUNDSCAPE_MAX_PREDICATES);
+      return false;
+    }
+    index++;
+  }
   return true;
 }
 
 /**
- * next()
- * ------
- * Moves to the next device and retrieves its latest reading.
+ * refreshSoundscape()
+ * -------------------
+ * Loads the rule table built from the sound_* settings. It is only compiled
+ * and published when its version differs from the current one; an invalid
+ * or oversized table keeps the current one. An unchanged table is answered
+ * with 304 and not downloaded at all.
+ *
+ * @return True if the current table is up to date.
  */
-void next() {
-  if (deviceCount == NO_DEVICES) return;
-  currentIndex = (currentIndex + INDEX_INCREMENT) % deviceCount;
-  getLatestReadingForCurrentDevice();
-  sendCurrentIndexUpdate(currentIndex);
-}
+bool refreshSoundscape() {
+  int code = beginGET(API_SOUNDSCAPE_PATH, soundscapeEtag);
+  if (code == HTTP_STATUS_NOT_MODIFIED) return true;
+  if (code != HTTP_STATUS_OK) return false;
+
+  DeserializationError err = deserializeJson(soundscapeBuffer, secureClient);
+  endGET();
+
+  if (err || soundscapeBuffer.overflowed()) {
+    metricsCount(COUNTER_JSON_PARSE_FAILURES);
+    Serial.printf("Soundscape parse error: %s\n", err ? err.c_str() : "out of memory");
+    soundscapeBuffer.clear();
+    return false;
+  }
 
-/**
- * previous()
- * ----------
- * Moves to the previous device and retrieves its latest reading.
- */
-void previous() {
-  if (deviceCount == NO_DEVICES) return;
-  currentIndex = (currentIndex - INDEX_DECREMENT + deviceCount) % deviceCount;
-  getLatestReadingForCurrentDevice();
+  JsonObject response = soundscapeBuffer.as<JsonObject>();
+  if (response["version"].as<uint32_t>() == soundscape.version) {
+    soundscapeBuffer.clear();
+    strlcpy(soundscapeEtag, responseEtag, ETAG_SIZE);
+    return true;
+  }
+
+  static SoundscapeTable next;
+  bool valid = compileSoundscape(response, next);
+  soundscapeBuffer.clear();
+
+  if (!valid) {
+    Serial.println("Keeping the current soundscape");
+    return false;
+  }
+
+  soundscape = next;
+  soundscapeState.write(soundscape);
+  strlcpy(soundscapeEtag, responseEtag, ETAG_SIZE);
+  Serial.print("Soundscape version: ");
+  Serial.println(soundscape.version);
+  return true;
 }
 
 /**
- * sendCurrentIndexUpdate(currentIndex)
- * ------------------------------------
- * Sends the current index to the server via WebSocket publisher endpoint.
- * 
- * @param currentIndex Index to publish.
+ * handleReadingEvent(data)
+ * ------------------------
+ * Applies a {"device_id", "reading_id", "ts", "values"} event published by
+ * the API after a reading was stored, and republishes the fleet. Devices
+ * not cached yet are picked up by the next snapshot. The server timestamp
+ * is kept with the entry, so the LED task can log the ingest-to-LED latency.
+ *
+ * @param data JSON event data.
  */
-void sendCurrentIndexUpdate(int currentIndex) {
-  String payload = "{\"index\": " + String(currentIndex) + "}";
-  String response = httpPOST(API_INDEX_UPDATE_PATH, payload, "application/json");
+void handleReadingEvent(const char* data) {
+  JsonDocument event;
+  DeserializationError err = deserializeJson(event, data);
+  if (err) {
+    metricsCount(COUNTER_JSON_PARSE_FAILURES);
+    Serial.print("Event parse error: ");
+    Serial.println(err.c_str());
+    return;
+  }
+
+  CachedDevice* entry = deviceCacheFind(event["device_id"].as<int32_t>());
+  uint32_t readingId = event["reading_id"].as<uint32_t>();
+  long long ingestedAt = event["ts"].as<long long>();
+  if (!entry || !deviceCacheBeginUpdate(entry, readingId, ingestedAt / MS_PER_SECOND)) return;
+
+  applyValues(entry, event["values"].as<JsonObject>());
+  entry->pushedReadingId = readingId;
+  entry->pushedAtMs = ingestedAt;
+  publishFleet();
 }
@@ -4,82 +4,61 @@
 // License: MIT License
 // Copyright (c) 2025 Yanis Deplazes
 // Description: Declares the HTTPS client interface for retrieving the latest
-//              sensor readings from all registered devices via a remote API.
+//              sensor readings from all registered devices via a remote API
+//              and keeping them in the device cache.
 // ============================================================================
 
 #pragma once
 #include <Arduino.h>
+#include "Soundscape.h"
 
 // ----------------------------------------------------------------------------
 // Constants & Macros (shared with Client.cpp to avoid magic numbers)
 // ----------------------------------------------------------------------------
 #define API_HOST "yanisdeplazes.loca.lt"
 #define API_PORT 443
-#define API_DEVICES_PATH "/api/device"
-#define API_LATEST_READING_PATH "/api/views/LatestDeviceReadings?device_id="
-#define API_INDEX_UPDATE_PATH "/api/installation/publish"
+#define API_SNAPSHOT_PATH "/api/snapshot"
+#define API_SOUNDSCAPE_PATH "/api/soundscape"
 
-#define DOC_BUFFER_SIZE 4096
+#define SNAPSHOT_TIMEOUT_MS 5000
+#define NO_CHARACTER -1
 #define HEADER_END_LINE "\r"
+#define STATUS_CODE_OFFSET 9  // "HTTP/1.0 " precedes the status code
+#define HTTP_STATUS_OK 200
 
-#define JSON_ARRAY_OFFSET 2
-#define JSON_ARRAY_OPEN_INDEX 0
+#define FIRST_SENSOR_ID 1
+#define SENSOR_KEY_SIZE 4
 #define LOOP_START_INDEX 0
 
 #define FLOAT_DECIMAL_PRECISION 2
 
-#define SENSOR_NAME_TEMP "DHT11 Temperature Sensor"
-#define SENSOR_NAME_HUM "DHT11 Humidity Sensor"
-#define SENSOR_NAME_LUX "BH1750 Light Sensor"
-#define SENSOR_NAME_WATER "Analog Water Sensor"
-#define SENSOR_NAME_PRESS "BMP180 Pressure Sensor"
-#define SENSOR_NAME_TEMP_BMP "BMP180 Temperature Sensor"
+#define MS_PER_SECOND 1000LL
 
 #define NO_DEVICES 0
-#define INDEX_INCREMENT 1
-#define INDEX_DECREMENT 1
 
 // ----------------------------------------------------------------------------
 // HTTPS Client Function Declarations
 // ----------------------------------------------------------------------------
 
 /**
- * Performs a HTTPS GET request to the specified API path.
+ * Refreshes the device cache from the snapshot of all devices and
+ * publishes it to the LED task.
  */
-String httpGET(const String& path);
+bool refreshSnapshot();
 
 /**
- * Performs a HTTPS POST request with a payload and content-type.
+ * Publishes the built-in soundscape to the audio task.
  */
-String httpPOST(const String& path, const String& payload, const String& contentType);
+void initSoundscape();
 
 /**
- * Loads and parses all registered devices.
+ * Loads the soundscape rules from the API and publishes them to the audio
+ * task if their version changed.
  */
-bool getDeviceCount();
+bool refreshSoundscape();
 
 /**
- * Loads and parses the latest readings for the current device.
+ * Applies a "new reading" event from the event stream to the device cache.
  */
-bool getLatestReadingForCurrentDevice();
+void handleReadingEvent(const char* data);
 
-/**
- * Advances to the next device (cyclic).
- */
-void next();
-
-/**
- * Goes back to the previous device (cyclic).
- */
-void previous();
-
-/**
- * Publishes the current device index to the server.
- */
-void sendCurrentIndexUpdate(int currentIndex);
-
-// ----------------------------------------------------------------------------
-// Shared State
-// ----------------------------------------------------------------------------
-
-extern int currentIndex;
\ No newline at end of file
@@ -4,45 +4,296 @@
 // License: MIT License
 // Copyright (c) 2025 Yanis Deplazes
 // Description: Manages DFPlayer Mini logic including initialization, volume
-//              control, and playback of indexed ambient audio files.
+//              control, and playback of indexed ambient audio files. Commands
+//              are sent as raw serial frames, one at a time, each waiting for
+//              the module's acknowledgement without blocking the caller.
 // ============================================================================
 
 #include "DFPlayerManager.h"
-#include "DFRobotDFPlayerMini.h"
+#include "Metrics.h"
+#include <atomic>
 
 // ----------------------------------------------------------------------------
 // Constants & Macros
 // ----------------------------------------------------------------------------
-#define TRACK_DEFAULT 6
-#define RAIN_THRESHOLD 500.0f
-#define TEMP_VERY_COLD_THRESHOLD 5.0f
-#define TEMP_MILD_DAY_THRESHOLD 25.0f
-#define TEMP_WARM_MIN 20.0f
-#define TEMP_HOT_MIN 28.0f
-#define PRESSURE_LOW 1000.0f
-#define PRESSURE_MILD 1015.0f
-#define LUX_NIGHT_MAX 50.0f
-#define LUX_SUNSET_MAX 200.0f
-#define LUX_DAY_MIN 400.0f
-#define LUX_DAY_MAX 1000.0f
-#define HUMIDITY_HIGH 80.0f
 #define DFPLAYER_BAUDRATE 9600
 
-// ----------------------------------------------------------------------------
-// Volume Configuration Macros
-// ----------------------------------------------------------------------------
+#define DFPLAYER_QUEUE_SIZE 8
+#define DFPLAYER_ACK_TIMEOUT_MS 200
+#define DFPLAYER_MAX_RETRIES 3
+#define DFPLAYER_PROBE_INTERVAL_MS 10000
+#define DFPLAYER_RAMP_STEP_MS 60
+#define DFPLAYER_RAMP_STEP 2
+
+// Serial frame: 7E FF 06 CMD FEEDBACK PARAM_H PARAM_L CHECKSUM_H CHECKSUM_L EF
+#define FRAME_SIZE 10
+#define FRAME_START 0x7E
+#define FRAME_VERSION 0xFF
+#define FRAME_LENGTH 0x06
+#define FRAME_END 0xEF
+#define FRAME_FEEDBACK 0x01
+#define FRAME_VERSION_INDEX 1
+#define FRAME_LENGTH_INDEX 2
+#define FRAME_CMD_INDEX 3
+#define FRAME_CHECKSUM_HIGH_INDEX 7
+#define FRAME_CHECKSUM_LOW_INDEX 8
+#define FRAME_END_INDEX 9
+#define BYTE_SHIFT 8
+#define BYTE_MASK 0xFF
+
+#define CMD_VOLUME 0x06
+#define CMD_LOOP_TRACK 0x08
+#define CMD_QUERY_STATUS 0x42  // Used as probe
+#define REPLY_MODULE_ONLINE 0x3F
+#define REPLY_ERROR 0x40
+#define REPLY_ACK 0x41
+
 #define DFPLAYER_VOLUME_MIN 0
 #define DFPLAYER_VOLUME_MAX 30
 #define DFPLAYER_VOLUME_INIT 20
+#define VOLUME_UNKNOWN 0xFF
+#define NO_TRACK 0
+#define NO_PARAM 0
+#define LOOP_START_INDEX 0
 
 // ----------------------------------------------------------------------------
 // Static State
 // ----------------------------------------------------------------------------
-static DFRobotDFPlayerMini player;
+
+/**
+ * Connection state of the module.
+ */
+enum PlayerState {
+  PLAYER_PROBING,  // Probe sent, waiting for the first acknowledgement
+  PLAYER_ONLINE,
+  PLAYER_OFFLINE   // Degraded mode: nothing is sent except periodic probes
+};
+
+/**
+ * A command waiting to be sent, or waiting for its acknowledgement.
+ */
+struct PlayerCommand {
+  uint8_t cmd;
+  uint16_t param;
+  uint32_t queuedAtMs;
+};
+
 static HardwareSerial* dfSerial;
-static uint8_t currentVolume = DFPLAYER_VOLUME_INIT;
-static uint8_t lastTrackPlayed = 0;
-static int rxPin, txPin;
+static PlayerState state = PLAYER_OFFLINE;
+
+static PlayerCommand queue[DFPLAYER_QUEUE_SIZE];
+static size_t queueHead = 0;
+static size_t queueCount = 0;
+
+static bool inFlight = false;
+static PlayerCommand current;
+static uint8_t attempts = 0;
+static uint32_t sentAtMs = 0;
+
+static uint8_t rxFrame[FRAME_SIZE];
+static size_t rxIndex = 0;
+
+static uint8_t currentVolume = DFPLAYER_VOLUME_INIT;  // Target set by the caller
+static uint8_t sentVolume = VOLUME_UNKNOWN;           // Level of the module
+static uint8_t requestedTrack = NO_TRACK;
+static uint8_t playingTrack = NO_TRACK;
+static uint32_t lastRampMs = 0;
+static uint32_t lastProbeMs = 0;
+static bool reportedOffline = false;
+
+static std::atomic<bool> online{ false };
+static std::atomic<uint32_t> sentCount{ 0 };
+static std::atomic<uint32_t> ackCount{ 0 };
+static std::atomic<uint32_t> retryCount{ 0 };
+static std::atomic<uint32_t> failureCount{ 0 };
+static std::atomic<uint32_t> droppedCount{ 0 };
+static std::atomic<uint32_t> maxQueueDepth{ 0 };
+static std::atomic<uint32_t> totalLatencyMs{ 0 };
+static std::atomic<uint32_t> maxLatencyMs{ 0 };
+
+// ----------------------------------------------------------------------------
+// Command Queue
+// ----------------------------------------------------------------------------
+
+/**
+ * Queues a command. A queued volume change is replaced instead of adding a
+ * second one, so only the newest level is sent.
+ *
+ * @return False if the queue is full.
+ */
+static bool enqueue(uint8_t cmd, uint16_t param, uint32_t nowMs) {
+  if (cmd == CMD_VOLUME) {
+    for (size_t i = LOOP_START_INDEX; i < queueCount; i++) {
+      PlayerCommand& queued = queue[(queueHead + i) % DFPLAYER_QUEUE_SIZE];
+      if (queued.cmd == CMD_VOLUME) {
+        queued.param = param;
+        return true;
+      }
+    }
+  }
+
+  if (queueCount >= DFPLAYER_QUEUE_SIZE) {
+    droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  queue[(queueHead + queueCount) % DFPLAYER_QUEUE_SIZE] = { cmd, param, nowMs };
+  queueCount++;
+  if (queueCount > maxQueueDepth.load(std::memory_order_relaxed)) maxQueueDepth.store(queueCount, std::memory_order_relaxed);
+  return true;
+}
+
+/**
+ * Writes one frame with acknowledgement requested.
+ */
+static void sendFrame(uint8_t cmd, uint16_t param) {
+  uint8_t frame[FRAME_SIZE] = { FRAME_START, FRAME_VERSION, FRAME_LENGTH, cmd, FRAME_FEEDBACK,
+                                (uint8_t)(param >> BYTE_SHIFT), (uint8_t)(param & BYTE_MASK), 0, 0, FRAME_END };
+
+  uint16_t sum = 0;
+  for (int i = FRAME_VERSION_INDEX; i < FRAME_CHECKSUM_HIGH_INDEX; i++) sum += frame[i];
+  uint16_t checksum = 0 - sum;
+  frame[FRAME_CHECKSUM_HIGH_INDEX] = checksum >> BYTE_SHIFT;
+  frame[FRAME_CHECKSUM_LOW_INDEX] = checksum & BYTE_MASK;
+
+  dfSerial->write(frame, FRAME_SIZE);
+  sentCount.fetch_add(1, std::memory_order_relaxed);
+  metricsCount(COUNTER_DFPLAYER_COMMANDS);
+}
+
+/**
+ * Forgets what the module plays and at which volume, e.g. after it reset,
+ * so the ramp restores both.
+ */
+static void resetPlaybackState() {
+  sentVolume = VOLUME_UNKNOWN;
+  playingTrack = NO_TRACK;
+}
+
+/**
+ * Enters degraded mode: queued commands are discarded and only probes are
+ * sent until the module answers again.
+ */
+static void goOffline(uint32_t nowMs) {
+  if (!reportedOffline) Serial.println("DFPlayer not responding, audio disabled");
+  reportedOffline = true;
+  state = PLAYER_OFFLINE;
+  online.store(false, std::memory_order_relaxed);
+  inFlight = false;
+  queueCount = 0;
+  lastProbeMs = nowMs;
+  resetPlaybackState();
+}
+
+/**
+ * Completes the command in flight after its acknowledgement.
+ */
+static void completeCommand(uint32_t nowMs) {
+  if (!inFlight) return;
+  inFlight = false;
+
+  uint32_t latency = nowMs - current.queuedAtMs;
+  ackCount.fetch_add(1, std::memory_order_relaxed);
+  totalLatencyMs.fetch_add(latency, std::memory_order_relaxed);
+  if (latency > maxLatencyMs.load(std::memory_order_relaxed)) maxLatencyMs.store(latency, std::memory_order_relaxed);
+
+  if (state == PLAYER_PROBING) {
+    Serial.println("DFPlayer online");
+    state = PLAYER_ONLINE;
+    online.store(true, std::memory_order_relaxed);
+    reportedOffline = false;
+    resetPlaybackState();
+  }
+}
+
+/**
+ * Sends the command in flight again, or gives up on the module once it
+ * missed every attempt. Track and volume are restored once it is back.
+ */
+static void retryCommand(uint32_t nowMs) {
+  if (attempts >= DFPLAYER_MAX_RETRIES) {
+    failureCount.fetch_add(1, std::memory_order_relaxed);
+    goOffline(nowMs);
+    return;
+  }
+
+  attempts++;
+  retryCount.fetch_add(1, std::memory_order_relaxed);
+  sentAtMs = nowMs;
+  sendFrame(current.cmd, current.param);
+}
+
+/**
+ * Handles one complete, checksum-verified frame from the module.
+ */
+static void handleFrame(uint32_t nowMs) {
+  switch (rxFrame[FRAME_CMD_INDEX]) {
+    case REPLY_ACK:
+      completeCommand(nowMs);
+      break;
+    case REPLY_ERROR:
+      if (inFlight) retryCommand(nowMs);
+      break;
+    case REPLY_MODULE_ONLINE:
+      Serial.println("DFPlayer reset");
+      resetPlaybackState();
+      break;
+    default:
+      break;  // Replies to queries carry no acknowledgement of their own
+  }
+}
+
+/**
+ * Reads available bytes into frames, resynchronizing on the start byte.
+ */
+static void readReplies(uint32_t nowMs) {
+  while (dfSerial->available()) {
+    uint8_t value = dfSerial->read();
+    if (rxIndex == LOOP_START_INDEX && value != FRAME_START) continue;
+
+    rxFrame[rxIndex++] = value;
+    if (rxIndex < FRAME_SIZE) continue;
+    rxIndex = LOOP_START_INDEX;
+
+    uint16_t sum = 0;
+    for (int i = FRAME_VERSION_INDEX; i < FRAME_CHECKSUM_HIGH_INDEX; i++) sum += rxFrame[i];
+    uint16_t checksum = (rxFrame[FRAME_CHECKSUM_HIGH_INDEX] << BYTE_SHIFT) | rxFrame[FRAME_CHECKSUM_LOW_INDEX];
+
+    if (rxFrame[FRAME_VERSION_INDEX] == FRAME_VERSION && rxFrame[FRAME_LENGTH_INDEX] == FRAME_LENGTH
+        && rxFrame[FRAME_END_INDEX] == FRAME_END && (uint16_t)(sum + checksum) == 0) {
+      handleFrame(nowMs);
+    }
+  }
+}
+
+/**
+ * Moves the module one step towards the requested track and volume: fade
+ * out, switch the track at volume 0, fade back in. Steps are only queued
+ * when the previous command was acknowledged, so ramps never pile up.
+ */
+static void stepRamp(uint32_t nowMs) {
+  if (inFlight || queueCount || nowMs - lastRampMs < DFPLAYER_RAMP_STEP_MS) return;
+
+  bool switching = requestedTrack != playingTrack;
+  if (switching && sentVolume == DFPLAYER_VOLUME_MIN) {
+    enqueue(CMD_LOOP_TRACK, requestedTrack, nowMs);
+    playingTrack = requestedTrack;
+    return;
+  }
+
+  uint8_t target = switching ? DFPLAYER_VOLUME_MIN : currentVolume;
+  if (sentVolume == target) return;
+
+  uint8_t next = target;  // Nothing audible yet: no need to ramp
+  if (sentVolume != VOLUME_UNKNOWN && playingTrack != NO_TRACK) {
+    next = sentVolume > target ? max(sentVolume - DFPLAYER_RAMP_STEP, (int)target)
+                               : min(sentVolume + DFPLAYER_RAMP_STEP, (int)target);
+  }
+
+  enqueue(CMD_VOLUME, next, nowMs);
+  sentVolume = next;
+  lastRampMs = nowMs;
+}
 
 // ----------------------------------------------------------------------------
 // DFPlayer Initialization
@@ -51,7 +302,10 @@ static int rxPin, txPin;
 /**
  * initDFPlayer()
  * --------------
- * Initializes the DFPlayer Mini via a hardware serial connection.
+ * Opens the hardware serial connection and queues a probe. If the module
+ * does not answer, playback is disabled and the probe repeated every
+ * DFPLAYER_PROBE_INTERVAL_MS, so a missing module never halts the device.
+ * Calling it again starts over with an empty queue and default volume.
  *
  * @param serial Pointer to HardwareSerial instance.
  * @param rx Receive pin number.
@@ -59,30 +313,67 @@ static int rxPin, txPin;
  */
 void initDFPlayer(HardwareSerial* serial, int rx, int tx) {
   dfSerial = serial;
-  rxPin = rx;
-  txPin = tx;
+  dfSerial->begin(DFPLAYER_BAUDRATE, SERIAL_8N1, rx, tx);
+
+  uint32_t now = millis();
+  queueHead = 0;
+  queueCount = 0;
+  inFlight = false;
+  rxIndex = LOOP_START_INDEX;
+  currentVolume = DFPLAYER_VOLUME_INIT;
+  requestedTrack = NO_TRACK;
+  lastRampMs = 0;
+  reportedOffline = false;
+  resetPlaybackState();
 
-  dfSerial->begin(DFPLAYER_BAUDRATE, SERIAL_8N1, rxPin, txPin);
+  state = PLAYER_PROBING;
+  online.store(false, std::memory_order_relaxed);
+  enqueue(CMD_QUERY_STATUS, NO_PARAM, now);
+}
+
+/**
+ * updateDFPlayer(nowMs)
+ * ---------------------
+ * Reads replies, retries an unacknowledged command after
+ * DFPLAYER_ACK_TIMEOUT_MS, advances the volume ramp and sends the next
+ * queued command. Only one command is in flight at a time.
+ *
+ * @param nowMs Current millis().
+ */
+void updateDFPlayer(unsigned long nowMs) {
+  if (!dfSerial) return;
+  readReplies(nowMs);
+
+  if (inFlight && nowMs - sentAtMs >= DFPLAYER_ACK_TIMEOUT_MS) retryCommand(nowMs);
 
-  if (!player.begin(*dfSerial)) {
-    Serial.println("DFPlayer init failed");
-    while (true)
-      ;  // Halt if initialization fails
+  if (state == PLAYER_OFFLINE) {
+    if (nowMs - lastProbeMs < DFPLAYER_PROBE_INTERVAL_MS) return;
+    state = PLAYER_PROBING;
+    enqueue(CMD_QUERY_STATUS, NO_PARAM, nowMs);
   }
 
-  setVolume(currentVolume);
+  if (state == PLAYER_ONLINE) stepRamp(nowMs);
+
+  if (inFlight || !queueCount) return;
+  current = queue[queueHead];
+  queueHead = (queueHead + 1) % DFPLAYER_QUEUE_SIZE;
+  queueCount--;
+
+  inFlight = true;
+  attempts = 0;
+  sentAtMs = nowMs;
+  sendFrame(current.cmd, current.param);
 }
 
 /**
  * setVolume()
  * -----------
- * Sets the volume level within valid range.
+ * Sets the target volume within valid range. The module is ramped to it.
  *
  * @param vol Volume level (0–30).
  */
 void setVolume(uint8_t vol) {
   currentVolume = constrain(vol, DFPLAYER_VOLUME_MIN, DFPLAYER_VOLUME_MAX);
-  player.volume(currentVolume);
 }
 
 /**
@@ -92,7 +383,7 @@ void setVolume(uint8_t vol) {
  */
 void volumeUp() {
   if (currentVolume < DFPLAYER_VOLUME_MAX) {
-    setVolume(++currentVolume);
+    setVolume(currentVolume + 1);
   }
 }
 
@@ -103,67 +394,46 @@ void volumeUp() {
  */
 void volumeDown() {
   if (currentVolume > DFPLAYER_VOLUME_MIN) {
-    setVolume(--currentVolume);
+    setVolume(currentVolume - 1);
   }
 }
 
 /**
  * playTrack()
  * -----------
- * Plays a specific ambient track in loop, only if different from the last.
+ * Requests a specific ambient track in loop, only if different from the
+ * last. The ramp fades out, switches and fades in; a newer request during
+ * a ramp replaces the older one. While the module is offline the request
+ * is kept and played once it answers again.
  *
  * @param track Track index to play.
  */
 void playTrack(uint8_t track) {
-  if (track != lastTrackPlayed) {
+  if (track != requestedTrack) {
     Serial.println("Playing new Track");
     Serial.println(track);
-    player.loop(track);
-    lastTrackPlayed = track;
+    requestedTrack = track;
   }
 }
 
 /**
- * playBasedOnSensorData()
- * -----------------------
- * Determines appropriate ambient track based on sensor input.
- *
- * @param temp Temperature in °C.
- * @param hum Relative humidity in %.
- * @param lux Ambient light in lux.
- * @param water Analog water level.
- * @param pressure Atmospheric pressure in hPa.
- */
-void playBasedOnSensorData(float temp, float hum, float lux, float water, float pressure) {
-  uint8_t trackToPlay = TRACK_DEFAULT;
-
-  if (water > RAIN_THRESHOLD) {
-    trackToPlay = TRACK_RAINSTORM;
-  } else if (temp < TEMP_VERY_COLD_THRESHOLD && pressure < PRESSURE_LOW) {
-    trackToPlay = TRACK_BLIZZARD_WIND;
-  } else if (temp < TEMP_VERY_COLD_THRESHOLD && pressure >= PRESSURE_LOW && lux <= LUX_SUNSET_MAX) {
-    trackToPlay = TRACK_COLD_SUNSET_WIND;
-  } else if (temp < TEMP_VERY_COLD_THRESHOLD && pressure >= PRESSURE_LOW) {
-    trackToPlay = TRACK_COLD_WINTER_DAY;
-  } else if (temp <= TEMP_WARM_MIN && lux < LUX_NIGHT_MAX) {
-    trackToPlay = TRACK_CALM_NIGHT_CRICKETS;
-  } else if (temp < TEMP_WARM_MIN && pressure < PRESSURE_LOW) {
-    trackToPlay = TRACK_MILD_STORM_WIND;
-  } else if (temp < TEMP_WARM_MIN && pressure >= PRESSURE_LOW && lux > LUX_DAY_MIN) {
-    trackToPlay = TRACK_SPRING_MORNING_BIRDS;
-  } else if (temp < TEMP_WARM_MIN && lux < LUX_SUNSET_MAX && lux >= LUX_NIGHT_MAX) {
-    trackToPlay = TRACK_SPRING_EVENING_CHILL;
-  } else if (temp < TEMP_MILD_DAY_THRESHOLD && pressure <= PRESSURE_MILD && hum < HUMIDITY_HIGH) {
-    trackToPlay = TRACK_MILD_DAY_BREEZE;
-  } else if (temp < TEMP_HOT_MIN && pressure < PRESSURE_LOW && hum > HUMIDITY_HIGH) {
-    trackToPlay = TRACK_HUMID_STORM_BUILD;
-  } else if (temp >= TEMP_WARM_MIN && temp < TEMP_HOT_MIN && lux >= LUX_SUNSET_MAX && lux < LUX_DAY_MAX) {
-    trackToPlay = TRACK_WARM_MORNING_BIRDS;
-  } else if (temp >= TEMP_HOT_MIN && lux > LUX_DAY_MAX) {
-    trackToPlay = TRACK_SUMMER_CICADAS;
-  } else if (temp >= TEMP_HOT_MIN && lux < LUX_SUNSET_MAX) {
-    trackToPlay = TRACK_SUMMER_NIGHT_CRICKETS;
-  }
+ * printDFPlayerStats()
+ * --------------------
+ * Prints the module state, sent/acknowledged commands, retries, failures,
+ * dropped commands, the deepest queue and the latency from queueing to
+ * acknowledgement since the last call.
+ */
+void printDFPlayerStats() {
+  uint32_t acks = ackCount.exchange(0, std::memory_order_relaxed);
+  uint32_t totalLatency = totalLatencyMs.exchange(0, std::memory_order_relaxed);
 
-  playTrack(trackToPlay);
+  Serial.printf("DFPlayer %s: sent %lu, acked %lu, retries %lu, failed %lu, dropped %lu, max queue %lu, latency avg %lu ms, max %lu ms\n",
+                online.load(std::memory_order_relaxed) ? "online" : "offline",
+                (unsigned long)sentCount.exchange(0, std::memory_order_relaxed), (unsigned long)acks,
+                (unsigned long)retryCount.exchange(0, std::memory_order_relaxed),
+                (unsigned long)failureCount.exchange(0, std::memory_order_relaxed),
+                (unsigned long)droppedCount.exchange(0, std::memory_order_relaxed),
+                (unsigned long)maxQueueDepth.exchange(0, std::memory_order_relaxed),
+                (unsigned long)(acks ? totalLatency / acks : 0),
+                (unsigned long)maxLatencyMs.exchange(0, std::memory_order_relaxed));
 }
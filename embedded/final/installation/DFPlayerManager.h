@@ -3,8 +3,9 @@
 // Author: Yanis Deplazes
 // License: MIT License
 // Copyright (c) 2025 Yanis Deplazes
-// Description: Header file for DFPlayer Mini logic: initialization, playback,
-//              volume control, and track selection based on sensor data.
+// Description: Header file for DFPlayer Mini logic: initialization, playback
+//              and volume control through a non-blocking command queue.
+//              Tracks are selected by the soundscape.
 // ============================================================================
 
 #pragma once
@@ -14,6 +15,14 @@
 #define DFPLAYER_VOLUME_MAX 30
 #define DFPLAYER_VOLUME_INIT 20
 #define DFPLAYER_BAUDRATE 9600
+
+#define DFPLAYER_QUEUE_SIZE 8
+#define DFPLAYER_ACK_TIMEOUT_MS 200
+#define DFPLAYER_MAX_RETRIES 3
+#define DFPLAYER_PROBE_INTERVAL_MS 10000  // While the module does not answer
+#define DFPLAYER_RAMP_STEP_MS 60
+#define DFPLAYER_RAMP_STEP 2              // Volume per ramp step
+
 #define TRACK_RAINSTORM 1
 #define TRACK_BLIZZARD_WIND 2
 #define TRACK_COLD_WINTER_DAY 3
@@ -28,31 +37,23 @@
 #define TRACK_SUMMER_CICADAS 12
 #define TRACK_SUMMER_NIGHT_CRICKETS 13
 #define TRACK_DEFAULT TRACK_SPRING_MORNING_BIRDS
-#define RAIN_THRESHOLD 500.0f
-#define TEMP_VERY_COLD_THRESHOLD 5.0f
-#define TEMP_MILD_DAY_THRESHOLD 25.0f
-#define TEMP_WARM_MIN 20.0f
-#define TEMP_HOT_MIN 28.0f
-
-#define PRESSURE_LOW 1000.0f
-#define PRESSURE_MILD 1015.0f
-
-#define LUX_NIGHT_MAX 50.0f
-#define LUX_SUNSET_MAX 200.0f
-#define LUX_DAY_MIN 400.0f
-#define LUX_DAY_MAX 1000.0f
-
-#define HUMIDITY_HIGH 80.0f
-
 
 /**
- * Initializes the DFPlayer Mini over the given HardwareSerial interface.
+ * Opens the serial connection and queues a probe. Never blocks: without an
+ * answer the player runs in degraded mode and probes again periodically.
  */
 void initDFPlayer(HardwareSerial* serial, int rx, int tx);
 
 /**
- * Sets volume within defined range.
-  */
+ * Processes replies, retries and volume ramps and sends the next queued
+ * command. Call regularly from the audio task; all other functions below
+ * must be called from the same task.
+ */
+void updateDFPlayer(unsigned long nowMs);
+
+/**
+ * Sets the target volume within the defined range; it is ramped to.
+ */
 void setVolume(uint8_t vol);
 
 /**
@@ -66,11 +67,14 @@ void volumeUp();
 void volumeDown();
 
 /**
- * Plays the given track if it differs from the last played.
+ * Fades out, loops the given track and fades back in, if it differs from
+ * the last requested track.
  */
 void playTrack(uint8_t track);
 
 /**
- * Evaluates environmental sensor data to determine which ambient track to play.
+ * Prints queue depth, command latency and failure counters since the last
+ * call. Safe to call from any task.
  */
-void playBasedOnSensorData(float temp, float hum, float lux, float water, float pressure);
+void printDFPlayerStats();
+
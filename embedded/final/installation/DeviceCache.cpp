@@ -0,0 +1,230 @@
+// ============================================================================
+// File: DeviceCache.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the device cache as a sorted fixed-size array.
+//              Entries stay ordered by device id, matching the order of the
+//              device list in the frontend. Pointers returned by the cache
+//              are only valid until the next upsert or removal.
+// ============================================================================
+
+#include "DeviceCache.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define FIRST_SENSOR_ID 1
+#define SENSOR_BIT(id) (1 << ((id) - FIRST_SENSOR_ID))
+#define LOOP_START_INDEX 0
+
+// ----------------------------------------------------------------------------
+// Cache State
+// ----------------------------------------------------------------------------
+static CachedDevice entries[DEVICE_CACHE_CAPACITY];
+static size_t entryCount = 0;
+
+/**
+ * Position of the first entry with an id not less than the given one.
+ */
+static size_t lowerBound(int32_t id) {
+  size_t low = 0;
+  size_t high = entryCount;
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (entries[mid].id < id) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/**
+ * Removes the entry at the given position.
+ */
+static void removeAt(size_t index) {
+  memmove(&entries[index], &entries[index + 1], sizeof(CachedDevice) * (entryCount - index - 1));
+  entryCount--;
+}
+
+/**
+ * Position of the least recently refreshed entry.
+ */
+static size_t oldestIndex(unsigned long nowMs) {
+  size_t oldest = LOOP_START_INDEX;
+  for (size_t i = LOOP_START_INDEX; i < entryCount; i++) {
+    if (nowMs - entries[i].refreshedAtMs > nowMs - entries[oldest].refreshedAtMs) oldest = i;
+  }
+  return oldest;
+}
+
+/**
+ * True for the sensor ids the cache has a slot for.
+ */
+static bool isKnownSensor(int sensorId) {
+  return sensorId >= FIRST_SENSOR_ID && sensorId < FIRST_SENSOR_ID + DEVICE_CACHE_SENSORS;
+}
+
+// ----------------------------------------------------------------------------
+// Device Cache Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * deviceCacheFind(id)
+ * -------------------
+ * @param id Device id.
+ * @return The cached entry, or nullptr.
+ */
+CachedDevice* deviceCacheFind(int32_t id) {
+  size_t index = lowerBound(id);
+  return index < entryCount && entries[index].id == id ? &entries[index] : nullptr;
+}
+
+/**
+ * deviceCacheUpsert(id, nowMs)
+ * ----------------------------
+ * Marks a device as refreshed, inserting it in id order if it is new. When
+ * the cache is full, the entry that went longest without a refresh makes
+ * room; that is normally a device deleted on the server. Entries refreshed
+ * at nowMs belong to the snapshot being applied and are never evicted, so
+ * a fleet larger than the cache keeps its first DEVICE_CACHE_CAPACITY
+ * devices instead of replacing them one after the other.
+ *
+ * @param id Device id.
+ * @param nowMs Current millis(), the same for all devices of a snapshot.
+ * @return The entry of the device, or nullptr if the cache is full.
+ */
+CachedDevice* deviceCacheUpsert(int32_t id, unsigned long nowMs) {
+  CachedDevice* entry = deviceCacheFind(id);
+  if (entry) {
+    entry->refreshedAtMs = nowMs;
+    return entry;
+  }
+
+  if (entryCount == DEVICE_CACHE_CAPACITY) {
+    size_t oldest = oldestIndex(nowMs);
+    if (entries[oldest].refreshedAtMs == nowMs) return nullptr;
+    removeAt(oldest);
+  }
+
+  size_t index = lowerBound(id);
+  memmove(&entries[index + 1], &entries[index], sizeof(CachedDevice) * (entryCount - index));
+  entryCount++;
+
+  entries[index] = {};
+  entries[index].id = id;
+  entries[index].refreshedAtMs = nowMs;
+  return &entries[index];
+}
+
+/**
+ * deviceCacheBeginUpdate(entry, readingId, updatedAt)
+ * ---------------------------------------------------
+ * Reading ids grow with every insert, so they order updates from the
+ * snapshot and from events regardless of which arrives first.
+ *
+ * @param entry Cache entry.
+ * @param readingId Newest reading contained in the update.
+ * @param updatedAt Server time of that reading.
+ * @return True if the update's values should be applied.
+ */
+bool deviceCacheBeginUpdate(CachedDevice* entry, uint32_t readingId, uint32_t updatedAt) {
+  if (readingId < entry->readingId) return false;
+
+  entry->readingId = readingId;
+  if (updatedAt > entry->updatedAt) entry->updatedAt = updatedAt;
+  return true;
+}
+
+/**
+ * deviceCacheSetValue(entry, sensorId, value)
+ * -------------------------------------------
+ * @param entry Cache entry.
+ * @param sensorId Sensor id (1..DEVICE_CACHE_SENSORS).
+ * @param value Sensor value.
+ */
+void deviceCacheSetValue(CachedDevice* entry, int sensorId, float value) {
+  if (!isKnownSensor(sensorId)) return;
+
+  entry->values[sensorId - FIRST_SENSOR_ID] = value;
+  entry->validMask |= SENSOR_BIT(sensorId);
+}
+
+/**
+ * deviceCacheValue(entry, sensorId, fallback)
+ * -------------------------------------------
+ * @param entry Cache entry.
+ * @param sensorId Sensor id.
+ * @param fallback Value returned if the sensor has not reported yet.
+ * @return The cached value or fallback.
+ */
+float deviceCacheValue(const CachedDevice* entry, int sensorId, float fallback) {
+  if (!isKnownSensor(sensorId) || !(entry->validMask & SENSOR_BIT(sensorId))) return fallback;
+  return entry->values[sensorId - FIRST_SENSOR_ID];
+}
+
+/**
+ * deviceCacheRefreshAll(nowMs)
+ * ----------------------------
+ * A snapshot answered with 304 still lists every cached device, so all of
+ * them count as seen.
+ *
+ * @param nowMs Current millis().
+ */
+void deviceCacheRefreshAll(unsigned long nowMs) {
+  for (size_t i = LOOP_START_INDEX; i < entryCount; i++) {
+    entries[i].refreshedAtMs = nowMs;
+  }
+}
+
+/**
+ * deviceCacheRemoveStale(nowMs)
+ * -----------------------------
+ * Every snapshot refreshes all devices that still exist, so entries that
+ * miss several snapshots belong to deleted devices.
+ *
+ * @param nowMs Current millis().
+ * @return Number of entries removed.
+ */
+size_t deviceCacheRemoveStale(unsigned long nowMs) {
+  size_t removed = 0;
+  for (size_t i = entryCount; i > LOOP_START_INDEX; i--) {
+    if (!deviceCacheIsFresh(&entries[i - 1], nowMs)) {
+      removeAt(i - 1);
+      removed++;
+    }
+  }
+  return removed;
+}
+
+/**
+ * deviceCacheIsFresh(entry, nowMs)
+ * --------------------------------
+ * @param entry Cache entry.
+ * @param nowMs Current millis().
+ * @return True if the entry was refreshed within DEVICE_CACHE_MAX_AGE_MS.
+ */
+bool deviceCacheIsFresh(const CachedDevice* entry, unsigned long nowMs) {
+  return nowMs - entry->refreshedAtMs <= DEVICE_CACHE_MAX_AGE_MS;
+}
+
+/**
+ * deviceCacheCount()
+ * ------------------
+ * @return Number of cached devices.
+ */
+size_t deviceCacheCount() {
+  return entryCount;
+}
+
+/**
+ * deviceCacheAt(index)
+ * --------------------
+ * @param index Position in id order.
+ * @return The entry, or nullptr if index is out of range.
+ */
+CachedDevice* deviceCacheAt(size_t index) {
+  return index < entryCount ? &entries[index] : nullptr;
+}
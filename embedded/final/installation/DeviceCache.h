@@ -0,0 +1,102 @@
+// ============================================================================
+// File: DeviceCache.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the fixed-size cache of the latest sensor values per
+//              device, so rotating through devices needs no network request.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with DeviceCache.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define DEVICE_CACHE_CAPACITY 16
+#define DEVICE_CACHE_SENSORS 6             // Sensor ids 1..6
+#define DEVICE_CACHE_MAX_AGE_MS 180000UL   // Entries not refreshed for this long are dropped
+#define NO_READING 0
+
+#define SENSOR_ID_DHT11_TEMPERATURE 1
+#define SENSOR_ID_DHT11_HUMIDITY 2
+#define SENSOR_ID_BH1750_LUX 3
+#define SENSOR_ID_ANALOG_WATER 4
+#define SENSOR_ID_BMP180_TEMPERATURE 5
+#define SENSOR_ID_BMP180_PRESSURE 6
+
+// ----------------------------------------------------------------------------
+// Data Structure
+// ----------------------------------------------------------------------------
+
+/**
+ * The last known state of one device.
+ */
+struct CachedDevice {
+  int32_t id;
+  uint32_t readingId;          // Newest reading applied, NO_READING if none
+  uint32_t updatedAt;          // Server time of that reading (Unix seconds)
+  unsigned long refreshedAtMs; // millis() of the last snapshot or event that listed the device
+  uint8_t validMask;           // Bit (sensorId - 1) set if values[] holds that sensor
+  float values[DEVICE_CACHE_SENSORS];
+  uint32_t pushedReadingId;    // Newest reading that arrived as an event
+  long long pushedAtMs;        // Server time that reading was stored (Unix ms)
+};
+
+// ----------------------------------------------------------------------------
+// Device Cache Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Returns the entry of a device, or nullptr if it is not cached.
+ */
+CachedDevice* deviceCacheFind(int32_t id);
+
+/**
+ * Returns the entry of a device, adding it if needed. When the cache is
+ * full, the least recently refreshed entry is evicted, unless it was
+ * refreshed at nowMs too; then nullptr is returned.
+ */
+CachedDevice* deviceCacheUpsert(int32_t id, unsigned long nowMs);
+
+/**
+ * Records a newer reading for an entry. Returns false if the reading is
+ * older than the one already applied, so a late snapshot cannot overwrite
+ * values pushed by an event.
+ */
+bool deviceCacheBeginUpdate(CachedDevice* entry, uint32_t readingId, uint32_t updatedAt);
+
+/**
+ * Stores a sensor value in an entry. Unknown sensor ids are ignored.
+ */
+void deviceCacheSetValue(CachedDevice* entry, int sensorId, float value);
+
+/**
+ * Returns a value of an entry, or fallback if the sensor was never reported.
+ */
+float deviceCacheValue(const CachedDevice* entry, int sensorId, float fallback);
+
+/**
+ * Marks every entry as refreshed, for a snapshot that did not change.
+ */
+void deviceCacheRefreshAll(unsigned long nowMs);
+
+/**
+ * Drops every entry that was not refreshed within DEVICE_CACHE_MAX_AGE_MS.
+ */
+size_t deviceCacheRemoveStale(unsigned long nowMs);
+
+/**
+ * True if the entry was refreshed within DEVICE_CACHE_MAX_AGE_MS.
+ */
+bool deviceCacheIsFresh(const CachedDevice* entry, unsigned long nowMs);
+
+/**
+ * Number of cached devices.
+ */
+size_t deviceCacheCount();
+
+/**
+ * Returns the entry at the given position; entries are ordered by id.
+ */
+CachedDevice* deviceCacheAt(size_t index);
@@ -0,0 +1,293 @@
+// ============================================================================
+// File: EventStream.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements an EventSource (SSE) client on its own TLS
+//              connection. The response is parsed incrementally, one byte at
+//              a time, so the main loop never waits for the network.
+// ============================================================================
+
+#include "EventStream.h"
+#include "Client.h"
+#include "Metrics.h"
+#include <WiFiClientSecure.h>
+#include <ctype.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define EVENT_REQUEST_SIZE 256
+#define EVENT_LINE_SIZE 128           // Header and chunk-size lines
+#define EVENT_MAX_BYTES_PER_POLL 512  // Keeps a single poll short
+#define HEX_BASE 16
+
+#define STATUS_OK_TOKEN " 200 "
+#define CHUNKED_HEADER "transfer-encoding: chunked"
+#define SSE_DATA_FIELD "data:"
+#define SSE_COMMENT ':'
+
+// ----------------------------------------------------------------------------
+// Stream State
+// ----------------------------------------------------------------------------
+
+/**
+ * Where the parser is within the HTTP response.
+ */
+enum StreamState {
+  STREAM_DISCONNECTED,
+  STREAM_STATUS,
+  STREAM_HEADERS,
+  STREAM_CHUNK_SIZE,
+  STREAM_CHUNK_DATA,
+  STREAM_CHUNK_END,
+  STREAM_BODY
+};
+
+static WiFiClientSecure streamClient;
+static EventHandler eventHandler = nullptr;
+static StreamState state = STREAM_DISCONNECTED;
+static bool chunked = false;
+static size_t chunkRemaining = 0;
+static unsigned long lastByteAt = 0;
+static unsigned long lastAttemptAt = 0;
+static bool attempted = false;
+
+static char line[EVENT_LINE_SIZE];
+static size_t lineLength = 0;
+
+static char sseLine[EVENT_DATA_SIZE];
+static size_t sseLineLength = 0;
+static bool sseLineOverflow = false;
+
+static char eventData[EVENT_DATA_SIZE];
+static size_t eventLength = 0;
+static bool eventOverflow = false;
+
+/**
+ * Closes the connection and schedules a reconnect.
+ */
+static void disconnect(const char* reason) {
+  if (state != STREAM_DISCONNECTED) {
+    Serial.print("Event stream closed: ");
+    Serial.println(reason);
+  }
+  streamClient.stop();
+  state = STREAM_DISCONNECTED;
+}
+
+/**
+ * Opens the connection and sends the subscription request in one write.
+ */
+static bool connectStream() {
+  unsigned long start = millis();
+  streamClient.setInsecure();
+  if (!streamClient.connect(API_HOST, API_PORT)) {
+    Serial.println("Event stream connection failed");
+    return false;
+  }
+  metricsObserve(HISTOGRAM_TLS_CONNECT_MS, millis() - start);
+
+  char request[EVENT_REQUEST_SIZE];
+  int length = snprintf(request, sizeof(request),
+                        "GET %s HTTP/1.1\r\n"
+                        "Host: %s\r\n"
+                        "User-Agent: ESP32\r\n"
+                        "Accept: text/event-stream\r\n"
+                        "Cache-Control: no-cache\r\n"
+                        "bypass-tunnel-reminder: true\r\n"
+                        "\r\n",
+                        EVENT_STREAM_PATH, API_HOST);
+  streamClient.write((const uint8_t*)request, length);
+
+  state = STREAM_STATUS;
+  chunked = false;
+  lineLength = 0;
+  sseLineLength = 0;
+  sseLineOverflow = false;
+  eventLength = 0;
+  eventOverflow = false;
+  lastByteAt = millis();
+  return true;
+}
+
+/**
+ * Accumulates one byte of a CRLF-terminated protocol line.
+ *
+ * @return True when a complete line is in line[].
+ */
+static bool appendLineByte(char c) {
+  if (c == '\n') {
+    if (lineLength > 0 && line[lineLength - 1] == '\r') lineLength--;
+    line[lineLength] = '\0';
+    lineLength = 0;
+    return true;
+  }
+  if (lineLength < EVENT_LINE_SIZE - 1) line[lineLength++] = c;
+  return false;
+}
+
+/**
+ * Handles one complete SSE line. A blank line ends the event.
+ */
+static void handleSseLine() {
+  if (sseLineLength == 0) {
+    if (eventLength > 0 && !eventOverflow && eventHandler) {
+      eventData[eventLength] = '\0';
+      eventHandler(eventData);
+    }
+    eventLength = 0;
+    eventOverflow = false;
+    return;
+  }
+
+  sseLine[sseLineLength] = '\0';
+  if (sseLine[0] == SSE_COMMENT || sseLineOverflow) return;  // Keep-alive ping or oversized line
+  if (strncmp(sseLine, SSE_DATA_FIELD, strlen(SSE_DATA_FIELD)) != 0) return;
+
+  const char* value = sseLine + strlen(SSE_DATA_FIELD);
+  if (*value == ' ') value++;
+
+  // Multiple data lines are joined with a newline
+  size_t valueLength = strlen(value);
+  size_t separator = eventLength > 0 ? 1 : 0;
+  if (eventLength + separator + valueLength >= EVENT_DATA_SIZE) {
+    eventOverflow = true;
+    return;
+  }
+  if (separator) eventData[eventLength++] = '\n';
+  memcpy(eventData + eventLength, value, valueLength);
+  eventLength += valueLength;
+}
+
+/**
+ * Feeds one byte of the event-stream body to the SSE parser.
+ */
+static void feedSse(char c) {
+  if (c == '\r') return;
+  if (c == '\n') {
+    handleSseLine();
+    sseLineLength = 0;
+    sseLineOverflow = false;
+    return;
+  }
+  if (sseLineLength < EVENT_DATA_SIZE - 1) {
+    sseLine[sseLineLength++] = c;
+  } else {
+    sseLineOverflow = true;
+  }
+}
+
+/**
+ * Advances the response state machine by one byte.
+ */
+static void feedByte(char c) {
+  switch (state) {
+    case STREAM_STATUS:
+      if (!appendLineByte(c)) return;
+      if (!strstr(line, STATUS_OK_TOKEN)) {
+        disconnect(line);
+        return;
+      }
+      state = STREAM_HEADERS;
+      return;
+
+    case STREAM_HEADERS:
+      if (!appendLineByte(c)) return;
+      if (line[0] == '\0') {
+        state = chunked ? STREAM_CHUNK_SIZE : STREAM_BODY;
+        Serial.println("Event stream connected");
+        return;
+      }
+      for (char* p = line; *p; p++) *p = tolower(*p);
+      if (strcmp(line, CHUNKED_HEADER) == 0) chunked = true;
+      return;
+
+    case STREAM_CHUNK_SIZE:
+      if (!appendLineByte(c)) return;
+      chunkRemaining = strtoul(line, nullptr, HEX_BASE);
+      if (chunkRemaining == 0) {
+        disconnect("end of stream");
+        return;
+      }
+      state = STREAM_CHUNK_DATA;
+      return;
+
+    case STREAM_CHUNK_DATA:
+      feedSse(c);
+      if (--chunkRemaining == 0) state = STREAM_CHUNK_END;
+      return;
+
+    case STREAM_CHUNK_END:
+      if (appendLineByte(c)) state = STREAM_CHUNK_SIZE;  // CRLF after the chunk data
+      return;
+
+    case STREAM_BODY:
+      feedSse(c);
+      return;
+
+    case STREAM_DISCONNECTED:
+      return;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Event Stream Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * initEventStream(handler)
+ * ------------------------
+ * Registers the callback for incoming events.
+ *
+ * @param handler Called with the data of each event.
+ */
+void initEventStream(EventHandler handler) {
+  eventHandler = handler;
+}
+
+/**
+ * pollEventStream()
+ * -----------------
+ * Processes the bytes already received. The TLS handshake on (re)connect is
+ * the only blocking step and runs at most once per EVENT_STREAM_RETRY_MS.
+ * A stream that stays silent longer than two server pings is considered
+ * dead, since a dropped WiFi or tunnel does not always close the socket.
+ */
+void pollEventStream() {
+  unsigned long now = millis();
+
+  if (state == STREAM_DISCONNECTED) {
+    if (attempted && now - lastAttemptAt < EVENT_STREAM_RETRY_MS) return;
+    attempted = true;
+    lastAttemptAt = now;
+    connectStream();
+    return;
+  }
+
+  if (!streamClient.connected() && !streamClient.available()) {
+    disconnect("connection lost");
+    return;
+  }
+
+  size_t processed = 0;
+  while (streamClient.available() && processed < EVENT_MAX_BYTES_PER_POLL && state != STREAM_DISCONNECTED) {
+    feedByte((char)streamClient.read());
+    processed++;
+  }
+
+  if (processed > 0) {
+    lastByteAt = now;
+  } else if (now - lastByteAt > EVENT_STREAM_IDLE_TIMEOUT_MS) {
+    disconnect("idle timeout");
+  }
+}
+
+/**
+ * isEventStreamConnected()
+ * ------------------------
+ * @return True once the response headers were received.
+ */
+bool isEventStreamConnected() {
+  return state != STREAM_DISCONNECTED && state != STREAM_STATUS && state != STREAM_HEADERS;
+}
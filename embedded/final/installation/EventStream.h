@@ -0,0 +1,44 @@
+// ============================================================================
+// File: EventStream.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the long-lived EventSource subscription that receives
+//              "new reading" events from the backend instead of polling it.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with EventStream.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define EVENT_STREAM_PATH "/api/readings/sse"
+#define EVENT_DATA_SIZE 512                 // Longer events are dropped
+#define EVENT_STREAM_IDLE_TIMEOUT_MS 70000  // The server pings every 30 s
+#define EVENT_STREAM_RETRY_MS 5000
+
+// ----------------------------------------------------------------------------
+// Event Stream Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Called with the data of every complete event.
+ */
+typedef void (*EventHandler)(const char* data);
+
+/**
+ * Registers the event handler. The connection is opened by pollEventStream().
+ */
+void initEventStream(EventHandler handler);
+
+/**
+ * Reads whatever the stream has buffered without blocking, dispatches
+ * complete events and reconnects after errors or silence.
+ */
+void pollEventStream();
+
+/**
+ * True while the subscription is established.
+ */
+bool isEventStreamConnected();
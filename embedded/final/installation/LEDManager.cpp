@@ -3,18 +3,24 @@
 // Author: Yanis Deplazes
 // License: MIT License
 // Copyright (c) 2025 Yanis Deplazes
-// Description: Controls LED strip color based on temperature and humidity,
-//              using color interpolation with FastLED.
+// Description: Renders the LED strip frame by frame. Temperature selects a
+//              color from a gamma-corrected palette computed at compile time,
+//              pressure moves a slow gradient along the strip, and water adds
+//              a rain shimmer. Per frame only integer math is used.
 // ============================================================================
 
 #include "LEDManager.h"
+#include "Metrics.h"
 #include <FastLED.h>
+#include <atomic>
 
 // ----------------------------------------------------------------------------
 // Constants & Macros
 // ----------------------------------------------------------------------------
 #define LED_PIN 2
-#define NUM_LEDS 144
+#ifndef NUM_LEDS
+#define NUM_LEDS 144  // Strip length, a build flag for longer strips
+#endif
 #define LED_BRIGHTNESS 10
 #define LED_TYPE WS2812B
 #define LED_COLOR_ORDER GRB
@@ -22,25 +28,153 @@
 #define TEMP_COLOR_MIN -10.0f
 #define TEMP_COLOR_MAX 50.0f
 #define TEMP_COLOR_THRESHOLD 18.0f
-#define COLOR_LERP_MIN 0.0f
-#define COLOR_LERP_MAX 1.0f
-#define COLOR_LERP_SCALE 255
 
-#define COLOR_COLD_MIN CRGB(7, 14, 136)   // Deep Blue
-#define COLOR_COLD_MAX CRGB(0, 247, 255)  // Cyan
-#define COLOR_WARM_MIN CRGB(255, 217, 0)  // Yellow
-#define COLOR_WARM_MAX CRGB(255, 0, 171)  // Magenta
+#define COLOR_COLD_MIN { 7, 14, 136 }   // Deep Blue
+#define COLOR_COLD_MAX { 0, 247, 255 }  // Cyan
+#define COLOR_WARM_MIN { 255, 217, 0 }  // Yellow
+#define COLOR_WARM_MAX { 255, 0, 171 }  // Magenta
 
+#define LED_FRAME_MS 20
+#define LED_FRAME_BUDGET_US 3000
+#define LED_CROSSFADE_MS 1500
+#define LED_MAX_CATCHUP_FRAMES 5    // Longer stalls are skipped instead of replayed
+
+#define PALETTE_SIZE 256
+#define PALETTE_MAX_INDEX 255
+#define CHANNEL_MAX 255.0
+#define GAMMA_NEWTON_STEPS 20       // Fifth root for gamma 2.2 = 2 + 1/5
+#define FIFTH_POWER 5
+
+#define SHIMMER_WATER_MIN 100.0f    // Below this the strip stays dry
+#define SHIMMER_WATER_MAX 1000.0f
+#define SHIMMER_MAX_CHANCE 8        // Per LED and frame, out of 256
+#define SHIMMER_PEAK 160
+#define SHIMMER_DECAY 12            // Per frame
+
+#define GRADIENT_PRESSURE_STORM 980.0f
+#define GRADIENT_PRESSURE_CALM 1030.0f
+#define GRADIENT_DEPTH_STORM 40     // Palette steps the gradient swings around the base color
+#define GRADIENT_DEPTH_CALM 6
+#define GRADIENT_SPEED_STORM 160    // Phase per frame, Q8
+#define GRADIENT_SPEED_CALM 24
+#define GRADIENT_SPATIAL_STEP 3     // Phase per LED along the strip
+#define SINE_CENTER 128
+#define Q8_SHIFT 8
+
+#define FADE_DONE 255
 #define LOOP_START_INDEX 0
 
+// ----------------------------------------------------------------------------
+// Compile-Time Palettes
+// ----------------------------------------------------------------------------
+
+/**
+ * Plain color used to build the tables at compile time.
+ */
+struct Rgb {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+};
+
+struct ColorLut {
+  Rgb entries[PALETTE_SIZE];
+};
+
+struct GammaLut {
+  uint8_t entries[PALETTE_SIZE];
+};
+
+/**
+ * x^(1/5) for 0 <= x <= 1 by Newton's method (no constexpr pow available).
+ */
+constexpr double fifthRoot(double x) {
+  if (x <= 0) return 0;
+  double y = 1;
+  for (int i = LOOP_START_INDEX; i < GAMMA_NEWTON_STEPS; i++) {
+    double y4 = y * y * y * y;
+    y -= (y4 * y - x) / (FIFTH_POWER * y4);
+  }
+  return y;
+}
+
+/**
+ * Maps a perceived channel value to the PWM value (gamma 2.2).
+ */
+constexpr uint8_t gammaCorrect(double value) {
+  double x = value / CHANNEL_MAX;
+  return (uint8_t)(x * x * fifthRoot(x) * CHANNEL_MAX + 0.5);
+}
+
+constexpr double lerpChannel(uint8_t low, uint8_t high, double ratio) {
+  return low + (high - low) * ratio;
+}
+
+/**
+ * Same interpolation the strip used per call before, now per palette entry.
+ */
+constexpr ColorLut makeTemperaturePalette() {
+  ColorLut lut = {};
+  constexpr Rgb coldMin = COLOR_COLD_MIN;
+  constexpr Rgb coldMax = COLOR_COLD_MAX;
+  constexpr Rgb warmMin = COLOR_WARM_MIN;
+  constexpr Rgb warmMax = COLOR_WARM_MAX;
+
+  for (int i = LOOP_START_INDEX; i < PALETTE_SIZE; i++) {
+    double temp = TEMP_COLOR_MIN + (TEMP_COLOR_MAX - TEMP_COLOR_MIN) * i / PALETTE_MAX_INDEX;
+    bool warm = temp >= TEMP_COLOR_THRESHOLD;
+    double ratio = warm ? (temp - TEMP_COLOR_THRESHOLD) / (TEMP_COLOR_MAX - TEMP_COLOR_THRESHOLD)
+                        : (temp - TEMP_COLOR_MIN) / (TEMP_COLOR_THRESHOLD - TEMP_COLOR_MIN);
+    Rgb low = warm ? warmMin : coldMin;
+    Rgb high = warm ? warmMax : coldMax;
+
+    lut.entries[i] = { gammaCorrect(lerpChannel(low.r, high.r, ratio)),
+                       gammaCorrect(lerpChannel(low.g, high.g, ratio)),
+                       gammaCorrect(lerpChannel(low.b, high.b, ratio)) };
+  }
+  return lut;
+}
+
+constexpr GammaLut makeGammaTable() {
+  GammaLut lut = {};
+  for (int i = LOOP_START_INDEX; i < PALETTE_SIZE; i++) {
+    lut.entries[i] = gammaCorrect(i);
+  }
+  return lut;
+}
+
+static constexpr ColorLut TEMPERATURE_PALETTE = makeTemperaturePalette();
+static constexpr GammaLut GAMMA = makeGammaTable();
+
 // ----------------------------------------------------------------------------
 // LED Strip State
 // ----------------------------------------------------------------------------
+
+/**
+ * Everything a frame is rendered from, derived once per scene change.
+ */
+struct LedScene {
+  uint8_t paletteIndex;
+  uint8_t shimmerChance;
+  uint8_t gradientDepth;
+  uint8_t gradientSpeed;
+};
+
 static CRGB leds[NUM_LEDS];
-static uint16_t gradientOffset = 0;
-static uint32_t lastUpdate = 0;
+static CRGB fadeFrom[NUM_LEDS];  // Frame shown when the crossfade started
+static uint8_t sparkles[NUM_LEDS];
 
+static LedScene scene = {};
+static bool sceneChanged = false;
+static uint32_t fadeElapsedMs = LED_CROSSFADE_MS;
+static uint16_t gradientOffset = 0;  // Q8 phase of the pressure gradient
+static uint32_t lastUpdate = 0;
+static bool overBudget = false;
 
+static std::atomic<uint32_t> frameCount{ 0 };
+static std::atomic<uint32_t> showCount{ 0 };
+static std::atomic<uint32_t> overrunCount{ 0 };
+static std::atomic<uint32_t> maxRenderUs{ 0 };
 
 // ----------------------------------------------------------------------------
 // Initialization
@@ -54,45 +188,156 @@ static uint32_t lastUpdate = 0;
 void initLEDs() {
   FastLED.addLeds<LED_TYPE, LED_PIN, LED_COLOR_ORDER>(leds, NUM_LEDS);
   FastLED.setBrightness(LED_BRIGHTNESS);
+  lastUpdate = millis();
 }
 
+// ----------------------------------------------------------------------------
+// Rendering
+// ----------------------------------------------------------------------------
+
 /**
- * interpolateColor()
- * ------------------
- * Linearly interpolates between two CRGB colors based on a normalized value.
- *
- * @param value The value used for interpolation.
- * @param min Minimum expected value.
- * @param max Maximum expected value.
- * @param low Color for the minimum value.
- * @param high Color for the maximum value.
- * @return Interpolated color as CRGB.
+ * Maps value from [inMin, inMax] to [outMin, outMax], clamped.
  */
-CRGB interpolateColor(float value, float min, float max, const CRGB& low, const CRGB& high) {
-  float ratio = constrain((value - min) / (max - min), COLOR_LERP_MIN, COLOR_LERP_MAX);
-  uint8_t r = lerp8by8(low.r, high.r, ratio * COLOR_LERP_SCALE);
-  uint8_t g = lerp8by8(low.g, high.g, ratio * COLOR_LERP_SCALE);
-  uint8_t b = lerp8by8(low.b, high.b, ratio * COLOR_LERP_SCALE);
-  return CRGB(r, g, b);
+static uint8_t mapClamped(float value, float inMin, float inMax, uint8_t outMin, uint8_t outMax) {
+  float ratio = constrain((value - inMin) / (inMax - inMin), 0.0f, 1.0f);
+  return (uint8_t)(outMin + (outMax - outMin) * ratio + 0.5f);
 }
 
 /**
- * showColor()
- * -----------
- * Displays a solid color on the LED strip based on current temperature.
+ * Base color of one LED: the temperature color, shifted along the palette
+ * by the pressure gradient.
+ */
+static CRGB scenePixel(int led, uint8_t phase) {
+  int wave = (int)sin8(led * GRADIENT_SPATIAL_STEP + phase) - SINE_CENTER;
+  int index = scene.paletteIndex + wave * scene.gradientDepth / SINE_CENTER;
+  const Rgb& color = TEMPERATURE_PALETTE.entries[constrain(index, 0, PALETTE_MAX_INDEX)];
+  return CRGB(color.r, color.g, color.b);
+}
+
+/**
+ * Advances the animation state by the given number of fixed steps.
  *
- * @param temp Temperature value to influence LED color.
+ * @return True if something visible changed.
  */
-void showColor(float temp) {
-  CRGB color = (temp >= TEMP_COLOR_THRESHOLD)
-                 ? interpolateColor(temp, TEMP_COLOR_THRESHOLD, TEMP_COLOR_MAX, COLOR_WARM_MIN, COLOR_WARM_MAX)
-                 : interpolateColor(temp, TEMP_COLOR_MIN, TEMP_COLOR_THRESHOLD, COLOR_COLD_MIN, COLOR_COLD_MAX);
+static bool advance(uint32_t steps) {
+  uint8_t phaseBefore = gradientOffset >> Q8_SHIFT;
+  gradientOffset += scene.gradientSpeed * steps;
+  bool changed = (gradientOffset >> Q8_SHIFT) != phaseBefore;
+
+  if (fadeElapsedMs < LED_CROSSFADE_MS) {
+    fadeElapsedMs = overBudget ? LED_CROSSFADE_MS : min(fadeElapsedMs + steps * LED_FRAME_MS, (uint32_t)LED_CROSSFADE_MS);
+    changed = true;
+  }
 
+  uint8_t decay = min(steps * SHIMMER_DECAY, (uint32_t)UINT8_MAX);
+  uint8_t chance = overBudget ? 0 : scene.shimmerChance;
   for (int i = LOOP_START_INDEX; i < NUM_LEDS; i++) {
-    leds[i] = color;
+    if (sparkles[i]) {
+      sparkles[i] = qsub8(sparkles[i], decay);
+      changed = true;
+    }
+    if (chance && random8() < chance) {
+      sparkles[i] = SHIMMER_PEAK;
+      changed = true;
+    }
   }
 
-  FastLED.show();
+  return changed;
+}
 
-  Serial.printf("Static Temp Color → R: %d, G: %d, B: %d\n", color.r, color.g, color.b);
+/**
+ * setLedScene(temp, water, pressure)
+ * ----------------------------------
+ * Derives the scene from the weather and starts a crossfade from the frame
+ * currently shown. Repeating the same scene does not restart the fade.
+ *
+ * @param temp Temperature in °C, selects the palette color.
+ * @param water Analog water level, drives the rain shimmer.
+ * @param pressure Atmospheric pressure in hPa, lower is a livelier gradient.
+ */
+void setLedScene(float temp, float water, float pressure) {
+  LedScene next = {
+    mapClamped(temp, TEMP_COLOR_MIN, TEMP_COLOR_MAX, 0, PALETTE_MAX_INDEX),
+    water < SHIMMER_WATER_MIN ? (uint8_t)0 : mapClamped(water, SHIMMER_WATER_MIN, SHIMMER_WATER_MAX, 1, SHIMMER_MAX_CHANCE),
+    mapClamped(pressure, GRADIENT_PRESSURE_STORM, GRADIENT_PRESSURE_CALM, GRADIENT_DEPTH_STORM, GRADIENT_DEPTH_CALM),
+    mapClamped(pressure, GRADIENT_PRESSURE_STORM, GRADIENT_PRESSURE_CALM, GRADIENT_SPEED_STORM, GRADIENT_SPEED_CALM)
+  };
+  if (memcmp(&next, &scene, sizeof(scene)) == 0) return;
+
+  memcpy(fadeFrom, leds, sizeof(leds));
+  scene = next;
+  fadeElapsedMs = 0;
+  sceneChanged = true;
+}
+
+/**
+ * renderLedFrame(nowMs)
+ * ---------------------
+ * Runs the animation in fixed LED_FRAME_MS steps, independent of how often
+ * it is called, and renders once. Only LEDs whose color changed mark the
+ * frame dirty; clean frames skip show(). A frame that exceeds its render
+ * budget makes the next one drop the shimmer and finish the crossfade.
+ *
+ * @param nowMs Current millis().
+ * @return True if show() was called.
+ */
+bool renderLedFrame(unsigned long nowMs) {
+  uint32_t steps = (nowMs - lastUpdate) / LED_FRAME_MS;
+  if (steps == 0 && !sceneChanged) return false;
+
+  if (steps > LED_MAX_CATCHUP_FRAMES) {
+    steps = LED_MAX_CATCHUP_FRAMES;
+    lastUpdate = nowMs;
+  } else {
+    lastUpdate += steps * LED_FRAME_MS;
+  }
+
+  uint32_t start = micros();
+  bool changed = advance(steps) || sceneChanged;
+  sceneChanged = false;
+  frameCount.fetch_add(1, std::memory_order_relaxed);
+
+  bool dirty = false;
+  if (changed) {
+    uint8_t phase = gradientOffset >> Q8_SHIFT;
+    bool fading = fadeElapsedMs < LED_CROSSFADE_MS;
+    uint8_t progress = fadeElapsedMs * FADE_DONE / LED_CROSSFADE_MS;
+
+    for (int i = LOOP_START_INDEX; i < NUM_LEDS; i++) {
+      CRGB color = scenePixel(i, phase);
+      if (fading) color = blend(fadeFrom[i], color, progress);
+      if (sparkles[i]) color += CRGB(GAMMA.entries[sparkles[i]], GAMMA.entries[sparkles[i]], GAMMA.entries[sparkles[i]]);
+
+      if (leds[i] != color) {
+        leds[i] = color;
+        dirty = true;
+      }
+    }
+  }
+
+  uint32_t renderUs = micros() - start;
+  overBudget = renderUs > LED_FRAME_BUDGET_US;
+  if (overBudget) overrunCount.fetch_add(1, std::memory_order_relaxed);
+  if (renderUs > maxRenderUs.load(std::memory_order_relaxed)) maxRenderUs.store(renderUs, std::memory_order_relaxed);
+
+  if (dirty) {
+    FastLED.show();
+    showCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  metricsObserve(HISTOGRAM_LED_FRAME_US, micros() - start);
+  return dirty;
+}
+
+/**
+ * printLedStats()
+ * ---------------
+ * Prints rendered frames, frames that reached the strip, budget overruns
+ * and the slowest render since the last call.
+ */
+void printLedStats() {
+  Serial.printf("LED frames: %lu, shown: %lu, over budget: %lu, max render %lu us\n",
+                (unsigned long)frameCount.exchange(0, std::memory_order_relaxed),
+                (unsigned long)showCount.exchange(0, std::memory_order_relaxed),
+                (unsigned long)overrunCount.exchange(0, std::memory_order_relaxed),
+                (unsigned long)maxRenderUs.exchange(0, std::memory_order_relaxed));
 }
@@ -3,8 +3,9 @@
 // Author: Yanis Deplazes
 // License: MIT License
 // Copyright (c) 2025 Yanis Deplazes
-// Description: Header file for controlling an LED strip based on temperature,
-//              exposing init and display functions.
+// Description: Header file for the frame-based LED renderer. A scene is set
+//              from the weather of the current device and rendered with a
+//              fixed timestep, crossfading whenever the scene changes.
 // ============================================================================
 
 #pragma once
@@ -15,7 +16,9 @@
 // Constants & Macros (shared with .cpp to avoid magic numbers)
 // ----------------------------------------------------------------------------
 #define LED_PIN 2
-#define NUM_LEDS 144
+#ifndef NUM_LEDS
+#define NUM_LEDS 144  // Strip length, a build flag for longer strips
+#endif
 #define LED_BRIGHTNESS 10
 #define LED_TYPE WS2812B
 #define LED_COLOR_ORDER GRB
@@ -23,14 +26,15 @@
 #define TEMP_COLOR_MIN -10.0f
 #define TEMP_COLOR_MAX 50.0f
 #define TEMP_COLOR_THRESHOLD 18.0f
-#define COLOR_LERP_MIN 0.0f
-#define COLOR_LERP_MAX 1.0f
-#define COLOR_LERP_SCALE 255
 
-#define COLOR_COLD_MIN CRGB(7, 14, 136)   // Deep Blue
-#define COLOR_COLD_MAX CRGB(0, 247, 255)  // Cyan
-#define COLOR_WARM_MIN CRGB(255, 217, 0)  // Yellow
-#define COLOR_WARM_MAX CRGB(255, 0, 171)  // Magenta
+#define COLOR_COLD_MIN { 7, 14, 136 }   // Deep Blue
+#define COLOR_COLD_MAX { 0, 247, 255 }  // Cyan
+#define COLOR_WARM_MIN { 255, 217, 0 }  // Yellow
+#define COLOR_WARM_MAX { 255, 0, 171 }  // Magenta
+
+#define LED_FRAME_MS 20            // Fixed animation timestep (50 fps)
+#define LED_FRAME_BUDGET_US 3000   // Render time per frame, excluding show()
+#define LED_CROSSFADE_MS 1500
 
 #define LOOP_START_INDEX 0
 
@@ -44,6 +48,17 @@
 void initLEDs();
 
 /**
- * Displays a solid interpolated color based on temperature.
+ * Sets the scene for a device's weather and starts a crossfade to it.
+ */
+void setLedScene(float temp, float water, float pressure);
+
+/**
+ * Advances the animation to nowMs in fixed steps and renders one frame.
+ * Returns true if the strip was updated.
+ */
+bool renderLedFrame(unsigned long nowMs);
+
+/**
+ * Prints frame statistics since the last call.
  */
-void showColor(float temp);
+void printLedStats();
@@ -0,0 +1,185 @@
+// ============================================================================
+// File: Metrics.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the runtime metrics. Every observation is a bucket
+//              scan and three relaxed atomic adds, so recording stays enabled
+//              in production. Buckets are counted individually and summed up
+//              when /metrics is scraped; sums are 32 bit and wrap, which
+//              Prometheus treats like a counter reset.
+// ============================================================================
+
+#include "Metrics.h"
+#include <atomic>
+#include <stdarg.h>
+#include "esp_timer.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define METRICS_BUCKET_COUNT 8
+#define METRICS_BUFFER_SIZE 6144
+
+#define LOOP_START_INDEX 0
+#define US_PER_SECOND 1000000LL
+
+// ----------------------------------------------------------------------------
+// Metric Definitions
+// ----------------------------------------------------------------------------
+
+/**
+ * Name, help text and bucket upper bounds of a histogram.
+ */
+struct HistogramInfo {
+  const char* name;
+  const char* help;
+  uint32_t bounds[METRICS_BUCKET_COUNT];
+};
+
+/**
+ * Counts per bucket (the last one is +Inf) and the sum of all observations.
+ * The number of observations is the total of the buckets.
+ */
+struct HistogramData {
+  std::atomic<uint32_t> buckets[METRICS_BUCKET_COUNT + 1];
+  std::atomic<uint32_t> sum;
+};
+
+/**
+ * Name and help text of a counter.
+ */
+struct CounterInfo {
+  const char* name;
+  const char* help;
+};
+
+static const HistogramInfo HISTOGRAMS[HISTOGRAM_COUNT] = {
+  { "atmos_http_get_duration_ms", "HTTPS GET from connect until the body is parsed",
+    { 50, 100, 250, 500, 1000, 2500, 5000, 10000 } },
+  { "atmos_http_post_duration_ms", "HTTPS POST of the shown index, from writing the request until the reply is read or the request failed",
+    { 50, 100, 250, 500, 1000, 2500, 5000, 10000 } },
+  { "atmos_tls_connect_duration_ms", "TCP connect and TLS handshake",
+    { 50, 100, 250, 500, 1000, 2500, 5000, 10000 } },
+  { "atmos_led_frame_duration_us", "LED frame render and show",
+    { 250, 500, 1000, 2000, 3000, 5000, 10000, 20000 } }
+};
+
+static const CounterInfo COUNTERS[COUNTER_COUNT] = {
+  { "atmos_json_parse_failures_total", "API responses and events that failed to parse" },
+  { "atmos_dfplayer_commands_total", "Command frames sent to the DFPlayer, retries included" },
+  { "atmos_http_not_modified_total", "HTTPS GETs answered 304, so the body was not downloaded" }
+};
+
+static HistogramData histograms[HISTOGRAM_COUNT];
+static std::atomic<uint32_t> counters[COUNTER_COUNT];
+
+// ----------------------------------------------------------------------------
+// Metrics Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * metricsObserve(histogram, value)
+ * --------------------------------
+ * Records one observation in the first bucket whose bound is not exceeded.
+ *
+ * @param histogram Histogram to record into.
+ * @param value Observed duration in the unit of the histogram.
+ */
+void metricsObserve(Histogram histogram, uint32_t value) {
+  const uint32_t* bounds = HISTOGRAMS[histogram].bounds;
+  size_t bucket = LOOP_START_INDEX;
+  while (bucket < METRICS_BUCKET_COUNT && value > bounds[bucket]) bucket++;
+
+  HistogramData& data = histograms[histogram];
+  data.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  data.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+/**
+ * metricsCount(counter)
+ * ---------------------
+ * Increments a counter by one.
+ *
+ * @param counter Counter to increment.
+ */
+void metricsCount(Counter counter) {
+  counters[counter].fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * metricsAppend(buffer, size, length, format, ...)
+ * ------------------------------------------------
+ * Appends formatted text behind the first length characters of buffer.
+ *
+ * @return New length, at most size - 1.
+ */
+size_t metricsAppend(char* buffer, size_t size, size_t length, const char* format, ...) {
+  if (length + 1 >= size) return length;
+
+  va_list args;
+  va_start(args, format);
+  int written = vsnprintf(buffer + length, size - length, format, args);
+  va_end(args);
+
+  if (written < 0) return length;
+  return min(length + written, size - 1);
+}
+
+/**
+ * formatMetrics(buffer, size)
+ * ---------------------------
+ * Writes the heap gauges, the uptime, every histogram with cumulative
+ * buckets and every counter. The values are read one by one while tasks keep
+ * recording, so a scrape can be off by the observations made meanwhile.
+ *
+ * @param buffer Output buffer.
+ * @param size Size of the buffer.
+ * @return Length of the text in buffer.
+ */
+size_t formatMetrics(char* buffer, size_t size) {
+  size_t length = 0;
+
+  length = metricsAppend(buffer, size, length,
+                         "# HELP atmos_heap_free_bytes Free heap\n"
+                         "# TYPE atmos_heap_free_bytes gauge\n"
+                         "atmos_heap_free_bytes %lu\n"
+                         "# HELP atmos_heap_largest_free_block_bytes Largest block that can be allocated\n"
+                         "# TYPE atmos_heap_largest_free_block_bytes gauge\n"
+                         "atmos_heap_largest_free_block_bytes %lu\n"
+                         "# HELP atmos_heap_min_free_bytes Lowest free heap since boot\n"
+                         "# TYPE atmos_heap_min_free_bytes gauge\n"
+                         "atmos_heap_min_free_bytes %lu\n"
+                         "# HELP atmos_uptime_seconds Time since boot\n"
+                         "# TYPE atmos_uptime_seconds counter\n"
+                         "atmos_uptime_seconds %lld\n",
+                         (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMaxAllocHeap(),
+                         (unsigned long)ESP.getMinFreeHeap(), (long long)(esp_timer_get_time() / US_PER_SECOND));
+
+  for (size_t h = LOOP_START_INDEX; h < HISTOGRAM_COUNT; h++) {
+    const HistogramInfo& info = HISTOGRAMS[h];
+    HistogramData& data = histograms[h];
+
+    length = metricsAppend(buffer, size, length, "# HELP %s %s\n# TYPE %s histogram\n", info.name, info.help, info.name);
+
+    uint32_t cumulative = 0;
+    for (size_t b = LOOP_START_INDEX; b < METRICS_BUCKET_COUNT; b++) {
+      cumulative += data.buckets[b].load(std::memory_order_relaxed);
+      length = metricsAppend(buffer, size, length, "%s_bucket{le=\"%lu\"} %lu\n", info.name,
+                             (unsigned long)info.bounds[b], (unsigned long)cumulative);
+    }
+    cumulative += data.buckets[METRICS_BUCKET_COUNT].load(std::memory_order_relaxed);
+    length = metricsAppend(buffer, size, length, "%s_bucket{le=\"+Inf\"} %lu\n%s_sum %lu\n%s_count %lu\n",
+                           info.name, (unsigned long)cumulative, info.name,
+                           (unsigned long)data.sum.load(std::memory_order_relaxed), info.name,
+                           (unsigned long)cumulative);
+  }
+
+  for (size_t c = LOOP_START_INDEX; c < COUNTER_COUNT; c++) {
+    const CounterInfo& info = COUNTERS[c];
+    length = metricsAppend(buffer, size, length, "# HELP %s %s\n# TYPE %s counter\n%s %lu\n", info.name, info.help,
+                           info.name, info.name, (unsigned long)counters[c].load(std::memory_order_relaxed));
+  }
+
+  return length;
+}
@@ -0,0 +1,72 @@
+// ============================================================================
+// File: Metrics.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the runtime metrics served on /metrics: fixed-bucket
+//              latency histograms and counters that any task can record into
+//              without locking, formatted as Prometheus text.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with Metrics.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define METRICS_BUCKET_COUNT 8  // Upper bounds per histogram, +Inf comes on top
+#define METRICS_BUFFER_SIZE 6144
+
+// ----------------------------------------------------------------------------
+// Metric Identifiers
+// ----------------------------------------------------------------------------
+
+/**
+ * Latency histograms.
+ */
+enum Histogram {
+  HISTOGRAM_HTTP_GET_MS,
+  HISTOGRAM_HTTP_POST_MS,
+  HISTOGRAM_TLS_CONNECT_MS,
+  HISTOGRAM_LED_FRAME_US,
+  HISTOGRAM_COUNT
+};
+
+/**
+ * Monotonic counters.
+ */
+enum Counter {
+  COUNTER_JSON_PARSE_FAILURES,
+  COUNTER_DFPLAYER_COMMANDS,
+  COUNTER_HTTP_NOT_MODIFIED,
+  COUNTER_COUNT
+};
+
+// ----------------------------------------------------------------------------
+// Metrics Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Records one observation. Two relaxed atomic adds, safe from any task.
+ */
+void metricsObserve(Histogram histogram, uint32_t value);
+
+/**
+ * Increments a counter. Safe from any task.
+ */
+void metricsCount(Counter counter);
+
+/**
+ * Appends printf-formatted text at length. Output that does not fit is cut
+ * off.
+ *
+ * @return New length of the text in buffer.
+ */
+size_t metricsAppend(char* buffer, size_t size, size_t length, const char* format, ...);
+
+/**
+ * Writes heap, uptime, histograms and counters in Prometheus text format.
+ *
+ * @return Length of the text in buffer.
+ */
+size_t formatMetrics(char* buffer, size_t size);
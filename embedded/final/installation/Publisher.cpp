@@ -0,0 +1,321 @@
+// ============================================================================
+// File: Publisher.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Publishes index updates to the NGINX push stream publisher.
+//              Only the latest pending index is sent, one request at a time
+//              over a kept-alive connection. The reply is parsed byte by byte
+//              on later polls, failures back off exponentially.
+// ============================================================================
+
+#include "Publisher.h"
+#include "Client.h"
+#include "Metrics.h"
+#include <WiFiClientSecure.h>
+#include <atomic>
+#include <ctype.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define API_INDEX_UPDATE_PATH "/api/installation/publish"
+#define PUBLISH_RESPONSE_TIMEOUT_MS 5000
+#define PUBLISH_BACKOFF_MIN_MS 500
+#define PUBLISH_BACKOFF_MAX_MS 30000
+
+#define PUBLISH_REQUEST_SIZE 384
+#define PUBLISH_BODY_SIZE 32
+#define PUBLISH_LINE_SIZE 128
+#define PUBLISH_MAX_BYTES_PER_POLL 512
+#define BACKOFF_FACTOR 2
+#define HEX_BASE 16
+#define DECIMAL_BASE 10
+#define UNKNOWN_LENGTH -1
+#define STATUS_CODE_OFFSET 9  // "HTTP/1.1 " precedes the status code
+#define STATUS_SUCCESS_MIN 200
+#define STATUS_SUCCESS_MAX 299
+
+#define CONTENT_LENGTH_HEADER "content-length:"
+#define CHUNKED_HEADER "transfer-encoding: chunked"
+#define CONNECTION_CLOSE_HEADER "connection: close"
+
+// ----------------------------------------------------------------------------
+// Publisher State
+// ----------------------------------------------------------------------------
+
+/**
+ * Where the parser is within the reply to the update in flight.
+ */
+enum PublishState {
+  PUBLISH_IDLE,
+  PUBLISH_STATUS,
+  PUBLISH_HEADERS,
+  PUBLISH_BODY,
+  PUBLISH_CHUNK_SIZE,
+  PUBLISH_CHUNK_DATA,
+  PUBLISH_CHUNK_END,
+  PUBLISH_TRAILER
+};
+
+static WiFiClientSecure publishClient;
+static PublishState state = PUBLISH_IDLE;
+
+static bool hasPending = false;
+static int pendingIndex = 0;
+static int inFlightIndex = 0;
+static unsigned long sentAt = 0;
+static unsigned long retryAt = 0;
+static bool backingOff = false;
+static unsigned long backoffMs = PUBLISH_BACKOFF_MIN_MS;
+
+static int statusCode = 0;
+static long bodyRemaining = UNKNOWN_LENGTH;
+static bool chunked = false;
+static bool closeAfterReply = false;
+
+static char line[PUBLISH_LINE_SIZE];
+static size_t lineLength = 0;
+
+static std::atomic<uint32_t> publishedCount{ 0 };
+static std::atomic<uint32_t> coalescedCount{ 0 };
+static std::atomic<uint32_t> failedCount{ 0 };
+
+// ----------------------------------------------------------------------------
+// Request & Reply
+// ----------------------------------------------------------------------------
+
+/**
+ * Drops the connection and retries after the current backoff, which then
+ * doubles. The failed index is sent again unless a newer one is pending.
+ */
+static void failPublish(const char* reason, unsigned long now) {
+  Serial.print("Index publish failed: ");
+  Serial.println(reason);
+  failedCount.fetch_add(1, std::memory_order_relaxed);
+  if (state != PUBLISH_IDLE) metricsObserve(HISTOGRAM_HTTP_POST_MS, now - sentAt);  // Timeouts show in the top buckets
+
+  publishClient.stop();
+  if (state != PUBLISH_IDLE && !hasPending) {
+    pendingIndex = inFlightIndex;
+    hasPending = true;
+  }
+  state = PUBLISH_IDLE;
+
+  retryAt = now + backoffMs;
+  backingOff = true;
+  backoffMs = min(backoffMs * BACKOFF_FACTOR, (unsigned long)PUBLISH_BACKOFF_MAX_MS);
+}
+
+/**
+ * Finishes the update in flight once its reply was read completely.
+ */
+static void completePublish(unsigned long now) {
+  if (statusCode < STATUS_SUCCESS_MIN || statusCode > STATUS_SUCCESS_MAX) {
+    Serial.print("Index publish status: ");
+    Serial.println(statusCode);
+    failPublish("unexpected status", now);
+    return;
+  }
+
+  publishedCount.fetch_add(1, std::memory_order_relaxed);
+  metricsObserve(HISTOGRAM_HTTP_POST_MS, now - sentAt);
+  backoffMs = PUBLISH_BACKOFF_MIN_MS;
+  state = PUBLISH_IDLE;
+  if (closeAfterReply) publishClient.stop();
+}
+
+/**
+ * Sends the pending index, reconnecting first if the server closed the
+ * connection. The TLS handshake is the only blocking step.
+ */
+static void sendPending(unsigned long now) {
+  if (!publishClient.connected()) {
+    unsigned long start = millis();
+    publishClient.setInsecure();
+    if (!publishClient.connect(API_HOST, API_PORT)) {
+      failPublish("connection failed", now);
+      return;
+    }
+    metricsObserve(HISTOGRAM_TLS_CONNECT_MS, millis() - start);
+  }
+
+  char body[PUBLISH_BODY_SIZE];
+  int bodyLength = snprintf(body, sizeof(body), "{\"index\": %d}", pendingIndex);
+
+  char request[PUBLISH_REQUEST_SIZE];
+  int length = snprintf(request, sizeof(request),
+                        "POST %s HTTP/1.1\r\n"
+                        "Host: %s\r\n"
+                        "User-Agent: ESP32\r\n"
+                        "bypass-tunnel-reminder: true\r\n"
+                        "Connection: keep-alive\r\n"
+                        "Content-Type: application/json\r\n"
+                        "Content-Length: %d\r\n"
+                        "\r\n"
+                        "%s",
+                        API_INDEX_UPDATE_PATH, API_HOST, bodyLength, body);
+
+  inFlightIndex = pendingIndex;
+  hasPending = false;
+  state = PUBLISH_STATUS;
+  statusCode = 0;
+  bodyRemaining = UNKNOWN_LENGTH;
+  chunked = false;
+  closeAfterReply = false;
+  lineLength = 0;
+  sentAt = millis();  // After a reconnect, so the handshake is not counted again
+
+  if (publishClient.write((const uint8_t*)request, length) != (size_t)length) {
+    failPublish("write failed", sentAt);
+  }
+}
+
+/**
+ * Accumulates one byte of a CRLF-terminated protocol line.
+ *
+ * @return True when a complete line is in line[].
+ */
+static bool appendLineByte(char c) {
+  if (c == '\n') {
+    if (lineLength > 0 && line[lineLength - 1] == '\r') lineLength--;
+    line[lineLength] = '\0';
+    lineLength = 0;
+    return true;
+  }
+  if (lineLength < PUBLISH_LINE_SIZE - 1) line[lineLength++] = c;
+  return false;
+}
+
+/**
+ * Handles the blank line after the headers: the body is framed by chunks,
+ * by Content-Length, or by the server closing the connection.
+ */
+static void endHeaders(unsigned long now) {
+  if (chunked) {
+    state = PUBLISH_CHUNK_SIZE;
+  } else if (bodyRemaining > 0) {
+    state = PUBLISH_BODY;
+  } else {
+    if (bodyRemaining == UNKNOWN_LENGTH) closeAfterReply = true;
+    completePublish(now);
+  }
+}
+
+/**
+ * Advances the reply state machine by one byte.
+ */
+static void feedByte(char c, unsigned long now) {
+  switch (state) {
+    case PUBLISH_STATUS:
+      if (!appendLineByte(c)) return;
+      statusCode = strlen(line) > STATUS_CODE_OFFSET ? atoi(line + STATUS_CODE_OFFSET) : 0;
+      state = PUBLISH_HEADERS;
+      return;
+
+    case PUBLISH_HEADERS:
+      if (!appendLineByte(c)) return;
+      if (line[0] == '\0') {
+        endHeaders(now);
+        return;
+      }
+      for (char* p = line; *p; p++) *p = tolower(*p);
+      if (strncmp(line, CONTENT_LENGTH_HEADER, strlen(CONTENT_LENGTH_HEADER)) == 0) {
+        bodyRemaining = strtol(line + strlen(CONTENT_LENGTH_HEADER), nullptr, DECIMAL_BASE);
+      } else if (strcmp(line, CHUNKED_HEADER) == 0) {
+        chunked = true;
+      } else if (strcmp(line, CONNECTION_CLOSE_HEADER) == 0) {
+        closeAfterReply = true;
+      }
+      return;
+
+    case PUBLISH_BODY:
+      if (--bodyRemaining == 0) completePublish(now);
+      return;
+
+    case PUBLISH_CHUNK_SIZE:
+      if (!appendLineByte(c)) return;
+      bodyRemaining = strtol(line, nullptr, HEX_BASE);
+      state = bodyRemaining == 0 ? PUBLISH_TRAILER : PUBLISH_CHUNK_DATA;
+      return;
+
+    case PUBLISH_CHUNK_DATA:
+      if (--bodyRemaining == 0) state = PUBLISH_CHUNK_END;
+      return;
+
+    case PUBLISH_CHUNK_END:
+      if (appendLineByte(c)) state = PUBLISH_CHUNK_SIZE;  // CRLF after the chunk data
+      return;
+
+    case PUBLISH_TRAILER:
+      if (appendLineByte(c) && line[0] == '\0') completePublish(now);
+      return;
+
+    case PUBLISH_IDLE:
+      return;  // Nothing expected, e.g. leftovers after a failed reply
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Publisher Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * publishIndex(index)
+ * -------------------
+ * Queues the index for publishing. An index that is still waiting is
+ * replaced and counted as coalesced, so only the latest one is sent.
+ *
+ * @param index Device index shown by the installation.
+ */
+void publishIndex(int index) {
+  if (hasPending) coalescedCount.fetch_add(1, std::memory_order_relaxed);
+  pendingIndex = index;
+  hasPending = true;
+}
+
+/**
+ * pollPublisher(nowMs)
+ * --------------------
+ * Processes the bytes of the reply received so far. Once the reply is
+ * complete, the pending index (if any) is sent right away; after a failure
+ * only when the backoff expired. A reply that does not arrive within
+ * PUBLISH_RESPONSE_TIMEOUT_MS counts as failed.
+ *
+ * @param nowMs Current millis().
+ */
+void pollPublisher(unsigned long nowMs) {
+  if (state != PUBLISH_IDLE) {
+    int budget = PUBLISH_MAX_BYTES_PER_POLL;
+    while (state != PUBLISH_IDLE && budget-- > 0 && publishClient.available()) {
+      feedByte((char)publishClient.read(), nowMs);
+    }
+
+    if (state == PUBLISH_IDLE) {
+      // Reply complete, continue below
+    } else if (!publishClient.connected() && !publishClient.available()) {
+      failPublish("connection closed", nowMs);
+    } else if (nowMs - sentAt >= PUBLISH_RESPONSE_TIMEOUT_MS) {
+      failPublish("timeout", nowMs);
+    }
+    if (state != PUBLISH_IDLE) return;
+  }
+
+  if (!hasPending) return;
+  if (backingOff && (long)(nowMs - retryAt) < 0) return;
+  backingOff = false;
+  sendPending(nowMs);
+}
+
+/**
+ * printPublisherStats()
+ * ---------------------
+ * Prints the index updates published, coalesced into a newer one and
+ * failed since the last call.
+ */
+void printPublisherStats() {
+  Serial.printf("Index publish: published %lu, coalesced %lu, failed %lu\n",
+                (unsigned long)publishedCount.exchange(0, std::memory_order_relaxed),
+                (unsigned long)coalescedCount.exchange(0, std::memory_order_relaxed),
+                (unsigned long)failedCount.exchange(0, std::memory_order_relaxed));
+}
@@ -0,0 +1,43 @@
+// ============================================================================
+// File: Publisher.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the outbound publisher for index updates. Pending
+//              updates are coalesced to the latest index and sent over one
+//              kept-alive HTTPS connection without waiting for the reply.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with Publisher.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define API_INDEX_UPDATE_PATH "/api/installation/publish"
+#define PUBLISH_RESPONSE_TIMEOUT_MS 5000
+#define PUBLISH_BACKOFF_MIN_MS 500
+#define PUBLISH_BACKOFF_MAX_MS 30000
+
+// ----------------------------------------------------------------------------
+// Publisher Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Marks the index as the one to publish next. Replaces an index that has
+ * not been sent yet.
+ */
+void publishIndex(int index);
+
+/**
+ * Reads the reply to the last update without blocking, and sends the
+ * pending index once the connection is free and no backoff is running.
+ * Call regularly from the network task.
+ */
+void pollPublisher(unsigned long nowMs);
+
+/**
+ * Prints published, coalesced and failed updates since the last call.
+ * Safe to call from any task.
+ */
+void printPublisherStats();
@@ -3,17 +3,23 @@
 // Author: Yanis Deplazes
 // License: MIT License
 // Copyright (c) 2025 Yanis Deplazes
-// Description: Sets up an HTTPS server with a /index route and WebSocket over
-//              TLS support for bi-directional communication.
+// Description: Sets up an HTTPS server with a /index route and a WebSocket
+//              route over TLS. The WebSocket route pushes every change of the
+//              displayed device to clients on the local network, without the
+//              round trip through the public NGINX Push Stream.
 // ============================================================================
 
-#include "server.h"
+#include "Server.h"
 #include "esp_https_server.h"
 #include "esp_log.h"
 #include "esp_tls.h"
 #include "cert.h"
 #include "key.h"
-#include "Client.h"  // To access currentIndex
+#include "SharedState.h"  // To access displayedIndex and localUpdateState
+#include "Metrics.h"
+#include "Tasks.h"
+#include <atomic>
+#include <math.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -26,12 +32,131 @@
 #define JSON_BUFFER_SIZE 32
 #define CERT_STRLEN_PADDING 1
 
+#define ROUTE_METRICS_URI "/metrics"
+#define METRICS_CONTENT_TYPE "text/plain; version=0.0.4"
+#define ROUTE_WS_URI "/ws"
+#define WS_MAX_CLIENTS 3
+#define WS_MIN_FREE_HEAP 40000
+#define WS_FRAME_SIZE 256
+#define WS_RECEIVE_BUFFER_SIZE 128
+#define WS_SPARE_SOCKETS 1  // Keeps /index reachable with all WebSocket slots taken
+#define WS_FREE_SLOT -1
+#define FIRST_SENSOR_ID 1
+#define LOOP_START_INDEX 0
+
 // ----------------------------------------------------------------------------
 // State
 // ----------------------------------------------------------------------------
 static const char *TAG = TAG_NAME;
 static httpd_handle_t server = NULL;
-static int ws_client_fd = -1;  // Track connected WebSocket client
+
+// Only touched from the server task (handlers and queued work)
+static int ws_client_fds[WS_MAX_CLIENTS];
+static LocalUpdate ws_update;
+static char metrics_buffer[METRICS_BUFFER_SIZE];  // Too large for the server task stack
+
+static std::atomic<bool> ws_push_queued{ false };
+static std::atomic<uint32_t> ws_client_count{ 0 };
+static std::atomic<uint32_t> ws_pushed_count{ 0 };
+static std::atomic<uint32_t> ws_failed_count{ 0 };
+static std::atomic<uint32_t> ws_rejected_count{ 0 };
+
+// ----------------------------------------------------------------------------
+// WebSocket Clients
+// ----------------------------------------------------------------------------
+
+/**
+ * Writes the update as {"index":..,"device":..,"at":..,"values":{"<sensorId>":..}},
+ * with "at" the millis() of the change.
+ *
+ * @return Length of the frame.
+ */
+static size_t format_update(const LocalUpdate &update, char *buf, size_t size) {
+  size_t len = snprintf(buf, size, "{\"index\":%d,\"device\":%ld,\"at\":%lu,\"values\":{", update.index,
+                        (long)update.device.id, update.changedAtMs);
+  bool first = true;
+  for (int sensorId = FIRST_SENSOR_ID; sensorId <= DEVICE_CACHE_SENSORS && len < size; sensorId++) {
+    float value = deviceCacheValue(&update.device, sensorId, NAN);
+    if (isnan(value)) continue;
+    len += snprintf(buf + len, size - len, "%s\"%d\":%.2f", first ? "" : ",", sensorId, value);
+    first = false;
+  }
+  if (len < size) len += snprintf(buf + len, size - len, "}}");
+  return min(len, size - 1);
+}
+
+/**
+ * Sends one text frame to a client. A client that is gone or cannot be
+ * written to loses its slot.
+ */
+static void send_ws_frame(int &fd, const char *frame, size_t len) {
+  if (httpd_ws_get_fd_info(server, fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+    fd = WS_FREE_SLOT;
+    ws_client_count.fetch_sub(1, std::memory_order_relaxed);
+    return;
+  }
+
+  httpd_ws_frame_t pkt;
+  memset(&pkt, 0, sizeof(pkt));
+  pkt.final = true;
+  pkt.type = HTTPD_WS_TYPE_TEXT;
+  pkt.payload = (uint8_t *)frame;
+  pkt.len = len;
+
+  if (httpd_ws_send_frame_async(server, fd, &pkt) != ESP_OK) {
+    ws_failed_count.fetch_add(1, std::memory_order_relaxed);
+    httpd_sess_trigger_close(server, fd);
+    fd = WS_FREE_SLOT;
+    ws_client_count.fetch_sub(1, std::memory_order_relaxed);
+    return;
+  }
+  ws_pushed_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Queued work, runs in the server task. Reads the newest update and sends
+ * it to every client; updates published in between are skipped.
+ */
+static void push_ws_update(void *arg) {
+  ws_push_queued.store(false, std::memory_order_release);
+
+  uint32_t version;
+  if (!localUpdateState.read(ws_update, version)) return;
+
+  char frame[WS_FRAME_SIZE];
+  size_t len = format_update(ws_update, frame, sizeof(frame));
+  for (size_t i = LOOP_START_INDEX; i < WS_MAX_CLIENTS; i++) {
+    if (ws_client_fds[i] != WS_FREE_SLOT) send_ws_frame(ws_client_fds[i], frame, len);
+  }
+}
+
+/**
+ * Takes a free slot for a new client. Clients are refused when all slots
+ * are taken or the heap is too low for another TLS session.
+ */
+static bool add_ws_client(int fd) {
+  if (esp_get_free_heap_size() < WS_MIN_FREE_HEAP) return false;
+  for (size_t i = LOOP_START_INDEX; i < WS_MAX_CLIENTS; i++) {
+    if (ws_client_fds[i] == WS_FREE_SLOT || httpd_ws_get_fd_info(server, ws_client_fds[i]) != HTTPD_WS_CLIENT_WEBSOCKET) {
+      if (ws_client_fds[i] == WS_FREE_SLOT) ws_client_count.fetch_add(1, std::memory_order_relaxed);
+      ws_client_fds[i] = fd;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Frees the slot of a client that closed the connection.
+ */
+static void remove_ws_client(int fd) {
+  for (size_t i = LOOP_START_INDEX; i < WS_MAX_CLIENTS; i++) {
+    if (ws_client_fds[i] == fd) {
+      ws_client_fds[i] = WS_FREE_SLOT;
+      ws_client_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+}
 
 // ----------------------------------------------------------------------------
 // Route Handlers
@@ -44,12 +169,71 @@ static int ws_client_fd = -1;  // Track connected WebSocket client
  */
 esp_err_t handle_index(httpd_req_t *req) {
   char resp_str[JSON_BUFFER_SIZE];
-  snprintf(resp_str, sizeof(resp_str), ROUTE_INDEX_JSON_FMT, currentIndex);
+  snprintf(resp_str, sizeof(resp_str), ROUTE_INDEX_JSON_FMT, displayedIndex.load());
 
   httpd_resp_set_type(req, "application/json");
   return httpd_resp_send(req, resp_str, HTTPD_RESP_USE_STRLEN);
 }
 
+/**
+ * handle_metrics()
+ * ----------------
+ * GET endpoint for /metrics: heap, uptime, latency histograms, counters and
+ * task stacks in Prometheus text format.
+ */
+esp_err_t handle_metrics(httpd_req_t *req) {
+  size_t len = formatMetrics(metrics_buffer, sizeof(metrics_buffer));
+  len = formatTaskMetrics(metrics_buffer, sizeof(metrics_buffer), len);
+
+  httpd_resp_set_type(req, METRICS_CONTENT_TYPE);
+  return httpd_resp_send(req, metrics_buffer, len);
+}
+
+/**
+ * handle_ws()
+ * -----------
+ * WebSocket endpoint. After the handshake the client gets the current
+ * update right away and every following one as it happens. Frames sent by
+ * clients are read and ignored.
+ */
+esp_err_t handle_ws(httpd_req_t *req) {
+  int fd = httpd_req_to_sockfd(req);
+
+  if (req->method == HTTP_GET) {
+    if (!add_ws_client(fd)) {
+      ESP_LOGW(TAG, "WebSocket client refused, %u bytes heap free", (unsigned)esp_get_free_heap_size());
+      ws_rejected_count.fetch_add(1, std::memory_order_relaxed);
+      httpd_sess_trigger_close(server, fd);
+      return ESP_OK;
+    }
+
+    uint32_t version;
+    if (localUpdateState.version() != 0 && localUpdateState.read(ws_update, version)) {
+      char frame[WS_FRAME_SIZE];
+      size_t len = format_update(ws_update, frame, sizeof(frame));
+      for (size_t i = LOOP_START_INDEX; i < WS_MAX_CLIENTS; i++) {
+        if (ws_client_fds[i] == fd) send_ws_frame(ws_client_fds[i], frame, len);
+      }
+    }
+    return ESP_OK;
+  }
+
+  httpd_ws_frame_t pkt;
+  memset(&pkt, 0, sizeof(pkt));
+  esp_err_t ret = httpd_ws_recv_frame(req, &pkt, 0);  // Length only
+  if (ret != ESP_OK) return ret;
+  if (pkt.len > WS_RECEIVE_BUFFER_SIZE) return ESP_FAIL;  // Closes the connection
+
+  uint8_t payload[WS_RECEIVE_BUFFER_SIZE];
+  if (pkt.len > 0) {
+    pkt.payload = payload;
+    ret = httpd_ws_recv_frame(req, &pkt, pkt.len);
+  }
+
+  if (pkt.type == HTTPD_WS_TYPE_CLOSE) remove_ws_client(fd);
+  return ret;
+}
+
 // ----------------------------------------------------------------------------
 // HTTPS Server Setup
 // ----------------------------------------------------------------------------
@@ -66,6 +250,9 @@ void start_https_server() {
   conf.servercert_len = strlen(server_cert) + CERT_STRLEN_PADDING;
   conf.prvtkey_pem = (const uint8_t *)server_key;
   conf.prvtkey_len = strlen(server_key) + CERT_STRLEN_PADDING;
+  conf.httpd.max_open_sockets = WS_MAX_CLIENTS + WS_SPARE_SOCKETS;
+
+  for (size_t i = LOOP_START_INDEX; i < WS_MAX_CLIENTS; i++) ws_client_fds[i] = WS_FREE_SLOT;
 
   esp_err_t ret = httpd_ssl_start(&server, &conf);
   if (ret != ESP_OK) {
@@ -80,6 +267,54 @@ void start_https_server() {
     .user_ctx = NULL
   };
 
+  httpd_uri_t metrics_uri = {
+    .uri = ROUTE_METRICS_URI,
+    .method = HTTP_GET,
+    .handler = handle_metrics,
+    .user_ctx = NULL
+  };
+
+  httpd_uri_t ws_uri = {
+    .uri = ROUTE_WS_URI,
+    .method = HTTP_GET,
+    .handler = handle_ws,
+    .user_ctx = NULL,
+    .is_websocket = true
+  };
+
   httpd_register_uri_handler(server, &index_uri);
+  httpd_register_uri_handler(server, &metrics_uri);
+  httpd_register_uri_handler(server, &ws_uri);
   ESP_LOGI(TAG, "HTTPS server started");
 }
+
+/**
+ * notifyLocalClients()
+ * --------------------
+ * Queues sending the newest update to the WebSocket clients on the server
+ * task. At most one send is queued at a time; it always picks up the newest
+ * update, so changes in quick succession are coalesced.
+ */
+void notifyLocalClients() {
+  if (!server || ws_client_count.load(std::memory_order_relaxed) == 0) return;
+  if (ws_push_queued.exchange(true, std::memory_order_acq_rel)) return;
+  if (httpd_queue_work(server, push_ws_update, NULL) != ESP_OK) {
+    ws_push_queued.store(false, std::memory_order_release);
+    ws_failed_count.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * printServerStats()
+ * ------------------
+ * Prints the connected WebSocket clients, the frames pushed, failed and
+ * the clients refused since the last call, and the free heap.
+ */
+void printServerStats() {
+  Serial.printf("Local push: clients %lu, pushed %lu, failed %lu, refused %lu, heap free %u bytes\n",
+                (unsigned long)ws_client_count.load(std::memory_order_relaxed),
+                (unsigned long)ws_pushed_count.exchange(0, std::memory_order_relaxed),
+                (unsigned long)ws_failed_count.exchange(0, std::memory_order_relaxed),
+                (unsigned long)ws_rejected_count.exchange(0, std::memory_order_relaxed),
+                (unsigned)esp_get_free_heap_size());
+}
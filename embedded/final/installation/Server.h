@@ -3,8 +3,9 @@
 // Author: Yanis Deplazes
 // License: MIT License
 // Copyright (c) 2025 Yanis Deplazes
-// Description: Declares the HTTPS server setup with TLS and a basic /index
-//              route for secure status verification.
+// Description: Declares the HTTPS server setup with TLS, a basic /index
+//              route for secure status verification and a /ws route that
+//              pushes the displayed device to clients on the local network.
 // ============================================================================
 
 #pragma once
@@ -16,6 +17,9 @@
 #define TAG_HTTPS_SERVER "HTTPS_SERVER"
 #define STATUS_ROUTE "/index"
 #define MAX_RESPONSE_LEN 32
+#define WS_ROUTE "/ws"
+#define WS_MAX_CLIENTS 3
+#define WS_MIN_FREE_HEAP 40000  // Each TLS session takes roughly 30-40 KB
 
 // ----------------------------------------------------------------------------
 // HTTPS Server Function Declarations
@@ -26,8 +30,15 @@
  */
 void start_https_server();
 
-// ----------------------------------------------------------------------------
-// Shared State
-// ----------------------------------------------------------------------------
+/**
+ * Sends the update in localUpdateState to every WebSocket client. Returns
+ * right away, the frames are sent from the server task.
+ */
+void notifyLocalClients();
+
+/**
+ * Prints the connected WebSocket clients, the frames pushed and failed since
+ * the last call and the free heap. Safe to call from any task.
+ */
+void printServerStats();
 
-extern int currentIndex;
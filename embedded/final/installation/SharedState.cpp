@@ -0,0 +1,25 @@
+// ============================================================================
+// File: SharedState.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Defines the channels shared between the installation tasks.
+//              Each channel has exactly one writer task.
+// ============================================================================
+
+#include "SharedState.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define INITIAL_INDEX 0
+
+// ----------------------------------------------------------------------------
+// Shared State
+// ----------------------------------------------------------------------------
+Seqlock<FleetSnapshot> fleetState;
+SpscQueue<int, INDEX_QUEUE_SIZE> indexQueue;
+SpscQueue<AudioCommand, AUDIO_QUEUE_SIZE> audioQueue;
+Seqlock<SoundscapeTable> soundscapeState;
+std::atomic<int> displayedIndex{ INITIAL_INDEX };
+Seqlock<LocalUpdate> localUpdateState;
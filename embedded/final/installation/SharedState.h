@@ -0,0 +1,162 @@
+// ============================================================================
+// File: SharedState.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the lock-free channels between the network, LED and
+//              audio tasks: single-producer/single-consumer queues for
+//              commands and seqlocks for the fleet snapshot, the soundscape
+//              table and the device pushed to local WebSocket clients.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "DeviceCache.h"
+#include "Soundscape.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with SharedState.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define SEQLOCK_MAX_RETRIES 8  // Readers give up and keep their last copy
+#define INDEX_QUEUE_SIZE 4
+#define AUDIO_QUEUE_SIZE 4
+
+// ----------------------------------------------------------------------------
+// Lock-Free Primitives
+// ----------------------------------------------------------------------------
+
+/**
+ * Bounded queue for exactly one producer task and one consumer task. One
+ * slot stays empty to tell a full queue from an empty one.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+public:
+  /**
+   * Producer side. Returns false if the queue is full.
+   */
+  bool push(const T& item) {
+    size_t tail = tailIndex.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) % (N + 1);
+    if (next == headIndex.load(std::memory_order_acquire)) return false;
+
+    slots[tail] = item;
+    tailIndex.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Consumer side. Returns false if the queue is empty.
+   */
+  bool pop(T& item) {
+    size_t head = headIndex.load(std::memory_order_relaxed);
+    if (head == tailIndex.load(std::memory_order_acquire)) return false;
+
+    item = slots[head];
+    headIndex.store((head + 1) % (N + 1), std::memory_order_release);
+    return true;
+  }
+
+private:
+  T slots[N + 1];
+  std::atomic<size_t> headIndex{ 0 };
+  std::atomic<size_t> tailIndex{ 0 };
+};
+
+/**
+ * Single-writer, single-reader value that the reader copies without
+ * blocking the writer. The sequence is odd while a write is in progress;
+ * the reader copies into a private buffer and retries if the sequence
+ * changed during the copy, so a torn copy never reaches the caller.
+ */
+template <typename T>
+class Seqlock {
+public:
+  /**
+   * Writer side, only ever called from one task.
+   */
+  void write(const T& value) {
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    data = value;
+    sequence.store(seq + 2, std::memory_order_release);
+  }
+
+  /**
+   * Reader side, only ever called from one task. Copies a consistent value
+   * into out. Returns false and leaves out untouched if every attempt
+   * overlapped a write, e.g. while the writer task is preempted mid-copy.
+   */
+  bool read(T& out, uint32_t& readVersion) {
+    for (int attempt = 0; attempt < SEQLOCK_MAX_RETRIES; attempt++) {
+      uint32_t before = sequence.load(std::memory_order_acquire);
+      if (before & 1) continue;
+
+      pending = data;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before) {
+        out = pending;
+        readVersion = before;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Changes with every write, so readers can skip the copy if nothing changed.
+   */
+  uint32_t version() const {
+    return sequence.load(std::memory_order_acquire);
+  }
+
+private:
+  T data;
+  T pending;  // Reader's copy until the sequence check passed; a task stack is too small for it
+  std::atomic<uint32_t> sequence{ 0 };
+};
+
+// ----------------------------------------------------------------------------
+// Shared Data Structures
+// ----------------------------------------------------------------------------
+
+/**
+ * Copy of the device cache, published by the network task.
+ */
+struct FleetSnapshot {
+  size_t count;
+  CachedDevice devices[DEVICE_CACHE_CAPACITY];
+};
+
+/**
+ * Sensor values the audio task picks a track for.
+ */
+struct AudioCommand {
+  float temp;
+  float hum;
+  float lux;
+  float water;
+  float pressure;
+};
+
+/**
+ * Device the installation shows, pushed to local WebSocket clients.
+ */
+struct LocalUpdate {
+  int index;
+  CachedDevice device;
+  unsigned long changedAtMs;  // millis() of the change, lets clients measure push latency
+};
+
+// ----------------------------------------------------------------------------
+// Shared State
+// ----------------------------------------------------------------------------
+
+extern Seqlock<FleetSnapshot> fleetState;                     // Network task -> LED task
+extern SpscQueue<int, INDEX_QUEUE_SIZE> indexQueue;           // LED task -> network task
+extern SpscQueue<AudioCommand, AUDIO_QUEUE_SIZE> audioQueue;  // LED task -> audio task
+extern Seqlock<SoundscapeTable> soundscapeState;              // Network task -> audio task
+extern std::atomic<int> displayedIndex;                       // LED task -> HTTPS server
+extern Seqlock<LocalUpdate> localUpdateState;                 // LED task -> HTTPS server
@@ -0,0 +1,221 @@
+// ============================================================================
+// File: Soundscape.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Compiles soundscape rules into a predicate table and selects
+//              the ambient track for a set of sensor values. Every distinct
+//              comparison is evaluated once into a bitmask, the first rule
+//              whose mask is fully set wins.
+// ============================================================================
+
+#include "Soundscape.h"
+#include "DFPlayerManager.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define SOUNDSCAPE_MAX_RULES 24
+#define SOUNDSCAPE_MAX_PREDICATES 32
+#define SOUNDSCAPE_DEFAULT_VERSION 0
+#define SOUND_UNKNOWN -1
+#define LOOP_START_INDEX 0
+#define NO_PREDICATES 0
+#define NO_RULES 0
+#define PREDICATE_BIT 1UL
+
+// Built-in thresholds, mirrored by the sound_* defaults in the Setting table
+#define RAIN_THRESHOLD 500.0f
+#define TEMP_VERY_COLD_THRESHOLD 5.0f
+#define TEMP_MILD_DAY_THRESHOLD 25.0f
+#define TEMP_WARM_MIN 20.0f
+#define TEMP_HOT_MIN 28.0f
+#define PRESSURE_LOW 1000.0f
+#define PRESSURE_MILD 1015.0f
+#define LUX_NIGHT_MAX 50.0f
+#define LUX_SUNSET_MAX 200.0f
+#define LUX_DAY_MIN 400.0f
+#define LUX_DAY_MAX 1000.0f
+#define HUMIDITY_HIGH 80.0f
+
+#define DEFAULT_RULE_CONDITIONS 4
+
+// ----------------------------------------------------------------------------
+// Built-In Rules
+// ----------------------------------------------------------------------------
+
+/**
+ * Rule as written in the built-in table.
+ */
+struct DefaultRule {
+  uint8_t track;
+  uint8_t count;
+  SoundCondition conditions[DEFAULT_RULE_CONDITIONS];
+};
+
+static const DefaultRule DEFAULT_RULES[] = {
+  { TRACK_RAINSTORM, 1, { { SOUND_INPUT_WATER, SOUND_OP_GT, RAIN_THRESHOLD } } },
+  { TRACK_BLIZZARD_WIND, 2, { { SOUND_INPUT_TEMP, SOUND_OP_LT, TEMP_VERY_COLD_THRESHOLD }, { SOUND_INPUT_PRESSURE, SOUND_OP_LT, PRESSURE_LOW } } },
+  { TRACK_COLD_SUNSET_WIND, 3, { { SOUND_INPUT_TEMP, SOUND_OP_LT, TEMP_VERY_COLD_THRESHOLD }, { SOUND_INPUT_PRESSURE, SOUND_OP_GE, PRESSURE_LOW }, { SOUND_INPUT_LUX, SOUND_OP_LE, LUX_SUNSET_MAX } } },
+  { TRACK_COLD_WINTER_DAY, 2, { { SOUND_INPUT_TEMP, SOUND_OP_LT, TEMP_VERY_COLD_THRESHOLD }, { SOUND_INPUT_PRESSURE, SOUND_OP_GE, PRESSURE_LOW } } },
+  { TRACK_CALM_NIGHT_CRICKETS, 2, { { SOUND_INPUT_TEMP, SOUND_OP_LE, TEMP_WARM_MIN }, { SOUND_INPUT_LUX, SOUND_OP_LT, LUX_NIGHT_MAX } } },
+  { TRACK_MILD_STORM_WIND, 2, { { SOUND_INPUT_TEMP, SOUND_OP_LT, TEMP_WARM_MIN }, { SOUND_INPUT_PRESSURE, SOUND_OP_LT, PRESSURE_LOW } } },
+  { TRACK_SPRING_MORNING_BIRDS, 3, { { SOUND_INPUT_TEMP, SOUND_OP_LT, TEMP_WARM_MIN }, { SOUND_INPUT_PRESSURE, SOUND_OP_GE, PRESSURE_LOW }, { SOUND_INPUT_LUX, SOUND_OP_GT, LUX_DAY_MIN } } },
+  { TRACK_SPRING_EVENING_CHILL, 3, { { SOUND_INPUT_TEMP, SOUND_OP_LT, TEMP_WARM_MIN }, { SOUND_INPUT_LUX, SOUND_OP_LT, LUX_SUNSET_MAX }, { SOUND_INPUT_LUX, SOUND_OP_GE, LUX_NIGHT_MAX } } },
+  { TRACK_MILD_DAY_BREEZE, 3, { { SOUND_INPUT_TEMP, SOUND_OP_LT, TEMP_MILD_DAY_THRESHOLD }, { SOUND_INPUT_PRESSURE, SOUND_OP_LE, PRESSURE_MILD }, { SOUND_INPUT_HUM, SOUND_OP_LT, HUMIDITY_HIGH } } },
+  { TRACK_HUMID_STORM_BUILD, 3, { { SOUND_INPUT_TEMP, SOUND_OP_LT, TEMP_HOT_MIN }, { SOUND_INPUT_PRESSURE, SOUND_OP_LT, PRESSURE_LOW }, { SOUND_INPUT_HUM, SOUND_OP_GT, HUMIDITY_HIGH } } },
+  { TRACK_WARM_MORNING_BIRDS, 4, { { SOUND_INPUT_TEMP, SOUND_OP_GE, TEMP_WARM_MIN }, { SOUND_INPUT_TEMP, SOUND_OP_LT, TEMP_HOT_MIN }, { SOUND_INPUT_LUX, SOUND_OP_GE, LUX_SUNSET_MAX }, { SOUND_INPUT_LUX, SOUND_OP_LT, LUX_DAY_MAX } } },
+  { TRACK_SUMMER_CICADAS, 2, { { SOUND_INPUT_TEMP, SOUND_OP_GE, TEMP_HOT_MIN }, { SOUND_INPUT_LUX, SOUND_OP_GT, LUX_DAY_MAX } } },
+  { TRACK_SUMMER_NIGHT_CRICKETS, 2, { { SOUND_INPUT_TEMP, SOUND_OP_GE, TEMP_HOT_MIN }, { SOUND_INPUT_LUX, SOUND_OP_LT, LUX_SUNSET_MAX } } },
+};
+
+static const char* const INPUT_NAMES[SOUND_INPUT_COUNT] = { "temp", "hum", "lux", "water", "pressure" };
+static const char* const OP_NAMES[SOUND_OP_COUNT] = { "lt", "le", "gt", "ge" };
+
+// ----------------------------------------------------------------------------
+// Compilation
+// ----------------------------------------------------------------------------
+
+/**
+ * Returns the index of a comparison in the predicate list, adding it if it
+ * is new, or SOUND_UNKNOWN if the list is full.
+ */
+static int predicateIndex(SoundscapeTable& table, const SoundCondition& condition) {
+  for (int i = LOOP_START_INDEX; i < table.predicateCount; i++) {
+    const SoundCondition& predicate = table.predicates[i];
+    if (predicate.input == condition.input && predicate.op == condition.op && predicate.threshold == condition.threshold) {
+      return i;
+    }
+  }
+
+  if (table.predicateCount >= SOUNDSCAPE_MAX_PREDICATES) return SOUND_UNKNOWN;
+  table.predicates[table.predicateCount] = condition;
+  return table.predicateCount++;
+}
+
+/**
+ * soundscapeBegin(table, version, defaultTrack)
+ * ---------------------------------------------
+ * Resets the table to no rules.
+ *
+ * @param table Table to reset.
+ * @param version Version reported by the API.
+ * @param defaultTrack Track played when no rule matches.
+ */
+void soundscapeBegin(SoundscapeTable& table, uint32_t version, uint8_t defaultTrack) {
+  table.version = version;
+  table.defaultTrack = defaultTrack;
+  table.predicateCount = NO_PREDICATES;
+  table.ruleCount = NO_RULES;
+}
+
+/**
+ * soundscapeAddRule(table, track, conditions, count)
+ * --------------------------------------------------
+ * Appends a rule after the existing ones. Its conditions are merged into
+ * the predicate list, so shared comparisons are only evaluated once.
+ *
+ * @param table Table to extend.
+ * @param track Track the rule selects.
+ * @param conditions Conditions that must all hold.
+ * @param count Number of conditions.
+ * @return False if the rule or predicate limit was reached.
+ */
+bool soundscapeAddRule(SoundscapeTable& table, uint8_t track, const SoundCondition* conditions, size_t count) {
+  if (table.ruleCount >= SOUNDSCAPE_MAX_RULES) return false;
+
+  uint32_t required = 0;
+  for (size_t i = LOOP_START_INDEX; i < count; i++) {
+    int index = predicateIndex(table, conditions[i]);
+    if (index == SOUND_UNKNOWN) return false;
+    required |= PREDICATE_BIT << index;
+  }
+
+  table.rules[table.ruleCount++] = { required, track };
+  return true;
+}
+
+/**
+ * soundscapeLoadDefaults(table)
+ * -----------------------------
+ * Compiles the built-in rules. They match the defaults of the sound_*
+ * settings, so the device behaves the same before the API table is loaded.
+ *
+ * @param table Table to fill.
+ */
+void soundscapeLoadDefaults(SoundscapeTable& table) {
+  soundscapeBegin(table, SOUNDSCAPE_DEFAULT_VERSION, TRACK_DEFAULT);
+  for (const DefaultRule& rule : DEFAULT_RULES) {
+    soundscapeAddRule(table, rule.track, rule.conditions, rule.count);
+  }
+}
+
+/**
+ * Looks up a name in a list of names.
+ */
+static int indexOfName(const char* const* names, int count, const char* name) {
+  if (!name) return SOUND_UNKNOWN;
+  for (int i = LOOP_START_INDEX; i < count; i++) {
+    if (strcmp(names[i], name) == 0) return i;
+  }
+  return SOUND_UNKNOWN;
+}
+
+/**
+ * soundInputFromName(name)
+ * ------------------------
+ * Maps an input name used by the API ("temp", "hum", ...) to SOUND_INPUT_*.
+ *
+ * @param name Input name.
+ * @return Input index, or SOUND_UNKNOWN.
+ */
+int soundInputFromName(const char* name) {
+  return indexOfName(INPUT_NAMES, SOUND_INPUT_COUNT, name);
+}
+
+/**
+ * soundOpFromName(name)
+ * ---------------------
+ * Maps an operator name used by the API ("lt", "le", "gt", "ge") to SOUND_OP_*.
+ *
+ * @param name Operator name.
+ * @return Operator index, or SOUND_UNKNOWN.
+ */
+int soundOpFromName(const char* name) {
+  return indexOfName(OP_NAMES, SOUND_OP_COUNT, name);
+}
+
+// ----------------------------------------------------------------------------
+// Evaluation
+// ----------------------------------------------------------------------------
+
+/**
+ * soundscapeSelect(table, inputs)
+ * -------------------------------
+ * Evaluates every predicate once, then returns the track of the first rule
+ * whose predicates all hold.
+ *
+ * @param table Compiled table.
+ * @param inputs Sensor values indexed by SOUND_INPUT_*.
+ * @return Track number.
+ */
+uint8_t soundscapeSelect(const SoundscapeTable& table, const float inputs[SOUND_INPUT_COUNT]) {
+  uint32_t holds = 0;
+  for (int i = LOOP_START_INDEX; i < table.predicateCount; i++) {
+    const SoundCondition& predicate = table.predicates[i];
+    float value = inputs[predicate.input];
+    bool result;
+    switch (predicate.op) {
+      case SOUND_OP_LT: result = value < predicate.threshold; break;
+      case SOUND_OP_LE: result = value <= predicate.threshold; break;
+      case SOUND_OP_GT: result = value > predicate.threshold; break;
+      default: result = value >= predicate.threshold; break;
+    }
+    if (result) holds |= PREDICATE_BIT << i;
+  }
+
+  for (int i = LOOP_START_INDEX; i < table.ruleCount; i++) {
+    if ((holds & table.rules[i].required) == table.rules[i].required) return table.rules[i].track;
+  }
+  return table.defaultTrack;
+}
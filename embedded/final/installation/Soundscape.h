@@ -0,0 +1,103 @@
+// ============================================================================
+// File: Soundscape.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the weather-to-soundscape decision table. Rules are
+//              loaded from the API (or the built-in defaults) and compiled
+//              into a list of distinct comparisons and one bitmask per rule.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with Soundscape.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define SOUNDSCAPE_MAX_RULES 24
+#define SOUNDSCAPE_MAX_PREDICATES 32  // One bit per comparison in the rule masks
+#define SOUNDSCAPE_DEFAULT_VERSION 0
+
+#define SOUND_INPUT_TEMP 0
+#define SOUND_INPUT_HUM 1
+#define SOUND_INPUT_LUX 2
+#define SOUND_INPUT_WATER 3
+#define SOUND_INPUT_PRESSURE 4
+#define SOUND_INPUT_COUNT 5
+
+#define SOUND_OP_LT 0
+#define SOUND_OP_LE 1
+#define SOUND_OP_GT 2
+#define SOUND_OP_GE 3
+#define SOUND_OP_COUNT 4
+
+#define SOUND_MAX_CONDITIONS (SOUND_INPUT_COUNT * SOUND_OP_COUNT)
+#define SOUND_UNKNOWN -1
+
+// ----------------------------------------------------------------------------
+// Data Structures
+// ----------------------------------------------------------------------------
+
+/**
+ * One comparison of a sensor input against a threshold.
+ */
+struct SoundCondition {
+  uint8_t input;
+  uint8_t op;
+  float threshold;
+};
+
+/**
+ * A rule matches if all predicates in its mask hold.
+ */
+struct SoundRule {
+  uint32_t required;
+  uint8_t track;
+};
+
+/**
+ * Compiled table. Selecting a track costs at most SOUNDSCAPE_MAX_PREDICATES
+ * comparisons and SOUNDSCAPE_MAX_RULES mask tests.
+ */
+struct SoundscapeTable {
+  uint32_t version;
+  uint8_t defaultTrack;
+  uint8_t predicateCount;
+  uint8_t ruleCount;
+  SoundCondition predicates[SOUNDSCAPE_MAX_PREDICATES];
+  SoundRule rules[SOUNDSCAPE_MAX_RULES];
+};
+
+// ----------------------------------------------------------------------------
+// Soundscape Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Clears the table before rules are added.
+ */
+void soundscapeBegin(SoundscapeTable& table, uint32_t version, uint8_t defaultTrack);
+
+/**
+ * Appends a rule. Returns false if the table is full.
+ */
+bool soundscapeAddRule(SoundscapeTable& table, uint8_t track, const SoundCondition* conditions, size_t count);
+
+/**
+ * Compiles the built-in rules, used until the API table is loaded.
+ */
+void soundscapeLoadDefaults(SoundscapeTable& table);
+
+/**
+ * Returns the SOUND_INPUT_* for an API input name, or SOUND_UNKNOWN.
+ */
+int soundInputFromName(const char* name);
+
+/**
+ * Returns the SOUND_OP_* for an API operator name, or SOUND_UNKNOWN.
+ */
+int soundOpFromName(const char* name);
+
+/**
+ * Returns the track of the first matching rule, or the default track.
+ */
+uint8_t soundscapeSelect(const SoundscapeTable& table, const float inputs[SOUND_INPUT_COUNT]);
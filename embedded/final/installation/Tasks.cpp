@@ -0,0 +1,334 @@
+// ============================================================================
+// File: Tasks.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the network, LED and audio tasks. The network task
+//              owns the device cache and all HTTPS traffic, the LED task owns
+//              the rotation and the strip, the audio task the DFPlayer. They
+//              only talk through the channels in SharedState.h.
+// ============================================================================
+
+#include "Tasks.h"
+#include "Client.h"
+#include "EventStream.h"
+#include "Metrics.h"
+#include "Publisher.h"
+#include "Server.h"
+#include "SharedState.h"
+#include "LEDManager.h"
+#include "DFPlayerManager.h"
+#include <sys/time.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define TASK_NETWORK 0
+#define TASK_LED 1
+#define TASK_AUDIO 2
+#define TASK_COUNT 3
+
+#define INITIAL_INDEX 0
+#define INDEX_INCREMENT 1
+#define NO_VALUE 0.0f
+#define ERROR_DEVICE_ID -1
+#define NO_INDEX -1
+
+#define MIN_VALID_EPOCH 1700000000L
+#define US_PER_MS 1000
+
+// ----------------------------------------------------------------------------
+// Task Statistics
+// ----------------------------------------------------------------------------
+
+/**
+ * Loop statistics, written by the task itself and read by printTaskStats().
+ */
+struct TaskStats {
+  const char* name;
+  TaskHandle_t handle;
+  std::atomic<uint32_t> loops;
+  std::atomic<uint32_t> totalUs;
+  std::atomic<uint32_t> maxUs;
+};
+
+static TaskStats stats[TASK_COUNT] = { { "network" }, { "led" }, { "audio" } };
+
+/**
+ * Records the duration of one loop iteration.
+ */
+static void recordLoop(TaskStats& task, uint32_t startUs) {
+  uint32_t elapsed = micros() - startUs;
+  task.loops.fetch_add(1, std::memory_order_relaxed);
+  task.totalUs.fetch_add(elapsed, std::memory_order_relaxed);
+
+  uint32_t max = task.maxUs.load(std::memory_order_relaxed);
+  while (elapsed > max && !task.maxUs.compare_exchange_weak(max, elapsed, std::memory_order_relaxed)) {
+  }
+}
+
+/**
+ * Wall-clock time in milliseconds, or 0 until NTP has synced.
+ */
+static long long currentEpochMs() {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  if (now.tv_sec < MIN_VALID_EPOCH) return 0;
+  return (long long)now.tv_sec * MS_PER_SECOND + now.tv_usec / US_PER_MS;
+}
+
+// ----------------------------------------------------------------------------
+// Tasks
+// ----------------------------------------------------------------------------
+
+/**
+ * networkTask()
+ * -------------
+ * Core 0. Keeps the event stream open, refreshes the snapshot and the
+ * soundscape on their intervals and hands index changes to the publisher,
+ * which only sends the latest one.
+ */
+static void networkTask(void* parameter) {
+  initSoundscape();
+  refreshSoundscape();
+  refreshSnapshot();
+  unsigned long lastSensorFetch = millis();
+  unsigned long lastSoundscapeFetch = lastSensorFetch;
+  initEventStream(handleReadingEvent);
+
+  for (;;) {
+    uint32_t start = micros();
+    unsigned long now = millis();
+
+    pollEventStream();
+
+    if (now - lastSensorFetch >= SENSOR_FETCH_INTERVAL_MS) {
+      refreshSnapshot();
+      lastSensorFetch = now;
+    }
+
+    if (now - lastSoundscapeFetch >= SOUNDSCAPE_FETCH_INTERVAL_MS) {
+      refreshSoundscape();
+      lastSoundscapeFetch = now;
+    }
+
+    int index;
+    while (indexQueue.pop(index)) publishIndex(index);
+    pollPublisher(now);
+
+    recordLoop(stats[TASK_NETWORK], start);
+    vTaskDelay(pdMS_TO_TICKS(NETWORK_TASK_PERIOD_MS));
+  }
+}
+
+/**
+ * Keeps showing the same device after the fleet changed, or stays in
+ * range if it is gone.
+ */
+static int followDevice(const FleetSnapshot& fleet, int32_t deviceId, int index) {
+  for (size_t i = LOOP_START_INDEX; i < fleet.count; i++) {
+    if (fleet.devices[i].id == deviceId) return i;
+  }
+  return fleet.count == NO_DEVICES ? INITIAL_INDEX : min(index, (int)fleet.count - INDEX_INCREMENT);
+}
+
+/**
+ * Builds the audio command for a device.
+ */
+static AudioCommand audioCommandFor(const CachedDevice& device) {
+  return {
+    deviceCacheValue(&device, SENSOR_ID_DHT11_TEMPERATURE, NO_VALUE),
+    deviceCacheValue(&device, SENSOR_ID_DHT11_HUMIDITY, NO_VALUE),
+    deviceCacheValue(&device, SENSOR_ID_BH1750_LUX, NO_VALUE),
+    deviceCacheValue(&device, SENSOR_ID_ANALOG_WATER, NO_VALUE),
+    deviceCacheValue(&device, SENSOR_ID_BMP180_PRESSURE, NO_VALUE)
+  };
+}
+
+/**
+ * ledTask()
+ * ---------
+ * Core 1, fixed frame rate. Picks up new fleet snapshots, rotates through
+ * the devices and renders the current one. The scene is only set when the
+ * device or its reading changed; such changes and index changes are pushed
+ * to local WebSocket clients right away, and index changes, from the
+ * rotation or from following a device through a fleet change, are queued
+ * for the publisher. The ingest-to-LED latency is logged for readings that
+ * arrived over the event stream; both clocks come from NTP, so it is
+ * accurate to their offset (typically a few ms).
+ */
+static void ledTask(void* parameter) {
+  static FleetSnapshot fleet;  // Too large for the task stack
+  uint32_t fleetVersion = 0;
+  int index = INITIAL_INDEX;
+  int32_t shownId = ERROR_DEVICE_ID;
+  uint32_t shownReadingId = NO_READING;
+  int shownIndex = NO_INDEX;
+  AudioCommand audio;
+  bool audioPending = false;  // Retried every frame while the audio queue is full
+  bool logLatency = false;    // Logged once the pushed reading reached the strip
+  long long pushedAtMs = 0;
+  unsigned long lastChange = millis();
+  TickType_t wakeTime = xTaskGetTickCount();
+
+  for (;;) {
+    uint32_t start = micros();
+    unsigned long now = millis();
+
+    uint32_t version;
+    if (fleetState.version() != fleetVersion && fleetState.read(fleet, version)) {
+      fleetVersion = version;
+      int followed = followDevice(fleet, shownId, index);
+      if (followed != index) indexQueue.push(followed);  // Same as a rotation, the frontend follows
+      index = followed;
+    }
+
+    if (fleet.count != NO_DEVICES && now - lastChange >= DEVICE_CYCLE_INTERVAL_MS) {
+      index = (index + INDEX_INCREMENT) % fleet.count;
+      lastChange = now;
+      indexQueue.push(index);
+    }
+    displayedIndex.store(index, std::memory_order_relaxed);
+
+    if (fleet.count != NO_DEVICES) {
+      const CachedDevice& device = fleet.devices[index];
+      bool sameDevice = device.id == shownId;
+      bool sceneChanged = !sameDevice || device.readingId != shownReadingId;
+      if (sceneChanged) {
+        audio = audioCommandFor(device);
+        audioPending = true;
+        setLedScene(audio.temp, audio.water, audio.pressure);
+        logLatency = sameDevice && device.pushedReadingId == device.readingId && device.pushedAtMs > 0;
+        pushedAtMs = device.pushedAtMs;
+
+        shownId = device.id;
+        shownReadingId = device.readingId;
+      }
+
+      if (sceneChanged || index != shownIndex) {
+        localUpdateState.write({ index, device, now });
+        notifyLocalClients();
+        shownIndex = index;
+      }
+    }
+
+    if (renderLedFrame(now) && logLatency) {
+      long long shownAt = currentEpochMs();
+      if (shownAt > 0) {
+        Serial.print("Ingest to LED ms: ");
+        Serial.println((long)(shownAt - pushedAtMs));
+      }
+      logLatency = false;
+    }
+
+    if (audioPending && audioQueue.push(audio)) audioPending = false;
+
+    recordLoop(stats[TASK_LED], start);
+    vTaskDelayUntil(&wakeTime, pdMS_TO_TICKS(LED_FRAME_MS));
+  }
+}
+
+/**
+ * audioTask()
+ * -----------
+ * Core 1. Picks the track for the newest queued values, and again for the
+ * last values when a new soundscape arrives, and drives the DFPlayer
+ * command queue. The DFPlayer is only ever driven from this task.
+ */
+static void audioTask(void* parameter) {
+  static SoundscapeTable soundscape;  // Too large for the task stack
+  uint32_t soundscapeVersion = 0;
+  AudioCommand command = {};
+  bool received = false;
+
+  for (;;) {
+    uint32_t start = micros();
+
+    bool changed = false;
+    while (audioQueue.pop(command)) changed = received = true;
+
+    uint32_t version;
+    if (soundscapeState.version() != soundscapeVersion && soundscapeState.read(soundscape, version)) {
+      soundscapeVersion = version;
+      changed = true;
+    }
+
+    if (changed && received && soundscapeVersion) {
+      float inputs[SOUND_INPUT_COUNT] = { command.temp, command.hum, command.lux, command.water, command.pressure };
+      playTrack(soundscapeSelect(soundscape, inputs));
+    }
+    updateDFPlayer(millis());
+
+    recordLoop(stats[TASK_AUDIO], start);
+    vTaskDelay(pdMS_TO_TICKS(AUDIO_TASK_PERIOD_MS));
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Task Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * startTasks()
+ * ------------
+ * Creates the tasks pinned to their cores. The initial index is queued so
+ * the frontend is in sync once the network task is up.
+ */
+void startTasks() {
+  indexQueue.push(INITIAL_INDEX);
+
+  xTaskCreatePinnedToCore(networkTask, stats[TASK_NETWORK].name, NETWORK_TASK_STACK_SIZE, nullptr,
+                          NETWORK_TASK_PRIORITY, &stats[TASK_NETWORK].handle, NETWORK_TASK_CORE);
+  xTaskCreatePinnedToCore(ledTask, stats[TASK_LED].name, LED_TASK_STACK_SIZE, nullptr,
+                          LED_TASK_PRIORITY, &stats[TASK_LED].handle, LED_TASK_CORE);
+  xTaskCreatePinnedToCore(audioTask, stats[TASK_AUDIO].name, AUDIO_TASK_STACK_SIZE, nullptr,
+                          AUDIO_TASK_PRIORITY, &stats[TASK_AUDIO].handle, AUDIO_TASK_CORE);
+}
+
+/**
+ * printTaskStats()
+ * ----------------
+ * Prints per task: iterations, average and worst loop time since the last
+ * call, and the smallest amount of stack that was ever left unused.
+ */
+void printTaskStats() {
+  Serial.println("--- Task stats ---");
+  for (size_t i = LOOP_START_INDEX; i < TASK_COUNT; i++) {
+    TaskStats& task = stats[i];
+    if (!task.handle) continue;
+
+    uint32_t loops = task.loops.exchange(0, std::memory_order_relaxed);
+    uint32_t totalUs = task.totalUs.exchange(0, std::memory_order_relaxed);
+    uint32_t maxUs = task.maxUs.exchange(0, std::memory_order_relaxed);
+
+    Serial.printf("%s: core %d, loops %lu, avg %lu us, max %lu us, stack free %u bytes\n", task.name,
+                  (int)xTaskGetAffinity(task.handle), (unsigned long)loops,
+                  (unsigned long)(loops ? totalUs / loops : 0), (unsigned long)maxUs,
+                  (unsigned)uxTaskGetStackHighWaterMark(task.handle));
+  }
+  Serial.println("------------------");
+}
+
+/**
+ * formatTaskMetrics(buffer, size, length)
+ * ---------------------------------------
+ * Appends the smallest amount of stack that was ever left unused, per task,
+ * in Prometheus text format.
+ *
+ * @param buffer Output buffer, already holding length characters.
+ * @param size Size of the buffer.
+ * @param length Current length of the text in buffer.
+ * @return New length of the text in buffer.
+ */
+size_t formatTaskMetrics(char* buffer, size_t size, size_t length) {
+  length = metricsAppend(buffer, size, length,
+                         "# HELP atmos_task_stack_free_bytes Smallest unused stack since the task started\n"
+                         "# TYPE atmos_task_stack_free_bytes gauge\n");
+  for (size_t i = LOOP_START_INDEX; i < TASK_COUNT; i++) {
+    const TaskStats& task = stats[i];
+    if (!task.handle) continue;
+    length = metricsAppend(buffer, size, length, "atmos_task_stack_free_bytes{task=\"%s\"} %u\n", task.name,
+                           (unsigned)uxTaskGetStackHighWaterMark(task.handle));
+  }
+  return length;
+}
@@ -0,0 +1,55 @@
+// ============================================================================
+// File: Tasks.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the FreeRTOS tasks of the installation. Networking
+//              runs on core 0 next to the WiFi stack, LED rendering and audio
+//              control on core 1, so blocking TLS never stalls the output.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with Tasks.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define NETWORK_TASK_CORE 0
+#define NETWORK_TASK_PRIORITY 1
+#define NETWORK_TASK_STACK_SIZE 12288  // TLS handshakes need the headroom
+#define NETWORK_TASK_PERIOD_MS 10
+
+#define LED_TASK_CORE 1
+#define LED_TASK_PRIORITY 3
+#define LED_TASK_STACK_SIZE 4096
+
+#define AUDIO_TASK_CORE 1
+#define AUDIO_TASK_PRIORITY 2
+#define AUDIO_TASK_STACK_SIZE 4096
+#define AUDIO_TASK_PERIOD_MS 20  // Resolution of DFPlayer timeouts and ramps
+
+#define DEVICE_CYCLE_INTERVAL_MS 10000
+#define SENSOR_FETCH_INTERVAL_MS 50000
+#define SOUNDSCAPE_FETCH_INTERVAL_MS 600000
+
+// ----------------------------------------------------------------------------
+// Task Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Creates the network, LED and audio tasks. WiFi, LEDs and the DFPlayer
+ * must be initialized before.
+ */
+void startTasks();
+
+/**
+ * Prints loop latency and stack high-water marks per task and resets the
+ * latency counters.
+ */
+void printTaskStats();
+
+/**
+ * Appends the free stack of every task to a /metrics response. Unlike
+ * printTaskStats() it resets nothing, so both can be used side by side.
+ */
+size_t formatTaskMetrics(char* buffer, size_t size, size_t length);
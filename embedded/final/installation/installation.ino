@@ -3,8 +3,9 @@
 // Author: Yanis Deplazes
 // License: MIT License
 // Copyright (c) 2025 Yanis Deplazes
-// Description: Initializes HTTPS server, fetches sensor data from backend API,
-//              and cycles through available devices on a timed interval.
+// Description: Initializes HTTPS server and hardware, then starts the
+//              network, LED and audio tasks. The Arduino loop only reports
+//              task statistics.
 // ============================================================================
 
 #include <Arduino.h>
@@ -16,6 +17,8 @@
 #include "Client.h"
 #include "Server.h"
 #include "LEDManager.h"
+#include "Tasks.h"
+#include "Publisher.h"
 
 // ---------------------------------------------------------------------------
 // Pin & Serial Configuration
@@ -30,25 +33,22 @@
 // ---------------------------------------------------------------------------
 
 #define SERIAL_BAUD_RATE 115200
-#define DEVICE_CYCLE_INTERVAL_MS 10000
-#define SENSOR_FETCH_INTERVAL_MS 50000
-#define INITIAL_INDEX 0
-#define TIME_ZERO_MS 0
+#define STATS_INTERVAL_MS 10000
+#define NTP_SERVER "pool.ntp.org"
+#define UTC_OFFSET_S 0
+#define DST_OFFSET_S 0
 
 // ---------------------------------------------------------------------------
 // State Variables
 // ---------------------------------------------------------------------------
 
 HardwareSerial mySerial(DFPLAYER_SERIAL_INDEX);
-unsigned long lastSensorFetch = TIME_ZERO_MS;
-unsigned long lastChange = TIME_ZERO_MS;
-
-int currentIndex = INITIAL_INDEX;
 
 /**
  * setup()
  * -------
- * Initializes all components: WiFi, LED strip, DFPlayer, server, and backend sync.
+ * Initializes all components: WiFi, LED strip, DFPlayer, server, and the
+ * tasks that take over from here.
  */
 void setup() {
   Serial.begin(SERIAL_BAUD_RATE);
@@ -56,20 +56,21 @@ void setup() {
   initLEDs();
   initDFPlayer(&mySerial, DFPLAYER_RX_PIN, DFPLAYER_TX_PIN);
   start_https_server();
-  getDeviceCount();
-  getLatestReadingForCurrentDevice();
+  configTime(UTC_OFFSET_S, DST_OFFSET_S, NTP_SERVER);  // Used to measure ingest-to-LED latency
+  startTasks();
 }
 
 /**
  * loop()
  * ------
- * Periodically cycles through devices by incrementing current index.
+ * Prints per-task loop latency, stack high-water marks, LED frame,
+ * DFPlayer command and index publish stats.
  */
 void loop() {
-  unsigned long now = millis();
-
-  if (now - lastChange >= DEVICE_CYCLE_INTERVAL_MS) {
-    next();
-    lastChange = now;
-  }
+  printTaskStats();
+  printLedStats();
+  printDFPlayerStats();
+  printPublisherStats();
+  printServerStats();
+  delay(STATS_INTERVAL_MS);
 }
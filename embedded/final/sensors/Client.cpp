@@ -8,10 +8,16 @@
 // ============================================================================
 
 #include "Client.h"
+#include "HttpMessage.h"
+#include "ReadingQueue.h"
+#include "WireFormat.h"
+#include "Scheduler.h"
+#include "ReportPolicy.h"
 #include <ESP8266WiFi.h>
 #include <Arduino.h>
 #include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
+#include <LittleFS.h>
 
 // ----------------------------------------------------------------------------
 // Constants & Macros
@@ -21,72 +27,193 @@
 #define API_DEVICES_PATH "/api/device"
 #define API_READING_PATH "/api/reading"
 #define API_SENSORDATA_PATH "/api/sensordata"
+#define API_READING_BATCH_PATH "/api/reading-with-sensordata/batch"
 
-#define DOC_BUFFER_SIZE 4096
-#define DOC_POST_SIZE 128
-#define DOC_SENSOR_ARRAY_SIZE 1024
-#define DOC_READING_LIST_SIZE 2048
-
-#define JSON_ARRAY_OPEN_INDEX 0
-#define HEADER_END_LINE "\r"
 #define PAYLOAD_DELAY_MS 200
 
 #define ERROR_READING_ID -1
-#define JSON_ARRAY_OFFSET 2
 
 #define LOOP_START_INDEX 0
 #define FLOAT_DECIMAL_PRECISION 2
 
+#define HTTP_TIMEOUT_MS 5000
+#define HTTP_MAX_ATTEMPTS 2
+#define HTTP_STATUS_NONE 0
+#define HTTP_HEADER_RESERVE 256       // Request line and headers, rendered in front of the body
+#define HTTP_BODY_CAPACITY 2560       // Largest request body (a JSON batch of 5 readings)
+#define HTTP_RESPONSE_BUFFER_SIZE 2048
+#define HTTP_READ_CHUNK 64
+
+#define UPLOAD_BATCH_SIZE 10
+#define JSON_UPLOAD_BATCH_SIZE 5
+#define UPLOAD_MAX_INTERVAL_MS 30000
+#define UPLOAD_RETRY_MS 10000
+#define VALUE_SCALE 100.0
+#define SINGLE_SAMPLE 1
+#define UPLOAD_FAILED -1
+#define HTTP_STATUS_OK 200
+#define HTTP_STATUS_NOT_MODIFIED 304
+#define HTTP_STATUS_CLIENT_ERROR 400
+#define HTTP_STATUS_NOT_FOUND 404
+#define HTTP_STATUS_SERVER_ERROR 500
+
+#define DEVICE_CACHE_PATH "/device.id"
+#define DEVICE_CACHE_MAGIC 0x41544432  // "ATD2"
+#define DEVICE_KEY_SIZE 18             // "AA:BB:CC:DD:EE:FF" + '\0'
+#define DEVICE_PATH_SIZE 64
+#define DEVICE_REVALIDATE_PERIOD_MS 60000
+
 // ----------------------------------------------------------------------------
 // Internal Utilities
 // ----------------------------------------------------------------------------
 
 WiFiClientSecure secureClient;
-static StaticJsonDocument<DOC_BUFFER_SIZE> jsonBuffer;
+static BearSSL::Session tlsSession;  // Cached TLS session for abbreviated handshakes
+static JsonDocument jsonBuffer;  // ArduinoJson 7, kept so its heap pool is reused
 int deviceId = ERROR_READING_ID;
+unsigned long tlsHandshakeCount = 0;
+int lastResponseStatus = HTTP_STATUS_NONE;
+
+static QueuedReading uploadBatch[UPLOAD_BATCH_SIZE];
+static uint32_t uploadSequence = 0;
+static bool useBinaryUpload = true;
+static unsigned long lastUploadAttempt = 0;
+static bool lastUploadFailed = false;
+static bool deviceConfirmed = false;  // Device ID checked against the API since boot
+static char deviceEtag[HTTP_ETAG_SIZE];  // Validator of the cached device ID
+
+/**
+ * Device ID cached in LittleFS, together with the MAC it was resolved for
+ * and the ETag of the lookup that confirmed it.
+ */
+struct DeviceCacheRecord {
+  uint32_t magic;
+  char key[DEVICE_KEY_SIZE];
+  int32_t id;
+  char etag[HTTP_ETAG_SIZE];
+};
+
+// Headers are rendered right-aligned into the reserve in front of the body,
+// so a request leaves in a single write without copying the body.
+static char requestBuffer[HTTP_HEADER_RESERVE + HTTP_BODY_CAPACITY];
+static char responseBuffer[HTTP_RESPONSE_BUFFER_SIZE];
+static HttpResponse response;
+
+static unsigned long httpRequestCount = 0;
+static unsigned long httpWriteCount = 0;
+static unsigned long httpRecordCount = 0;  // Estimated, see HTTP_TLS_RECORD_PAYLOAD
+static unsigned long httpBytesSent = 0;
+
+static_assert(HTTP_BODY_CAPACITY >= WIRE_FRAME_MAX_SIZE(UPLOAD_BATCH_SIZE), "Binary upload frame does not fit the request buffer");
 
 /**
- * Writes standard HTTP headers for GET/POST requests.
+ * Makes sure the keep-alive connection is open, reconnecting if the peer closed it.
+ * Reconnects offer the cached BearSSL session so the server can resume it.
  */
-void writeCommonHeaders(const String& method, const String& path, const String& contentType = "", size_t contentLength = 0) {
-  secureClient.print(method + " ");
-  secureClient.print(path);
-  secureClient.println(" HTTP/1.1");
-
-  secureClient.print("Host: ");
-  secureClient.println(API_HOST);
-  secureClient.println("User-Agent: ESP8266");
-  secureClient.println("bypass-tunnel-reminder: true");
-  secureClient.println("Connection: close");
-
-  if (method == "POST") {
-    secureClient.print("Content-Type: ");
-    secureClient.println(contentType);
-    secureClient.print("Content-Length: ");
-    secureClient.println(contentLength);
+bool ensureConnected() {
+  if (secureClient.connected()) return true;
+
+  secureClient.stop();
+  secureClient.setInsecure();  // Skip cert validation (for dev)
+  secureClient.setSession(&tlsSession);
+  secureClient.setTimeout(HTTP_TIMEOUT_MS);
+
+  if (!secureClient.connect(API_HOST, API_PORT)) {
+    Serial.println("Connection failed");
+    return false;
   }
 
-  secureClient.println();  // End of headers
+  tlsHandshakeCount++;
+  Serial.print("TLS handshakes: ");
+  Serial.println(tlsHandshakeCount);
+  return true;
+}
+
+/**
+ * Renders the request headers in front of the body already stored in the
+ * request buffer and sends everything with one write.
+ *
+ * @return True if the whole request was written.
+ */
+bool writeRequest(const char* method, const char* path, size_t bodyLength, const char* contentType, const char* ifNoneMatch) {
+  size_t headerLength = httpRenderRequest(requestBuffer, HTTP_HEADER_RESERVE, API_HOST, method, path, bodyLength,
+                                          contentType, ifNoneMatch);
+  if (headerLength == HTTP_RENDER_FAILED) return false;
+
+  const char* start = requestBuffer + HTTP_HEADER_RESERVE - headerLength;
+  size_t total = headerLength + bodyLength;
+  httpWriteCount++;
+  httpRecordCount += httpTlsRecords(total);
+  httpBytesSent += total;
+
+  return secureClient.write((const uint8_t*)start, total) == total;
 }
 
 /**
- * Skips HTTP headers in the response stream.
+ * Feeds the response to the parser as it arrives, until it is complete,
+ * broken, or no byte arrived for HTTP_TIMEOUT_MS. While waiting, due
+ * sampling tasks keep running.
+ *
+ * @return True if the status line and all headers were received.
  */
-void skipHttpHeaders() {
-  while (secureClient.connected()) {
-    String line = secureClient.readStringUntil('\n');
-    if (line == HEADER_END_LINE) break;  // Empty line marks end of headers
+bool readResponse() {
+  uint8_t chunk[HTTP_READ_CHUNK];
+  unsigned long lastData = millis();
+
+  while (!httpResponseFinished(response)) {
+    int available = secureClient.available();
+    if (available <= 0) {
+      if (!secureClient.connected()) {
+        httpResponseClosed(response);
+        break;
+      }
+      if (millis() - lastData >= HTTP_TIMEOUT_MS) break;
+      runSamplingTasks();
+      yield();
+      continue;
+    }
+
+    int got = secureClient.read(chunk, min((size_t)available, sizeof(chunk)));
+    if (got > 0) {
+      httpResponseFeed(response, chunk, got);
+      lastData = millis();
+    }
   }
+
+  if (response.state != HTTP_PARSE_DONE) response.keepAlive = false;  // Leftover bytes would corrupt the next response
+  return response.headersComplete;
 }
 
 /**
- * Extracts a JSON array string from raw HTTP body.
+ * Sends the request over the keep-alive connection and reads the response
+ * into the response buffer. A reused connection that was silently closed by
+ * the peer is retried once on a fresh (resumed) connection. The status code
+ * is kept in lastResponseStatus.
+ *
+ * @return HTTP status code, or HTTP_STATUS_NONE.
  */
-String extractJsonArray(const String& raw) {
-  int start = raw.indexOf("[{");
-  int end = raw.lastIndexOf("}]") + JSON_ARRAY_OFFSET;
-  if (start == JSON_ARRAY_OPEN_INDEX || end <= start) return "";
-  return raw.substring(start, end);
+int sendRequest(const char* method, const char* path, size_t bodyLength = 0, const char* contentType = "",
+                const char* ifNoneMatch = "") {
+  lastResponseStatus = HTTP_STATUS_NONE;
+  httpRequestCount++;
+
+  for (int attempt = LOOP_START_INDEX; attempt < HTTP_MAX_ATTEMPTS; attempt++) {
+    bool reused = secureClient.connected();
+    httpResponseBegin(response, responseBuffer, sizeof(responseBuffer));
+    if (!ensureConnected()) return HTTP_STATUS_NONE;
+
+    if (!writeRequest(method, path, bodyLength, contentType, ifNoneMatch) || !readResponse()) {
+      secureClient.stop();
+      if (reused) continue;  // Stale keep-alive socket
+      return HTTP_STATUS_NONE;
+    }
+
+    lastResponseStatus = response.status;
+    if (!response.keepAlive) secureClient.stop();
+    return response.status;
+  }
+
+  return HTTP_STATUS_NONE;
 }
 
 // ----------------------------------------------------------------------------
@@ -94,184 +221,403 @@ String extractJsonArray(const String& raw) {
 // ----------------------------------------------------------------------------
 
 /**
- * httpGET(path)
- * -------------
- * Performs a HTTPS GET request to the specified API path.
- * 
- * @param path Relative API path to request.
- * @return Response body as String.
+ * httpRequestBody()
+ * -----------------
+ * Returns the buffer POST bodies are rendered into before calling httpPOST().
+ * It holds HTTP_BODY_CAPACITY bytes and stays untouched until the next request.
+ *
+ * @return Pointer to the request body buffer.
  */
-String httpGET(const String& path) {
-  Serial.println("GET " + path);
-
-  secureClient.setInsecure();  // Skip cert validation (for dev)
-  if (!secureClient.connect(API_HOST, API_PORT)) {
-    Serial.println("Connection failed");
-    return "";
-  }
-
-  writeCommonHeaders("GET", path);
-  skipHttpHeaders();  // Skip response headers
+uint8_t* httpRequestBody() {
+  return (uint8_t*)requestBuffer + HTTP_HEADER_RESERVE;
+}
 
-  String responseBody;
-  while (secureClient.available()) {
-    responseBody += (char)secureClient.read();
-  }
+/**
+ * httpResponseBody()
+ * ------------------
+ * @return The NUL-terminated body of the last response (may be truncated).
+ */
+const char* httpResponseBody() {
+  return responseBuffer;
+}
 
-  secureClient.stop();
-  return responseBody;
+/**
+ * httpGET(path, etag)
+ * -------------------
+ * Performs a HTTPS GET request to the specified API path over the
+ * keep-alive connection. The body is available via httpResponseBody().
+ *
+ * @param path Relative API path to request.
+ * @param etag Validator of the cached copy; the server answers 304 without
+ *             a body while it is current. Empty for a plain GET.
+ * @return HTTP status code, or HTTP_STATUS_NONE.
+ */
+int httpGET(const char* path, const char* etag) {
+  Serial.print("GET ");
+  Serial.println(path);
+  return sendRequest("GET", path, 0, "", etag);
 }
 
 /**
- * httpPOST(path, payload, contentType)
- * ------------------------------------
- * Performs a HTTPS POST request with a JSON payload.
- * 
+ * httpPOST(path, bodyLength, contentType)
+ * ---------------------------------------
+ * Performs a HTTPS POST request with the body rendered into
+ * httpRequestBody() over the keep-alive connection.
+ *
  * @param path Relative API path.
- * @param payload JSON-formatted string.
+ * @param bodyLength Number of body bytes in httpRequestBody().
  * @param contentType Content type header value (default = application/json).
- * @return Response body as String.
+ * @return HTTP status code, or HTTP_STATUS_NONE.
  */
-String httpPOST(const String& path, const String& payload, const String& contentType) {
-  Serial.println("POST " + path);
+int httpPOST(const char* path, size_t bodyLength, const char* contentType) {
+  Serial.print("POST ");
+  Serial.println(path);
+  return sendRequest("POST", path, min(bodyLength, (size_t)HTTP_BODY_CAPACITY), contentType);
+}
 
-  secureClient.setInsecure();  // Skip cert validation
-  if (!secureClient.connect(API_HOST, API_PORT)) {
-    Serial.println("Connection failed");
-    return "";
+/**
+ * printHttpStats()
+ * ----------------
+ * Prints bytes, writes and estimated TLS records per request together with
+ * the heap state, to check that requests neither fragment nor leak.
+ */
+void printHttpStats() {
+  Serial.println("--- HTTP ---");
+  if (httpRequestCount > 0) {
+    Serial.printf("requests=%lu bytes/req=%lu writes/req=%lu.%02lu records/req=%lu.%02lu\n",
+                  httpRequestCount, httpBytesSent / httpRequestCount,
+                  httpWriteCount / httpRequestCount, httpWriteCount * 100 / httpRequestCount % 100,
+                  httpRecordCount / httpRequestCount, httpRecordCount * 100 / httpRequestCount % 100);
   }
+  Serial.printf("heap free=%u max_block=%u fragmentation=%u%%\n",
+                ESP.getFreeHeap(), ESP.getMaxFreeBlockSize(), ESP.getHeapFragmentation());
+  Serial.println("------------------------");
+}
 
-  writeCommonHeaders("POST", path, contentType, payload.length());
-  secureClient.println(payload);  // Send body
-  skipHttpHeaders();
-
-  String responseBody;
-  while (secureClient.available()) {
-    responseBody += (char)secureClient.read();
-  }
+/**
+ * Builds the lookup/registration path for this station's key.
+ */
+void devicePath(char* path, size_t size, const String& mac) {
+  snprintf(path, size, "%s?key=%s", API_DEVICES_PATH, mac.c_str());
+}
 
-  secureClient.stop();
-  return responseBody;
+/**
+ * Reads the id from a {"id": ...} response of the device key endpoint.
+ *
+ * @return The id, or ERROR_READING_ID.
+ */
+int parseDeviceId() {
+  JsonDocument doc;
+  if (deserializeJson(doc, responseBuffer, response.bodyLength) || !doc["id"].is<int>()) return ERROR_READING_ID;
+  return doc["id"].as<int>();
 }
 
 /**
- * getDevices()
- * ------------
- * Retrieves all registered devices from the server and parses the JSON array.
- * 
- * @return True if successful, false otherwise.
+ * Loads the device ID cached for this MAC address. The MAC is stored with
+ * the ID, so a flash image moved to another board is not trusted.
  */
-bool getDevices() {
-  String raw = httpGET(API_DEVICES_PATH);
+bool loadCachedDeviceId(const String& mac) {
+  File f = LittleFS.open(DEVICE_CACHE_PATH, "r");
+  if (!f) return false;
 
-  String json = extractJsonArray(raw);
-  if (json == "") {
-    Serial.println("JSON array not found");
-    return false;
-  }
+  DeviceCacheRecord record;
+  bool ok = f.read((uint8_t*)&record, sizeof(record)) == sizeof(record);
+  f.close();
 
-  DeserializationError err = deserializeJson(jsonBuffer, json);
-  if (err) {
-    Serial.print("JSON parse error: ");
-    Serial.println(err.c_str());
+  record.key[sizeof(record.key) - 1] = '\0';
+  if (!ok || record.magic != DEVICE_CACHE_MAGIC || mac != record.key || record.id == ERROR_READING_ID) {
     return false;
   }
 
+  record.etag[sizeof(record.etag) - 1] = '\0';
+  deviceId = record.id;
+  strcpy(deviceEtag, record.etag);
   return true;
 }
 
 /**
- * getDeviceIdForMac(mac)
- * -----------------------
- * Matches the device MAC address to a known device entry.
- * 
- * @param mac Device MAC address.
- * @return True if match is found, false otherwise.
+ * Stores the resolved device ID for the next boot.
  */
-bool getDeviceIdForMac(const String& mac) {
-  for (JsonObject device : jsonBuffer.as<JsonArray>()) {
-    if (device["key"].as<String>() == mac) {
-      deviceId = device["id"].as<int>();
-      return true;
-    }
-  }
-  return false;
+void saveCachedDeviceId(const String& mac) {
+  DeviceCacheRecord record = {};
+  record.magic = DEVICE_CACHE_MAGIC;
+  strncpy(record.key, mac.c_str(), sizeof(record.key) - 1);
+  record.id = deviceId;
+  strcpy(record.etag, deviceEtag);
+
+  File f = LittleFS.open(DEVICE_CACHE_PATH, "w");
+  if (!f) return;
+  f.write((const uint8_t*)&record, sizeof(record));
+  f.close();
 }
 
 /**
- * addDevice(mac)
- * --------------
- * Registers the device in the remote database by MAC address.
- * 
+ * registerDevice(mac)
+ * -------------------
+ * Looks up or registers the device with one idempotent PUT to
+ * /api/device?key=<mac> and caches the returned ID. The server names new
+ * devices after their MAC address.
+ *
  * @param mac Device MAC address.
+ * @return True if the device ID is known.
  */
-void addDevice(const String& mac) {
-  StaticJsonDocument<DOC_POST_SIZE> postDoc;
-  postDoc["key"] = mac;
-  postDoc["name"] = "Weather Station";
-
-  String requestBody;
-  serializeJson(postDoc, requestBody);
-  httpPOST(API_DEVICES_PATH, requestBody);
+bool registerDevice(const String& mac) {
+  char path[DEVICE_PATH_SIZE];
+  devicePath(path, sizeof(path), mac);
+
+  int status = sendRequest("PUT", path, 0, "application/json");
+  int id = status == HTTP_STATUS_NONE ? ERROR_READING_ID : parseDeviceId();
+  if (id == ERROR_READING_ID) {
+    Serial.println("Failed to register and fetch device ID");
+    return false;
+  }
+
+  deviceId = id;
+  deviceEtag[0] = '\0';  // PUT responses carry no ETag
+  saveCachedDeviceId(mac);
+  return true;
 }
 
 /**
  * setupDevice()
  * -------------
- * Registers or retrieves the device ID for the current hardware.
+ * Resolves the device ID for the current hardware. A cached ID is used
+ * right away and confirmed later by revalidateDevice(), so boot does not
+ * wait for the API. Without a cache the ID is fetched (or created) with a
+ * single request, independent of the number of registered devices.
  */
 void setupDevice() {
+  unsigned long start = millis();
   String mac = WiFi.macAddress();
 
-  if (!getDevices()) {
-    Serial.println("Failed to fetch devices");
+  if (loadCachedDeviceId(mac)) {
+    deviceConfirmed = false;
+    Serial.print("Device ID (cached): ");
+  } else if (registerDevice(mac)) {
+    deviceConfirmed = true;
+    Serial.print("Device ID: ");
+  } else {
     return;
   }
 
-  if (getDeviceIdForMac(mac)) {
-    Serial.println("Device already registered.");
-    Serial.print("Device ID: ");
-    Serial.println(deviceId);
-  } else {
-    Serial.println("Registering new device...");
-    addDevice(mac);
-
-    if (getDevices() && getDeviceIdForMac(mac)) {
-      Serial.println("Device successfully registered.");
-      Serial.print("Device ID: ");
-      Serial.println(deviceId);
-    } else {
-      Serial.println("Failed to register and fetch device ID");
-    }
+  Serial.print(deviceId);
+  Serial.print(", resolved in ms: ");
+  Serial.println(millis() - start);
+}
+
+/**
+ * revalidateDevice()
+ * ------------------
+ * Confirms a cached device ID against the API in the background. If the
+ * device was deleted on the server it is registered again and the new ID
+ * replaces the cached one. Retries on the next run if the API is unreachable.
+ * The lookup sends the ETag of the last one, so while the device table is
+ * unchanged the server confirms the ID with an empty 304.
+ */
+void revalidateDevice() {
+  if (deviceConfirmed) return;
+
+  String mac = WiFi.macAddress();
+  if (deviceId == ERROR_READING_ID) {
+    deviceConfirmed = registerDevice(mac);
+    return;
+  }
+
+  char path[DEVICE_PATH_SIZE];
+  devicePath(path, sizeof(path), mac);
+
+  int status = httpGET(path, deviceEtag);
+  if (status == HTTP_STATUS_NOT_MODIFIED) {
+    deviceConfirmed = true;  // No device was added or removed since the last check
+    return;
+  }
+  if (status == HTTP_STATUS_NOT_FOUND) {
+    Serial.println("Cached device ID no longer exists, registering again");
+    deviceConfirmed = registerDevice(mac);
+    return;
+  }
+
+  int id = status == HTTP_STATUS_OK ? parseDeviceId() : ERROR_READING_ID;
+  if (id == ERROR_READING_ID) return;
+
+  if (id != deviceId) {
+    Serial.print("Device ID changed to ");
+    Serial.println(id);
+  }
+  if (id != deviceId || strcmp(response.etag, deviceEtag) != 0) {
+    deviceId = id;
+    strcpy(deviceEtag, response.etag);
+    saveCachedDeviceId(mac);
   }
+  deviceConfirmed = true;
 }
 
 /**
  * addReading(sensorData, count)
  * -----------------------------
- * Sends a reading and all associated sensor data in a single HTTPS POST request
- * using the /api/reading-with-sensordata endpoint.
+ * Stores the values that changed beyond their deadband (or are due for a
+ * heartbeat) with their capture time in the flash-backed queue. Nothing is
+ * queued if no value changed. The reading is uploaded later by
+ * flushReadings(), so it survives WiFi or tunnel outages and power loss.
  *
  * @param sensorData Array of SensorData structs.
  * @param count Number of sensor data points.
  */
 void addReading(SensorData sensorData[], size_t count) {
-  if (deviceId == ERROR_READING_ID) {
-    Serial.println("Device ID not set.");
-    return;
+  SensorData changed[QUEUE_MAX_VALUES];
+  size_t changedCount = selectReportedValues(sensorData, min(count, (size_t)QUEUE_MAX_VALUES), changed, millis());
+  if (changedCount == 0) return;
+
+  if (!pushReading(changed, changedCount)) {
+    Serial.println("Failed to queue reading");
   }
+}
 
-  StaticJsonDocument<DOC_SENSOR_ARRAY_SIZE> doc;
-  doc["device_id"] = deviceId;
+/**
+ * Parses the batch acknowledgement of the last response.
+ *
+ * @param sent Number of readings in the batch.
+ * @return Number of processed readings, or UPLOAD_FAILED.
+ */
+int parseBatchAck(size_t sent) {
+  JsonDocument ack;
+  if (deserializeJson(ack, responseBuffer, response.bodyLength) || !ack["processed"].is<int>()) return UPLOAD_FAILED;
+  return min(ack["processed"].as<size_t>(), sent);
+}
+
+/**
+ * Uploads readings as a JSON batch.
+ *
+ * @param n Number of readings in uploadBatch.
+ * @return Number of processed readings, or UPLOAD_FAILED.
+ */
+int uploadJsonBatch(size_t n) {
+  n = min(n, (size_t)JSON_UPLOAD_BATCH_SIZE);  // Window stats make JSON values large, bound the document size
 
-  JsonArray arr = doc.createNestedArray("sensor_data");
-  for (size_t i = LOOP_START_INDEX; i < count; i++) {
-    JsonObject obj = arr.createNestedObject();
-    obj["sensor_id"] = sensorData[i].sensorId;
-    obj["value"] = String(sensorData[i].value, FLOAT_DECIMAL_PRECISION);
+  jsonBuffer.clear();
+  jsonBuffer["device_id"] = deviceId;
+  JsonArray readings = jsonBuffer["readings"].to<JsonArray>();
+
+  for (size_t i = LOOP_START_INDEX; i < n; i++) {
+    JsonObject reading = readings.add<JsonObject>();
+    if (uploadBatch[i].capturedAt != EPOCH_UNKNOWN) {
+      reading["captured_at"] = uploadBatch[i].capturedAt;
+    }
+
+    JsonArray arr = reading["sensor_data"].to<JsonArray>();
+    for (size_t j = LOOP_START_INDEX; j < uploadBatch[i].count; j++) {
+      const SensorData& v = uploadBatch[i].values[j];
+      JsonObject obj = arr.add<JsonObject>();
+      obj["sensor_id"] = v.sensorId;
+      obj["value"] = round(v.value * VALUE_SCALE) / VALUE_SCALE;
+
+      if (v.count > SINGLE_SAMPLE) {
+        obj["min"] = round(v.min * VALUE_SCALE) / VALUE_SCALE;
+        obj["max"] = round(v.max * VALUE_SCALE) / VALUE_SCALE;
+        obj["count"] = v.count;
+      }
+    }
   }
 
-  String payload;
-  serializeJson(doc, payload);
-  httpPOST("/api/reading-with-sensordata", payload);
+  if (measureJson(jsonBuffer) >= HTTP_BODY_CAPACITY) return UPLOAD_FAILED;
+
+  size_t length = serializeJson(jsonBuffer, (char*)httpRequestBody(), HTTP_BODY_CAPACITY);
+  if (httpPOST(API_READING_BATCH_PATH, length) == HTTP_STATUS_NONE) return UPLOAD_FAILED;
+  return parseBatchAck(n);
+}
+
+/**
+ * Uploads readings as a compact binary frame (see WireFormat.h).
+ *
+ * @param n Number of readings in uploadBatch.
+ * @return Number of processed readings, or UPLOAD_FAILED.
+ */
+int uploadBinaryBatch(size_t n) {
+  size_t length = encodeReadingBatch(httpRequestBody(), HTTP_BODY_CAPACITY, deviceId, ++uploadSequence, uploadBatch, n);
+  if (length == WIRE_ENCODE_FAILED) return UPLOAD_FAILED;
+
+  if (httpPOST(API_READING_BATCH_PATH, length, WIRE_CONTENT_TYPE) == HTTP_STATUS_NONE) return UPLOAD_FAILED;
+  return parseBatchAck(n);
+}
+
+/**
+ * Uploads the oldest queued readings as one batch and removes the ones the
+ * server reports as processed.
+ *
+ * The compact binary format is used first. If the server rejects it with a
+ * client error, the station falls back to JSON until the next reboot.
+ *
+ * @return Number of processed readings, or UPLOAD_FAILED.
+ */
+int uploadOldestBatch() {
+  size_t n = peekReadings(uploadBatch, UPLOAD_BATCH_SIZE);
+  if (n == 0) return UPLOAD_FAILED;
+
+  // Sampling keeps queueing during the upload; a full queue may overwrite
+  // readings of this batch, which then must not be popped a second time.
+  uint32_t droppedBefore = droppedReadingCount();
+
+  int processed = useBinaryUpload ? uploadBinaryBatch(n) : uploadJsonBatch(n);
+
+  if (processed == UPLOAD_FAILED && useBinaryUpload &&
+      lastResponseStatus >= HTTP_STATUS_CLIENT_ERROR && lastResponseStatus < HTTP_STATUS_SERVER_ERROR) {
+    Serial.println("Binary upload rejected, falling back to JSON");
+    useBinaryUpload = false;
+    processed = uploadJsonBatch(n);
+  }
+
+  if (processed == UPLOAD_FAILED) {
+    Serial.println("Batch upload failed");
+    return UPLOAD_FAILED;
+  }
+
+  size_t overwritten = droppedReadingCount() - droppedBefore;
+  popReadings(processed > (int)overwritten ? processed - overwritten : 0);
+
+  Serial.print("Uploaded readings: ");
+  Serial.print(processed);
+  Serial.print(", still queued: ");
+  Serial.println(queuedReadingCount());
+  return processed;
+}
+
+/**
+ * flushReadings()
+ * ---------------
+ * Uploads the oldest queued readings as one batch to the
+ * /api/reading-with-sensordata/batch endpoint. Uploads wait until a full
+ * batch is queued or UPLOAD_MAX_INTERVAL_MS has passed.
+ */
+void flushReadings() {
+  if (deviceId == ERROR_READING_ID) return;
+
+  size_t queued = queuedReadingCount();
+  if (queued == 0) return;
+
+  unsigned long now = millis();
+  unsigned long wait = lastUploadFailed ? UPLOAD_RETRY_MS : UPLOAD_MAX_INTERVAL_MS;
+  if ((queued < UPLOAD_BATCH_SIZE || lastUploadFailed) && now - lastUploadAttempt < wait) return;
+  lastUploadAttempt = now;
+
+  lastUploadFailed = uploadOldestBatch() == UPLOAD_FAILED;
+}
+
+/**
+ * drainReadings(budgetMs)
+ * -----------------------
+ * Uploads batches back to back until the queue is empty, an upload fails
+ * or the time budget is spent. Used by the deep sleep mode, which has to
+ * upload everything within one short wake.
+ *
+ * @param budgetMs Maximum time to spend uploading.
+ * @return True if the queue was emptied.
+ */
+bool drainReadings(unsigned long budgetMs) {
+  if (deviceId == ERROR_READING_ID) return false;
+
+  unsigned long start = millis();
+  while (queuedReadingCount() > 0) {
+    if (millis() - start >= budgetMs || uploadOldestBatch() <= 0) return false;
+  }
+  return true;
 }
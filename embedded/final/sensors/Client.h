@@ -18,27 +18,50 @@
 #define API_DEVICES_PATH "/api/device"
 #define API_READING_PATH "/api/reading"
 #define API_SENSORDATA_PATH "/api/sensordata"
+#define API_READING_BATCH_PATH "/api/reading-with-sensordata/batch"
 
-#define DOC_BUFFER_SIZE 4096
-#define DOC_POST_SIZE 128
-#define DOC_SENSOR_ARRAY_SIZE 1024
-#define DOC_READING_LIST_SIZE 2048
-
-#define JSON_ARRAY_OPEN_INDEX 0
-#define JSON_ARRAY_OFFSET 2
 #define LOOP_START_INDEX 0
-#define HEADER_END_LINE "\r"
 
 #define ERROR_READING_ID -1
 #define PAYLOAD_DELAY_MS 200
 #define FLOAT_DECIMAL_PRECISION 2
 
+#define HTTP_TIMEOUT_MS 5000
+#define HTTP_MAX_ATTEMPTS 2
+#define HTTP_STATUS_NONE 0
+#define HTTP_HEADER_RESERVE 256       // Request line and headers, rendered in front of the body
+#define HTTP_BODY_CAPACITY 2560       // Largest request body (a JSON batch of 5 readings)
+#define HTTP_RESPONSE_BUFFER_SIZE 2048
+#define HTTP_READ_CHUNK 64
+
+#define UPLOAD_BATCH_SIZE 10
+#define JSON_UPLOAD_BATCH_SIZE 5
+#define UPLOAD_MAX_INTERVAL_MS 30000
+#define UPLOAD_RETRY_MS 10000
+#define VALUE_SCALE 100.0
+#define SINGLE_SAMPLE 1
+#define UPLOAD_FAILED -1
+#define HTTP_STATUS_OK 200
+#define HTTP_STATUS_NOT_MODIFIED 304
+#define HTTP_STATUS_CLIENT_ERROR 400
+#define HTTP_STATUS_NOT_FOUND 404
+#define HTTP_STATUS_SERVER_ERROR 500
+
+#define DEVICE_CACHE_PATH "/device.id"
+#define DEVICE_CACHE_MAGIC 0x41544432  // "ATD2"
+#define DEVICE_KEY_SIZE 18             // "AA:BB:CC:DD:EE:FF" + '\0'
+#define DEVICE_PATH_SIZE 64
+#define DEVICE_REVALIDATE_PERIOD_MS 60000
+
 // ----------------------------------------------------------------------------
 // Data Structure
 // ----------------------------------------------------------------------------
 struct SensorData {
   int sensorId;
-  float value;
+  float value;     // Instant value, or the window mean when count > 1
+  float min;       // Window minimum (valid when count > 1)
+  float max;       // Window maximum (valid when count > 1)
+  uint16_t count;  // Number of samples aggregated into value
 };
 
 // ----------------------------------------------------------------------------
@@ -46,29 +69,40 @@ struct SensorData {
 // ----------------------------------------------------------------------------
 
 /**
- * Performs a HTTPS GET request to the specified API path.
+ * Opens the keep-alive TLS connection if needed, resuming the cached session.
+ */
+bool ensureConnected();
+
+/**
+ * Returns the buffer (HTTP_BODY_CAPACITY bytes) POST bodies are rendered into.
  */
-String httpGET(const String& path);
+uint8_t* httpRequestBody();
 
 /**
- * Performs a HTTPS POST request with a JSON payload.
+ * Returns the NUL-terminated body of the last response.
  */
-String httpPOST(const String& path, const String& payload, const String& contentType = "application/json");
+const char* httpResponseBody();
 
 /**
- * Retrieves and deserializes the list of registered devices.
+ * Performs a HTTPS GET request to the specified API path, conditional if an
+ * ETag is given.
  */
-bool getDevices();
+int httpGET(const char* path, const char* etag = "");
 
 /**
- * Finds a device entry matching the given MAC address.
+ * Performs a HTTPS POST request with the body stored in httpRequestBody().
  */
-bool getDeviceIdForMac(const String& mac);
+int httpPOST(const char* path, size_t bodyLength, const char* contentType = "application/json");
 
 /**
- * Registers a new device in the backend.
+ * Prints bytes, writes and TLS records per request and the heap state.
  */
-void addDevice(const String& mac);
+void printHttpStats();
+
+/**
+ * Looks up or registers the device by MAC address with one request.
+ */
+bool registerDevice(const String& mac);
 
 /**
  * Sets up the device by fetching or creating its backend entry.
@@ -76,14 +110,31 @@ void addDevice(const String& mac);
 void setupDevice();
 
 /**
- * Sends a reading and all associated sensor data in a single HTTPS POST request
- * using the /api/reading-with-sensordata endpoint.
+ * Confirms a cached device ID against the API; runs as a background task.
+ */
+void revalidateDevice();
+
+/**
+ * Queues the changed sensor values of a reading for upload.
  */
 void addReading(SensorData sensorData[], size_t count);
 
+/**
+ * Uploads queued readings in batches using the
+ * /api/reading-with-sensordata/batch endpoint, binary first with JSON fallback.
+ */
+void flushReadings();
+
+/**
+ * Uploads queued readings until the queue is empty or budgetMs is spent.
+ */
+bool drainReadings(unsigned long budgetMs);
+
 
 // ----------------------------------------------------------------------------
 // Shared State
 // ----------------------------------------------------------------------------
 
 extern int deviceId;
+extern unsigned long tlsHandshakeCount;
+extern int lastResponseStatus;
@@ -0,0 +1,238 @@
+// ============================================================================
+// File: DeepSleep.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the deep sleep cycle. Only the RTC domain is
+//              powered during sleep, so the state is kept in RTC user memory
+//              and checked with a CRC after every wake.
+// ============================================================================
+
+#include "DeepSleep.h"
+#include "ReadingQueue.h"
+#include <time.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define RTC_USER_MEMORY_OFFSET 0   // In 4-byte blocks
+#define RTC_USER_MEMORY_SIZE 512
+#define CRC32_INITIAL 0xFFFFFFFFUL
+#define CRC32_POLYNOMIAL 0xEDB88320UL
+#define BITS_PER_BYTE 8
+#define MS_PER_SECOND 1000UL
+#define US_PER_MS 1000ULL
+#define NO_WAKES 0
+
+static_assert(sizeof(SleepState) <= RTC_USER_MEMORY_SIZE, "SleepState does not fit into RTC user memory");
+static_assert(sizeof(SleepState) % sizeof(uint32_t) == 0, "RTC memory is accessed in 4-byte blocks");
+
+// ----------------------------------------------------------------------------
+// Sleep State
+// ----------------------------------------------------------------------------
+static SleepState state;
+static uint32_t uploadEvery = 1;
+static bool uploadWake = true;
+
+/**
+ * Bitwise CRC-32 (IEEE), small enough to run once per wake.
+ */
+static uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = CRC32_INITIAL;
+  for (size_t i = LOOP_START_INDEX; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = LOOP_START_INDEX; bit < BITS_PER_BYTE; bit++) {
+      crc = (crc >> 1) ^ (CRC32_POLYNOMIAL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+/**
+ * CRC over every field after the crc member.
+ */
+static uint32_t stateCrc() {
+  const uint8_t* start = (const uint8_t*)&state.wakeCount;
+  return crc32(start, sizeof(SleepState) - offsetof(SleepState, wakeCount));
+}
+
+/**
+ * Resets the state after a cold boot or a layout change.
+ */
+static void resetState() {
+  memset(&state, 0, sizeof(state));
+  state.magic = SLEEP_MAGIC;
+  state.epochAtSleep = EPOCH_UNKNOWN;
+  state.deviceId = ERROR_READING_ID;
+}
+
+// ----------------------------------------------------------------------------
+// Deep Sleep Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * beginSleepCycle(uploadEveryWakes)
+ * ---------------------------------
+ * Restores the state from RTC memory and counts this wake. The device ID
+ * found on an earlier upload wake is restored into the client.
+ *
+ * @param uploadEveryWakes Number of wakes per upload (at most SLEEP_MAX_READINGS).
+ * @return True if the station woke from deep sleep.
+ */
+bool beginSleepCycle(uint32_t uploadEveryWakes) {
+  uploadEvery = constrain(uploadEveryWakes, 1, SLEEP_MAX_READINGS);
+
+  bool restored = ESP.rtcUserMemoryRead(RTC_USER_MEMORY_OFFSET, (uint32_t*)&state, sizeof(state)) &&
+                  state.magic == SLEEP_MAGIC && state.crc == stateCrc();
+  if (!restored) {
+    resetState();
+  }
+
+  bool resumed = restored && ESP.getResetInfoPtr()->reason == REASON_DEEP_SLEEP_AWAKE;
+  uploadWake = !resumed || state.radioNextWake;
+
+  state.wakeCount++;
+  if (state.deviceId != ERROR_READING_ID) {
+    deviceId = state.deviceId;
+  }
+
+  return resumed;
+}
+
+/**
+ * isUploadWake()
+ * --------------
+ * @return True if WiFi is available in this wake.
+ */
+bool isUploadWake() {
+  return uploadWake;
+}
+
+/**
+ * estimatedEpoch()
+ * ----------------
+ * Returns the NTP time once synced. On wakes without radio the time is
+ * carried across sleep; it drifts with the RTC oscillator (a few percent)
+ * until the next upload wake resyncs it.
+ *
+ * @return Unix time in seconds, or EPOCH_UNKNOWN.
+ */
+uint32_t estimatedEpoch() {
+  uint32_t now = currentEpoch();
+  if (now != EPOCH_UNKNOWN || state.epochAtSleep == EPOCH_UNKNOWN) return now;
+
+  return state.epochAtSleep + (state.sleepMs + millis()) / MS_PER_SECOND;
+}
+
+/**
+ * storeSleepReading(values, count)
+ * --------------------------------
+ * Appends a reading to the RTC buffer. If uploads kept failing and the
+ * buffer is full, the oldest reading is dropped.
+ *
+ * @param values Array of SensorData structs.
+ * @param count Number of sensor values (capped at SLEEP_MAX_VALUES).
+ */
+void storeSleepReading(const SensorData values[], size_t count) {
+  if (state.readingCount == SLEEP_MAX_READINGS) {
+    memmove(&state.records[0], &state.records[1], sizeof(SleepRecord) * (SLEEP_MAX_READINGS - 1));
+    state.readingCount--;
+    state.droppedCount++;
+  }
+
+  SleepRecord& record = state.records[state.readingCount++];
+  record = {};
+  record.capturedAt = estimatedEpoch();
+  record.count = min(count, (size_t)SLEEP_MAX_VALUES);
+  for (size_t i = LOOP_START_INDEX; i < record.count; i++) {
+    record.sensorIds[i] = values[i].sensorId;
+    record.values[i] = (int32_t)lround(values[i].value * VALUE_SCALE);
+  }
+}
+
+/**
+ * moveSleepReadingsToQueue()
+ * --------------------------
+ * Hands the RTC readings to the flash queue, which keeps them until the API
+ * acknowledges them. Readings are removed from RTC memory only once stored.
+ *
+ * @return Number of readings moved.
+ */
+size_t moveSleepReadingsToQueue() {
+  size_t moved = 0;
+  SensorData values[SLEEP_MAX_VALUES];
+
+  for (; moved < state.readingCount; moved++) {
+    const SleepRecord& record = state.records[moved];
+    for (size_t i = LOOP_START_INDEX; i < record.count; i++) {
+      values[i] = {};
+      values[i].sensorId = record.sensorIds[i];
+      values[i].value = record.values[i] / VALUE_SCALE;
+    }
+
+    if (!pushReadingAt(values, record.count, record.capturedAt)) break;
+  }
+
+  memmove(&state.records[0], &state.records[moved], sizeof(SleepRecord) * (state.readingCount - moved));
+  state.readingCount -= moved;
+  return moved;
+}
+
+/**
+ * printSleepStats()
+ * -----------------
+ * Prints the average awake time of sensor-only and radio wakes and the
+ * awake time per reading. Multiplied with the measured current of each
+ * phase, this gives the energy per reading.
+ */
+void printSleepStats() {
+  uint32_t wakes = state.sensorWakes + state.radioWakes;
+  if (wakes == NO_WAKES) return;
+
+  Serial.println("--- Sleep cycle stats ---");
+  Serial.printf("Sensor wakes: %lu, avg awake %lu ms\n", (unsigned long)state.sensorWakes,
+                (unsigned long)(state.sensorWakes ? state.sensorAwakeMs / state.sensorWakes : 0));
+  Serial.printf("Radio wakes: %lu, avg awake %lu ms\n", (unsigned long)state.radioWakes,
+                (unsigned long)(state.radioWakes ? state.radioAwakeMs / state.radioWakes : 0));
+  Serial.printf("Awake per reading: %lu ms, dropped: %u\n",
+                (unsigned long)((state.sensorAwakeMs + state.radioAwakeMs) / wakes), state.droppedCount);
+  Serial.println("------------------------");
+}
+
+/**
+ * enterDeepSleep(periodMs, radioWasOn)
+ * ------------------------------------
+ * Records the awake time of this wake, decides whether the next wake brings
+ * the radio up, saves the state and sleeps. The RF mode must be chosen now:
+ * a station woken with WAKE_RF_DISABLED cannot enable WiFi until it sleeps
+ * again. Boot ROM time before setup() is not included in the awake time.
+ *
+ * @param periodMs Sleep duration.
+ * @param radioWasOn True if WiFi was used in this wake.
+ */
+void enterDeepSleep(unsigned long periodMs, bool radioWasOn) {
+  uint32_t awakeMs = millis();
+  if (radioWasOn) {
+    state.radioWakes++;
+    state.radioAwakeMs += awakeMs;
+  } else {
+    state.sensorWakes++;
+    state.sensorAwakeMs += awakeMs;
+  }
+
+  Serial.print("Awake ms: ");
+  Serial.print(awakeMs);
+  Serial.println(radioWasOn ? " (radio on)" : " (radio off)");
+
+  bool nextIsUpload = state.wakeCount % uploadEvery == uploadEvery - 1 ||
+                      state.readingCount >= SLEEP_MAX_READINGS - 1;
+
+  state.epochAtSleep = estimatedEpoch();
+  state.sleepMs = periodMs;
+  state.deviceId = deviceId;
+  state.radioNextWake = nextIsUpload;
+  state.crc = stateCrc();
+  ESP.rtcUserMemoryWrite(RTC_USER_MEMORY_OFFSET, (uint32_t*)&state, sizeof(state));
+
+  ESP.deepSleep(periodMs * US_PER_MS, nextIsUpload ? WAKE_RF_DEFAULT : WAKE_RF_DISABLED);
+}
@@ -0,0 +1,99 @@
+// ============================================================================
+// File: DeepSleep.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the duty-cycled operating mode for battery-powered
+//              stations. Readings are buffered in RTC user memory across
+//              ESP.deepSleep() cycles and the radio only wakes to upload them.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Client.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with DeepSleep.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define SLEEP_MAGIC 0x534C5031     // "SLP1", bump when SleepState changes
+#define SLEEP_MAX_READINGS 12      // Fills the 512-byte RTC user memory
+#define SLEEP_MAX_VALUES 6
+
+// ----------------------------------------------------------------------------
+// Data Structures
+// ----------------------------------------------------------------------------
+
+/**
+ * One reading as kept in RTC memory. Values are stored as centi-units to
+ * keep a record at 36 bytes.
+ */
+struct SleepRecord {
+  uint32_t capturedAt;  // Estimated Unix time, EPOCH_UNKNOWN before the first NTP sync
+  int32_t values[SLEEP_MAX_VALUES];
+  uint8_t sensorIds[SLEEP_MAX_VALUES];
+  uint8_t count;
+};
+
+/**
+ * Everything that survives a deep sleep cycle. The CRC covers all fields
+ * after it, so stale or corrupted RTC memory is detected after a cold boot.
+ */
+struct SleepState {
+  uint32_t magic;
+  uint32_t crc;
+  uint32_t wakeCount;
+  uint32_t epochAtSleep;   // Estimated Unix time when the last cycle went to sleep
+  uint32_t sleepMs;        // Requested duration of the last sleep
+  int32_t deviceId;        // Saves the device lookup on upload wakes
+  uint16_t readingCount;
+  uint16_t droppedCount;   // Readings overwritten because uploads kept failing
+  uint32_t radioNextWake;  // Whether the last sleep left the radio enabled
+
+  uint32_t sensorWakes;    // Wakes with the radio off
+  uint32_t sensorAwakeMs;
+  uint32_t radioWakes;     // Wakes that brought WiFi up
+  uint32_t radioAwakeMs;
+
+  SleepRecord records[SLEEP_MAX_READINGS];
+};
+
+// ----------------------------------------------------------------------------
+// Deep Sleep Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Restores the RTC state and counts the wake. Returns true if the station
+ * woke from deep sleep, false after a cold boot or reset.
+ */
+bool beginSleepCycle(uint32_t uploadEveryWakes);
+
+/**
+ * True if the radio was left enabled for this wake and the buffered
+ * readings should be uploaded.
+ */
+bool isUploadWake();
+
+/**
+ * Returns the NTP time if synced, otherwise the time carried across sleep.
+ */
+uint32_t estimatedEpoch();
+
+/**
+ * Buffers a reading in RTC memory, overwriting the oldest one when full.
+ */
+void storeSleepReading(const SensorData values[], size_t count);
+
+/**
+ * Moves the RTC readings into the flash queue and returns how many moved.
+ */
+size_t moveSleepReadingsToQueue();
+
+/**
+ * Prints awake time per wake type, used to estimate energy per reading.
+ */
+void printSleepStats();
+
+/**
+ * Saves the RTC state and sleeps for periodMs. Does not return.
+ */
+void enterDeepSleep(unsigned long periodMs, bool radioWasOn);
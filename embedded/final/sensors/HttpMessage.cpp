@@ -0,0 +1,318 @@
+// ============================================================================
+// File: HttpMessage.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements request rendering and the incremental response
+//              parser of the HTTPS client. Works on caller-supplied buffers
+//              only, so a request allocates nothing on the heap.
+// ============================================================================
+
+#include "HttpMessage.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define HEX_RADIX 16
+#define HTTP_STATUS_NONE 0
+#define HTTP_STATUS_OK 200
+#define HTTP_STATUS_NO_CONTENT 204
+#define HTTP_STATUS_NOT_MODIFIED 304
+
+// ----------------------------------------------------------------------------
+// Internal Utilities
+// ----------------------------------------------------------------------------
+
+/**
+ * Returns the value of a lowercased header line if it starts with name.
+ */
+static const char* headerValue(const char* line, const char* name) {
+  size_t length = strlen(name);
+  return strncmp(line, name, length) == 0 ? line + length : nullptr;
+}
+
+/**
+ * Resets everything that belongs to one status line and its headers.
+ */
+static void resetHeaders(HttpResponse& response) {
+  response.status = HTTP_STATUS_NONE;
+  response.contentLength = CONTENT_LENGTH_UNKNOWN;
+  response.chunked = false;
+  response.keepAlive = true;
+  response.headersComplete = false;
+  response.etag[0] = '\0';
+}
+
+/**
+ * Appends body bytes to the caller's buffer, dropping what does not fit.
+ */
+static void storeBody(HttpResponse& response, const uint8_t* data, size_t length) {
+  size_t space = response.bodyCapacity - 1 - response.bodyLength;  // Keep room for '\0'
+  size_t n = min(length, space);
+  memcpy(response.body + response.bodyLength, data, n);
+  response.bodyLength += n;
+  response.body[response.bodyLength] = '\0';
+  if (n < length) response.truncated = true;
+}
+
+/**
+ * Decides how the body is framed once the empty line after the headers
+ * arrived. Interim 1xx responses are skipped.
+ */
+static void endHeaders(HttpResponse& response) {
+  if (response.status < HTTP_STATUS_OK) {
+    resetHeaders(response);
+    response.state = HTTP_PARSE_STATUS_LINE;
+    return;
+  }
+
+  response.headersComplete = true;
+  if (response.status == HTTP_STATUS_NO_CONTENT || response.status == HTTP_STATUS_NOT_MODIFIED) {
+    response.state = HTTP_PARSE_DONE;  // Never has a body
+  } else if (response.chunked) {
+    response.state = HTTP_PARSE_CHUNK_SIZE;
+  } else if (response.contentLength != CONTENT_LENGTH_UNKNOWN) {
+    response.remaining = response.contentLength;
+    response.state = response.remaining > 0 ? HTTP_PARSE_BODY : HTTP_PARSE_DONE;
+  } else {
+    response.untilClose = true;
+    response.keepAlive = false;
+    response.state = HTTP_PARSE_BODY;
+  }
+}
+
+/**
+ * Handles a header line. The ETag keeps its case, everything else is
+ * matched lowercased.
+ */
+static void parseHeader(HttpResponse& response, char* line) {
+  if (strncasecmp(line, "etag:", strlen("etag:")) == 0) {
+    const char* etag = line + strlen("etag:");
+    while (*etag == ' ') etag++;
+    if (strlen(etag) < HTTP_ETAG_SIZE) strcpy(response.etag, etag);
+    return;
+  }
+
+  for (char* p = line; *p; p++) *p = tolower(*p);
+
+  const char* value;
+  if ((value = headerValue(line, "content-length:"))) {
+    response.contentLength = atol(value);
+    if (response.contentLength < 0) response.state = HTTP_PARSE_ERROR;
+  } else if ((value = headerValue(line, "transfer-encoding:")) && strstr(value, "chunked")) {
+    response.chunked = true;
+  } else if ((value = headerValue(line, "connection:")) && strstr(value, "close")) {
+    response.keepAlive = false;
+  }
+}
+
+/**
+ * Handles one complete line (without its line ending).
+ */
+static void processLine(HttpResponse& response) {
+  char* line = response.line;
+
+  switch (response.state) {
+    case HTTP_PARSE_STATUS_LINE: {
+      if (strncmp(line, "HTTP/", strlen("HTTP/")) != 0) {
+        response.state = HTTP_PARSE_ERROR;
+        break;
+      }
+      const char* space = strchr(line, ' ');
+      response.status = space ? atoi(space + 1) : HTTP_STATUS_NONE;
+      response.state = response.status > HTTP_STATUS_NONE ? HTTP_PARSE_HEADERS : HTTP_PARSE_ERROR;
+      break;
+    }
+
+    case HTTP_PARSE_HEADERS:
+      if (line[0] == '\0') {
+        endHeaders(response);
+      } else {
+        parseHeader(response, line);
+      }
+      break;
+
+    case HTTP_PARSE_CHUNK_SIZE: {
+      long chunkSize = strtol(line, nullptr, HEX_RADIX);  // Ignores chunk extensions
+      if (chunkSize > 0) {
+        response.remaining = chunkSize;
+        response.state = HTTP_PARSE_CHUNK_DATA;
+      } else {
+        response.state = HTTP_PARSE_TRAILERS;
+      }
+      break;
+    }
+
+    case HTTP_PARSE_CHUNK_END:
+      response.state = line[0] == '\0' ? HTTP_PARSE_CHUNK_SIZE : HTTP_PARSE_ERROR;
+      break;
+
+    case HTTP_PARSE_TRAILERS:
+      if (line[0] == '\0') response.state = HTTP_PARSE_DONE;  // Trailers up to the final CRLF
+      break;
+
+    default:
+      break;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// HTTP Message Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * httpRenderRequest(buffer, reserve, host, method, path, bodyLength, contentType, ifNoneMatch)
+ * -------------------------------------------------------------------------------------------
+ * Renders the request line and headers into the first reserve bytes of
+ * buffer, right-aligned so they end where the body starts. The whole
+ * request then leaves with one write without copying the body. Requests
+ * other than GET always carry Content-Type and Content-Length; a GET with
+ * an ETag carries If-None-Match.
+ *
+ * @param buffer Header reserve followed by the body.
+ * @param reserve Number of bytes in front of the body.
+ * @param host Value of the Host header.
+ * @param method Request method.
+ * @param path Request path including the query.
+ * @param bodyLength Number of body bytes after the reserve.
+ * @param contentType Content type of the body (ignored for GET).
+ * @param ifNoneMatch Validator for a conditional GET, or "".
+ * @return Header length; the request starts at buffer + reserve - length.
+ *         HTTP_RENDER_FAILED if the headers do not fit the reserve.
+ */
+size_t httpRenderRequest(char* buffer, size_t reserve, const char* host, const char* method, const char* path,
+                         size_t bodyLength, const char* contentType, const char* ifNoneMatch) {
+  int headerLength;
+  if (strcmp(method, "GET") != 0) {
+    headerLength = snprintf(buffer, reserve,
+                            "%s %s HTTP/1.1\r\n"
+                            "Host: %s\r\n"
+                            "User-Agent: " HTTP_USER_AGENT "\r\n"
+                            "bypass-tunnel-reminder: true\r\n"
+                            "Connection: keep-alive\r\n"
+                            "Content-Type: %s\r\n"
+                            "Content-Length: %u\r\n"
+                            "\r\n",
+                            method, path, host, contentType, (unsigned)bodyLength);
+  } else {
+    headerLength = snprintf(buffer, reserve,
+                            "%s %s HTTP/1.1\r\n"
+                            "Host: %s\r\n"
+                            "User-Agent: " HTTP_USER_AGENT "\r\n"
+                            "bypass-tunnel-reminder: true\r\n"
+                            "Connection: keep-alive\r\n"
+                            "%s%s%s"
+                            "\r\n",
+                            method, path, host, ifNoneMatch[0] ? "If-None-Match: " : "", ifNoneMatch,
+                            ifNoneMatch[0] ? "\r\n" : "");
+  }
+  if (headerLength < 0 || (size_t)headerLength >= reserve) return HTTP_RENDER_FAILED;
+
+  memmove(buffer + reserve - headerLength, buffer, headerLength);
+  return headerLength;
+}
+
+/**
+ * httpTlsRecords(bytes)
+ * ---------------------
+ * @param bytes Size of a single write.
+ * @return Number of TLS records it is split into with the default BearSSL
+ *         transmit buffer.
+ */
+size_t httpTlsRecords(size_t bytes) {
+  return (bytes + HTTP_TLS_RECORD_PAYLOAD - 1) / HTTP_TLS_RECORD_PAYLOAD;
+}
+
+/**
+ * httpResponseBegin(response, body, capacity)
+ * -------------------------------------------
+ * Starts a new response. The body buffer is emptied right away.
+ *
+ * @param response Parser state.
+ * @param body Buffer the body is written into, NUL-terminated.
+ * @param capacity Size of the body buffer (at least 1).
+ */
+void httpResponseBegin(HttpResponse& response, char* body, size_t capacity) {
+  resetHeaders(response);
+  response.state = HTTP_PARSE_STATUS_LINE;
+  response.truncated = false;
+  response.body = body;
+  response.bodyCapacity = capacity;
+  response.bodyLength = 0;
+  response.body[0] = '\0';
+  response.remaining = 0;
+  response.untilClose = false;
+  response.lineLength = 0;
+}
+
+/**
+ * httpResponseFeed(response, data, length)
+ * ----------------------------------------
+ * Parses the next received bytes. Bytes may arrive split at any point.
+ *
+ * @param response Parser state.
+ * @param data Received bytes.
+ * @param length Number of received bytes.
+ * @return Number of bytes consumed; less than length only once the
+ *         response is finished.
+ */
+size_t httpResponseFeed(HttpResponse& response, const uint8_t* data, size_t length) {
+  size_t consumed = 0;
+
+  while (consumed < length && !httpResponseFinished(response)) {
+    if (response.state == HTTP_PARSE_BODY || response.state == HTTP_PARSE_CHUNK_DATA) {
+      size_t n = length - consumed;
+      if (!response.untilClose) n = min(n, response.remaining);
+      storeBody(response, data + consumed, n);
+      consumed += n;
+
+      if (response.untilClose) continue;
+      response.remaining -= n;
+      if (response.remaining == 0) {
+        response.state = response.state == HTTP_PARSE_BODY ? HTTP_PARSE_DONE : HTTP_PARSE_CHUNK_END;
+      }
+      continue;
+    }
+
+    char c = (char)data[consumed++];
+    if (c == '\n') {
+      if (response.lineLength > 0 && response.line[response.lineLength - 1] == '\r') response.lineLength--;
+      response.line[response.lineLength] = '\0';
+      response.lineLength = 0;
+      processLine(response);
+    } else if (response.lineLength < HTTP_LINE_BUFFER_SIZE - 1) {
+      response.line[response.lineLength++] = c;
+    }
+  }
+
+  if (response.state == HTTP_PARSE_ERROR) response.keepAlive = false;
+  return consumed;
+}
+
+/**
+ * httpResponseClosed(response)
+ * ----------------------------
+ * Completes a body delimited by the connection close; any other response
+ * that is not finished yet is broken.
+ *
+ * @param response Parser state.
+ */
+void httpResponseClosed(HttpResponse& response) {
+  response.keepAlive = false;
+  if (response.state == HTTP_PARSE_BODY && response.untilClose) {
+    response.state = HTTP_PARSE_DONE;
+  } else if (!httpResponseFinished(response)) {
+    response.state = HTTP_PARSE_ERROR;
+  }
+}
+
+/**
+ * httpResponseFinished(response)
+ * ------------------------------
+ * @param response Parser state.
+ * @return True if the response is complete (HTTP_PARSE_DONE) or broken
+ *         (HTTP_PARSE_ERROR).
+ */
+bool httpResponseFinished(const HttpResponse& response) {
+  return response.state == HTTP_PARSE_DONE || response.state == HTTP_PARSE_ERROR;
+}
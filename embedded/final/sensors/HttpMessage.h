@@ -0,0 +1,102 @@
+// ============================================================================
+// File: HttpMessage.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the HTTP/1.1 message handling of the HTTPS client:
+//              rendering a request into one preallocated buffer and parsing
+//              a response incrementally as bytes arrive. Pure logic without
+//              any socket access.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with HttpMessage.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define HTTP_USER_AGENT "ESP8266"
+#define HTTP_LINE_BUFFER_SIZE 128     // Status line and headers; longer lines are truncated
+#define HTTP_ETAG_SIZE 48             // Longer validators are not stored
+#define HTTP_TLS_RECORD_PAYLOAD 512   // BearSSL default transmit buffer, one record per flush
+#define HTTP_RENDER_FAILED 0
+#define CONTENT_LENGTH_UNKNOWN -1
+
+// ----------------------------------------------------------------------------
+// Data Structures
+// ----------------------------------------------------------------------------
+
+/**
+ * Where the parser is within the response.
+ */
+enum HttpParseState : uint8_t {
+  HTTP_PARSE_STATUS_LINE,
+  HTTP_PARSE_HEADERS,
+  HTTP_PARSE_BODY,        // Content-Length body, or until the peer closes
+  HTTP_PARSE_CHUNK_SIZE,
+  HTTP_PARSE_CHUNK_DATA,
+  HTTP_PARSE_CHUNK_END,   // CRLF after the chunk data
+  HTTP_PARSE_TRAILERS,
+  HTTP_PARSE_DONE,
+  HTTP_PARSE_ERROR
+};
+
+/**
+ * Response parsed so far. The body goes into a caller-supplied buffer and
+ * is always NUL-terminated; bytes that do not fit are counted as truncated
+ * and dropped so the connection stays usable.
+ */
+struct HttpResponse {
+  HttpParseState state;
+  int status;
+  long contentLength;      // CONTENT_LENGTH_UNKNOWN if not sent
+  bool chunked;
+  bool keepAlive;
+  bool headersComplete;
+  bool truncated;
+  char etag[HTTP_ETAG_SIZE];
+
+  char* body;
+  size_t bodyCapacity;
+  size_t bodyLength;
+
+  size_t remaining;        // Bytes left in the body or the current chunk
+  bool untilClose;         // Body is delimited by the peer closing the connection
+  char line[HTTP_LINE_BUFFER_SIZE];
+  size_t lineLength;
+};
+
+// ----------------------------------------------------------------------------
+// HTTP Message Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Renders the request line and headers right-aligned in front of the body.
+ */
+size_t httpRenderRequest(char* buffer, size_t reserve, const char* host, const char* method, const char* path,
+                         size_t bodyLength, const char* contentType, const char* ifNoneMatch);
+
+/**
+ * Estimated number of TLS records a single write of the given size needs.
+ */
+size_t httpTlsRecords(size_t bytes);
+
+/**
+ * Starts parsing a new response into the given body buffer.
+ */
+void httpResponseBegin(HttpResponse& response, char* body, size_t capacity);
+
+/**
+ * Feeds received bytes to the parser.
+ */
+size_t httpResponseFeed(HttpResponse& response, const uint8_t* data, size_t length);
+
+/**
+ * Tells the parser that the peer closed the connection.
+ */
+void httpResponseClosed(HttpResponse& response);
+
+/**
+ * Returns true once the response is complete or cannot be parsed.
+ */
+bool httpResponseFinished(const HttpResponse& response);
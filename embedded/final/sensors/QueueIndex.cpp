@@ -0,0 +1,183 @@
+// ============================================================================
+// File: QueueIndex.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the segment bookkeeping of the reading queue.
+//              Readings are appended to the last segment; a segment is
+//              deleted as a whole once all its readings are acknowledged or
+//              once it is the oldest of a full queue.
+// ============================================================================
+
+#include "QueueIndex.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define FIRST_SLOT 0
+#define NO_READINGS 0
+
+/**
+ * Moves past a first segment whose readings are all acknowledged, as long
+ * as a newer segment exists. Returns true if the first segment changed.
+ */
+static bool skipConsumedSegment(QueueIndex& index) {
+  if (index.headOffset < QUEUE_SEGMENT_READINGS || index.firstSegment == index.lastSegment) return false;
+
+  index.firstSegment++;
+  index.headOffset = FIRST_SLOT;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Queue Index Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * queueIndexEmpty(segment)
+ * ------------------------
+ * @param segment Segment the first reading will be appended to.
+ * @return Index of an empty queue.
+ */
+QueueIndex queueIndexEmpty(uint32_t segment) {
+  return { segment, segment, FIRST_SLOT, NO_READINGS, 0 };
+}
+
+/**
+ * queueIndexCount(index)
+ * ----------------------
+ * @param index Queue index.
+ * @return Number of unacknowledged readings.
+ */
+size_t queueIndexCount(const QueueIndex& index) {
+  if (index.firstSegment == index.lastSegment) return index.tailCount - index.headOffset;
+
+  size_t fullSegments = index.lastSegment - index.firstSegment - 1;
+  return (QUEUE_SEGMENT_READINGS - index.headOffset) + fullSegments * QUEUE_SEGMENT_READINGS + index.tailCount;
+}
+
+/**
+ * queueIndexPush(index)
+ * ---------------------
+ * Reserves the next slot of the last segment. A full last segment starts a
+ * new one; if that exceeds QUEUE_SEGMENTS, the oldest segment is dropped
+ * with all its unacknowledged readings.
+ *
+ * @param index Queue index, updated in place.
+ * @return The flash operations the push needs.
+ */
+QueuePush queueIndexPush(QueueIndex& index) {
+  QueuePush push = { index.lastSegment, FIRST_SLOT, QUEUE_NO_SEGMENT, false };
+
+  if (index.tailCount == QUEUE_SEGMENT_READINGS) {
+    index.lastSegment++;
+    index.tailCount = NO_READINGS;
+
+    uint32_t oldest = index.firstSegment;
+    if (skipConsumedSegment(index)) {
+      push.removeSegment = oldest;
+      push.indexChanged = true;
+    } else if (index.lastSegment - index.firstSegment >= QUEUE_SEGMENTS) {
+      index.dropped += QUEUE_SEGMENT_READINGS - index.headOffset;
+      index.firstSegment++;
+      index.headOffset = FIRST_SLOT;
+      push.removeSegment = oldest;
+      push.indexChanged = true;
+    }
+  }
+
+  push.segment = index.lastSegment;
+  push.slot = index.tailCount++;
+  return push;
+}
+
+/**
+ * queueIndexPop(index, n)
+ * -----------------------
+ * Advances the head over acknowledged readings, leaving segments that are
+ * fully acknowledged behind.
+ *
+ * @param index Queue index, updated in place.
+ * @param n Number of acknowledged readings (capped at the queue length).
+ * @return The first segment still needed.
+ */
+uint32_t queueIndexPop(QueueIndex& index, size_t n) {
+  n = min(n, queueIndexCount(index));
+
+  while (n > 0) {
+    uint16_t end = index.firstSegment == index.lastSegment ? index.tailCount : QUEUE_SEGMENT_READINGS;
+    size_t step = min(n, (size_t)(end - index.headOffset));
+    index.headOffset += step;
+    n -= step;
+    skipConsumedSegment(index);
+  }
+
+  return index.firstSegment;
+}
+
+/**
+ * queueIndexLocate(index, position, segment, slot)
+ * ------------------------------------------------
+ * All segments but the last are full, so positions map linearly onto
+ * segment and slot.
+ *
+ * @param index Queue index.
+ * @param position Reading position, 0 = oldest unacknowledged.
+ * @param segment Receives the segment number.
+ * @param slot Receives the slot within the segment.
+ * @return False if position is beyond the queued readings.
+ */
+bool queueIndexLocate(const QueueIndex& index, size_t position, uint32_t& segment, uint16_t& slot) {
+  if (position >= queueIndexCount(index)) return false;
+
+  size_t absolute = index.headOffset + position;
+  segment = index.firstSegment + absolute / QUEUE_SEGMENT_READINGS;
+  slot = absolute % QUEUE_SEGMENT_READINGS;
+  return true;
+}
+
+/**
+ * queueIndexRestore(scan)
+ * -----------------------
+ * The segment files are the source of truth for what was written, the
+ * metadata only for what was acknowledged. Both are written in an order
+ * that keeps every combination left by a power loss consistent:
+ *   - metadata ahead of the files: segments before it are stale
+ *   - files ahead of the metadata: acknowledged readings are sent again
+ *   - a torn last slot: cut off, that reading was never confirmed
+ *
+ * @param scan Metadata and segment files found on flash.
+ * @return The restored index.
+ */
+QueueIndex queueIndexRestore(const QueueScan& scan) {
+  uint32_t dropped = scan.metaValid ? scan.metaDropped : 0;
+
+  if (scan.oldestSegment == QUEUE_NO_SEGMENT || (scan.metaValid && scan.metaFirst > scan.newestSegment)) {
+    QueueIndex index = queueIndexEmpty(scan.metaValid ? scan.metaFirst : 0);
+    index.dropped = dropped;
+    return index;
+  }
+
+  QueueIndex index = queueIndexEmpty(scan.oldestSegment);
+  index.dropped = dropped;
+  if (scan.metaValid && scan.metaFirst >= scan.oldestSegment) {
+    index.firstSegment = scan.metaFirst;
+    index.headOffset = scan.metaHeadOffset;
+  }
+
+  index.lastSegment = scan.newestSegment;
+  index.tailCount = min(scan.newestSize / scan.slotSize, (uint32_t)QUEUE_SEGMENT_READINGS);
+  uint16_t end = index.firstSegment == index.lastSegment ? index.tailCount : QUEUE_SEGMENT_READINGS;
+  index.headOffset = min(index.headOffset, end);
+  skipConsumedSegment(index);
+
+  // A capacity reduced by an update keeps the newest segments
+  if (index.lastSegment - index.firstSegment >= QUEUE_SEGMENTS) {
+    size_t before = queueIndexCount(index);
+    index.firstSegment = index.lastSegment - QUEUE_SEGMENTS + 1;
+    index.headOffset = FIRST_SLOT;
+    index.dropped += before - queueIndexCount(index);
+  }
+
+  return index;
+}
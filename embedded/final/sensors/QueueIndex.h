@@ -0,0 +1,101 @@
+// ============================================================================
+// File: QueueIndex.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the bookkeeping of the segmented reading queue:
+//              which segment files hold which readings, what a push or an
+//              acknowledgement changes and how the state is rebuilt after
+//              a power loss. Pure logic without any file access.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with QueueIndex.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define QUEUE_SEGMENT_READINGS 16  // Readings per segment file
+#define QUEUE_SEGMENTS 64          // Segments kept; the oldest is dropped beyond that
+#define QUEUE_CAPACITY (QUEUE_SEGMENT_READINGS * QUEUE_SEGMENTS)  // ~34 minutes at one reading per 2 s
+#define QUEUE_NO_SEGMENT 0xFFFFFFFFUL
+
+// ----------------------------------------------------------------------------
+// Data Structures
+// ----------------------------------------------------------------------------
+
+/**
+ * Position of the queued readings. Segments are numbered in write order;
+ * all segments between the first and the last are full.
+ */
+struct QueueIndex {
+  uint32_t firstSegment;  // Oldest segment that still holds unacknowledged readings
+  uint32_t lastSegment;   // Segment new readings are appended to
+  uint16_t headOffset;    // Readings of the first segment already acknowledged
+  uint16_t tailCount;     // Readings stored in the last segment
+  uint32_t dropped;       // Readings lost because the queue overflowed
+};
+
+/**
+ * What a push has to do on flash, in this order: persist the index if
+ * indexChanged, delete removeSegment, append to the slot.
+ */
+struct QueuePush {
+  uint32_t segment;        // Segment the reading is appended to
+  uint16_t slot;           // Its position within the segment
+  uint32_t removeSegment;  // Segment to delete, or QUEUE_NO_SEGMENT
+  bool indexChanged;       // First segment or dropped count changed
+};
+
+/**
+ * What was found on flash after a reboot.
+ */
+struct QueueScan {
+  bool metaValid;          // The stored first segment and head offset are usable
+  uint32_t metaFirst;
+  uint16_t metaHeadOffset;
+  uint32_t metaDropped;
+  uint32_t oldestSegment;  // Lowest segment number on flash, or QUEUE_NO_SEGMENT
+  uint32_t newestSegment;  // Highest segment number on flash
+  uint32_t newestSize;     // Bytes in the newest segment
+  uint32_t slotSize;       // Bytes per reading
+};
+
+// ----------------------------------------------------------------------------
+// Queue Index Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Returns an empty index that starts at the given segment.
+ */
+QueueIndex queueIndexEmpty(uint32_t segment);
+
+/**
+ * Number of unacknowledged readings.
+ */
+size_t queueIndexCount(const QueueIndex& index);
+
+/**
+ * Reserves the slot for a new reading, dropping the oldest segment if the
+ * queue is full.
+ */
+QueuePush queueIndexPush(QueueIndex& index);
+
+/**
+ * Acknowledges the n oldest readings. Returns the first segment that is
+ * still needed; all segments before it can be deleted.
+ */
+uint32_t queueIndexPop(QueueIndex& index, size_t n);
+
+/**
+ * Maps the position-th unacknowledged reading (0 = oldest) to its segment
+ * and slot. Returns false if there are not that many readings.
+ */
+bool queueIndexLocate(const QueueIndex& index, size_t position, uint32_t& segment, uint16_t& slot);
+
+/**
+ * Rebuilds the index from what is on flash. Segments before the returned
+ * first segment are stale and must be deleted, and the newest segment
+ * must be cut to tailCount slots.
+ */
+QueueIndex queueIndexRestore(const QueueScan& scan);
@@ -0,0 +1,346 @@
+// ============================================================================
+// File: ReadingQueue.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the reading queue as an append-only log of small
+//              segment files in LittleFS. A push appends one slot to the
+//              newest segment, so it never rewrites more than that segment;
+//              acknowledged segments are deleted as a whole. The metadata
+//              only records the acknowledged position and is written per
+//              acknowledgement, not per reading. LittleFS commits a file
+//              atomically on close, and QueueIndex rebuilds a consistent
+//              state from whatever a power loss left behind.
+// ============================================================================
+
+#include "ReadingQueue.h"
+#include <LittleFS.h>
+#include <time.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define QUEUE_SLOT_SIZE sizeof(QueuedReading)
+#define QUEUE_SEGMENT_PATH_SIZE 24
+#define QUEUE_SEGMENT_NAME_FORMAT QUEUE_DIR "/%08lx"
+#define HEX_RADIX 16
+#define LOOP_START_INDEX 0
+
+// ----------------------------------------------------------------------------
+// Queue State
+// ----------------------------------------------------------------------------
+
+/**
+ * Persistent queue metadata: the acknowledged position and the overflow
+ * counter. Where the queue ends follows from the segment files.
+ */
+struct QueueMeta {
+  uint32_t magic;
+  uint32_t firstSegment;
+  uint32_t headOffset;
+  uint32_t dropped;
+};
+
+static QueueIndex queueIndex = queueIndexEmpty(0);
+static bool queueReady = false;
+
+/**
+ * Writes the path of a segment file into out.
+ */
+static void segmentPath(char* out, uint32_t segment) {
+  snprintf(out, QUEUE_SEGMENT_PATH_SIZE, QUEUE_SEGMENT_NAME_FORMAT, (unsigned long)segment);
+}
+
+/**
+ * Parses a segment number from a file name, rejecting foreign files.
+ */
+static bool parseSegmentName(const char* name, uint32_t& segment) {
+  char* end;
+  unsigned long value = strtoul(name, &end, HEX_RADIX);
+  if (end == name || *end != '\0') return false;
+  segment = value;
+  return true;
+}
+
+/**
+ * Deletes a segment file.
+ */
+static void removeSegment(uint32_t segment) {
+  char path[QUEUE_SEGMENT_PATH_SIZE];
+  segmentPath(path, segment);
+  LittleFS.remove(path);
+}
+
+/**
+ * Writes the acknowledged position of index to the metadata file.
+ */
+static bool saveMeta(const QueueIndex& index) {
+  QueueMeta meta = { QUEUE_MAGIC, index.firstSegment, index.headOffset, index.dropped };
+
+  File f = LittleFS.open(QUEUE_META_PATH, "w");
+  if (!f) return false;
+  bool ok = f.write((const uint8_t*)&meta, sizeof(meta)) == sizeof(meta);
+  f.close();
+  return ok;
+}
+
+/**
+ * Loads the metadata file into scan, rejecting it if it belongs to another
+ * layout.
+ */
+static void loadMeta(QueueScan& scan) {
+  scan.metaValid = false;
+
+  File f = LittleFS.open(QUEUE_META_PATH, "r");
+  if (!f) return;
+
+  QueueMeta stored;
+  bool ok = f.read((uint8_t*)&stored, sizeof(stored)) == sizeof(stored);
+  f.close();
+
+  if (!ok || stored.magic != QUEUE_MAGIC || stored.headOffset > QUEUE_SEGMENT_READINGS) return;
+
+  scan.metaValid = true;
+  scan.metaFirst = stored.firstSegment;
+  scan.metaHeadOffset = stored.headOffset;
+  scan.metaDropped = stored.dropped;
+}
+
+/**
+ * Finds the oldest and the newest segment file and the size of the newest.
+ */
+static void scanSegments(QueueScan& scan) {
+  scan.oldestSegment = QUEUE_NO_SEGMENT;
+  scan.newestSegment = 0;
+  scan.newestSize = 0;
+  scan.slotSize = QUEUE_SLOT_SIZE;
+
+  bool found = false;
+  Dir dir = LittleFS.openDir(QUEUE_DIR);
+  while (dir.next()) {
+    uint32_t segment;
+    if (!parseSegmentName(dir.fileName().c_str(), segment)) continue;
+
+    if (!found || segment < scan.oldestSegment) scan.oldestSegment = segment;
+    if (!found || segment > scan.newestSegment) {
+      scan.newestSegment = segment;
+      scan.newestSize = dir.fileSize();
+    }
+    found = true;
+  }
+}
+
+/**
+ * Deletes the segments before the first one still needed. Only runs at
+ * boot, to clean up after a power loss between metadata and delete.
+ */
+static void removeStaleSegments(uint32_t firstSegment) {
+  uint32_t stale[QUEUE_SEGMENTS];
+  size_t count = 0;
+
+  Dir dir = LittleFS.openDir(QUEUE_DIR);
+  while (dir.next() && count < QUEUE_SEGMENTS) {
+    uint32_t segment;
+    if (parseSegmentName(dir.fileName().c_str(), segment) && segment < firstSegment) stale[count++] = segment;
+  }
+
+  for (size_t i = LOOP_START_INDEX; i < count; i++) removeSegment(stale[i]);
+}
+
+/**
+ * Cuts a torn slot off the end of the newest segment, so the next push
+ * starts on a slot boundary.
+ */
+static void trimNewestSegment(const QueueScan& scan) {
+  uint32_t expected = queueIndex.tailCount * QUEUE_SLOT_SIZE;
+  if (scan.oldestSegment == QUEUE_NO_SEGMENT || queueIndex.lastSegment != scan.newestSegment || scan.newestSize == expected) return;
+
+  char path[QUEUE_SEGMENT_PATH_SIZE];
+  segmentPath(path, scan.newestSegment);
+  File f = LittleFS.open(path, "r+");
+  if (!f) return;
+  f.truncate(expected);
+  f.close();
+}
+
+// ----------------------------------------------------------------------------
+// Queue Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * initReadingQueue()
+ * ------------------
+ * Mounts LittleFS and restores the queue state from the segment files and
+ * the metadata. The single-file queue of older firmware is discarded.
+ *
+ * @return True if the queue is usable.
+ */
+bool initReadingQueue() {
+  queueReady = false;
+  if (!LittleFS.begin()) {
+    Serial.println("LittleFS mount failed");
+    return false;
+  }
+
+  if (LittleFS.exists(QUEUE_LEGACY_DATA_PATH)) LittleFS.remove(QUEUE_LEGACY_DATA_PATH);
+  if (!LittleFS.exists(QUEUE_DIR) && !LittleFS.mkdir(QUEUE_DIR)) return false;
+
+  QueueScan scan;
+  loadMeta(scan);
+  scanSegments(scan);
+
+  queueIndex = queueIndexRestore(scan);
+  removeStaleSegments(queueIndex.firstSegment);
+  trimNewestSegment(scan);
+
+  queueReady = true;
+  Serial.print("Queued readings restored: ");
+  Serial.println(queueIndexCount(queueIndex));
+  return true;
+}
+
+/**
+ * currentEpoch()
+ * --------------
+ * Returns the wall-clock time used to stamp captured readings.
+ *
+ * @return Unix time in seconds, or EPOCH_UNKNOWN before the first NTP sync.
+ */
+uint32_t currentEpoch() {
+  time_t now = time(nullptr);
+  return now >= (time_t)MIN_VALID_EPOCH ? (uint32_t)now : EPOCH_UNKNOWN;
+}
+
+/**
+ * pushReading(values, count)
+ * --------------------------
+ * Appends a reading to the newest segment. When the queue is full the
+ * oldest segment is dropped and its readings are counted as dropped.
+ *
+ * @param values Array of SensorData structs.
+ * @param count Number of sensor values (capped at QUEUE_MAX_VALUES).
+ * @return True if the reading was persisted.
+ */
+bool pushReading(const SensorData values[], size_t count) {
+  return pushReadingAt(values, count, currentEpoch());
+}
+
+/**
+ * pushReadingAt(values, count, capturedAt)
+ * ----------------------------------------
+ * Same as pushReading(), for readings that were buffered elsewhere (e.g. in
+ * RTC memory during deep sleep) and already carry their capture time.
+ *
+ * A push writes the metadata only when a segment is dropped, before the
+ * segment is deleted; otherwise it is a single append.
+ *
+ * @param values Array of SensorData structs.
+ * @param count Number of sensor values (capped at QUEUE_MAX_VALUES).
+ * @param capturedAt Unix time in seconds, or EPOCH_UNKNOWN.
+ * @return True if the reading was persisted.
+ */
+bool pushReadingAt(const SensorData values[], size_t count, uint32_t capturedAt) {
+  if (!queueReady) return false;
+
+  QueuedReading reading = {};
+  reading.capturedAt = capturedAt;
+  reading.count = min(count, (size_t)QUEUE_MAX_VALUES);
+  for (size_t i = LOOP_START_INDEX; i < reading.count; i++) {
+    reading.values[i] = values[i];
+  }
+
+  QueueIndex next = queueIndex;
+  QueuePush push = queueIndexPush(next);
+  if (push.indexChanged && !saveMeta(next)) return false;
+  if (push.removeSegment != QUEUE_NO_SEGMENT) removeSegment(push.removeSegment);
+
+  char path[QUEUE_SEGMENT_PATH_SIZE];
+  segmentPath(path, push.segment);
+  size_t offset = push.slot * QUEUE_SLOT_SIZE;
+  File f = LittleFS.open(path, "a");
+  if (f && f.size() > offset) f.truncate(offset);  // Left over from a failed write
+  bool ok = f && f.size() == offset && f.write((const uint8_t*)&reading, QUEUE_SLOT_SIZE) == QUEUE_SLOT_SIZE;
+  if (f) f.close();
+
+  // The dropped segment is gone either way; only the reserved slot is undone
+  if (!ok) next.tailCount--;
+  queueIndex = next;
+  return ok;
+}
+
+/**
+ * peekReadings(out, max)
+ * ----------------------
+ * Copies the oldest readings without removing them, so a failed upload
+ * leaves the queue untouched. Each segment involved is opened once.
+ *
+ * @param out Destination array.
+ * @param max Capacity of the destination array.
+ * @return Number of readings copied.
+ */
+size_t peekReadings(QueuedReading out[], size_t max) {
+  if (!queueReady) return 0;
+
+  size_t n = min(queueIndexCount(queueIndex), max);
+  size_t copied = 0;
+  uint32_t openSegment = QUEUE_NO_SEGMENT;
+  File f;
+
+  for (; copied < n; copied++) {
+    uint32_t segment;
+    uint16_t slot;
+    queueIndexLocate(queueIndex, copied, segment, slot);
+
+    if (segment != openSegment) {
+      if (f) f.close();
+      char path[QUEUE_SEGMENT_PATH_SIZE];
+      segmentPath(path, segment);
+      f = LittleFS.open(path, "r");
+      openSegment = segment;
+      if (!f || !f.seek(slot * QUEUE_SLOT_SIZE, SeekSet)) break;
+    }
+
+    if (f.read((uint8_t*)&out[copied], QUEUE_SLOT_SIZE) != QUEUE_SLOT_SIZE) break;
+  }
+
+  if (f) f.close();
+  return copied;
+}
+
+/**
+ * popReadings(n)
+ * --------------
+ * Records the n oldest readings as acknowledged, then deletes the segments
+ * that no longer hold unacknowledged readings.
+ *
+ * @param n Number of acknowledged readings.
+ */
+void popReadings(size_t n) {
+  if (!queueReady || n == 0) return;
+
+  uint32_t oldFirst = queueIndex.firstSegment;
+  queueIndexPop(queueIndex, n);
+  saveMeta(queueIndex);
+
+  for (uint32_t segment = oldFirst; segment < queueIndex.firstSegment; segment++) {
+    removeSegment(segment);
+  }
+}
+
+/**
+ * queuedReadingCount()
+ * --------------------
+ * @return Number of readings waiting for upload.
+ */
+size_t queuedReadingCount() {
+  return queueIndexCount(queueIndex);
+}
+
+/**
+ * droppedReadingCount()
+ * ---------------------
+ * @return Number of readings dropped because the queue was full.
+ */
+uint32_t droppedReadingCount() {
+  return queueIndex.dropped;
+}
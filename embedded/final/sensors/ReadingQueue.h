@@ -0,0 +1,84 @@
+// ============================================================================
+// File: ReadingQueue.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the flash-backed store-and-forward queue that keeps
+//              captured readings in LittleFS segment files until the API
+//              acknowledges them.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Client.h"
+#include "QueueIndex.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with ReadingQueue.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define QUEUE_DIR "/queue"
+#define QUEUE_META_PATH "/queue.meta"
+#define QUEUE_LEGACY_DATA_PATH "/queue.bin"  // Single-file queue of older firmware
+#define QUEUE_MAGIC 0x41544D33               // "ATM3", bump when QueuedReading or QueueMeta changes
+#define QUEUE_MAX_VALUES 6
+
+#define NTP_SERVER "pool.ntp.org"
+#define MIN_VALID_EPOCH 1700000000UL
+#define EPOCH_UNKNOWN 0
+
+// ----------------------------------------------------------------------------
+// Data Structure
+// ----------------------------------------------------------------------------
+
+/**
+ * One captured reading as stored in a fixed-size flash slot.
+ */
+struct QueuedReading {
+  uint32_t capturedAt;  // Unix time in seconds, EPOCH_UNKNOWN if the clock was not synced
+  uint8_t count;
+  SensorData values[QUEUE_MAX_VALUES];
+};
+
+// ----------------------------------------------------------------------------
+// Reading Queue Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Mounts LittleFS and restores the queue left behind by the last power cycle.
+ */
+bool initReadingQueue();
+
+/**
+ * Returns the current Unix time, or EPOCH_UNKNOWN until NTP has synced.
+ */
+uint32_t currentEpoch();
+
+/**
+ * Appends a reading. When the queue is full, the oldest segment is dropped.
+ */
+bool pushReading(const SensorData values[], size_t count);
+
+/**
+ * Appends a reading captured at the given Unix time.
+ */
+bool pushReadingAt(const SensorData values[], size_t count, uint32_t capturedAt);
+
+/**
+ * Copies up to max of the oldest readings into out without removing them.
+ */
+size_t peekReadings(QueuedReading out[], size_t max);
+
+/**
+ * Removes the n oldest readings after the API acknowledged them.
+ */
+void popReadings(size_t n);
+
+/**
+ * Number of readings waiting for upload.
+ */
+size_t queuedReadingCount();
+
+/**
+ * Number of readings lost because the queue overflowed.
+ */
+uint32_t droppedReadingCount();
@@ -0,0 +1,154 @@
+// ============================================================================
+// File: ReportPolicy.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements per-sensor deadbands with a heartbeat, so unchanged
+//              values are not uploaded while the backend still receives every
+//              sensor at least once per silence interval.
+// ============================================================================
+
+#include "ReportPolicy.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define LOOP_START_INDEX 0
+#define RULE_NOT_FOUND -1
+#define NO_SAMPLES 0
+
+// ----------------------------------------------------------------------------
+// Policy State
+// ----------------------------------------------------------------------------
+
+/**
+ * A rule together with what was last reported for its sensor, and the
+ * window statistics of the values suppressed since.
+ */
+struct RuleState {
+  ReportRule rule;
+  bool reported;
+  float lastValue;
+  unsigned long lastReportMs;
+
+  float pendingMin;
+  float pendingMax;
+  uint16_t pendingCount;
+};
+
+static RuleState states[REPORT_MAX_RULES];
+static size_t stateCount = 0;
+static unsigned long suppressed = 0;
+
+/**
+ * Finds the state slot for a sensor ID.
+ */
+static int findState(int sensorId) {
+  for (size_t i = LOOP_START_INDEX; i < stateCount; i++) {
+    if (states[i].rule.sensorId == sensorId) return i;
+  }
+  return RULE_NOT_FOUND;
+}
+
+/**
+ * Decides whether a value has to be reported under its rule.
+ */
+static bool mustReport(const RuleState& state, float value, unsigned long now) {
+  if (!state.reported) return true;
+  if (now - state.lastReportMs >= state.rule.maxSilenceMs) return true;
+
+  float deadband = max(state.rule.absoluteDeadband, state.rule.relativeDeadband * fabsf(state.lastValue));
+  return fabsf(value - state.lastValue) > deadband;
+}
+
+/**
+ * Merges the min, max and sample count of one window into another.
+ */
+static void mergeWindow(float& low, float& high, uint16_t& count, const SensorData& window) {
+  if (window.count == NO_SAMPLES) return;
+  if (count == NO_SAMPLES) {
+    low = window.min;
+    high = window.max;
+  } else {
+    low = fminf(low, window.min);
+    high = fmaxf(high, window.max);
+  }
+  count = min((uint32_t)count + window.count, (uint32_t)UINT16_MAX);
+}
+
+// ----------------------------------------------------------------------------
+// Report Policy Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * initReportPolicy(rules, count)
+ * ------------------------------
+ * Installs the reporting rules and forgets previously reported values.
+ *
+ * @param rules Array of rules, one per sensor ID.
+ * @param count Number of rules (capped at REPORT_MAX_RULES).
+ */
+void initReportPolicy(const ReportRule rules[], size_t count) {
+  stateCount = min(count, (size_t)REPORT_MAX_RULES);
+  for (size_t i = LOOP_START_INDEX; i < stateCount; i++) {
+    states[i] = {};
+    states[i].rule = rules[i];
+  }
+}
+
+/**
+ * selectReportedValues(values, count, out, now)
+ * ---------------------------------------------
+ * Applies the deadbands and heartbeat to a full set of sensor values. The
+ * min, max and count of suppressed windows are carried into the next
+ * reported value of the sensor, so a spike inside a suppressed window is
+ * not lost.
+ *
+ * @param values Current sensor values.
+ * @param count Number of values.
+ * @param out Destination for the values to report (at least count entries).
+ * @param now Current time in milliseconds.
+ * @return Number of values copied to out.
+ */
+size_t selectReportedValues(const SensorData values[], size_t count, SensorData out[], unsigned long now) {
+  size_t selected = 0;
+
+  for (size_t i = LOOP_START_INDEX; i < count; i++) {
+    int idx = findState(values[i].sensorId);
+
+    if (idx == RULE_NOT_FOUND) {
+      out[selected++] = values[i];
+      continue;
+    }
+
+    RuleState& state = states[idx];
+    if (!mustReport(state, values[i].value, now)) {
+      mergeWindow(state.pendingMin, state.pendingMax, state.pendingCount, values[i]);
+      suppressed++;
+      continue;
+    }
+
+    SensorData& reported = out[selected++];
+    reported = values[i];
+    if (state.pendingCount != NO_SAMPLES) {
+      SensorData pending = { reported.sensorId, reported.value, state.pendingMin, state.pendingMax, state.pendingCount };
+      mergeWindow(reported.min, reported.max, reported.count, pending);
+      state.pendingCount = NO_SAMPLES;
+    }
+
+    state.reported = true;
+    state.lastValue = values[i].value;
+    state.lastReportMs = now;
+  }
+
+  return selected;
+}
+
+/**
+ * suppressedValueCount()
+ * ----------------------
+ * @return Number of values not reported because they stayed within their deadband.
+ */
+unsigned long suppressedValueCount() {
+  return suppressed;
+}
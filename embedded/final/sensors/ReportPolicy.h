@@ -0,0 +1,53 @@
+// ============================================================================
+// File: ReportPolicy.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the send-on-delta reporting policy that decides which
+//              sensor values are worth transmitting.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Client.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with ReportPolicy.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define REPORT_MAX_RULES 8
+#define REPORT_NO_DEADBAND 0.0f
+
+// ----------------------------------------------------------------------------
+// Data Structure
+// ----------------------------------------------------------------------------
+
+/**
+ * Reporting rule for one sensor. A value is reported when it moved by more
+ * than max(absoluteDeadband, relativeDeadband * |last reported value|), or
+ * when nothing was reported for maxSilenceMs (heartbeat).
+ */
+struct ReportRule {
+  int sensorId;
+  float absoluteDeadband;
+  float relativeDeadband;
+  unsigned long maxSilenceMs;
+};
+
+// ----------------------------------------------------------------------------
+// Report Policy Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Installs the reporting rules. Sensors without a rule are always reported.
+ */
+void initReportPolicy(const ReportRule rules[], size_t count);
+
+/**
+ * Copies the values that must be reported into out and marks them as sent.
+ */
+size_t selectReportedValues(const SensorData values[], size_t count, SensorData out[], unsigned long now);
+
+/**
+ * Number of values suppressed by the deadbands since boot.
+ */
+unsigned long suppressedValueCount();
@@ -0,0 +1,153 @@
+// ============================================================================
+// File: Scheduler.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the cooperative scheduler. Each task keeps a fixed
+//              release grid; a task that falls a full period behind skips the
+//              missed releases instead of running in a burst.
+// ============================================================================
+
+#include "Scheduler.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define LOOP_START_INDEX 0
+#define NO_RUNS 0
+
+// ----------------------------------------------------------------------------
+// Scheduler State
+// ----------------------------------------------------------------------------
+static ScheduledTask tasks[SCHEDULER_MAX_TASKS];
+static size_t taskCount = 0;
+
+/**
+ * Returns true once the given release time has been reached (wrap-safe).
+ */
+static bool isDue(unsigned long now, unsigned long releaseMs) {
+  return (long)(now - releaseMs) >= 0;
+}
+
+/**
+ * Runs a single due task and updates its statistics.
+ */
+static void runTask(ScheduledTask& task, unsigned long now) {
+  unsigned long jitter = now - task.nextRunMs;
+  task.lastJitterMs = jitter;
+  task.totalJitterMs += jitter;
+  if (jitter > task.maxJitterMs) task.maxJitterMs = jitter;
+
+  task.running = true;
+  unsigned long start = micros();
+  task.callback();
+  unsigned long duration = micros() - start;
+  task.running = false;
+
+  task.runs++;
+  if (duration > task.maxDurationUs) task.maxDurationUs = duration;
+
+  task.nextRunMs += task.periodMs;
+  unsigned long finished = millis();
+  if (isDue(finished, task.nextRunMs + task.periodMs)) {
+    // More than a full period behind: drop the missed releases
+    task.overruns++;
+    task.nextRunMs = finished + task.periodMs;
+  }
+}
+
+/**
+ * Runs all due tasks, optionally only those safe during network waits.
+ */
+static void runDueTasks(bool samplingOnly) {
+  for (size_t i = LOOP_START_INDEX; i < taskCount; i++) {
+    ScheduledTask& task = tasks[i];
+    if (task.running) continue;
+    if (samplingOnly && !task.runsDuringNetworkWait) continue;
+
+    unsigned long now = millis();
+    if (isDue(now, task.nextRunMs)) {
+      runTask(task, now);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Scheduler Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * addTask(name, periodMs, callback, runsDuringNetworkWait)
+ * --------------------------------------------------------
+ * Registers a periodic task. The first release is immediate.
+ *
+ * @param name Task name used in statistics output.
+ * @param periodMs Release period in milliseconds.
+ * @param callback Function to run.
+ * @param runsDuringNetworkWait True if the task may run while a network task waits.
+ * @return True if the task was added.
+ */
+bool addTask(const char* name, unsigned long periodMs, TaskCallback callback, bool runsDuringNetworkWait) {
+  if (taskCount >= SCHEDULER_MAX_TASKS) return false;
+
+  ScheduledTask& task = tasks[taskCount++];
+  task = {};
+  task.name = name;
+  task.periodMs = periodMs;
+  task.callback = callback;
+  task.runsDuringNetworkWait = runsDuringNetworkWait;
+  task.nextRunMs = millis();
+  return true;
+}
+
+/**
+ * runScheduler()
+ * --------------
+ * Runs every due task once. Call repeatedly from loop().
+ */
+void runScheduler() {
+  runDueTasks(false);
+}
+
+/**
+ * runSamplingTasks()
+ * ------------------
+ * Runs due tasks that are safe to execute while a network request is
+ * blocked, so sample timing does not depend on the uplink.
+ */
+void runSamplingTasks() {
+  runDueTasks(true);
+}
+
+/**
+ * msUntilNextTask()
+ * -----------------
+ * @return Milliseconds until the earliest release, capped at SCHEDULER_MAX_IDLE_MS.
+ */
+unsigned long msUntilNextTask() {
+  unsigned long now = millis();
+  unsigned long wait = SCHEDULER_MAX_IDLE_MS;
+
+  for (size_t i = LOOP_START_INDEX; i < taskCount; i++) {
+    if (isDue(now, tasks[i].nextRunMs)) return 0;
+    wait = min(wait, tasks[i].nextRunMs - now);
+  }
+
+  return wait;
+}
+
+/**
+ * printTaskStats()
+ * ----------------
+ * Prints runs, average/max jitter, overruns and worst-case duration per task.
+ */
+void printTaskStats() {
+  Serial.println("--- Tasks ---");
+  for (size_t i = LOOP_START_INDEX; i < taskCount; i++) {
+    const ScheduledTask& task = tasks[i];
+    unsigned long avgJitter = task.runs == NO_RUNS ? 0 : task.totalJitterMs / task.runs;
+    Serial.printf("%-8s runs=%lu jitter avg=%lums max=%lums overruns=%lu max_us=%lu\n",
+                  task.name, task.runs, avgJitter, task.maxJitterMs, task.overruns, task.maxDurationUs);
+  }
+  Serial.println("------------------------");
+}
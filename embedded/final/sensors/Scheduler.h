@@ -0,0 +1,72 @@
+// ============================================================================
+// File: Scheduler.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares a small millis-driven cooperative scheduler that runs
+//              periodic tasks and records their timing jitter and overruns.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with Scheduler.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define SCHEDULER_MAX_TASKS 8  // All used by sensors.ino; raise it before adding a task
+#define SCHEDULER_MAX_IDLE_MS 10
+
+// ----------------------------------------------------------------------------
+// Data Structure
+// ----------------------------------------------------------------------------
+typedef void (*TaskCallback)();
+
+/**
+ * A periodic task and its timing statistics.
+ */
+struct ScheduledTask {
+  const char* name;
+  unsigned long periodMs;
+  TaskCallback callback;
+  bool runsDuringNetworkWait;  // Safe to run while a network task is blocked
+
+  unsigned long nextRunMs;
+  bool running;
+
+  unsigned long runs;
+  unsigned long overruns;        // Releases skipped because the task ran a full period late
+  unsigned long lastJitterMs;    // Lateness of the last release
+  unsigned long maxJitterMs;     // Worst lateness seen
+  unsigned long totalJitterMs;   // Sum of lateness, for the average
+  unsigned long maxDurationUs;   // Longest execution time
+};
+
+// ----------------------------------------------------------------------------
+// Scheduler Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Registers a periodic task. Returns false if the task table is full.
+ */
+bool addTask(const char* name, unsigned long periodMs, TaskCallback callback, bool runsDuringNetworkWait);
+
+/**
+ * Runs every task whose release time has passed.
+ */
+void runScheduler();
+
+/**
+ * Runs due tasks flagged runsDuringNetworkWait. Called from network wait loops
+ * so sampling continues while an upload is blocked on the uplink.
+ */
+void runSamplingTasks();
+
+/**
+ * Milliseconds until the next task is due, capped at SCHEDULER_MAX_IDLE_MS.
+ */
+unsigned long msUntilNextTask();
+
+/**
+ * Prints per-task run, jitter and overrun counters to serial.
+ */
+void printTaskStats();
@@ -0,0 +1,146 @@
+// ============================================================================
+// File: SensorFilter.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the fixed-point filtering stage. All state lives in
+//              caller-owned structs, so filtering never allocates.
+// ============================================================================
+
+#include "SensorFilter.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define LOOP_START_INDEX 0
+#define EMPTY_WINDOW 0
+#define MEDIAN_MIDDLE(n) ((n) / 2)
+
+// ----------------------------------------------------------------------------
+// Filter Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * toFixed(value)
+ * --------------
+ * @param value Reading in its natural unit.
+ * @return Value in centi-units, rounded to nearest.
+ */
+int32_t toFixed(float value) {
+  return (int32_t)lroundf(value * FILTER_SCALE);
+}
+
+/**
+ * medianFilterAdd(filter, sample)
+ * -------------------------------
+ * Stores the sample in the ring and returns the median of the samples seen
+ * so far (up to MEDIAN_WINDOW), using an insertion sort on a stack copy.
+ *
+ * @param filter Filter state.
+ * @param sample New sample.
+ * @return Median of the window.
+ */
+int32_t medianFilterAdd(MedianFilter& filter, int32_t sample) {
+  filter.samples[filter.next] = sample;
+  filter.next = (filter.next + 1) % MEDIAN_WINDOW;
+  if (filter.filled < MEDIAN_WINDOW) filter.filled++;
+
+  int32_t sorted[MEDIAN_WINDOW];
+  for (uint8_t i = LOOP_START_INDEX; i < filter.filled; i++) {
+    int32_t v = filter.samples[i];
+    int8_t j = i - 1;
+    while (j >= 0 && sorted[j] > v) {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = v;
+  }
+
+  return sorted[MEDIAN_MIDDLE(filter.filled)];
+}
+
+/**
+ * emaFilterAdd(filter, sample)
+ * ----------------------------
+ * Updates the EMA in Q8 fixed point: state += (sample - state) / 2^shift.
+ * The first sample initialises the state.
+ *
+ * @param filter Filter state.
+ * @param sample New sample.
+ * @return Smoothed value, rounded to nearest.
+ */
+int32_t emaFilterAdd(EmaFilter& filter, int32_t sample) {
+  int32_t scaled = sample * (1 << EMA_FRACTION_BITS);
+
+  if (!filter.primed) {
+    filter.state = scaled;
+    filter.primed = true;
+  } else {
+    filter.state += (scaled - filter.state) / (1 << filter.shift);
+  }
+
+  int32_t half = 1 << (EMA_FRACTION_BITS - 1);
+  return (filter.state + (filter.state >= 0 ? half : -half)) / (1 << EMA_FRACTION_BITS);
+}
+
+/**
+ * spikeFilterAccept(filter, sample)
+ * ---------------------------------
+ * Accepts the first sample, then rejects jumps larger than maxStep unless
+ * they persist for SPIKE_REJECT_LIMIT consecutive samples.
+ *
+ * @param filter Filter state.
+ * @param sample New sample.
+ * @return True if the sample should be used.
+ */
+bool spikeFilterAccept(SpikeFilter& filter, int32_t sample) {
+  if (filter.primed && abs(sample - filter.last) > filter.maxStep && filter.rejected < SPIKE_REJECT_LIMIT) {
+    filter.rejected++;
+    return false;
+  }
+
+  filter.primed = true;
+  filter.rejected = 0;
+  filter.last = sample;
+  return true;
+}
+
+/**
+ * windowAdd(window, sample)
+ * -------------------------
+ * @param window Window state.
+ * @param sample New sample in centi-units.
+ */
+void windowAdd(WindowStats& window, int32_t sample) {
+  if (window.count == EMPTY_WINDOW) {
+    window.min = sample;
+    window.max = sample;
+  } else {
+    window.min = min(window.min, sample);
+    window.max = max(window.max, sample);
+  }
+
+  window.sum += sample;
+  if (window.count < UINT16_MAX) window.count++;
+}
+
+/**
+ * windowFlush(window, out)
+ * ------------------------
+ * Converts the window to SensorData (value = mean) and resets it.
+ *
+ * @param window Window state.
+ * @param out Destination; its sensorId is kept.
+ * @return False if the window held no samples.
+ */
+bool windowFlush(WindowStats& window, SensorData& out) {
+  if (window.count == EMPTY_WINDOW) return false;
+
+  out.value = (float)window.sum / window.count / FILTER_SCALE;
+  out.min = window.min / FILTER_SCALE;
+  out.max = window.max / FILTER_SCALE;
+  out.count = window.count;
+
+  window = {};
+  return true;
+}
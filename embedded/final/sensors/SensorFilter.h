@@ -0,0 +1,98 @@
+// ============================================================================
+// File: SensorFilter.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares allocation-free fixed-point filters (median, EMA,
+//              spike rejection) and the per-window aggregation of samples.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "Client.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with SensorFilter.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define FILTER_SCALE 100.0f        // Samples are processed as centi-units
+#define MEDIAN_WINDOW 5
+#define EMA_FRACTION_BITS 8        // EMA state is kept in Q8 centi-units
+#define SPIKE_REJECT_LIMIT 3       // Consecutive rejections before a step is accepted
+
+// ----------------------------------------------------------------------------
+// Data Structures
+// ----------------------------------------------------------------------------
+
+/**
+ * Running median over the last MEDIAN_WINDOW samples.
+ */
+struct MedianFilter {
+  int32_t samples[MEDIAN_WINDOW];
+  uint8_t next;
+  uint8_t filled;
+};
+
+/**
+ * Exponential moving average with smoothing factor 1 / 2^shift.
+ */
+struct EmaFilter {
+  uint8_t shift;
+  bool primed;
+  int32_t state;  // Q(EMA_FRACTION_BITS)
+};
+
+/**
+ * Rejects samples that jump more than maxStep from the last accepted one.
+ * A jump that persists for SPIKE_REJECT_LIMIT samples is accepted as real.
+ */
+struct SpikeFilter {
+  int32_t maxStep;
+  bool primed;
+  uint8_t rejected;
+  int32_t last;
+};
+
+/**
+ * Min, max, sum and count of the samples in the current upload window.
+ */
+struct WindowStats {
+  int32_t min;
+  int32_t max;
+  int64_t sum;
+  uint16_t count;
+};
+
+// ----------------------------------------------------------------------------
+// Filter Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Converts a float reading to fixed-point centi-units.
+ */
+int32_t toFixed(float value);
+
+/**
+ * Adds a sample and returns the median of the filled window.
+ */
+int32_t medianFilterAdd(MedianFilter& filter, int32_t sample);
+
+/**
+ * Adds a sample and returns the smoothed value.
+ */
+int32_t emaFilterAdd(EmaFilter& filter, int32_t sample);
+
+/**
+ * Returns true if the sample is plausible and should be used.
+ */
+bool spikeFilterAccept(SpikeFilter& filter, int32_t sample);
+
+/**
+ * Adds a sample to the window.
+ */
+void windowAdd(WindowStats& window, int32_t sample);
+
+/**
+ * Writes mean/min/max/count of the window into out and starts a new window.
+ * Leaves out untouched and returns false if the window is empty.
+ */
+bool windowFlush(WindowStats& window, SensorData& out);
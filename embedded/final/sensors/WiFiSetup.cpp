@@ -14,6 +14,7 @@
 #define WIFI_AP_PASSWORD "superSecret123"
 #define PORTAL_TIMEOUT_SEC 180
 #define RESTART_DELAY_MS 3000
+#define WIFI_POLL_MS 50
 
 // Instance of WiFiManager
 WiFiManager wifiManager;
@@ -31,3 +32,21 @@ void connectToWiFi() {
   Serial.print("IP Address: ");
   Serial.println(WiFi.localIP());
 }
+
+bool connectToSavedWiFi(unsigned long timeoutMs) {
+  WiFi.mode(WIFI_STA);
+  WiFi.begin();  // Credentials saved by WiFiManager
+
+  unsigned long start = millis();
+  while (WiFi.status() != WL_CONNECTED) {
+    if (millis() - start >= timeoutMs) {
+      Serial.println("WiFi connection timed out.");
+      return false;
+    }
+    delay(WIFI_POLL_MS);
+  }
+
+  Serial.print("WiFi connected in ms: ");
+  Serial.println(millis() - start);
+  return true;
+}
@@ -19,3 +19,12 @@
  * Reboots the device if no connection is established within the timeout.
  */
 void connectToWiFi();
+
+/**
+ * connectToSavedWiFi(timeoutMs)
+ * -----------------------------
+ * Connects with the credentials saved by WiFiManager without opening the
+ * captive portal. Used on deep sleep wakes, where a hanging portal would
+ * drain the battery. Returns false on timeout.
+ */
+bool connectToSavedWiFi(unsigned long timeoutMs);
@@ -0,0 +1,87 @@
+// ============================================================================
+// File: WireFormat.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the compact binary encoding for reading batches.
+//              Values are sent as fixed-point centi-units; window min/max are
+//              only included for aggregated values.
+// ============================================================================
+
+#include "WireFormat.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define LOOP_START_INDEX 0
+#define BYTE_MASK 0xFF
+#define BITS_PER_BYTE 8
+
+// ----------------------------------------------------------------------------
+// Internal Utilities
+// ----------------------------------------------------------------------------
+
+/**
+ * Writes an unsigned integer of the given width in little-endian order.
+ */
+static uint8_t* putLittleEndian(uint8_t* p, uint32_t value, size_t width) {
+  for (size_t i = LOOP_START_INDEX; i < width; i++) {
+    *p++ = (value >> (i * BITS_PER_BYTE)) & BYTE_MASK;
+  }
+  return p;
+}
+
+/**
+ * Converts a float to signed centi-units, rounding to the nearest unit.
+ */
+static int32_t toCentiUnits(float value) {
+  return (int32_t)lroundf(value * WIRE_VALUE_SCALE);
+}
+
+// ----------------------------------------------------------------------------
+// Wire Format Functions
+// ----------------------------------------------------------------------------
+
+/**
+ * encodeReadingBatch(out, outSize, deviceId, sequence, readings, count)
+ * ---------------------------------------------------------------------
+ * Encodes queued readings into a single binary frame without any heap
+ * allocation.
+ *
+ * @param out Destination buffer.
+ * @param outSize Size of the destination buffer.
+ * @param deviceId Backend device ID.
+ * @param sequence Upload sequence number echoed back by the server.
+ * @param readings Readings to encode.
+ * @param count Number of readings.
+ * @return Number of bytes written, or WIRE_ENCODE_FAILED if out is too small.
+ */
+size_t encodeReadingBatch(uint8_t* out, size_t outSize, int deviceId, uint32_t sequence,
+                          const QueuedReading readings[], size_t count) {
+  if (outSize < WIRE_FRAME_MAX_SIZE(count)) return WIRE_ENCODE_FAILED;
+
+  uint8_t* p = out;
+  p = putLittleEndian(p, WIRE_FORMAT_VERSION, sizeof(uint8_t));
+  p = putLittleEndian(p, (uint16_t)deviceId, sizeof(uint16_t));
+  p = putLittleEndian(p, sequence, sizeof(uint32_t));
+  p = putLittleEndian(p, (uint8_t)count, sizeof(uint8_t));
+
+  for (size_t i = LOOP_START_INDEX; i < count; i++) {
+    p = putLittleEndian(p, readings[i].capturedAt, sizeof(uint32_t));
+    p = putLittleEndian(p, readings[i].count, sizeof(uint8_t));
+
+    for (size_t j = LOOP_START_INDEX; j < readings[i].count; j++) {
+      const SensorData& v = readings[i].values[j];
+      p = putLittleEndian(p, (uint8_t)v.sensorId, sizeof(uint8_t));
+      p = putLittleEndian(p, v.count, sizeof(uint16_t));
+      p = putLittleEndian(p, (uint32_t)toCentiUnits(v.value), sizeof(uint32_t));
+
+      if (v.count > WIRE_SINGLE_SAMPLE) {
+        p = putLittleEndian(p, (uint32_t)toCentiUnits(v.min), sizeof(uint32_t));
+        p = putLittleEndian(p, (uint32_t)toCentiUnits(v.max), sizeof(uint32_t));
+      }
+    }
+  }
+
+  return p - out;
+}
@@ -0,0 +1,44 @@
+// ============================================================================
+// File: WireFormat.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the compact binary encoding used to upload queued
+//              readings as an alternative to JSON.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include "ReadingQueue.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros (shared with WireFormat.cpp to avoid magic numbers)
+// ----------------------------------------------------------------------------
+#define WIRE_CONTENT_TYPE "application/vnd.atmos.reading"
+#define WIRE_FORMAT_VERSION 2
+
+// Frame layout (little-endian):
+//   u8 version | u16 device_id | u32 sequence | u8 reading_count
+//   per reading: u32 captured_at | u8 value_count
+//   per value:   u8 sensor_id | u16 sample_count | i32 value in centi-units
+//                [| i32 min | i32 max, only if sample_count > 1]
+#define WIRE_HEADER_SIZE 8
+#define WIRE_READING_HEADER_SIZE 5
+#define WIRE_VALUE_SIZE 7
+#define WIRE_WINDOW_SIZE 8
+#define WIRE_VALUE_SCALE 100.0f
+#define WIRE_SINGLE_SAMPLE 1
+#define WIRE_FRAME_MAX_SIZE(readings) \
+  (WIRE_HEADER_SIZE + (readings) * (WIRE_READING_HEADER_SIZE + QUEUE_MAX_VALUES * (WIRE_VALUE_SIZE + WIRE_WINDOW_SIZE)))
+
+#define WIRE_ENCODE_FAILED 0
+
+// ----------------------------------------------------------------------------
+// Wire Format Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Encodes a batch of queued readings into out.
+ */
+size_t encodeReadingBatch(uint8_t* out, size_t outSize, int deviceId, uint32_t sequence,
+                          const QueuedReading readings[], size_t count);
@@ -3,8 +3,9 @@
 // Author: Yanis Deplazes
 // License: MIT License
 // Copyright (c) 2025 Yanis Deplazes
-// Description: Reads sensor data (DHT11, BMP180, BH1750, analog water sensor),
-//              sends data to remote API, and prints current sensor values.
+// Description: Reads sensor data (DHT11, BMP180, BH1750, analog water sensor)
+//              on per-sensor periods, sends data to remote API, and prints
+//              current sensor values.
 // ============================================================================
 
 #include <Wire.h>
@@ -13,8 +14,13 @@
 #include <DHT.h>
 #include <WiFiManager.h>
 
-#include "WifiSetup.h"
+#include "WiFiSetup.h"
 #include "Client.h"
+#include "ReadingQueue.h"
+#include "Scheduler.h"
+#include "ReportPolicy.h"
+#include "SensorFilter.h"
+#include "DeepSleep.h"
 
 // ---------------------------------------------------------------------------
 // Pin Configuration
@@ -54,11 +60,58 @@
 // ---------------------------------------------------------------------------
 
 #define SERIAL_BAUD_RATE 115200
-#define LOOP_DELAY_MS 2000
 #define MIN_VALID_LUX 0
 #define PA_TO_HPA_DIVISOR 100.0
 #define FLOAT_DISPLAY_PRECISION 2
 
+// ---------------------------------------------------------------------------
+// Task Periods
+// ---------------------------------------------------------------------------
+
+#define WATER_PERIOD_MS 100       // Analog read, cheap
+#define BH1750_PERIOD_MS 120      // High-resolution conversion time
+#define DHT11_PERIOD_MS 2000      // The DHT library returns its cached value for 2 s
+#define BMP180_PERIOD_MS 1000
+#define READING_PERIOD_MS 2000    // One queued reading per period
+#define UPLOAD_PERIOD_MS 1000     // flushReadings() decides when a batch is due
+#define STATS_PERIOD_MS 60000
+
+// ---------------------------------------------------------------------------
+// Deep Sleep Mode (battery-powered stations)
+// ---------------------------------------------------------------------------
+
+#define DEEP_SLEEP_MODE false          // true: one reading per wake, then ESP.deepSleep()
+#define SLEEP_PERIOD_MS 60000          // One reading per minute
+#define UPLOAD_EVERY_WAKES 10          // Radio comes up on every 10th wake
+#define WATER_BURST_SAMPLES 5          // Fills the median window once per wake
+#define WIFI_WAKE_TIMEOUT_MS 10000
+#define NTP_SYNC_TIMEOUT_MS 3000
+#define NTP_POLL_MS 50
+#define SLEEP_UPLOAD_BUDGET_MS 20000
+
+// ---------------------------------------------------------------------------
+// Reporting Policy (send-on-delta)
+// ---------------------------------------------------------------------------
+
+#define HEARTBEAT_MS 300000  // Every value is re-sent at least every 5 minutes
+
+const ReportRule reportRules[] = {
+  { SENSOR_ID_DHT11_TEMPERATURE, 0.5f, REPORT_NO_DEADBAND, HEARTBEAT_MS },
+  { SENSOR_ID_DHT11_HUMIDITY, 1.0f, REPORT_NO_DEADBAND, HEARTBEAT_MS },
+  { SENSOR_ID_BH1750_LUX, 2.0f, 0.05f, HEARTBEAT_MS },
+  { SENSOR_ID_ANALOG_WATER, 10.0f, REPORT_NO_DEADBAND, HEARTBEAT_MS },
+  { SENSOR_ID_BMP180_TEMPERATURE, 0.2f, REPORT_NO_DEADBAND, HEARTBEAT_MS },
+  { SENSOR_ID_BMP180_PRESSURE, 0.3f, REPORT_NO_DEADBAND, HEARTBEAT_MS }
+};
+
+// ---------------------------------------------------------------------------
+// Filtering
+// ---------------------------------------------------------------------------
+
+#define WATER_EMA_SHIFT 2                 // alpha = 1/4
+#define DHT11_TEMP_MAX_STEP_CENTI 300     // 3 °C between 1 s samples is a spike
+#define DHT11_HUMID_MAX_STEP_CENTI 1000   // 10 % RH between 1 s samples is a spike
+
 // ---------------------------------------------------------------------------
 // Sensor Instances
 // ---------------------------------------------------------------------------
@@ -67,6 +120,7 @@ BH1750 lightMeter;
 Adafruit_BMP085 bmp;
 DHT dht(DHTPIN, DHTTYPE);
 bool bmpReady = false;
+bool firstReadingRecorded = false;
 
 // ---------------------------------------------------------------------------
 // SensorData array for transmitting values
@@ -81,19 +135,62 @@ SensorData sensorData[SENSOR_COUNT] = {
   { SENSOR_ID_BMP180_PRESSURE, 0 }
 };
 
+// ---------------------------------------------------------------------------
+// Filter State (one upload window per sensorData[] entry)
+// ---------------------------------------------------------------------------
+
+MedianFilter waterMedian = {};
+EmaFilter waterEma = { WATER_EMA_SHIFT };
+SpikeFilter dhtTempSpike = { DHT11_TEMP_MAX_STEP_CENTI };
+SpikeFilter dhtHumidSpike = { DHT11_HUMID_MAX_STEP_CENTI };
+WindowStats windows[SENSOR_COUNT] = {};
+
 /**
  * setup()
  * -------
- * Initializes serial, WiFi, sensors, and API device registration.
+ * Initializes serial, the reading queue, WiFi, clock sync, sensors, and API
+ * device registration. In deep sleep mode, runs one sleep cycle instead.
  */
 void setup() {
   pinMode(WIFI_LED_PIN, OUTPUT);
   digitalWrite(WIFI_LED_PIN, LOW);
 
   Serial.begin(SERIAL_BAUD_RATE);
+
+  if (DEEP_SLEEP_MODE) {
+    runSleepCycle();  // Ends in deep sleep, the next wake restarts at setup()
+    return;
+  }
+
+  initReadingQueue();
+  initReportPolicy(reportRules, sizeof(reportRules) / sizeof(reportRules[0]));
   connectToWiFi();
+  configTime(0, 0, NTP_SERVER);
   setupDevice();
 
+  initSensors(BH1750::CONTINUOUS_HIGH_RES_MODE);
+
+  addTask("water", WATER_PERIOD_MS, readWaterSensor, true);
+  addTask("bh1750", BH1750_PERIOD_MS, readBh1750, true);
+  addTask("dht11", DHT11_PERIOD_MS, readDht11, true);
+  addTask("bmp180", BMP180_PERIOD_MS, readBmp180, true);
+  addTask("reading", READING_PERIOD_MS, recordReading, true);
+  addTask("upload", UPLOAD_PERIOD_MS, flushReadings, false);
+  addTask("device", DEVICE_REVALIDATE_PERIOD_MS, revalidateDevice, false);
+  addTask("stats", STATS_PERIOD_MS, printStats, false);
+
+  digitalWrite(WIFI_LED_PIN, HIGH);
+}
+
+/**
+ * initSensors(lightMode)
+ * ----------------------
+ * Starts the I2C bus and the sensors. Kept short, since it runs on every
+ * wake in deep sleep mode.
+ *
+ * @param lightMode BH1750 mode; one-time mode lets the sensor power down.
+ */
+void initSensors(BH1750::Mode lightMode) {
   Wire.begin();
   bmpReady = bmp.begin();
   if (!bmpReady) {
@@ -102,41 +199,62 @@ void setup() {
 
   dht.begin();
 
-  bool bh1750Ready = lightMeter.begin();
+  bool bh1750Ready = lightMeter.begin(lightMode);
   if (!bh1750Ready) {
     Serial.println("⚠️ BH1750 sensor not detected!");
   }
-
-
-  digitalWrite(WIFI_LED_PIN, HIGH);
 }
 
 /**
  * loop()
  * ------
- * Polls all sensors, uploads values, prints results, and waits.
+ * Runs due sensor, reading and upload tasks, then idles until the next one.
  */
 void loop() {
-  readDht11();
-  readBh1750();
-  readWaterSensor();
-  readBmp180();
+  runScheduler();
+  delay(msUntilNextTask());
+}
+
+/**
+ * recordReading()
+ * ---------------
+ * Closes the current window of every sensor, queues the values that changed
+ * since they were last reported and prints the current snapshot. A sensor
+ * without valid samples in the window keeps its last value.
+ */
+void recordReading() {
+  for (size_t i = LOOP_START_INDEX; i < SENSOR_COUNT; i++) {
+    if (!windowFlush(windows[i], sensorData[i])) sensorData[i].count = 0;  // Last value again, without new samples
+  }
+
   addReading(sensorData, SENSOR_COUNT);
   echoReadings();
-  delay(LOOP_DELAY_MS);
+
+  if (!firstReadingRecorded) {
+    firstReadingRecorded = true;
+    Serial.print("Boot to first reading ms: ");
+    Serial.println(millis());
+  }
 }
 
 /**
  * readDht11()
  * -----------
- * Reads temperature and humidity from DHT11 sensor.
+ * Reads temperature and humidity from DHT11 sensor, dropping NaN reads and
+ * single-sample spikes.
  */
 void readDht11() {
   float temp = dht.readTemperature();
   float hum = dht.readHumidity();
 
-  if (!isnan(temp)) sensorData[IDX_DHT11_TEMP].value = temp;
-  if (!isnan(hum)) sensorData[IDX_DHT11_HUMID].value = hum;
+  if (!isnan(temp)) {
+    int32_t fixed = toFixed(temp);
+    if (spikeFilterAccept(dhtTempSpike, fixed)) windowAdd(windows[IDX_DHT11_TEMP], fixed);
+  }
+  if (!isnan(hum)) {
+    int32_t fixed = toFixed(hum);
+    if (spikeFilterAccept(dhtHumidSpike, fixed)) windowAdd(windows[IDX_DHT11_HUMID], fixed);
+  }
 }
 
 /**
@@ -147,17 +265,19 @@ void readDht11() {
 void readBh1750() {
   float lux = lightMeter.readLightLevel();
   if (lux >= MIN_VALID_LUX) {
-    sensorData[IDX_BH1750_LUX].value = lux;
+    windowAdd(windows[IDX_BH1750_LUX], toFixed(lux));
   }
 }
 
 /**
  * readWaterSensor()
  * -----------------
- * Reads analog value from water sensor.
+ * Reads analog value from water sensor through a median-of-5 and EMA filter.
  */
 void readWaterSensor() {
-  sensorData[IDX_WATER_ANALOG].value = analogRead(WATERPIN);
+  int32_t raw = toFixed(analogRead(WATERPIN));
+  int32_t smoothed = emaFilterAdd(waterEma, medianFilterAdd(waterMedian, raw));
+  windowAdd(windows[IDX_WATER_ANALOG], smoothed);
 }
 
 /**
@@ -168,8 +288,86 @@ void readWaterSensor() {
 void readBmp180() {
   if (!bmpReady) return;
 
-  sensorData[IDX_BMP180_TEMP].value = bmp.readTemperature();
-  sensorData[IDX_BMP180_PRESSURE].value = bmp.readPressure() / PA_TO_HPA_DIVISOR;
+  windowAdd(windows[IDX_BMP180_TEMP], toFixed(bmp.readTemperature()));
+  windowAdd(windows[IDX_BMP180_PRESSURE], toFixed(bmp.readPressure() / PA_TO_HPA_DIVISOR));
+}
+
+/**
+ * runSleepCycle()
+ * ---------------
+ * One wake of the deep sleep mode: samples every sensor once, buffers the
+ * reading in RTC memory and sleeps. On upload wakes (and after a cold boot)
+ * the buffered readings move to the flash queue and are uploaded first.
+ * The deadband policy is not applied, its state does not survive sleep.
+ */
+void runSleepCycle() {
+  bool resumed = beginSleepCycle(UPLOAD_EVERY_WAKES);
+
+  initSensors(BH1750::ONE_TIME_HIGH_RES_MODE);
+  for (size_t i = LOOP_START_INDEX; i < WATER_BURST_SAMPLES; i++) {
+    readWaterSensor();
+  }
+  readDht11();
+  readBmp180();
+  lightMeter.measurementReady(true);
+  readBh1750();
+
+  SensorData sampled[SENSOR_COUNT];
+  size_t sampledCount = 0;
+  for (size_t i = LOOP_START_INDEX; i < SENSOR_COUNT; i++) {
+    if (windowFlush(windows[i], sensorData[i])) sampled[sampledCount++] = sensorData[i];
+  }
+  storeSleepReading(sampled, sampledCount);
+
+  bool radioOn = isUploadWake();
+  if (radioOn) {
+    uploadSleepReadings(resumed);
+    printSleepStats();
+  }
+
+  enterDeepSleep(SLEEP_PERIOD_MS, radioOn);
+}
+
+/**
+ * uploadSleepReadings(resumed)
+ * ----------------------------
+ * Moves the RTC readings into the flash queue, connects and uploads the
+ * queue within SLEEP_UPLOAD_BUDGET_MS. After a cold boot the WiFiManager
+ * portal may open, so a new station can still be provisioned.
+ *
+ * @param resumed True if the station woke from deep sleep.
+ */
+void uploadSleepReadings(bool resumed) {
+  initReadingQueue();
+  moveSleepReadingsToQueue();
+
+  if (resumed) {
+    if (!connectToSavedWiFi(WIFI_WAKE_TIMEOUT_MS)) return;
+  } else {
+    connectToWiFi();
+  }
+
+  configTime(0, 0, NTP_SERVER);
+  unsigned long start = millis();
+  while (currentEpoch() == EPOCH_UNKNOWN && millis() - start < NTP_SYNC_TIMEOUT_MS) {
+    delay(NTP_POLL_MS);
+  }
+
+  if (deviceId == ERROR_READING_ID) {
+    setupDevice();
+  }
+
+  drainReadings(SLEEP_UPLOAD_BUDGET_MS);
+}
+
+/**
+ * printStats()
+ * ------------
+ * Prints scheduler timing and HTTP client statistics.
+ */
+void printStats() {
+  printTaskStats();
+  printHttpStats();
 }
 
 /**
@@ -185,5 +383,7 @@ void echoReadings() {
     Serial.print(": ");
     Serial.println(sensorData[i].value, FLOAT_DISPLAY_PRECISION);
   }
+  Serial.print("Suppressed values: ");
+  Serial.println(suppressedValueCount());
   Serial.println("------------------------");
 }
@@ -0,0 +1,98 @@
+// ============================================================================
+// File: AllocationCounter.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Replaces the global allocation functions with versions that
+//              count allocations and track the live heap. Each block carries
+//              its size in a header in front of the returned pointer.
+// ============================================================================
+
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <stdlib.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define BLOCK_HEADER_SIZE alignof(std::max_align_t)
+
+// ----------------------------------------------------------------------------
+// Heap State
+// ----------------------------------------------------------------------------
+static std::atomic<uint64_t> allocationCount{ 0 };
+static std::atomic<size_t> liveBytes{ 0 };
+static std::atomic<size_t> baselineBytes{ 0 };
+static std::atomic<size_t> peakBytes{ 0 };
+
+/**
+ * Allocates a block with its size header and records it.
+ */
+static void* countedAllocate(size_t size) {
+  void* block = malloc(size + BLOCK_HEADER_SIZE);
+  if (!block) throw std::bad_alloc();
+  *(size_t*)block = size;
+
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+  size_t peak = peakBytes.load(std::memory_order_relaxed);
+  while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  return (char*)block + BLOCK_HEADER_SIZE;
+}
+
+/**
+ * Releases a block allocated by countedAllocate().
+ */
+static void countedFree(void* pointer) {
+  if (!pointer) return;
+  void* block = (char*)pointer - BLOCK_HEADER_SIZE;
+  liveBytes.fetch_sub(*(size_t*)block, std::memory_order_relaxed);
+  free(block);
+}
+
+// ----------------------------------------------------------------------------
+// Allocation Functions
+// ----------------------------------------------------------------------------
+
+void* operator new(size_t size) {
+  return countedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+  return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  countedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  countedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  countedFree(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+  countedFree(pointer);
+}
+
+// ----------------------------------------------------------------------------
+// Measurement
+// ----------------------------------------------------------------------------
+
+void allocationReset() {
+  size_t live = liveBytes.load(std::memory_order_relaxed);
+  allocationCount.store(0, std::memory_order_relaxed);
+  baselineBytes.store(live, std::memory_order_relaxed);
+  peakBytes.store(live, std::memory_order_relaxed);
+}
+
+AllocationStats allocationStats() {
+  return { allocationCount.load(std::memory_order_relaxed),
+           peakBytes.load(std::memory_order_relaxed) - baselineBytes.load(std::memory_order_relaxed) };
+}
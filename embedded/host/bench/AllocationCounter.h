@@ -0,0 +1,31 @@
+// ============================================================================
+// File: AllocationCounter.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the heap accounting behind the benchmark counters.
+//              Global operator new/delete are replaced, so every allocation
+//              of the process is seen.
+// ============================================================================
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Heap usage since the last allocationReset().
+ */
+struct AllocationStats {
+  uint64_t allocations;
+  size_t peakBytes;  // Highest live heap above the level at the reset
+};
+
+/**
+ * Starts a new measurement at the current live heap.
+ */
+void allocationReset();
+
+/**
+ * Returns the allocations and peak heap since the last reset.
+ */
+AllocationStats allocationStats();
@@ -0,0 +1,87 @@
+// ============================================================================
+// File: ConnectionBenchmark.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Uploads readings through the sensor station's HTTPS client
+//              (ensureConnected, httpPOST) to the local TLS stand-in, once
+//              with a new connection per request as before the keep-alive
+//              client, and once with keep-alive and session resumption.
+//              Reports the latency per reading and the TLS handshakes per
+//              hour at one upload per reading.
+// ============================================================================
+
+#include <benchmark/benchmark.h>
+#include "Client.h"
+#include "TlsStandIn.h"
+#include "WireFormat.h"
+
+extern WiFiClientSecure secureClient;  // The station's connection, defined in Client.cpp
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define DEVICE_ID 7
+#define SENSOR_COUNT 6
+#define READING_INTERVAL_MS 2000UL
+#define MS_PER_HOUR 3600000UL
+#define UPLOADS_PER_HOUR (MS_PER_HOUR / READING_INTERVAL_MS)  // One upload per reading
+
+/**
+ * How the station connects for each upload.
+ */
+enum ConnectionMode {
+  CONNECTION_PER_REQUEST,  // New connection and full handshake per upload (old client)
+  CONNECTION_KEEP_ALIVE,   // One connection for all uploads
+  CONNECTION_RESUMED,      // Server closes after each upload, the station resumes
+};
+
+static const char* const CONNECTION_MODE_NAMES[] = { "per_request", "keep_alive", "resumed" };
+
+// ----------------------------------------------------------------------------
+// Benchmarks
+// ----------------------------------------------------------------------------
+
+/**
+ * One reading uploaded as a binary frame and acknowledged by the stand-in.
+ */
+static void BM_UploadReading(benchmark::State& state) {
+  ConnectionMode mode = (ConnectionMode)state.range(0);
+  TlsStandIn standIn({ mode != CONNECTION_PER_REQUEST, mode == CONNECTION_RESUMED });
+  if (!standIn.ready()) {
+    state.SkipWithError("TLS stand-in did not start");
+    return;
+  }
+  hostSetNetwork(&standIn);
+  secureClient.stop();
+
+  QueuedReading reading = {};
+  reading.capturedAt = 1740000000;
+  reading.count = SENSOR_COUNT;
+  for (int i = 0; i < SENSOR_COUNT; i++) reading.values[i] = { i + 1, 20.0f + i, 19.0f + i, 21.0f + i, 20 };
+
+  uint32_t sequence = 0;
+  unsigned long handshakesBefore = tlsHandshakeCount;
+  for (auto _ : state) {
+    if (mode == CONNECTION_PER_REQUEST) secureClient.stop();
+    size_t length = encodeReadingBatch(httpRequestBody(), HTTP_BODY_CAPACITY, DEVICE_ID, ++sequence, &reading, 1);
+    if (httpPOST(API_READING_BATCH_PATH, length, WIRE_CONTENT_TYPE) != HTTP_STATUS_OK) {
+      state.SkipWithError("Upload failed");
+      break;
+    }
+  }
+  secureClient.stop();
+  hostSetNetwork(nullptr);
+
+  double iterations = (double)std::max<benchmark::IterationCount>(state.iterations(), 1);
+  state.SetLabel(CONNECTION_MODE_NAMES[mode]);
+  state.counters["handshakes/h"] = (tlsHandshakeCount - handshakesBefore) / iterations * UPLOADS_PER_HOUR;
+  state.counters["full/h"] = standIn.fullHandshakes() / iterations * UPLOADS_PER_HOUR;
+  state.counters["resumed/h"] = standIn.resumedHandshakes() / iterations * UPLOADS_PER_HOUR;
+}
+BENCHMARK(BM_UploadReading)
+    ->Arg(CONNECTION_PER_REQUEST)
+    ->Arg(CONNECTION_KEEP_ALIVE)
+    ->Arg(CONNECTION_RESUMED)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,383 @@
+// ============================================================================
+// File: FirmwareBenchmark.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Benchmarks the per-reading and per-rotation hot paths of both
+//              sketches on the host. Besides time, every benchmark reports
+//              heap allocations per iteration and the peak heap it used.
+// ============================================================================
+
+#include <benchmark/benchmark.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include "AllocationCounter.h"
+#include "ReportPolicy.h"
+#include "SensorFilter.h"
+#include "WireFormat.h"
+#include "HttpMessage.h"
+#include "DeviceCache.h"
+#include "LEDManager.h"
+#include "Soundscape.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define SAMPLE_SET_SIZE 64  // Power of two, inputs cycle through the set
+#define SENSOR_COUNT 6
+#define HEARTBEAT_MS 300000UL
+#define READING_INTERVAL_MS 2000UL
+#define HTTP_HEADER_RESERVE 256  // Same split as the request buffer in Client.cpp
+#define HTTP_READ_CHUNK 64       // Socket reads of readResponse()
+#define HTTP_RESPONSE_BUFFER_SIZE 2048
+#define DEVICE_ID 7
+#define VALUE_SCALE 100.0  // JSON values are rounded to 2 decimals, as in Client.cpp
+#define SINGLE_SAMPLE 1
+#define STORM_TEMP 24.0f       // Scene with shimmer and the fastest gradient,
+#define STORM_WATER 1000.0f    // so every frame has work to do
+#define STORM_PRESSURE 980.0f
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+/**
+ * Starts the heap measurement right before the timed loop.
+ */
+static void beginHeapMeasurement() {
+  allocationReset();
+}
+
+/**
+ * Adds allocations per iteration and peak heap to the benchmark output.
+ */
+static void reportHeap(benchmark::State& state) {
+  AllocationStats stats = allocationStats();
+  state.counters["allocs"] = benchmark::Counter((double)stats.allocations, benchmark::Counter::kAvgIterations);
+  state.counters["peak_heap_B"] = (double)stats.peakBytes;
+}
+
+/**
+ * Deterministic pseudo-random value in [low, high).
+ */
+static float sampleValue(uint32_t& seed, float low, float high) {
+  seed = seed * 1664525u + 1013904223u;
+  return low + (high - low) * (seed >> 8) / (float)(1u << 24);
+}
+
+// ----------------------------------------------------------------------------
+// Sensor Station
+// ----------------------------------------------------------------------------
+
+/**
+ * One water sample through median, EMA and window (per sampler tick).
+ */
+static void BM_FilterWaterSample(benchmark::State& state) {
+  MedianFilter median = {};
+  EmaFilter ema = { 2, false, 0 };
+  WindowStats window = {};
+  int32_t samples[SAMPLE_SET_SIZE];
+  uint32_t seed = 1;
+  for (int32_t& sample : samples) sample = (int32_t)sampleValue(seed, 0.0f, 102400.0f);
+
+  size_t i = 0;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    int32_t filtered = emaFilterAdd(ema, medianFilterAdd(median, samples[i++ % SAMPLE_SET_SIZE]));
+    windowAdd(window, filtered);
+    if (window.count == UINT16_MAX) window = {};
+    benchmark::DoNotOptimize(window);
+  }
+  reportHeap(state);
+}
+BENCHMARK(BM_FilterWaterSample);
+
+/**
+ * Deadband selection of a full reading (the policy step of addReading).
+ */
+static void BM_SelectReportedValues(benchmark::State& state) {
+  ReportRule rules[SENSOR_COUNT];
+  for (int i = 0; i < SENSOR_COUNT; i++) rules[i] = { i + 1, 0.5f, 0.02f, HEARTBEAT_MS };
+  initReportPolicy(rules, SENSOR_COUNT);
+
+  SensorData readings[SAMPLE_SET_SIZE][SENSOR_COUNT];
+  uint32_t seed = 2;
+  for (auto& reading : readings) {
+    for (int i = 0; i < SENSOR_COUNT; i++) reading[i] = { i + 1, sampleValue(seed, 19.0f, 23.0f), 0, 0, 1 };
+  }
+
+  SensorData out[SENSOR_COUNT];
+  unsigned long now = 0;
+  size_t i = 0;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    now += READING_INTERVAL_MS;
+    benchmark::DoNotOptimize(selectReportedValues(readings[i++ % SAMPLE_SET_SIZE], SENSOR_COUNT, out, now));
+  }
+  reportHeap(state);
+}
+BENCHMARK(BM_SelectReportedValues);
+
+/**
+ * Fills an upload batch with windowed readings of every sensor.
+ */
+static void fillUploadBatch(QueuedReading readings[], size_t count) {
+  uint32_t seed = 3;
+  for (size_t r = 0; r < count; r++) {
+    readings[r].capturedAt = 1740000000 + r * 2;
+    readings[r].count = SENSOR_COUNT;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+      float mean = sampleValue(seed, 0.0f, 1000.0f);
+      readings[r].values[i] = { i + 1, mean, mean - 1.0f, mean + 1.0f, 20 };
+    }
+  }
+}
+
+/**
+ * Binary frame of an upload batch (the encode step of flushReadings).
+ */
+static void BM_EncodeReadingBatch(benchmark::State& state) {
+  size_t count = state.range(0);
+  QueuedReading readings[QUEUE_CAPACITY] = {};
+  fillUploadBatch(readings, count);
+
+  static uint8_t frame[WIRE_FRAME_MAX_SIZE(QUEUE_CAPACITY)];
+  uint32_t sequence = 0;
+  size_t length = 0;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    length = encodeReadingBatch(frame, sizeof(frame), DEVICE_ID, sequence++, readings, count);
+    benchmark::DoNotOptimize(length);
+  }
+  reportHeap(state);
+  state.SetItemsProcessed(state.iterations() * count);
+  state.counters["bytes/req"] = (double)length;
+}
+BENCHMARK(BM_EncodeReadingBatch)->Arg(1)->Arg(10)->Arg(100);
+
+/**
+ * The JSON body the same batch was uploaded as before the binary format,
+ * built as uploadJsonBatch() does it, without its 5 reading cap. Only the
+ * body size carries over: the host ArduinoJson is a stand-in, so its time
+ * and allocations are not those of the library on the boards.
+ */
+static void BM_EncodeReadingJson(benchmark::State& state) {
+  size_t count = state.range(0);
+  QueuedReading readings[QUEUE_CAPACITY] = {};
+  fillUploadBatch(readings, count);
+
+  JsonDocument doc;
+  std::vector<char> body;
+  size_t length = 0;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    doc.clear();
+    doc["device_id"] = DEVICE_ID;
+    JsonArray batch = doc["readings"].to<JsonArray>();
+
+    for (size_t r = 0; r < count; r++) {
+      JsonObject reading = batch.add<JsonObject>();
+      reading["captured_at"] = readings[r].capturedAt;
+
+      JsonArray values = reading["sensor_data"].to<JsonArray>();
+      for (size_t i = 0; i < readings[r].count; i++) {
+        const SensorData& v = readings[r].values[i];
+        JsonObject obj = values.add<JsonObject>();
+        obj["sensor_id"] = v.sensorId;
+        obj["value"] = round(v.value * VALUE_SCALE) / VALUE_SCALE;
+
+        if (v.count > SINGLE_SAMPLE) {
+          obj["min"] = round(v.min * VALUE_SCALE) / VALUE_SCALE;
+          obj["max"] = round(v.max * VALUE_SCALE) / VALUE_SCALE;
+          obj["count"] = v.count;
+        }
+      }
+    }
+
+    if (body.empty()) body.resize(measureJson(doc) + 1);  // Sized once, like the request buffer
+    length = serializeJson(doc, body.data(), body.size());
+    benchmark::DoNotOptimize(length);
+  }
+  reportHeap(state);
+  state.SetItemsProcessed(state.iterations() * count);
+  state.counters["bytes/req"] = (double)length;
+}
+BENCHMARK(BM_EncodeReadingJson)->Arg(1)->Arg(10)->Arg(100);
+
+/**
+ * A complete binary upload request: frame encoded into the body, headers
+ * rendered in front of it. Reports bytes and TLS records per request.
+ */
+static void BM_RenderUploadRequest(benchmark::State& state) {
+  size_t count = state.range(0);
+  QueuedReading readings[QUEUE_CAPACITY] = {};
+  for (size_t r = 0; r < count; r++) {
+    readings[r].capturedAt = 1740000000 + r * 2;
+    readings[r].count = SENSOR_COUNT;
+    for (int i = 0; i < SENSOR_COUNT; i++) readings[r].values[i] = { i + 1, 21.5f, 21.0f, 22.0f, 20 };
+  }
+
+  static char request[HTTP_HEADER_RESERVE + WIRE_FRAME_MAX_SIZE(QUEUE_CAPACITY)];
+  size_t total = 0;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    size_t bodyLength = encodeReadingBatch((uint8_t*)request + HTTP_HEADER_RESERVE, sizeof(request) - HTTP_HEADER_RESERVE,
+                                           7, 1, readings, count);
+    size_t headerLength = httpRenderRequest(request, HTTP_HEADER_RESERVE, "api.example", "POST",
+                                            "/api/reading-with-sensordata/batch", bodyLength, WIRE_CONTENT_TYPE, "");
+    total = headerLength + bodyLength;
+    benchmark::DoNotOptimize(request);
+  }
+  reportHeap(state);
+  state.counters["bytes/req"] = (double)total;
+  state.counters["records/req"] = (double)httpTlsRecords(total);
+  state.counters["writes/req"] = 1;
+}
+BENCHMARK(BM_RenderUploadRequest)->Arg(1)->Arg(10);
+
+/**
+ * A chunked upload acknowledgement parsed in socket-sized reads.
+ */
+static void BM_ParseChunkedResponse(benchmark::State& state) {
+  const char raw[] = "HTTP/1.1 200 OK\r\nDate: Mon, 17 Feb 2025 10:00:00 GMT\r\nContent-Type: application/json\r\n"
+                     "Transfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n"
+                     "1e\r\n{\"processed\":10,\"sequence\":42}\r\n0\r\n\r\n";
+  static char body[HTTP_RESPONSE_BUFFER_SIZE];
+  HttpResponse response;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    httpResponseBegin(response, body, sizeof(body));
+    for (size_t offset = 0; offset < sizeof(raw) - 1; offset += HTTP_READ_CHUNK) {
+      httpResponseFeed(response, (const uint8_t*)raw + offset, min(sizeof(raw) - 1 - offset, (size_t)HTTP_READ_CHUNK));
+    }
+    benchmark::DoNotOptimize(response.status);
+  }
+  reportHeap(state);
+  state.SetBytesProcessed(state.iterations() * (sizeof(raw) - 1));
+}
+BENCHMARK(BM_ParseChunkedResponse);
+
+// ----------------------------------------------------------------------------
+// Installation
+// ----------------------------------------------------------------------------
+
+// LEDManager.cpp built again with NUM_LEDS=LONG_STRIP_LEDS, see CMakeLists.txt
+void initLEDsLongStrip();
+void setLedSceneLongStrip(float temp, float water, float pressure);
+bool renderLedFrameLongStrip(unsigned long nowMs);
+
+/**
+ * One LED frame of a stormy scene, for the installed strip and a long one.
+ * show() is a counter in the mock, so the time is the render alone.
+ */
+static void BM_RenderFrame(benchmark::State& state) {
+  bool longStrip = state.range(0) == LONG_STRIP_LEDS;
+  hostSetMillis(0);
+  longStrip ? initLEDsLongStrip() : initLEDs();
+  longStrip ? setLedSceneLongStrip(STORM_TEMP, STORM_WATER, STORM_PRESSURE)
+            : setLedScene(STORM_TEMP, STORM_WATER, STORM_PRESSURE);
+
+  unsigned long now = 0;
+  unsigned long showsBefore = FastLED.hostShowCount();
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    now += LED_FRAME_MS;
+    benchmark::DoNotOptimize(longStrip ? renderLedFrameLongStrip(now) : renderLedFrame(now));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["shows/frame"] =
+      benchmark::Counter((double)(FastLED.hostShowCount() - showsBefore), benchmark::Counter::kAvgIterations);
+  reportHeap(state);
+}
+BENCHMARK(BM_RenderFrame)->Arg(NUM_LEDS)->Arg(LONG_STRIP_LEDS);
+
+/**
+ * Reading the shown device from the cache (replaces the per-rotation
+ * request of getLatestReadingForCurrentDevice).
+ */
+static void BM_DeviceCacheRotation(benchmark::State& state) {
+  uint32_t seed = 4;
+  for (int32_t id = 1; id <= DEVICE_CACHE_CAPACITY; id++) {
+    CachedDevice* entry = deviceCacheUpsert(id * 3, 0);
+    deviceCacheBeginUpdate(entry, id, 1740000000);
+    for (int sensor = 1; sensor <= DEVICE_CACHE_SENSORS; sensor++) {
+      deviceCacheSetValue(entry, sensor, sampleValue(seed, 0.0f, 1000.0f));
+    }
+  }
+
+  int32_t id = 0;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    id = id % DEVICE_CACHE_CAPACITY + 1;
+    const CachedDevice* entry = deviceCacheFind(id * 3);
+    float sum = 0;
+    for (int sensor = 1; sensor <= DEVICE_CACHE_SENSORS; sensor++) sum += deviceCacheValue(entry, sensor, 0.0f);
+    benchmark::DoNotOptimize(sum);
+  }
+  reportHeap(state);
+}
+BENCHMARK(BM_DeviceCacheRotation);
+
+/**
+ * Applying one device of a fleet snapshot to the cache.
+ */
+static void BM_DeviceCacheApplySnapshot(benchmark::State& state) {
+  float values[SAMPLE_SET_SIZE];
+  uint32_t seed = 5;
+  for (float& value : values) value = sampleValue(seed, 0.0f, 1000.0f);
+
+  uint32_t readingId = 0;
+  unsigned long now = 0;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    readingId++;
+    CachedDevice* entry = deviceCacheUpsert(readingId % DEVICE_CACHE_CAPACITY, now++);
+    if (deviceCacheBeginUpdate(entry, readingId, 1740000000 + readingId)) {
+      for (int sensor = 1; sensor <= DEVICE_CACHE_SENSORS; sensor++) {
+        deviceCacheSetValue(entry, sensor, values[(readingId + sensor) % SAMPLE_SET_SIZE]);
+      }
+    }
+  }
+  reportHeap(state);
+}
+BENCHMARK(BM_DeviceCacheApplySnapshot);
+
+/**
+ * Track selection with the built-in rules (replaces playBasedOnSensorData).
+ */
+static void BM_SoundscapeSelect(benchmark::State& state) {
+  static SoundscapeTable table;
+  soundscapeLoadDefaults(table);
+
+  float inputs[SAMPLE_SET_SIZE][SOUND_INPUT_COUNT];
+  uint32_t seed = 6;
+  for (auto& input : inputs) {
+    input[SOUND_INPUT_TEMP] = sampleValue(seed, -10.0f, 40.0f);
+    input[SOUND_INPUT_HUM] = sampleValue(seed, 0.0f, 100.0f);
+    input[SOUND_INPUT_LUX] = sampleValue(seed, 0.0f, 2000.0f);
+    input[SOUND_INPUT_WATER] = sampleValue(seed, 0.0f, 1024.0f);
+    input[SOUND_INPUT_PRESSURE] = sampleValue(seed, 960.0f, 1040.0f);
+  }
+
+  size_t i = 0;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(soundscapeSelect(table, inputs[i++ % SAMPLE_SET_SIZE]));
+  }
+  reportHeap(state);
+}
+BENCHMARK(BM_SoundscapeSelect);
+
+/**
+ * Compiling the built-in rules (done once per soundscape table change).
+ */
+static void BM_SoundscapeCompileDefaults(benchmark::State& state) {
+  static SoundscapeTable table;
+  beginHeapMeasurement();
+  for (auto _ : state) {
+    soundscapeLoadDefaults(table);
+    benchmark::DoNotOptimize(table);
+  }
+  reportHeap(state);
+}
+BENCHMARK(BM_SoundscapeCompileDefaults);
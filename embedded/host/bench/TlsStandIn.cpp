@@ -0,0 +1,287 @@
+// ============================================================================
+// File: TlsStandIn.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the TLS stand-in for the API. The server signs a
+//              throwaway certificate at start-up and handles one
+//              connection at a time, which is all a station opens.
+// ============================================================================
+
+#include "TlsStandIn.h"
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define NO_BYTE -1
+#define READ_CHUNK 4096
+#define CLIENT_WAIT_MS 1     // available() waits this long for a record
+#define SERVER_WAIT_MS 50    // Server checks for shutdown this often
+#define CERT_DAYS 1
+#define SECONDS_PER_DAY 86400L
+#define SESSION_ID_CONTEXT "atmos"
+#define HEADER_END "\r\n\r\n"
+#define CONTENT_LENGTH_HEADER "Content-Length: "
+#define ACK_BODY "{\"processed\":1}"
+
+// ----------------------------------------------------------------------------
+// Client Side
+// ----------------------------------------------------------------------------
+
+/**
+ * OpenSSL session kept in the station's BearSSL::Session.
+ */
+class OpenSslSessionState : public HostSessionState {
+public:
+  explicit OpenSslSessionState(SSL_SESSION* tlsSession) : session(tlsSession) {}
+  ~OpenSslSessionState() override { SSL_SESSION_free(session); }
+
+  SSL_SESSION* session;
+};
+
+/**
+ * Client connection; decrypted bytes are buffered until read.
+ */
+class TlsConnection : public HostConnection {
+public:
+  TlsConnection(SSL* tls, int socketFd) : ssl(tls), fd(socketFd) {}
+
+  ~TlsConnection() override {
+    SSL_shutdown(ssl);  // Without it OpenSSL marks the session not resumable
+    SSL_free(ssl);
+    close(fd);
+  }
+
+  bool connected() override {
+    if (inbox.empty()) fill(0);
+    return open || !inbox.empty();
+  }
+
+  int available() override {
+    if (inbox.empty()) fill(CLIENT_WAIT_MS);
+    return (int)inbox.size();
+  }
+
+  int read(uint8_t* buffer, size_t size) override {
+    if (inbox.empty()) fill(0);
+    size_t count = std::min(size, inbox.size());
+    if (count == 0) return NO_BYTE;
+    memcpy(buffer, inbox.data(), count);
+    inbox.erase(0, count);
+    return (int)count;
+  }
+
+  int peek() override {
+    if (inbox.empty()) fill(0);
+    return inbox.empty() ? NO_BYTE : (uint8_t)inbox[0];
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    if (!open) return 0;
+    return SSL_write(ssl, buffer, (int)size) == (int)size ? size : 0;
+  }
+
+private:
+  /**
+   * Decrypts the next record if one arrives within waitMs.
+   */
+  void fill(int waitMs) {
+    if (!open) return;
+    if (SSL_pending(ssl) == 0) {
+      pollfd entry = { fd, POLLIN, 0 };
+      if (poll(&entry, 1, waitMs) <= 0) return;
+    }
+
+    char chunk[READ_CHUNK];
+    int count = SSL_read(ssl, chunk, sizeof(chunk));
+    if (count > 0) {
+      inbox.append(chunk, count);
+    } else if (SSL_get_error(ssl, count) != SSL_ERROR_WANT_READ) {
+      open = false;
+    }
+  }
+
+  SSL* ssl;
+  int fd;
+  bool open = true;
+  std::string inbox;
+};
+
+// ----------------------------------------------------------------------------
+// Setup
+// ----------------------------------------------------------------------------
+
+/**
+ * Puts a fresh P-256 key and a self-signed certificate on the context.
+ */
+static bool useThrowawayCertificate(SSL_CTX* context) {
+  EVP_PKEY* key = EVP_EC_gen("P-256");
+  X509* cert = X509_new();
+  bool ok = key && cert;
+  if (ok) {
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), CERT_DAYS * SECONDS_PER_DAY);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    ok = X509_sign(cert, key, EVP_sha256()) > 0 && SSL_CTX_use_certificate(context, cert) == 1 &&
+         SSL_CTX_use_PrivateKey(context, key) == 1;
+  }
+  X509_free(cert);
+  EVP_PKEY_free(key);
+  return ok;
+}
+
+static void disableNagle(int fd) {
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+TlsStandIn::TlsStandIn(const TlsStandInOptions& standInOptions) : options(standInOptions) {
+  signal(SIGPIPE, SIG_IGN);  // A peer may close before close_notify is sent
+  serverContext = SSL_CTX_new(TLS_server_method());
+  clientContext = SSL_CTX_new(TLS_client_method());
+  if (!serverContext || !clientContext || !useThrowawayCertificate(serverContext)) return;
+
+  SSL_CTX_set_max_proto_version(serverContext, TLS1_2_VERSION);
+  SSL_CTX_set_options(serverContext, SSL_OP_NO_TICKET);  // BearSSL resumes by session ID
+  SSL_CTX_set_session_cache_mode(serverContext, options.resumption ? SSL_SESS_CACHE_SERVER : SSL_SESS_CACHE_OFF);
+  SSL_CTX_set_session_id_context(serverContext, (const unsigned char*)SESSION_ID_CONTEXT, strlen(SESSION_ID_CONTEXT));
+
+  SSL_CTX_set_max_proto_version(clientContext, TLS1_2_VERSION);
+  SSL_CTX_set_verify(clientContext, SSL_VERIFY_NONE, nullptr);  // setInsecure()
+  SSL_CTX_set_session_cache_mode(clientContext, SSL_SESS_CACHE_OFF);  // The station keeps its session
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  if (fd < 0 || bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 1) != 0 ||
+      getsockname(fd, (sockaddr*)&address, &length) != 0) {
+    if (fd >= 0) close(fd);
+    return;
+  }
+
+  listenFd = fd;
+  listenPort = ntohs(address.sin_port);
+  server = std::thread(&TlsStandIn::serve, this);
+}
+
+TlsStandIn::~TlsStandIn() {
+  stopping = true;
+  if (server.joinable()) server.join();
+  if (listenFd >= 0) close(listenFd);
+  SSL_CTX_free(clientContext);
+  SSL_CTX_free(serverContext);
+}
+
+// ----------------------------------------------------------------------------
+// Client Connections
+// ----------------------------------------------------------------------------
+
+std::unique_ptr<HostConnection> TlsStandIn::connect(const char* host, uint16_t port, BearSSL::Session* session) {
+  (void)host;
+  (void)port;
+  if (!ready()) return nullptr;
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(listenPort);
+  if (fd < 0 || ::connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+    if (fd >= 0) close(fd);
+    return nullptr;
+  }
+  disableNagle(fd);
+
+  SSL* ssl = SSL_new(clientContext);
+  SSL_set_fd(ssl, fd);
+  OpenSslSessionState* cached = session ? dynamic_cast<OpenSslSessionState*>(session->hostState.get()) : nullptr;
+  if (cached) SSL_set_session(ssl, cached->session);
+  if (SSL_connect(ssl) != 1) {
+    SSL_free(ssl);
+    close(fd);
+    return nullptr;
+  }
+
+  SSL_session_reused(ssl) ? resumed++ : full++;
+  if (session) session->hostState = std::make_shared<OpenSslSessionState>(SSL_get1_session(ssl));
+  return std::make_unique<TlsConnection>(ssl, fd);
+}
+
+// ----------------------------------------------------------------------------
+// Server
+// ----------------------------------------------------------------------------
+
+/**
+ * Waits up to SERVER_WAIT_MS for the socket to become readable.
+ */
+static bool waitReadable(int fd) {
+  pollfd entry = { fd, POLLIN, 0 };
+  return poll(&entry, 1, SERVER_WAIT_MS) > 0;
+}
+
+void TlsStandIn::serve() {
+  while (!stopping) {
+    if (!waitReadable(listenFd)) continue;
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) continue;
+    disableNagle(fd);
+    serveConnection(fd);
+    close(fd);
+  }
+}
+
+/**
+ * Answers every complete request with the acknowledgement until the client
+ * closes, the stand-in stops, or the options close after one response.
+ */
+void TlsStandIn::serveConnection(int fd) {
+  SSL* ssl = SSL_new(serverContext);
+  SSL_set_fd(ssl, fd);
+  bool open = SSL_accept(ssl) == 1;
+  std::string pending;
+
+  while (open && !stopping) {
+    if (SSL_pending(ssl) == 0 && !waitReadable(fd)) continue;
+
+    char chunk[READ_CHUNK];
+    int count = SSL_read(ssl, chunk, sizeof(chunk));
+    if (count <= 0) break;
+    pending.append(chunk, count);
+
+    size_t headerEnd = pending.find(HEADER_END);
+    if (headerEnd == std::string::npos) continue;
+    size_t bodyLength = 0;
+    size_t lengthAt = pending.find(CONTENT_LENGTH_HEADER);
+    if (lengthAt != std::string::npos && lengthAt < headerEnd) {
+      bodyLength = strtoul(pending.c_str() + lengthAt + strlen(CONTENT_LENGTH_HEADER), nullptr, 10);
+    }
+    size_t requestLength = headerEnd + strlen(HEADER_END) + bodyLength;
+    if (pending.size() < requestLength) continue;
+    pending.erase(0, requestLength);
+
+    std::string response = std::string("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: ") +
+                           (options.closeAfterResponse ? "close" : "keep-alive") +
+                           "\r\nContent-Length: " + std::to_string(strlen(ACK_BODY)) + HEADER_END + ACK_BODY;
+    open = SSL_write(ssl, response.data(), (int)response.size()) == (int)response.size() && !options.closeAfterResponse;
+  }
+
+  SSL_shutdown(ssl);
+  SSL_free(ssl);
+}
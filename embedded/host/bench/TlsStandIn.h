@@ -0,0 +1,60 @@
+// ============================================================================
+// File: TlsStandIn.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Local stand-in for the API over real TLS, in the manner of
+//              `openssl s_server`. A server thread answers every request
+//              with a batch acknowledgement, and connect() opens OpenSSL
+//              client connections to it for WiFiClientSecure. Like BearSSL
+//              on the stations, both sides stop at TLS 1.2 and resume by
+//              session ID.
+// ============================================================================
+
+#pragma once
+#include <WiFiClientSecure.h>
+#include <openssl/ssl.h>
+#include <atomic>
+#include <thread>
+
+/**
+ * How the stand-in treats connections.
+ */
+struct TlsStandInOptions {
+  bool resumption;          // Server keeps a session cache
+  bool closeAfterResponse;  // Server answers with Connection: close
+};
+
+class TlsStandIn : public HostNetwork {
+public:
+  explicit TlsStandIn(const TlsStandInOptions& options);
+  ~TlsStandIn() override;
+
+  /**
+   * @return True if the server is listening.
+   */
+  bool ready() const { return listenFd >= 0; }
+
+  /**
+   * Opens a TLS connection to the stand-in, whatever host and port are
+   * given, and resumes the session if the server still knows it.
+   */
+  std::unique_ptr<HostConnection> connect(const char* host, uint16_t port, BearSSL::Session* session) override;
+
+  unsigned long fullHandshakes() const { return full; }
+  unsigned long resumedHandshakes() const { return resumed; }
+
+private:
+  void serve();
+  void serveConnection(int fd);
+
+  TlsStandInOptions options;
+  SSL_CTX* serverContext = nullptr;
+  SSL_CTX* clientContext = nullptr;
+  int listenFd = -1;
+  uint16_t listenPort = 0;
+  std::atomic<bool> stopping{ false };
+  std::thread server;
+  unsigned long full = 0;
+  unsigned long resumed = 0;
+};
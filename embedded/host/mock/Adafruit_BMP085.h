@@ -0,0 +1,37 @@
+// ============================================================================
+// File: Adafruit_BMP085.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the Adafruit BMP085/BMP180 library. Every
+//              sensor reports the values set with hostSetReading().
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+#define BMP085_ULTRAHIGHRES 3
+
+class TwoWire;
+
+class Adafruit_BMP085 {
+public:
+  bool begin(uint8_t mode = BMP085_ULTRAHIGHRES, TwoWire* wire = nullptr) {
+    (void)mode;
+    (void)wire;
+    return hostPresent;
+  }
+  float readTemperature() { return hostTemperature; }
+  int32_t readPressure() { return hostPressurePa; }
+
+  static void hostSetReading(float temperature, int32_t pressurePa) {
+    hostTemperature = temperature;
+    hostPressurePa = pressurePa;
+  }
+  static void hostSetPresent(bool present) { hostPresent = present; }
+
+private:
+  static inline float hostTemperature = 0;
+  static inline int32_t hostPressurePa = 0;
+  static inline bool hostPresent = true;
+};
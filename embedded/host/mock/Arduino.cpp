@@ -0,0 +1,271 @@
+// ============================================================================
+// File: Arduino.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the host stand-in for the Arduino core.
+// ============================================================================
+
+#include "Arduino.h"
+#include <stdarg.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define PRINTF_BUFFER_SIZE 512
+#define NUMBER_BUFFER_SIZE 40
+#define MICROS_PER_MILLI 1000UL
+#define RTC_BLOCK_SIZE 4
+#define HOST_WAIT_MS 1
+
+// ----------------------------------------------------------------------------
+// Timing
+// ----------------------------------------------------------------------------
+static unsigned long clockMs = 0;
+
+unsigned long millis() {
+  return clockMs;
+}
+
+unsigned long micros() {
+  return clockMs * MICROS_PER_MILLI;
+}
+
+void delay(unsigned long ms) {
+  clockMs += ms;
+}
+
+void yield() {}
+
+void hostSetMillis(unsigned long ms) {
+  clockMs = ms;
+}
+
+void hostAdvanceMillis(unsigned long ms) {
+  clockMs += ms;
+}
+
+static const char* ntpServer = nullptr;
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2,
+                const char* server3) {
+  (void)gmtOffsetSec; (void)daylightOffsetSec; (void)server2; (void)server3;
+  ntpServer = server1;
+}
+
+const char* hostNtpServer() {
+  return ntpServer;
+}
+
+#if defined(__GLIBC__) && __GLIBC__ == 2 && __GLIBC_MINOR__ < 38
+size_t strlcpy(char* destination, const char* source, size_t size) {
+  size_t length = strlen(source);
+  if (size > 0) {
+    size_t copied = min(length, size - 1);
+    memcpy(destination, source, copied);
+    destination[copied] = '\0';
+  }
+  return length;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// GPIO
+// ----------------------------------------------------------------------------
+static uint8_t pinModes[HOST_PIN_COUNT];
+static int pinValues[HOST_PIN_COUNT];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < HOST_PIN_COUNT) pinModes[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < HOST_PIN_COUNT) pinValues[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < HOST_PIN_COUNT ? pinValues[pin] : LOW;
+}
+
+int analogRead(uint8_t pin) {
+  return pin < HOST_PIN_COUNT ? pinValues[pin] : 0;
+}
+
+void hostSetAnalog(uint8_t pin, int value) {
+  if (pin < HOST_PIN_COUNT) pinValues[pin] = value;
+}
+
+uint8_t hostPinMode(uint8_t pin) {
+  return pin < HOST_PIN_COUNT ? pinModes[pin] : INPUT;
+}
+
+// ----------------------------------------------------------------------------
+// String
+// ----------------------------------------------------------------------------
+
+/**
+ * Formats a floating point number with a fixed number of decimals.
+ */
+static std::string formatDecimal(double number, unsigned int decimals) {
+  char buffer[NUMBER_BUFFER_SIZE];
+  snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, number);
+  return buffer;
+}
+
+String::String(float number, unsigned int decimals) : value(formatDecimal(number, decimals)) {}
+
+String::String(double number, unsigned int decimals) : value(formatDecimal(number, decimals)) {}
+
+int String::indexOf(char c, size_t from) const {
+  size_t found = value.find(c, from);
+  return found == std::string::npos ? -1 : (int)found;
+}
+
+int String::indexOf(const char* text, size_t from) const {
+  size_t found = value.find(text, from);
+  return found == std::string::npos ? -1 : (int)found;
+}
+
+String String::substring(size_t from, size_t to) const {
+  if (from >= value.size()) return String();
+  return String(value.substr(from, to == std::string::npos ? to : to - from));
+}
+
+void String::trim() {
+  size_t start = value.find_first_not_of(" \t\r\n");
+  size_t end = value.find_last_not_of(" \t\r\n");
+  value = start == std::string::npos ? "" : value.substr(start, end - start + 1);
+}
+
+void String::toLowerCase() {
+  for (char& c : value) c = (char)tolower((unsigned char)c);
+}
+
+// ----------------------------------------------------------------------------
+// Print
+// ----------------------------------------------------------------------------
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while (written < size && write(buffer[written])) written++;
+  return written;
+}
+
+size_t Print::print(long number, int base) {
+  char buffer[NUMBER_BUFFER_SIZE];
+  snprintf(buffer, sizeof(buffer), base == HEX ? "%lx" : "%ld", number);
+  return write(buffer);
+}
+
+size_t Print::print(unsigned long number, int base) {
+  char buffer[NUMBER_BUFFER_SIZE];
+  snprintf(buffer, sizeof(buffer), base == HEX ? "%lx" : "%lu", number);
+  return write(buffer);
+}
+
+size_t Print::print(double number, int decimals) {
+  return write(formatDecimal(number, decimals).c_str());
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buffer[PRINTF_BUFFER_SIZE];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  return length > 0 ? write((const uint8_t*)buffer, min((size_t)length, sizeof(buffer) - 1)) : 0;
+}
+
+// ----------------------------------------------------------------------------
+// Stream
+// ----------------------------------------------------------------------------
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  for (;;) {
+    int c = read();
+    if (c >= 0) return c;
+    if (millis() - start >= timeout) return -1;
+    delay(HOST_WAIT_MS);
+  }
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t size) {
+  size_t count = 0;
+  while (count < size) {
+    int c = timedRead();
+    if (c < 0) break;
+    buffer[count++] = (uint8_t)c;
+  }
+  return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+  std::string text;
+  int c = timedRead();
+  while (c >= 0 && c != terminator) {
+    text += (char)c;
+    c = timedRead();
+  }
+  return String(text);
+}
+
+// ----------------------------------------------------------------------------
+// HardwareSerial
+// ----------------------------------------------------------------------------
+
+int HardwareSerial::read() {
+  if (rx.empty()) return -1;
+  uint8_t value = rx.front();
+  rx.pop_front();
+  return value;
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+  return write(&value, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (output == HOST_SERIAL_STDOUT) {
+    fwrite(buffer, 1, size, stdout);
+  } else if (output == HOST_SERIAL_CAPTURE) {
+    tx.insert(tx.end(), buffer, buffer + size);
+  }
+  return size;
+}
+
+HardwareSerial Serial(getenv("ATMOS_HOST_SERIAL") ? HOST_SERIAL_STDOUT : HOST_SERIAL_DISCARD);
+
+// ----------------------------------------------------------------------------
+// ESP
+// ----------------------------------------------------------------------------
+
+void EspClass::deepSleep(uint64_t timeUs, RFMode mode) {
+  deepSleeps++;
+  lastSleepUs = timeUs;
+  lastSleepMode = mode;
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+  size_t start = (size_t)offset * RTC_BLOCK_SIZE;
+  if (start + size > sizeof(rtcMemory)) return false;
+  memcpy(data, rtcMemory + start, size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+  size_t start = (size_t)offset * RTC_BLOCK_SIZE;
+  if (start + size > sizeof(rtcMemory)) return false;
+  memcpy(rtcMemory + start, data, size);
+  return true;
+}
+
+void EspClass::hostReset() {
+  *this = EspClass();
+}
+
+EspClass ESP;
+
+uint32_t esp_get_free_heap_size() {
+  return ESP.getFreeHeap();
+}
@@ -0,0 +1,349 @@
+// ============================================================================
+// File: Arduino.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the Arduino core. Provides the subset the
+//              firmware uses (String, Stream, Serial, HardwareSerial, GPIO,
+//              the ESP class, timing and math helpers) on top of the C++
+//              standard library, with a clock the tests advance by hand. Like
+//              the ESP32 core it pulls in FreeRTOS.
+// ============================================================================
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define SERIAL_8N1 0
+#define DEC 10
+#define HEX 16
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define A0 17  // ESP8266 ADC pin
+#define HOST_PIN_COUNT 40
+
+#if defined(__GLIBC__) && __GLIBC__ == 2 && __GLIBC_MINOR__ < 38
+size_t strlcpy(char* destination, const char* source, size_t size);  // Both ESP cores provide it
+#endif
+
+// ----------------------------------------------------------------------------
+// Timing
+// ----------------------------------------------------------------------------
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+/**
+ * Sets the value millis() returns; micros() follows at 1000x.
+ */
+void hostSetMillis(unsigned long ms);
+
+/**
+ * Moves the clock forward.
+ */
+void hostAdvanceMillis(unsigned long ms);
+
+/**
+ * Starts SNTP on the boards. On the host the system clock is already set,
+ * so only the server is kept.
+ */
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2 = nullptr,
+                const char* server3 = nullptr);
+
+/**
+ * Server passed to the last configTime() call, or nullptr.
+ */
+const char* hostNtpServer();
+
+// ----------------------------------------------------------------------------
+// GPIO
+// ----------------------------------------------------------------------------
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+/**
+ * Sets the value analogRead() returns for a pin.
+ */
+void hostSetAnalog(uint8_t pin, int value);
+
+/**
+ * Mode set by the last pinMode() call for a pin.
+ */
+uint8_t hostPinMode(uint8_t pin);
+
+// ----------------------------------------------------------------------------
+// String
+// ----------------------------------------------------------------------------
+
+/**
+ * Arduino String on top of std::string.
+ */
+class String {
+public:
+  String() {}
+  String(const char* text) : value(text ? text : "") {}
+  String(const std::string& text) : value(text) {}
+  String(char c) : value(1, c) {}
+  String(int number) : value(std::to_string(number)) {}
+  String(unsigned int number) : value(std::to_string(number)) {}
+  String(long number) : value(std::to_string(number)) {}
+  String(unsigned long number) : value(std::to_string(number)) {}
+  String(float number, unsigned int decimals = 2);
+  String(double number, unsigned int decimals = 2);
+
+  size_t length() const { return value.size(); }
+  const char* c_str() const { return value.c_str(); }
+  bool isEmpty() const { return value.empty(); }
+  void reserve(size_t size) { value.reserve(size); }
+  char operator[](size_t index) const { return index < value.size() ? value[index] : 0; }
+
+  int indexOf(char c, size_t from = 0) const;
+  int indexOf(const char* text, size_t from = 0) const;
+  bool startsWith(const char* text) const { return value.compare(0, strlen(text), text) == 0; }
+  String substring(size_t from, size_t to = std::string::npos) const;
+  void trim();
+  void toLowerCase();
+  long toInt() const { return strtol(value.c_str(), nullptr, DEC); }
+  float toFloat() const { return strtof(value.c_str(), nullptr); }
+
+  String& operator+=(const String& other) { value += other.value; return *this; }
+  String& operator+=(const char* text) { value += text; return *this; }
+  String& operator+=(char c) { value += c; return *this; }
+  bool operator==(const String& other) const { return value == other.value; }
+  bool operator==(const char* text) const { return value == text; }
+  bool operator!=(const String& other) const { return value != other.value; }
+  bool operator!=(const char* text) const { return value != text; }
+  friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+
+private:
+  std::string value;
+};
+
+// ----------------------------------------------------------------------------
+// Print & Stream
+// ----------------------------------------------------------------------------
+
+class Print;
+
+/**
+ * Value that knows how to print itself, such as an IPAddress.
+ */
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print& out) const = 0;
+};
+
+/**
+ * Print base.
+ */
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+
+  size_t print(const char* text) { return write(text); }
+  size_t print(const String& text) { return write(text.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int number, int base = DEC) { return print((long)number, base); }
+  size_t print(unsigned int number, int base = DEC) { return print((unsigned long)number, base); }
+  size_t print(long number, int base = DEC);
+  size_t print(unsigned long number, int base = DEC);
+  size_t print(double number, int decimals = 2);
+  size_t print(const Printable& value) { return value.printTo(*this); }
+
+  template <typename T>
+  size_t println(T value) { size_t n = print(value); return n + println(); }
+  template <typename T>
+  size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+  size_t println() { return write("\r\n"); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+/**
+ * Readable byte source with a timeout for the blocking reads.
+ */
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long ms) { timeout = ms; }
+  unsigned long getTimeout() const { return timeout; }
+  size_t readBytes(uint8_t* buffer, size_t size);
+
+  /**
+   * Reads up to the terminator, which is consumed but not returned, or
+   * until no byte arrived for the timeout.
+   */
+  String readStringUntil(char terminator);
+
+protected:
+  /**
+   * Waits for a byte; on the host the clock advances while waiting.
+   *
+   * @return The byte, or -1 on timeout.
+   */
+  int timedRead();
+
+  unsigned long timeout = 1000;
+};
+
+// ----------------------------------------------------------------------------
+// Serial
+// ----------------------------------------------------------------------------
+
+/**
+ * Where a HardwareSerial sends what the firmware writes.
+ */
+enum HostSerialOutput {
+  HOST_SERIAL_CAPTURE,  // Collected in written()
+  HOST_SERIAL_STDOUT,
+  HOST_SERIAL_DISCARD
+};
+
+/**
+ * UART with scripted input: bytes queued by hostFeed() are returned by
+ * read(). The debug Serial discards its output unless ATMOS_HOST_SERIAL is
+ * set in the environment.
+ */
+class HardwareSerial : public Stream {
+public:
+  explicit HardwareSerial(HostSerialOutput mode = HOST_SERIAL_CAPTURE) : output(mode) {}
+  explicit HardwareSerial(int uart) : output(HOST_SERIAL_CAPTURE) { (void)uart; }  // ESP32 UART number
+
+  void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int rx = -1, int tx = -1) {
+    (void)baud; (void)config; (void)rx; (void)tx;
+  }
+  int available() override { return (int)rx.size(); }
+  int read() override;
+  int peek() override { return rx.empty() ? -1 : rx.front(); }
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  /**
+   * Queues bytes the firmware will read.
+   */
+  void hostFeed(const uint8_t* buffer, size_t size) { rx.insert(rx.end(), buffer, buffer + size); }
+
+  /**
+   * Bytes the firmware wrote since the last hostClearWritten().
+   */
+  const std::vector<uint8_t>& written() const { return tx; }
+  void hostClearWritten() { tx.clear(); }
+
+private:
+  HostSerialOutput output;
+  std::deque<uint8_t> rx;
+  std::vector<uint8_t> tx;
+};
+
+extern HardwareSerial Serial;
+
+// ----------------------------------------------------------------------------
+// ESP
+// ----------------------------------------------------------------------------
+#define REASON_DEFAULT_RST 0
+#define REASON_DEEP_SLEEP_AWAKE 5
+#define HOST_RTC_USER_MEMORY_SIZE 512
+#define HOST_FREE_HEAP 160000
+
+/**
+ * Why the chip (re)started, as reported by the ESP8266 SDK.
+ */
+struct rst_info {
+  uint32_t reason;
+};
+
+/**
+ * Radio state after deep sleep.
+ */
+enum RFMode {
+  RF_DEFAULT = 0,
+  RF_CAL = 1,
+  RF_NO_CAL = 2,
+  RF_DISABLED = 4
+};
+
+#define WAKE_RF_DEFAULT RF_DEFAULT
+#define WAKE_RF_DISABLED RF_DISABLED
+
+/**
+ * Chip functions of both cores. Restarts and deep sleep are recorded and
+ * return, RTC user memory keeps its content until hostReset().
+ */
+class EspClass {
+public:
+  uint32_t getFreeHeap() const { return freeHeap; }
+  uint32_t getMaxFreeBlockSize() const { return freeHeap; }
+  uint8_t getHeapFragmentation() const { return 0; }
+  uint32_t getMaxAllocHeap() const { return freeHeap; }
+  uint32_t getMinFreeHeap() const { return freeHeap; }
+
+  void restart() { restarts++; }
+  void deepSleep(uint64_t timeUs, RFMode mode = RF_DEFAULT);
+  bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+  bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+  rst_info* getResetInfoPtr() { return &resetInfo; }
+
+  /**
+   * Sets the reset reason the next boot reports.
+   */
+  void hostSetResetReason(uint32_t reason) { resetInfo.reason = reason; }
+  void hostSetFreeHeap(uint32_t bytes) { freeHeap = bytes; }
+
+  unsigned long hostRestartCount() const { return restarts; }
+  unsigned long hostDeepSleepCount() const { return deepSleeps; }
+  uint64_t hostLastDeepSleepUs() const { return lastSleepUs; }
+  RFMode hostLastDeepSleepMode() const { return lastSleepMode; }
+
+  /**
+   * Clears RTC memory and the counters, as a power cycle does.
+   */
+  void hostReset();
+
+private:
+  uint8_t rtcMemory[HOST_RTC_USER_MEMORY_SIZE] = {};
+  rst_info resetInfo = { REASON_DEFAULT_RST };
+  uint32_t freeHeap = HOST_FREE_HEAP;
+  unsigned long restarts = 0;
+  unsigned long deepSleeps = 0;
+  uint64_t lastSleepUs = 0;
+  RFMode lastSleepMode = RF_DEFAULT;
+};
+
+extern EspClass ESP;
+
+/**
+ * ESP-IDF name of ESP.getFreeHeap().
+ */
+uint32_t esp_get_free_heap_size();
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
@@ -0,0 +1,453 @@
+// ============================================================================
+// File: ArduinoJson.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements parsing and serializing for the host stand-in of
+//              ArduinoJson 7.
+// ============================================================================
+
+#include "ArduinoJson.h"
+#include <ctype.h>
+#include <errno.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define NO_CHARACTER -1
+#define NESTING_LIMIT 10  // ARDUINOJSON_DEFAULT_NESTING_LIMIT
+#define HEX_BASE 16
+#define DECIMAL_BASE 10
+#define UNICODE_ESCAPE_DIGITS 4
+#define NUMBER_BUFFER_SIZE 32
+#define MAX_EXACT_INTEGER 1e15  // Larger floats are printed in exponent notation
+
+// ----------------------------------------------------------------------------
+// Input Sources
+// ----------------------------------------------------------------------------
+
+/**
+ * Characters of the input, consumed one at a time.
+ */
+class JsonSource {
+public:
+  virtual ~JsonSource() {}
+  virtual int peek() = 0;
+  virtual int next() = 0;
+};
+
+/**
+ * Text in memory, up to size characters or the first NUL.
+ */
+class TextSource : public JsonSource {
+public:
+  TextSource(const char* input, size_t size) : position(input), end(input + size) {}
+
+  int peek() override { return position < end && *position ? (uint8_t)*position : NO_CHARACTER; }
+  int next() override {
+    int c = peek();
+    if (c != NO_CHARACTER) position++;
+    return c;
+  }
+
+private:
+  const char* position;
+  const char* end;
+};
+
+/**
+ * Stream, waiting up to its timeout for each character. Only the value
+ * itself is consumed.
+ */
+class StreamSource : public JsonSource {
+public:
+  explicit StreamSource(Stream& input) : stream(input) {}
+
+  int peek() override {
+    unsigned long start = millis();
+    int c = stream.peek();
+    while (c == NO_CHARACTER && millis() - start < stream.getTimeout()) {
+      delay(1);
+      c = stream.peek();
+    }
+    return c;
+  }
+
+  int next() override {
+    int c = peek();
+    if (c != NO_CHARACTER) stream.read();
+    return c;
+  }
+
+private:
+  Stream& stream;
+};
+
+// ----------------------------------------------------------------------------
+// Parser
+// ----------------------------------------------------------------------------
+
+typedef DeserializationError::Code Code;
+
+/**
+ * What the filter says about a value: whether it is kept and, for objects
+ * and arrays, the filter for its content (nullptr keeps everything).
+ */
+struct FilterRule {
+  bool keep;
+  const JsonNode* filter;
+};
+
+/**
+ * Rule for a value the filter node applies to.
+ */
+static FilterRule ruleFor(const JsonNode* filter) {
+  if (!filter) return { true, nullptr };
+  if (filter->type == JSON_BOOLEAN) return { filter->boolean, nullptr };
+  return { filter->type == JSON_OBJECT || filter->type == JSON_ARRAY, filter };
+}
+
+static int skipSpace(JsonSource& source) {
+  while (isspace(source.peek())) source.next();
+  return source.peek();
+}
+
+static Code parseValue(JsonSource& source, JsonNode* out, const JsonNode* filter, int depth);
+
+/**
+ * Appends a code point as UTF-8.
+ */
+static void appendUtf8(std::string& text, unsigned long codePoint) {
+  if (codePoint < 0x80) {
+    text += (char)codePoint;
+  } else if (codePoint < 0x800) {
+    text += (char)(0xC0 | (codePoint >> 6));
+    text += (char)(0x80 | (codePoint & 0x3F));
+  } else {
+    text += (char)(0xE0 | (codePoint >> 12));
+    text += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+    text += (char)(0x80 | (codePoint & 0x3F));
+  }
+}
+
+static Code parseString(JsonSource& source, std::string& text) {
+  source.next();  // Opening quote
+  for (;;) {
+    int c = source.next();
+    if (c == NO_CHARACTER) return DeserializationError::IncompleteInput;
+    if (c == '"') return DeserializationError::Ok;
+    if (c != '\\') {
+      text += (char)c;
+      continue;
+    }
+
+    c = source.next();
+    switch (c) {
+      case '"': case '\\': case '/': text += (char)c; break;
+      case 'b': text += '\b'; break;
+      case 'f': text += '\f'; break;
+      case 'n': text += '\n'; break;
+      case 'r': text += '\r'; break;
+      case 't': text += '\t'; break;
+      case 'u': {
+        char digits[UNICODE_ESCAPE_DIGITS + 1] = {};
+        for (int i = 0; i < UNICODE_ESCAPE_DIGITS; i++) {
+          int digit = source.next();
+          if (digit == NO_CHARACTER) return DeserializationError::IncompleteInput;
+          if (!isxdigit(digit)) return DeserializationError::InvalidInput;
+          digits[i] = (char)digit;
+        }
+        appendUtf8(text, strtoul(digits, nullptr, HEX_BASE));
+        break;
+      }
+      case NO_CHARACTER: return DeserializationError::IncompleteInput;
+      default: return DeserializationError::InvalidInput;
+    }
+  }
+}
+
+static Code parseNumber(JsonSource& source, JsonNode* out) {
+  std::string text;
+  bool isFloat = false;
+  for (int c = source.peek(); c != NO_CHARACTER && (isdigit(c) || strchr("+-.eE", c)); c = source.peek()) {
+    if (!isdigit(c) && c != '-') isFloat = true;
+    text += (char)source.next();
+  }
+
+  char* end;
+  if (!isFloat) {
+    errno = 0;
+    long long integer = strtoll(text.c_str(), &end, DECIMAL_BASE);
+    if (*end || text.empty()) return DeserializationError::InvalidInput;
+    if (errno != ERANGE) {
+      if (out) {
+        out->reset(JSON_INTEGER);
+        out->integer = integer;
+      }
+      return DeserializationError::Ok;
+    }
+  }
+
+  double number = strtod(text.c_str(), &end);
+  if (*end || text.empty()) return DeserializationError::InvalidInput;
+  if (out) {
+    out->reset(JSON_FLOAT);
+    out->number = number;
+  }
+  return DeserializationError::Ok;
+}
+
+static Code parseLiteral(JsonSource& source, JsonNode* out) {
+  static const char* const literals[] = { "true", "false", "null" };
+  for (const char* literal : literals) {
+    if (source.peek() != literal[0]) continue;
+    for (const char* expected = literal; *expected; expected++) {
+      int c = source.next();
+      if (c == NO_CHARACTER) return DeserializationError::IncompleteInput;
+      if (c != *expected) return DeserializationError::InvalidInput;
+    }
+    if (out) {
+      out->reset(literal[0] == 'n' ? JSON_NULL : JSON_BOOLEAN);
+      out->boolean = literal[0] == 't';
+    }
+    return DeserializationError::Ok;
+  }
+  return DeserializationError::InvalidInput;
+}
+
+static Code parseObject(JsonSource& source, JsonNode* out, const JsonNode* filter, int depth) {
+  source.next();  // Opening brace
+  if (out) out->reset(JSON_OBJECT);
+
+  if (skipSpace(source) == '}') {
+    source.next();
+    return DeserializationError::Ok;
+  }
+
+  for (;;) {
+    int c = skipSpace(source);
+    if (c == NO_CHARACTER) return DeserializationError::IncompleteInput;
+    if (c != '"') return DeserializationError::InvalidInput;
+
+    std::string key;
+    Code result = parseString(source, key);
+    if (result != DeserializationError::Ok) return result;
+
+    c = skipSpace(source);
+    if (c == NO_CHARACTER) return DeserializationError::IncompleteInput;
+    if (c != ':') return DeserializationError::InvalidInput;
+    source.next();
+
+    FilterRule rule = { true, nullptr };
+    if (filter) rule = filter->type == JSON_OBJECT ? ruleFor(const_cast<JsonNode*>(filter)->member(key)) : ruleFor(filter);
+
+    JsonNode* member = nullptr;
+    if (out && rule.keep) {
+      member = out->member(key);  // A repeated key replaces the value
+      if (!member) {
+        out->children.emplace_back();
+        member = &out->children.back();
+        member->key = key;
+      }
+    }
+
+    result = parseValue(source, member, rule.filter, depth + 1);
+    if (result != DeserializationError::Ok) return result;
+
+    c = skipSpace(source);
+    source.next();
+    if (c == '}') return DeserializationError::Ok;
+    if (c == NO_CHARACTER) return DeserializationError::IncompleteInput;
+    if (c != ',') return DeserializationError::InvalidInput;
+  }
+}
+
+static Code parseArray(JsonSource& source, JsonNode* out, const JsonNode* filter, int depth) {
+  source.next();  // Opening bracket
+  if (out) out->reset(JSON_ARRAY);
+
+  if (skipSpace(source) == ']') {
+    source.next();
+    return DeserializationError::Ok;
+  }
+
+  FilterRule rule = { true, nullptr };
+  if (filter) {
+    rule = filter->type == JSON_ARRAY ? (filter->children.empty() ? FilterRule{ false, nullptr } : ruleFor(&filter->children.front()))
+                                      : ruleFor(filter);
+  }
+
+  for (;;) {
+    JsonNode* element = nullptr;
+    if (out && rule.keep) {
+      out->children.emplace_back();
+      element = &out->children.back();
+    }
+
+    Code result = parseValue(source, element, rule.filter, depth + 1);
+    if (result != DeserializationError::Ok) return result;
+
+    int c = skipSpace(source);
+    source.next();
+    if (c == ']') return DeserializationError::Ok;
+    if (c == NO_CHARACTER) return DeserializationError::IncompleteInput;
+    if (c != ',') return DeserializationError::InvalidInput;
+  }
+}
+
+/**
+ * Parses one value into out, or skips it if out is nullptr. A filter that
+ * expects an object or array drops other values.
+ */
+static Code parseValue(JsonSource& source, JsonNode* out, const JsonNode* filter, int depth) {
+  if (depth > NESTING_LIMIT) return DeserializationError::TooDeep;
+
+  int c = skipSpace(source);
+  bool structural = c == '{' || c == '[';
+  if (filter && !structural) out = nullptr;
+  if (out) out->reset(JSON_NULL);
+
+  if (c == NO_CHARACTER) return DeserializationError::IncompleteInput;
+  if (c == '{') return parseObject(source, out, filter, depth);
+  if (c == '[') return parseArray(source, out, filter, depth);
+  if (c == '"') {
+    std::string text;
+    Code result = parseString(source, text);
+    if (out && result == DeserializationError::Ok) {
+      out->reset(JSON_STRING);
+      out->text = text;
+    }
+    return result;
+  }
+  if (c == '-' || isdigit(c)) return parseNumber(source, out);
+  return parseLiteral(source, out);
+}
+
+static DeserializationError deserialize(JsonDocument& doc, JsonSource& source, const JsonNode* filter) {
+  doc.clear();
+  if (skipSpace(source) == NO_CHARACTER) return DeserializationError::EmptyInput;
+
+  Code result = parseValue(source, &doc.hostRoot(), filter, 0);
+  if (result != DeserializationError::Ok) doc.clear();
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// Deserialization
+// ----------------------------------------------------------------------------
+
+const char* DeserializationError::c_str() const {
+  static const char* const names[] = { "Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep" };
+  return names[result];
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input) {
+  return deserializeJson(doc, input, input ? strlen(input) : 0);
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t size) {
+  TextSource source(input ? input : "", input ? size : 0);
+  return deserialize(doc, source, nullptr);
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input) {
+  StreamSource source(input);
+  return deserialize(doc, source, nullptr);
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input, DeserializationOption::Filter filter) {
+  StreamSource source(input);
+  return deserialize(doc, source, filter.hostNode());
+}
+
+// ----------------------------------------------------------------------------
+// Serialization
+// ----------------------------------------------------------------------------
+
+static void writeString(std::string& out, const std::string& text) {
+  out += '"';
+  for (char c : text) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\b': out += "\\b"; break;
+      case '\f': out += "\\f"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if ((uint8_t)c < 0x20) {
+          char escape[8];
+          snprintf(escape, sizeof(escape), "\\u%04x", c);
+          out += escape;
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+}
+
+/**
+ * Integral values print without decimals, others with up to 9 significant
+ * digits; NaN and infinity print as null, like the library by default.
+ */
+static void writeNumber(std::string& out, double number) {
+  if (!isfinite(number)) {
+    out += "null";
+    return;
+  }
+
+  char text[NUMBER_BUFFER_SIZE];
+  if (number == trunc(number) && fabs(number) < MAX_EXACT_INTEGER) {
+    snprintf(text, sizeof(text), "%.0f", number);
+  } else {
+    snprintf(text, sizeof(text), "%.9g", number);
+  }
+  out += text;
+}
+
+static void writeNode(std::string& out, const JsonNode& node) {
+  switch (node.type) {
+    case JSON_NULL: out += "null"; return;
+    case JSON_BOOLEAN: out += node.boolean ? "true" : "false"; return;
+    case JSON_INTEGER: out += std::to_string(node.integer); return;
+    case JSON_FLOAT: writeNumber(out, node.number); return;
+    case JSON_STRING: writeString(out, node.text); return;
+
+    case JSON_ARRAY:
+    case JSON_OBJECT: {
+      bool object = node.type == JSON_OBJECT;
+      out += object ? '{' : '[';
+      bool first = true;
+      for (const JsonNode& child : node.children) {
+        if (!first) out += ',';
+        first = false;
+        if (object) {
+          writeString(out, child.key);
+          out += ':';
+        }
+        writeNode(out, child);
+      }
+      out += object ? '}' : ']';
+      return;
+    }
+  }
+}
+
+size_t serializeJson(const JsonDocument& doc, char* output, size_t size) {
+  if (size == 0) return 0;
+
+  std::string text;
+  writeNode(text, doc.hostRoot());
+  size_t length = min(text.size(), size - 1);
+  memcpy(output, text.data(), length);
+  output[length] = '\0';
+  return length;
+}
+
+size_t measureJson(const JsonDocument& doc) {
+  std::string text;
+  writeNode(text, doc.hostRoot());
+  return text.size();
+}
@@ -0,0 +1,481 @@
+// ============================================================================
+// File: ArduinoJson.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the subset of ArduinoJson 7 the firmware
+//              uses: documents, objects, arrays and variants, parsing from
+//              text or a Stream (with a filter) and serializing to a buffer.
+//              It follows the library's behaviour, not its memory layout, so
+//              allocation and timing figures measured on it do not carry
+//              over to the boards; sizes of the produced JSON do.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+// Nodes
+// ----------------------------------------------------------------------------
+
+enum JsonType {
+  JSON_NULL,
+  JSON_BOOLEAN,
+  JSON_INTEGER,
+  JSON_FLOAT,
+  JSON_STRING,
+  JSON_ARRAY,
+  JSON_OBJECT
+};
+
+/**
+ * One value of a document. Members of an object carry their key. Children
+ * live in a list, so references to them stay valid while others are added.
+ */
+struct JsonNode {
+  JsonType type = JSON_NULL;
+  bool boolean = false;
+  long long integer = 0;
+  double number = 0;
+  std::string text;
+  std::string key;
+  std::list<JsonNode> children;
+
+  void reset(JsonType next) {
+    type = next;
+    text.clear();
+    children.clear();
+  }
+
+  JsonNode* member(const std::string& name) {
+    if (type != JSON_OBJECT) return nullptr;
+    for (JsonNode& child : children) {
+      if (child.key == name) return &child;
+    }
+    return nullptr;
+  }
+};
+
+class JsonObject;
+class JsonArray;
+
+// ----------------------------------------------------------------------------
+// JsonVariant
+// ----------------------------------------------------------------------------
+
+/**
+ * Reference to a value. A member that does not exist yet is only created
+ * when something is written to it, as in the library.
+ */
+class JsonVariant {
+public:
+  JsonVariant() {}
+  explicit JsonVariant(JsonNode* target) : node(target) {}
+  JsonVariant(JsonNode* object, const std::string& name) : parent(object), key(name) {}
+
+  /**
+   * Node behind the variant, created (and its parent turned into an
+   * object) if create is set.
+   */
+  JsonNode* resolve(bool create) const;
+
+  bool isNull() const {
+    const JsonNode* target = resolve(false);
+    return !target || target->type == JSON_NULL;
+  }
+
+  template <typename T>
+  bool is() const;
+
+  template <typename T>
+  T as() const;
+
+  template <typename T>
+  T to() const;
+
+  template <typename T>
+  operator T() const {
+    return as<T>();
+  }
+
+  template <typename K>
+  JsonVariant operator[](const K& name) const;
+
+  template <typename T>
+  JsonVariant& operator=(const T& value);
+
+  JsonVariant& operator=(const JsonVariant& other) = default;
+
+private:
+  JsonNode* node = nullptr;
+  JsonNode* parent = nullptr;
+  std::shared_ptr<const JsonVariant> owner;  // Member of a member that may not exist yet
+  std::string key;
+};
+
+// ----------------------------------------------------------------------------
+// JsonObject & JsonArray
+// ----------------------------------------------------------------------------
+
+/**
+ * Key of an object member.
+ */
+class JsonString {
+public:
+  explicit JsonString(const char* value) : text(value) {}
+  const char* c_str() const { return text; }
+
+private:
+  const char* text;
+};
+
+/**
+ * Member of an object, as returned when iterating it.
+ */
+class JsonPair {
+public:
+  explicit JsonPair(JsonNode* member) : node(member) {}
+  JsonString key() const { return JsonString(node->key.c_str()); }
+  JsonVariant value() const { return JsonVariant(node); }
+
+private:
+  JsonNode* node;
+};
+
+/**
+ * Iterates the children of a node, yielding T for each.
+ */
+template <typename T>
+class JsonIterator {
+public:
+  explicit JsonIterator(std::list<JsonNode>::iterator at) : position(at) {}
+  T operator*() const { return T(&*position); }
+  JsonIterator& operator++() { ++position; return *this; }
+  bool operator!=(const JsonIterator& other) const { return position != other.position; }
+
+private:
+  std::list<JsonNode>::iterator position;
+};
+
+class JsonObject {
+public:
+  JsonObject() {}
+  explicit JsonObject(JsonNode* object) : node(object) {}
+
+  bool isNull() const { return !node; }
+  size_t size() const { return node ? node->children.size() : 0; }
+
+  template <typename K>
+  JsonVariant operator[](const K& name) const {
+    if (!node) return JsonVariant();
+    return JsonVariant(node, std::string(String(name).c_str()));
+  }
+
+  JsonIterator<JsonPair> begin() const { return JsonIterator<JsonPair>(node ? node->children.begin() : empty().begin()); }
+  JsonIterator<JsonPair> end() const { return JsonIterator<JsonPair>(node ? node->children.end() : empty().end()); }
+
+private:
+  static std::list<JsonNode>& empty() {
+    static std::list<JsonNode> none;
+    return none;
+  }
+
+  JsonNode* node = nullptr;
+};
+
+class JsonArray {
+public:
+  JsonArray() {}
+  explicit JsonArray(JsonNode* array) : node(array) {}
+
+  bool isNull() const { return !node; }
+  size_t size() const { return node ? node->children.size() : 0; }
+
+  /**
+   * Appends an empty object or array, or null for other types.
+   */
+  template <typename T>
+  T add() const {
+    if (!node) return T();
+    node->children.emplace_back();
+    JsonNode& child = node->children.back();
+    if constexpr (std::is_same_v<T, JsonObject>) child.type = JSON_OBJECT;
+    if constexpr (std::is_same_v<T, JsonArray>) child.type = JSON_ARRAY;
+    return T(&child);
+  }
+
+  /**
+   * Appends a value.
+   */
+  template <typename T>
+  bool add(const T& value) const {
+    if (!node) return false;
+    node->children.emplace_back();
+    JsonVariant slot(&node->children.back());
+    slot = value;
+    return true;
+  }
+
+  JsonVariant operator[](size_t index) const {
+    if (!node || index >= node->children.size()) return JsonVariant();
+    auto child = node->children.begin();
+    std::advance(child, index);
+    return JsonVariant(&*child);
+  }
+
+  JsonIterator<JsonVariant> begin() const { return JsonIterator<JsonVariant>(node ? node->children.begin() : empty().begin()); }
+  JsonIterator<JsonVariant> end() const { return JsonIterator<JsonVariant>(node ? node->children.end() : empty().end()); }
+
+private:
+  static std::list<JsonNode>& empty() {
+    static std::list<JsonNode> none;
+    return none;
+  }
+
+  JsonNode* node = nullptr;
+};
+
+// ----------------------------------------------------------------------------
+// JsonVariant Templates
+// ----------------------------------------------------------------------------
+
+inline JsonNode* JsonVariant::resolve(bool create) const {
+  if (node) return node;
+
+  JsonNode* object = parent ? parent : (owner ? owner->resolve(create) : nullptr);
+  if (!object) return nullptr;
+  if (object->type == JSON_NULL && create) object->reset(JSON_OBJECT);
+
+  JsonNode* member = object->member(key);
+  if (member || !create || object->type != JSON_OBJECT) return member;
+
+  object->children.emplace_back();
+  object->children.back().key = key;
+  return &object->children.back();
+}
+
+template <typename T>
+bool JsonVariant::is() const {
+  const JsonNode* target = resolve(false);
+  if (!target) return false;
+
+  if constexpr (std::is_same_v<T, JsonObject>) {
+    return target->type == JSON_OBJECT;
+  } else if constexpr (std::is_same_v<T, JsonArray>) {
+    return target->type == JSON_ARRAY;
+  } else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, String>) {
+    return target->type == JSON_STRING;
+  } else if constexpr (std::is_same_v<T, bool>) {
+    return target->type == JSON_BOOLEAN;
+  } else if constexpr (std::is_integral_v<T>) {
+    // Only integers that fit the type, as in the library
+    return target->type == JSON_INTEGER && target->integer >= (long long)std::numeric_limits<T>::min() &&
+           (target->integer < 0 || (unsigned long long)target->integer <= (unsigned long long)std::numeric_limits<T>::max());
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return target->type == JSON_INTEGER || target->type == JSON_FLOAT;
+  } else {
+    static_assert(sizeof(T) == 0, "Type not supported by the host ArduinoJson");
+  }
+}
+
+template <typename T>
+T JsonVariant::as() const {
+  JsonNode* target = resolve(false);
+
+  if constexpr (std::is_same_v<T, JsonObject>) {
+    return JsonObject(target && target->type == JSON_OBJECT ? target : nullptr);
+  } else if constexpr (std::is_same_v<T, JsonArray>) {
+    return JsonArray(target && target->type == JSON_ARRAY ? target : nullptr);
+  } else if constexpr (std::is_same_v<T, JsonVariant>) {
+    return *this;
+  } else if constexpr (std::is_same_v<T, const char*>) {
+    return target && target->type == JSON_STRING ? target->text.c_str() : nullptr;
+  } else if constexpr (std::is_same_v<T, String>) {
+    return String(target && target->type == JSON_STRING ? target->text.c_str() : "");
+  } else if constexpr (std::is_same_v<T, bool>) {
+    if (!target) return false;
+    if (target->type == JSON_BOOLEAN) return target->boolean;
+    if (target->type == JSON_INTEGER) return target->integer != 0;
+    return target->type == JSON_FLOAT && target->number != 0;
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    if (!target) return 0;
+    if (target->type == JSON_INTEGER) return (T)target->integer;
+    if (target->type == JSON_FLOAT) {
+      if constexpr (std::is_integral_v<T>) return isfinite(target->number) ? (T)(long long)target->number : 0;
+      return (T)target->number;
+    }
+    if (target->type == JSON_BOOLEAN) return target->boolean ? 1 : 0;
+    return 0;
+  } else {
+    static_assert(sizeof(T) == 0, "Type not supported by the host ArduinoJson");
+  }
+}
+
+template <typename T>
+T JsonVariant::to() const {
+  JsonNode* target = resolve(true);
+  if (!target) return T();
+
+  if constexpr (std::is_same_v<T, JsonObject>) {
+    target->reset(JSON_OBJECT);
+  } else if constexpr (std::is_same_v<T, JsonArray>) {
+    target->reset(JSON_ARRAY);
+  } else {
+    static_assert(std::is_same_v<T, JsonVariant>, "Type not supported by the host ArduinoJson");
+    target->reset(JSON_NULL);
+  }
+  return T(target);
+}
+
+template <typename K>
+JsonVariant JsonVariant::operator[](const K& name) const {
+  if constexpr (std::is_integral_v<K>) {
+    return as<JsonArray>()[(size_t)name];
+  } else if (node) {
+    return JsonVariant(node, String(name).c_str());
+  } else {
+    JsonVariant member;
+    member.owner = std::make_shared<const JsonVariant>(*this);
+    member.key = String(name).c_str();
+    return member;
+  }
+}
+
+template <typename T>
+JsonVariant& JsonVariant::operator=(const T& value) {
+  JsonNode* target = resolve(true);
+  if (!target) return *this;
+
+  if constexpr (std::is_same_v<T, bool>) {
+    target->reset(JSON_BOOLEAN);
+    target->boolean = value;
+  } else if constexpr (std::is_integral_v<T>) {
+    target->reset(JSON_INTEGER);
+    target->integer = (long long)value;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    target->reset(JSON_FLOAT);
+    target->number = value;
+  } else if constexpr (std::is_same_v<T, String>) {
+    target->reset(JSON_STRING);
+    target->text = value.c_str();
+  } else if constexpr (std::is_convertible_v<const T&, const char*>) {
+    const char* text = value;
+    target->reset(text ? JSON_STRING : JSON_NULL);
+    if (text) target->text = text;
+  } else {
+    static_assert(sizeof(T) == 0, "Type not supported by the host ArduinoJson");
+  }
+  return *this;
+}
+
+// ----------------------------------------------------------------------------
+// JsonDocument
+// ----------------------------------------------------------------------------
+
+/**
+ * Document owning its values on the heap, like ArduinoJson 7.
+ */
+class JsonDocument {
+public:
+  template <typename K>
+  JsonVariant operator[](const K& name) {
+    return JsonVariant(&root)[name];
+  }
+
+  template <typename T>
+  T as() { return JsonVariant(&root).as<T>(); }
+
+  template <typename T>
+  T to() { return JsonVariant(&root).to<T>(); }
+
+  bool isNull() const { return root.type == JSON_NULL; }
+  size_t size() const { return root.children.size(); }
+  void clear() { root = JsonNode(); }
+
+  /**
+   * True if the pool ran out of memory; the host never does.
+   */
+  bool overflowed() const { return false; }
+
+  JsonNode& hostRoot() { return root; }
+  const JsonNode& hostRoot() const { return root; }
+
+private:
+  JsonNode root;
+};
+
+// ----------------------------------------------------------------------------
+// Deserialization
+// ----------------------------------------------------------------------------
+
+class DeserializationError {
+public:
+  enum Code {
+    Ok,
+    EmptyInput,
+    IncompleteInput,
+    InvalidInput,
+    NoMemory,
+    TooDeep
+  };
+
+  DeserializationError(Code value = Ok) : result(value) {}
+
+  Code code() const { return result; }
+  const char* c_str() const;
+  explicit operator bool() const { return result != Ok; }
+  bool operator==(Code other) const { return result == other; }
+  bool operator!=(Code other) const { return result != other; }
+
+private:
+  Code result;
+};
+
+namespace DeserializationOption {
+
+/**
+ * Keeps only the members marked true in the filter document. The first
+ * element of an array in the filter applies to every element.
+ */
+class Filter {
+public:
+  explicit Filter(const JsonDocument& filter) : node(&filter.hostRoot()) {}
+  const JsonNode* hostNode() const { return node; }
+
+private:
+  const JsonNode* node;
+};
+
+}  // namespace DeserializationOption
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input);
+DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t size);
+
+/**
+ * Reads one value from the stream and nothing after it.
+ */
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input);
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input, DeserializationOption::Filter filter);
+
+// ----------------------------------------------------------------------------
+// Serialization
+// ----------------------------------------------------------------------------
+
+/**
+ * Writes the minified document and a terminating NUL; output that does not
+ * fit is cut off.
+ *
+ * @return Characters written, without the NUL.
+ */
+size_t serializeJson(const JsonDocument& doc, char* output, size_t size);
+
+/**
+ * Length of the minified document.
+ */
+size_t measureJson(const JsonDocument& doc);
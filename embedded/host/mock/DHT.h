@@ -0,0 +1,38 @@
+// ============================================================================
+// File: DHT.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the Adafruit DHT sensor library. Every
+//              sensor returns the values set with DHT::hostSetReading(); NAN
+//              stands for a failed read, as on the board.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+#define DHT11 11
+#define DHT22 22
+
+class DHT {
+public:
+  DHT(uint8_t pin, uint8_t type, uint8_t count = 6) : pin(pin), type(type) { (void)count; }
+
+  void begin(uint8_t usecMaxCycles = 55) { (void)usecMaxCycles; }
+  float readTemperature(bool fahrenheit = false, bool force = false) {
+    (void)force;
+    return fahrenheit ? hostTemperature * 9 / 5 + 32 : hostTemperature;
+  }
+  float readHumidity(bool force = false) { (void)force; return hostHumidity; }
+
+  static void hostSetReading(float temperature, float humidity) {
+    hostTemperature = temperature;
+    hostHumidity = humidity;
+  }
+
+private:
+  uint8_t pin;
+  uint8_t type;
+  static inline float hostTemperature = NAN;
+  static inline float hostHumidity = NAN;
+};
@@ -0,0 +1,11 @@
+// ============================================================================
+// File: ESP8266WiFi.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the ESP8266 WiFi header; the station API is
+//              the same as on the ESP32.
+// ============================================================================
+
+#pragma once
+#include "WiFi.h"
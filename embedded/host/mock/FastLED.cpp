@@ -0,0 +1,43 @@
+// ============================================================================
+// File: FastLED.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the host stand-in for FastLED.
+// ============================================================================
+
+#include "FastLED.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define RAND16_SEED 1337
+#define RAND16_MULTIPLIER 2053
+#define RAND16_INCREMENT 13849
+
+// Base and slope (Q4) of the four sections of a quarter sine wave
+static const uint8_t SIN8_SECTIONS[] = { 0, 49, 49, 41, 90, 27, 117, 10 };
+
+static uint16_t rand16seed = RAND16_SEED;
+
+uint8_t sin8(uint8_t theta) {
+  uint8_t offset = theta;
+  if (theta & 0x40) offset = 255 - offset;
+  offset &= 0x3F;
+
+  uint8_t secoffset = offset & 0x0F;
+  if (theta & 0x40) secoffset++;
+
+  const uint8_t* section = SIN8_SECTIONS + (offset >> 4) * 2;
+  uint8_t mx = (section[1] * secoffset) >> 4;
+  int8_t y = mx + section[0];
+  if (theta & 0x80) y = -y;
+  return (uint8_t)(y + 128);
+}
+
+uint8_t random8() {
+  rand16seed = rand16seed * RAND16_MULTIPLIER + RAND16_INCREMENT;
+  return (uint8_t)((uint8_t)(rand16seed & 0xFF) + (uint8_t)(rand16seed >> 8));
+}
+
+CFastLED FastLED;
@@ -0,0 +1,134 @@
+// ============================================================================
+// File: FastLED.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the FastLED subset the installation uses:
+//              CRGB, the 8-bit math helpers (same integer algorithms as the
+//              library's portable C versions) and a controller that counts
+//              show() calls instead of driving a strip.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+typedef uint8_t fract8;
+
+// ----------------------------------------------------------------------------
+// Colors
+// ----------------------------------------------------------------------------
+
+/**
+ * Saturating 8-bit add and subtract.
+ */
+inline uint8_t qadd8(uint8_t i, uint8_t j) {
+  unsigned int t = i + j;
+  return t > UINT8_MAX ? UINT8_MAX : (uint8_t)t;
+}
+
+inline uint8_t qsub8(uint8_t i, uint8_t j) {
+  return i > j ? i - j : 0;
+}
+
+/**
+ * Blends a toward b by amountOfB / 256.
+ */
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB) {
+  uint16_t partial = (a << 8) | b;
+  partial += b * amountOfB;
+  partial -= a * amountOfB;
+  return partial >> 8;
+}
+
+/**
+ * Sine of theta (a full turn is 256) scaled to 0..255, piecewise linear.
+ */
+uint8_t sin8(uint8_t theta);
+
+/**
+ * Fast 16-bit LCG, same sequence as the library.
+ */
+uint8_t random8();
+
+/**
+ * RGB pixel.
+ */
+struct CRGB {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+
+  CRGB() = default;
+  constexpr CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+
+  CRGB& operator+=(const CRGB& rhs) {
+    r = qadd8(r, rhs.r);
+    g = qadd8(g, rhs.g);
+    b = qadd8(b, rhs.b);
+    return *this;
+  }
+  bool operator==(const CRGB& rhs) const { return r == rhs.r && g == rhs.g && b == rhs.b; }
+  bool operator!=(const CRGB& rhs) const { return !(*this == rhs); }
+};
+
+inline CRGB blend(const CRGB& p1, const CRGB& p2, fract8 amountOfP2) {
+  return CRGB(blend8(p1.r, p2.r, amountOfP2), blend8(p1.g, p2.g, amountOfP2), blend8(p1.b, p2.b, amountOfP2));
+}
+
+// ----------------------------------------------------------------------------
+// Controller
+// ----------------------------------------------------------------------------
+
+enum EOrder {
+  RGB = 0012,
+  RBG = 0021,
+  GRB = 0102,
+  GBR = 0120,
+  BRG = 0201,
+  BGR = 0210
+};
+
+/**
+ * Chipset tags, only used to pick addLeds().
+ */
+template <uint8_t DATA_PIN, EOrder RGB_ORDER = GRB>
+class WS2812B {};
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER = GRB>
+class NEOPIXEL {};
+
+/**
+ * The strip registered with addLeds().
+ */
+struct CLEDController {
+  CRGB* leds = nullptr;
+  int count = 0;
+};
+
+/**
+ * The FastLED singleton. show() only counts; the frame stays readable in
+ * the array passed to addLeds().
+ */
+class CFastLED {
+public:
+  template <template <uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+  CLEDController& addLeds(CRGB* data, int count) {
+    controller.leds = data;
+    controller.count = count;
+    return controller;
+  }
+
+  void setBrightness(uint8_t scale) { brightness = scale; }
+  uint8_t getBrightness() const { return brightness; }
+  void show() { shows++; }
+
+  unsigned long hostShowCount() const { return shows; }
+  const CLEDController& hostController() const { return controller; }
+
+private:
+  CLEDController controller;
+  uint8_t brightness = UINT8_MAX;
+  unsigned long shows = 0;
+};
+
+extern CFastLED FastLED;
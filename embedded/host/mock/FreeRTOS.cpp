@@ -0,0 +1,52 @@
+// ============================================================================
+// File: FreeRTOS.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the host stand-in for the FreeRTOS task API.
+// ============================================================================
+
+#include <Arduino.h>
+#include <deque>
+
+// ----------------------------------------------------------------------------
+// Tasks
+// ----------------------------------------------------------------------------
+static std::deque<HostTask> tasks;  // Handles stay valid as tasks are added
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackBytes, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+  tasks.push_back({ function, name, stackBytes, parameter, priority, core });
+  if (handle) *handle = &tasks.back();
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks * portTICK_PERIOD_MS);
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+  *previousWake += increment;
+  TickType_t now = xTaskGetTickCount();
+  if ((int32_t)(*previousWake - now) > 0) vTaskDelay(*previousWake - now);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)(millis() / portTICK_PERIOD_MS);
+}
+
+BaseType_t xTaskGetAffinity(TaskHandle_t task) {
+  return task->core;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  return task->stackBytes;
+}
+
+size_t hostTaskCount() {
+  return tasks.size();
+}
+
+const HostTask& hostTaskAt(size_t index) {
+  return tasks.at(index);
+}
@@ -0,0 +1,180 @@
+// ============================================================================
+// File: LittleFS.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the in-memory LittleFS stand-in.
+// ============================================================================
+
+#include "LittleFS.h"
+
+// ----------------------------------------------------------------------------
+// File Handles
+// ----------------------------------------------------------------------------
+
+/**
+ * State shared by all copies of an open file.
+ */
+struct File::Handle {
+  HostFS* fs;
+  std::string path;
+  std::vector<uint8_t> content;
+  size_t position;
+  bool writable;
+  bool append;
+  bool dirty;
+  bool closed;
+
+  ~Handle() {
+    if (!closed && dirty) fs->commit(path, content);
+  }
+};
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  if (!handle) return 0;
+  size_t n = min(size, handle->content.size() - min(handle->position, handle->content.size()));
+  memcpy(buffer, handle->content.data() + handle->position, n);
+  handle->position += n;
+  return n;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!handle || !handle->writable) return 0;
+  if (handle->append) handle->position = handle->content.size();
+  if (handle->content.size() < handle->position + size) handle->content.resize(handle->position + size);
+  memcpy(handle->content.data() + handle->position, buffer, size);
+  handle->position += size;
+  handle->dirty = true;
+  return size;
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+  if (!handle) return false;
+  size_t base = mode == SeekSet ? 0 : mode == SeekCur ? handle->position : handle->content.size();
+  if (base + position > handle->content.size()) return false;
+  handle->position = base + position;
+  return true;
+}
+
+size_t File::position() const {
+  return handle ? handle->position : 0;
+}
+
+size_t File::size() const {
+  return handle ? handle->content.size() : 0;
+}
+
+bool File::truncate(uint32_t size) {
+  if (!handle || !handle->writable) return false;
+  handle->content.resize(size);
+  handle->position = min(handle->position, (size_t)size);
+  handle->dirty = true;
+  return true;
+}
+
+void File::close() {
+  if (!handle) return;
+  if (!handle->closed && handle->dirty) handle->fs->commit(handle->path, handle->content);
+  handle->closed = true;
+  handle.reset();
+}
+
+bool Dir::next() {
+  if (started) index++;
+  started = true;
+  return index < entries.size();
+}
+
+String Dir::fileName() const {
+  return index < entries.size() ? String(entries[index].first) : String();
+}
+
+size_t Dir::fileSize() const {
+  return index < entries.size() ? entries[index].second : 0;
+}
+
+// ----------------------------------------------------------------------------
+// File System
+// ----------------------------------------------------------------------------
+
+File HostFS::open(const char* path, const char* mode) {
+  File file;
+  auto existing = files.find(path);
+  if (mode[0] == 'r' && existing == files.end()) return file;
+  bool read = mode[0] == 'r' && mode[1] != '+';
+
+  file.handle = std::make_shared<File::Handle>();
+  File::Handle& handle = *file.handle;
+  handle.fs = this;
+  handle.path = path;
+  handle.writable = !read;
+  handle.append = mode[0] == 'a';
+  handle.closed = false;
+  handle.position = 0;
+
+  bool truncate = mode[0] == 'w';
+  if (existing != files.end() && !truncate) handle.content = existing->second;
+  if (handle.append) handle.position = handle.content.size();
+  handle.dirty = truncate || (handle.append && existing == files.end());
+  return file;
+}
+
+bool HostFS::exists(const char* path) const {
+  return files.count(path) || directories.count(path);
+}
+
+bool HostFS::remove(const char* path) {
+  if (!files.count(path)) return false;
+  if (reachFlash()) files.erase(path);
+  return true;
+}
+
+bool HostFS::mkdir(const char* path) {
+  if (reachFlash()) directories.insert(path);
+  return true;
+}
+
+Dir HostFS::openDir(const char* path) const {
+  Dir dir;
+  std::string prefix = std::string(path) + "/";
+  for (const auto& file : files) {
+    if (file.first.compare(0, prefix.size(), prefix) != 0) continue;
+    std::string name = file.first.substr(prefix.size());
+    if (name.find('/') == std::string::npos) dir.entries.push_back({ name, file.second.size() });
+  }
+  return dir;
+}
+
+void HostFS::hostFormat() {
+  files.clear();
+  directories.clear();
+  hostRestorePower();
+  lastCommitBytes = 0;
+  programmedBytes = 0;
+}
+
+void HostFS::hostCutPowerAfter(size_t operations) {
+  powerCut = true;
+  operationsLeft = operations;
+}
+
+void HostFS::hostRestorePower() {
+  powerCut = false;
+  operationsLeft = 0;
+}
+
+bool HostFS::reachFlash() {
+  if (!powerCut) return true;
+  if (operationsLeft == 0) return false;
+  operationsLeft--;
+  return true;
+}
+
+void HostFS::commit(const std::string& path, const std::vector<uint8_t>& content) {
+  if (!reachFlash()) return;
+  files[path] = content;
+  lastCommitBytes = content.size();
+  programmedBytes += content.size();
+}
+
+HostFS LittleFS;
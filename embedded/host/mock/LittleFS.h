@@ -0,0 +1,131 @@
+// ============================================================================
+// File: LittleFS.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the ESP8266 LittleFS API, kept in memory.
+//              Like LittleFS, an open file is committed atomically when it
+//              is closed. Tests can cut the power after a number of flash
+//              operations and count the bytes programmed per commit.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <set>
+
+// ----------------------------------------------------------------------------
+// File Handles
+// ----------------------------------------------------------------------------
+
+enum SeekMode {
+  SeekSet,
+  SeekCur,
+  SeekEnd
+};
+
+class HostFS;
+
+/**
+ * Open file. Reads and writes work on a private copy that close() (or the
+ * last copy of the handle going away) commits.
+ */
+class File {
+public:
+  File() {}
+
+  explicit operator bool() const { return (bool)handle; }
+  size_t read(uint8_t* buffer, size_t size);
+  size_t write(const uint8_t* buffer, size_t size);
+  bool seek(uint32_t position, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  bool truncate(uint32_t size);
+  void close();
+
+private:
+  friend class HostFS;
+  struct Handle;
+  std::shared_ptr<Handle> handle;
+};
+
+/**
+ * Directory listing of the files directly inside a directory.
+ */
+class Dir {
+public:
+  bool next();
+  String fileName() const;
+  size_t fileSize() const;
+
+private:
+  friend class HostFS;
+  std::vector<std::pair<std::string, size_t>> entries;
+  size_t index = 0;
+  bool started = false;
+};
+
+// ----------------------------------------------------------------------------
+// File System
+// ----------------------------------------------------------------------------
+
+/**
+ * In-memory file system.
+ */
+class HostFS {
+public:
+  bool begin() { return true; }
+  void end() {}
+  File open(const char* path, const char* mode);
+  bool exists(const char* path) const;
+  bool remove(const char* path);
+  bool mkdir(const char* path);
+  Dir openDir(const char* path) const;
+
+  /**
+   * Erases every file and directory and restores power.
+   */
+  void hostFormat();
+
+  /**
+   * Lets the given number of commits, removes and mkdirs reach flash;
+   * everything after that is lost, as if the power was cut.
+   */
+  void hostCutPowerAfter(size_t operations);
+
+  /**
+   * Ends the simulated power cut; the next begin() sees what reached flash.
+   */
+  void hostRestorePower();
+
+  /**
+   * False once a power cut took effect.
+   */
+  bool hostPowered() const { return !powerCut || operationsLeft > 0; }
+
+  /**
+   * Bytes programmed by the last commit (the whole file, as a copy-on-write
+   * file system rewrites it) and in total.
+   */
+  size_t hostLastCommitBytes() const { return lastCommitBytes; }
+  size_t hostProgrammedBytes() const { return programmedBytes; }
+
+private:
+  friend class File;
+
+  /**
+   * Consumes one flash operation. False if it is lost to a power cut.
+   */
+  bool reachFlash();
+  void commit(const std::string& path, const std::vector<uint8_t>& content);
+
+  std::map<std::string, std::vector<uint8_t>> files;
+  std::set<std::string> directories;
+  bool powerCut = false;
+  size_t operationsLeft = 0;
+  size_t lastCommitBytes = 0;
+  size_t programmedBytes = 0;
+};
+
+extern HostFS LittleFS;
@@ -0,0 +1,22 @@
+// ============================================================================
+// File: WiFi.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the host stand-in for the WiFi station API.
+// ============================================================================
+
+#include "WiFi.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define IPV4_TEXT_SIZE 16
+
+String IPAddress::toString() const {
+  char text[IPV4_TEXT_SIZE];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+  return String(text);
+}
+
+WiFiClass WiFi;
@@ -0,0 +1,69 @@
+// ============================================================================
+// File: WiFi.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the WiFi station API of the ESP32 and
+//              ESP8266 cores. The station connects as soon as it is asked to,
+//              unless a test keeps it offline.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define WL_IDLE_STATUS 0
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+#define WIFI_OFF 0
+#define WIFI_STA 1
+
+#define HOST_MAC_ADDRESS "AA:BB:CC:DD:EE:FF"
+#define IPV4_OCTETS 4
+
+// ----------------------------------------------------------------------------
+// WiFi Station
+// ----------------------------------------------------------------------------
+
+/**
+ * IPv4 address that prints itself in dotted notation.
+ */
+class IPAddress : public Printable {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{ a, b, c, d } {}
+
+  String toString() const;
+  size_t printTo(Print& out) const override { return out.print(toString()); }
+
+private:
+  uint8_t octets[IPV4_OCTETS];
+};
+
+/**
+ * The station interface.
+ */
+class WiFiClass {
+public:
+  bool mode(uint8_t mode) { currentMode = mode; return true; }
+  int begin() { state = reachable ? WL_CONNECTED : WL_DISCONNECTED; return state; }
+  int status() const { return state; }
+  String macAddress() const { return HOST_MAC_ADDRESS; }
+  IPAddress localIP() const { return state == WL_CONNECTED ? IPAddress(192, 168, 1, 2) : IPAddress(); }
+
+  /**
+   * Whether begin() and WiFiManager connect. Defaults to true.
+   */
+  void hostSetReachable(bool value) { reachable = value; }
+  bool hostReachable() const { return reachable; }
+  void hostSetStatus(int value) { state = value; }
+
+private:
+  uint8_t currentMode = WIFI_OFF;
+  int state = WL_IDLE_STATUS;
+  bool reachable = true;
+};
+
+extern WiFiClass WiFi;
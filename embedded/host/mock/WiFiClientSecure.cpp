@@ -0,0 +1,48 @@
+// ============================================================================
+// File: WiFiClientSecure.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the host stand-in for the TLS client.
+// ============================================================================
+
+#include "WiFiClientSecure.h"
+
+#define NO_BYTE -1
+
+static HostNetwork* network = nullptr;
+
+void hostSetNetwork(HostNetwork* next) {
+  network = next;
+}
+
+int WiFiClientSecure::connect(const char* host, uint16_t port) {
+  connection.reset();
+  if (network) connection = network->connect(host, port, session);
+  return connection ? 1 : 0;
+}
+
+uint8_t WiFiClientSecure::connected() {
+  return connection && connection->connected();
+}
+
+int WiFiClientSecure::available() {
+  return connection ? connection->available() : 0;
+}
+
+int WiFiClientSecure::read() {
+  uint8_t value;
+  return read(&value, 1) == 1 ? value : NO_BYTE;
+}
+
+int WiFiClientSecure::read(uint8_t* buffer, size_t size) {
+  return connection ? connection->read(buffer, size) : NO_BYTE;
+}
+
+int WiFiClientSecure::peek() {
+  return connection ? connection->peek() : NO_BYTE;
+}
+
+size_t WiFiClientSecure::write(const uint8_t* buffer, size_t size) {
+  return connection ? connection->write(buffer, size) : 0;
+}
@@ -0,0 +1,121 @@
+// ============================================================================
+// File: WiFiClientSecure.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the TLS client of both cores, including the
+//              BearSSL session cache of the ESP8266 core. Connections are
+//              opened through the HostNetwork the test or benchmark sets, so
+//              they can be scripted in memory or run over real sockets.
+//              Without a network every connect() fails.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include <memory>
+
+// ----------------------------------------------------------------------------
+// TLS Sessions
+// ----------------------------------------------------------------------------
+
+/**
+ * Resumption state a HostNetwork keeps in a session, e.g. an OpenSSL session.
+ */
+class HostSessionState {
+public:
+  virtual ~HostSessionState() {}
+};
+
+namespace BearSSL {
+
+/**
+ * Session of the ESP8266 core, offered on the next connect() so the server
+ * can resume it instead of a full handshake.
+ */
+class Session {
+public:
+  std::shared_ptr<HostSessionState> hostState;  // Empty until a network stored one
+};
+
+}  // namespace BearSSL
+
+// ----------------------------------------------------------------------------
+// Host Transport
+// ----------------------------------------------------------------------------
+
+/**
+ * One open connection.
+ */
+class HostConnection {
+public:
+  virtual ~HostConnection() {}
+  virtual bool connected() = 0;
+  virtual int available() = 0;
+
+  /**
+   * @return Bytes read, or -1 if nothing can be read.
+   */
+  virtual int read(uint8_t* buffer, size_t size) = 0;
+
+  /**
+   * @return The next byte without consuming it, or -1.
+   */
+  virtual int peek() = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+};
+
+/**
+ * Opens the connections of all WiFiClientSecure instances.
+ */
+class HostNetwork {
+public:
+  virtual ~HostNetwork() {}
+
+  /**
+   * @param session Session set on the client, or nullptr. The network may
+   *                resume from it and stores the new state in it.
+   * @return The connection, or nullptr if it failed.
+   */
+  virtual std::unique_ptr<HostConnection> connect(const char* host, uint16_t port, BearSSL::Session* session) = 0;
+};
+
+/**
+ * Sets the network later connect() calls use; nullptr makes them fail.
+ */
+void hostSetNetwork(HostNetwork* network);
+
+// ----------------------------------------------------------------------------
+// WiFiClientSecure
+// ----------------------------------------------------------------------------
+
+class WiFiClientSecure : public Stream {
+public:
+  /**
+   * Closes the current connection, if any, and opens a new one.
+   *
+   * @return 1 if connected, 0 otherwise.
+   */
+  int connect(const char* host, uint16_t port);
+  uint8_t connected();
+  void stop() { connection.reset(); }
+  void setInsecure() { insecure = true; }
+  void setSession(BearSSL::Session* tlsSession) { session = tlsSession; }
+
+  int available() override;
+  int read() override;
+  int read(uint8_t* buffer, size_t size);
+  int peek() override;
+  size_t write(uint8_t value) override { return write(&value, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  /**
+   * True once setInsecure() was called; the host never validates anyway.
+   */
+  bool hostInsecure() const { return insecure; }
+
+private:
+  std::unique_ptr<HostConnection> connection;
+  BearSSL::Session* session = nullptr;
+  bool insecure = false;
+};
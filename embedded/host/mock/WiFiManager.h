@@ -0,0 +1,31 @@
+// ============================================================================
+// File: WiFiManager.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for tzapu/WiFiManager. autoConnect() joins the
+//              saved network right away; the captive portal never opens.
+// ============================================================================
+
+#pragma once
+#include "WiFi.h"
+
+/**
+ * Connects with the saved credentials, or fails as a timed out portal does
+ * when WiFi.hostSetReachable(false) was called.
+ */
+class WiFiManager {
+public:
+  void setConfigPortalTimeout(unsigned long seconds) { portalTimeoutSec = seconds; }
+
+  bool autoConnect(const char* apName, const char* apPassword = nullptr) {
+    (void)apName;
+    (void)apPassword;
+    return WiFi.begin() == WL_CONNECTED;
+  }
+
+  unsigned long hostPortalTimeoutSec() const { return portalTimeoutSec; }
+
+private:
+  unsigned long portalTimeoutSec = 0;
+};
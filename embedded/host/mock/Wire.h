@@ -0,0 +1,22 @@
+// ============================================================================
+// File: Wire.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the I2C bus. The sensor stand-ins answer
+//              without it, so it only has to exist.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+class TwoWire {
+public:
+  void begin() { started = true; }
+  bool hostStarted() const { return started; }
+
+private:
+  bool started = false;
+};
+
+inline TwoWire Wire;
@@ -0,0 +1,11 @@
+// ============================================================================
+// File: cert.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the certificate that is not committed. A
+//              cert.h next to Server.cpp takes precedence.
+// ============================================================================
+
+#pragma once
+#include "cert-example.h"
@@ -0,0 +1,191 @@
+// ============================================================================
+// File: esp_http_server.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Implements the host stand-in for the ESP-IDF HTTP server.
+// ============================================================================
+
+#include "esp_http_server.h"
+#include <deque>
+#include <functional>
+#include <map>
+
+// ----------------------------------------------------------------------------
+// Server State
+// ----------------------------------------------------------------------------
+
+/**
+ * Session of one client.
+ */
+struct HostSession {
+  const httpd_uri_t* route = nullptr;  // WebSocket route after the handshake
+  bool open = true;
+  std::vector<std::string> frames;
+};
+
+/**
+ * The one server a firmware runs.
+ */
+struct HostServer {
+  httpd_config_t config = {};
+  std::deque<httpd_uri_t> routes;
+  std::map<int, HostSession> sessions;
+  std::deque<std::pair<httpd_work_fn_t, void*>> work;
+  std::string* response = nullptr;
+  std::string* type = nullptr;
+};
+
+static HostServer server;
+
+/**
+ * Finds the route for a URI and method.
+ */
+static const httpd_uri_t* findRoute(const char* uri, httpd_method_t method) {
+  for (const httpd_uri_t& route : server.routes) {
+    if (route.method == method && strcmp(route.uri, uri) == 0) return &route;
+  }
+  return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+// Server API
+// ----------------------------------------------------------------------------
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri) {
+  if (handle != &server || server.routes.size() >= server.config.max_uri_handlers) return ESP_FAIL;
+  server.routes.push_back(*uri);
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t* req, const char* type) {
+  (void)req;
+  if (server.type) *server.type = type;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t* req, const char* buffer, ssize_t length) {
+  (void)req;
+  size_t size = length == HTTPD_RESP_USE_STRLEN ? strlen(buffer) : (size_t)length;
+  if (server.response) server.response->assign(buffer, size);
+  return ESP_OK;
+}
+
+int httpd_req_to_sockfd(httpd_req_t* req) {
+  return req->fd;
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void* arg) {
+  if (handle != &server) return ESP_FAIL;
+  server.work.push_back({ work, arg });
+  return ESP_OK;
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int fd) {
+  (void)handle;
+  auto session = server.sessions.find(fd);
+  if (session == server.sessions.end()) return ESP_FAIL;
+  session->second.open = false;
+  return ESP_OK;
+}
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t handle, int fd) {
+  (void)handle;
+  auto session = server.sessions.find(fd);
+  if (session == server.sessions.end() || !session->second.open) return HTTPD_WS_CLIENT_INVALID;
+  return session->second.route ? HTTPD_WS_CLIENT_WEBSOCKET : HTTPD_WS_CLIENT_HTTP;
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t handle, int fd, httpd_ws_frame_t* frame) {
+  if (httpd_ws_get_fd_info(handle, fd) != HTTPD_WS_CLIENT_WEBSOCKET) return ESP_FAIL;
+  server.sessions[fd].frames.emplace_back((const char*)frame->payload, frame->len);
+  return ESP_OK;
+}
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t* req, httpd_ws_frame_t* frame, size_t maxLength) {
+  const httpd_ws_frame_t* received = req->hostFrame;
+  if (!received) return ESP_FAIL;
+
+  frame->final = received->final;
+  frame->type = received->type;
+  frame->len = received->len;
+  if (maxLength == 0) return ESP_OK;
+  if (maxLength < received->len || !frame->payload) return ESP_FAIL;
+  memcpy(frame->payload, received->payload, received->len);
+  return ESP_OK;
+}
+
+// ----------------------------------------------------------------------------
+// Host Hooks
+// ----------------------------------------------------------------------------
+
+esp_err_t hostHttpdStart(httpd_handle_t* handle, const httpd_config_t& config) {
+  server = HostServer();
+  server.config = config;
+  *handle = &server;
+  return ESP_OK;
+}
+
+const httpd_config_t& hostHttpdConfig() {
+  return server.config;
+}
+
+size_t hostHttpdHandlerCount() {
+  return server.routes.size();
+}
+
+esp_err_t hostHttpdRequest(const char* uri, httpd_method_t method, int fd, std::string* response, std::string* type) {
+  const httpd_uri_t* route = findRoute(uri, method);
+  if (!route) return ESP_FAIL;
+
+  HostSession& session = server.sessions[fd];
+  session = HostSession();
+  if (route->is_websocket) session.route = route;
+
+  httpd_req_t req = { &server, method, uri, 0, route->user_ctx, fd, nullptr };
+  server.response = response;
+  server.type = type;
+  esp_err_t result = route->handler(&req);
+  server.response = nullptr;
+  server.type = nullptr;
+
+  if (!route->is_websocket) session.open = false;
+  return result;
+}
+
+esp_err_t hostHttpdReceiveFrame(int fd, httpd_ws_type_t type, const std::string& payload) {
+  auto session = server.sessions.find(fd);
+  if (session == server.sessions.end() || !session->second.open || !session->second.route) return ESP_FAIL;
+
+  const httpd_uri_t* route = session->second.route;
+  httpd_ws_frame_t frame = { true, false, type, (uint8_t*)payload.data(), payload.size() };
+  httpd_req_t req = { &server, 0, route->uri, payload.size(), route->user_ctx, fd, &frame };
+  esp_err_t result = route->handler(&req);
+  if (result != ESP_OK || type == HTTPD_WS_TYPE_CLOSE) session->second.open = false;
+  return result;
+}
+
+size_t hostHttpdRunQueuedWork() {
+  size_t count = 0;
+  while (!server.work.empty()) {
+    auto work = server.work.front();
+    server.work.pop_front();
+    work.first(work.second);
+    count++;
+  }
+  return count;
+}
+
+const std::vector<std::string>& hostHttpdFramesSentTo(int fd) {
+  return server.sessions[fd].frames;
+}
+
+bool hostHttpdSessionOpen(int fd) {
+  auto session = server.sessions.find(fd);
+  return session != server.sessions.end() && session->second.open;
+}
+
+void hostHttpdDropClient(int fd) {
+  auto session = server.sessions.find(fd);
+  if (session != server.sessions.end()) session->second.open = false;
+}
@@ -0,0 +1,167 @@
+// ============================================================================
+// File: esp_http_server.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the ESP-IDF HTTP server with WebSocket
+//              support. There is no socket: tests send requests and frames
+//              to the registered handlers by URI and file descriptor, read
+//              the responses and frames back and run the queued work when the
+//              server task would.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include "esp_err.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define HTTPD_RESP_USE_STRLEN -1
+#define HTTPD_DEFAULT_MAX_OPEN_SOCKETS 7
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+typedef void* httpd_handle_t;
+
+typedef enum http_method {
+  HTTP_DELETE = 0,
+  HTTP_GET = 1,
+  HTTP_HEAD = 2,
+  HTTP_POST = 3,
+  HTTP_PUT = 4
+} httpd_method_t;
+
+typedef enum {
+  HTTPD_WS_TYPE_CONTINUE = 0x0,
+  HTTPD_WS_TYPE_TEXT = 0x1,
+  HTTPD_WS_TYPE_BINARY = 0x2,
+  HTTPD_WS_TYPE_CLOSE = 0x8,
+  HTTPD_WS_TYPE_PING = 0x9,
+  HTTPD_WS_TYPE_PONG = 0xA
+} httpd_ws_type_t;
+
+typedef enum {
+  HTTPD_WS_CLIENT_INVALID = 0x0,
+  HTTPD_WS_CLIENT_HTTP = 0x1,
+  HTTPD_WS_CLIENT_WEBSOCKET = 0x2
+} httpd_ws_client_info_t;
+
+typedef struct httpd_ws_frame {
+  bool final;
+  bool fragmented;
+  httpd_ws_type_t type;
+  uint8_t* payload;
+  size_t len;
+} httpd_ws_frame_t;
+
+/**
+ * One request. A method of 0 means a WebSocket frame arrived after the
+ * handshake.
+ */
+typedef struct httpd_req {
+  httpd_handle_t handle;
+  int method;
+  const char* uri;
+  size_t content_len;
+  void* user_ctx;
+  int fd;                               // Host only
+  const httpd_ws_frame_t* hostFrame;    // Host only, the frame being received
+} httpd_req_t;
+
+typedef struct httpd_uri {
+  const char* uri;
+  httpd_method_t method;
+  esp_err_t (*handler)(httpd_req_t* req);
+  void* user_ctx;
+  bool is_websocket;
+} httpd_uri_t;
+
+typedef struct httpd_config {
+  uint16_t max_open_sockets;
+  uint16_t max_uri_handlers;
+} httpd_config_t;
+
+typedef void (*httpd_work_fn_t)(void* arg);
+
+// ----------------------------------------------------------------------------
+// Server API
+// ----------------------------------------------------------------------------
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri);
+esp_err_t httpd_resp_set_type(httpd_req_t* req, const char* type);
+esp_err_t httpd_resp_send(httpd_req_t* req, const char* buffer, ssize_t length);
+int httpd_req_to_sockfd(httpd_req_t* req);
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void* arg);
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int fd);
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t handle, int fd);
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t handle, int fd, httpd_ws_frame_t* frame);
+
+/**
+ * Reads the frame being received. With maxLength 0 only its type and
+ * length are filled in.
+ */
+esp_err_t httpd_ws_recv_frame(httpd_req_t* req, httpd_ws_frame_t* frame, size_t maxLength);
+
+// ----------------------------------------------------------------------------
+// Host Hooks
+// ----------------------------------------------------------------------------
+
+/**
+ * Starts the server instance behind the handle; used by httpd_ssl_start().
+ */
+esp_err_t hostHttpdStart(httpd_handle_t* handle, const httpd_config_t& config);
+
+/**
+ * Config the server was started with.
+ */
+const httpd_config_t& hostHttpdConfig();
+
+/**
+ * Number of URI handlers registered since the server started.
+ */
+size_t hostHttpdHandlerCount();
+
+/**
+ * Runs the handler registered for the URI and method as if client fd sent
+ * the request. A GET on a WebSocket route is the handshake; the client
+ * stays connected until it or the server closes the session.
+ *
+ * @param response Receives the body sent by the handler, if not nullptr.
+ * @param type Receives the content type, if not nullptr.
+ * @return The handler's result, or ESP_FAIL if no route matched.
+ */
+esp_err_t hostHttpdRequest(const char* uri, httpd_method_t method, int fd, std::string* response = nullptr,
+                           std::string* type = nullptr);
+
+/**
+ * Delivers a frame from WebSocket client fd to the route it connected to.
+ */
+esp_err_t hostHttpdReceiveFrame(int fd, httpd_ws_type_t type, const std::string& payload);
+
+/**
+ * Runs the work queued with httpd_queue_work(), as the server task does.
+ *
+ * @return Number of work items run.
+ */
+size_t hostHttpdRunQueuedWork();
+
+/**
+ * Text frames sent to a client so far.
+ */
+const std::vector<std::string>& hostHttpdFramesSentTo(int fd);
+
+/**
+ * False once the server closed the session of fd.
+ */
+bool hostHttpdSessionOpen(int fd);
+
+/**
+ * Closes the session of fd from the client side without a close frame.
+ */
+void hostHttpdDropClient(int fd);
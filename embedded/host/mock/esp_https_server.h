@@ -0,0 +1,28 @@
+// ============================================================================
+// File: esp_https_server.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the ESP-IDF HTTPS server. The certificate
+//              and key are kept but no TLS is done; requests reach the
+//              handlers through the hooks in esp_http_server.h.
+// ============================================================================
+
+#pragma once
+#include "esp_http_server.h"
+
+typedef struct httpd_ssl_config {
+  httpd_config_t httpd;
+  const uint8_t* servercert;
+  size_t servercert_len;
+  const uint8_t* prvtkey_pem;
+  size_t prvtkey_len;
+} httpd_ssl_config_t;
+
+#define HTTPD_SSL_CONFIG_DEFAULT() \
+  httpd_ssl_config_t { { HTTPD_DEFAULT_MAX_OPEN_SOCKETS, 8 }, nullptr, 0, nullptr, 0 }
+
+inline esp_err_t httpd_ssl_start(httpd_handle_t* handle, httpd_ssl_config_t* config) {
+  if (!config->servercert || !config->prvtkey_pem) return ESP_ERR_INVALID_ARG;
+  return hostHttpdStart(handle, config->httpd);
+}
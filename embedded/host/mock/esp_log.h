@@ -0,0 +1,15 @@
+// ============================================================================
+// File: esp_log.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the ESP-IDF log macros, written to Serial.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+#define ESP_LOGE(tag, format, ...) Serial.printf("E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) Serial.printf("W (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) Serial.printf("I (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) Serial.printf("D (%s) " format "\n", tag, ##__VA_ARGS__)
@@ -0,0 +1,18 @@
+// ============================================================================
+// File: esp_timer.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the ESP-IDF high resolution timer, on the
+//              host clock.
+// ============================================================================
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * Microseconds since boot.
+ */
+inline int64_t esp_timer_get_time() {
+  return (int64_t)micros();
+}
@@ -0,0 +1,11 @@
+// ============================================================================
+// File: esp_tls.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the ESP-IDF TLS header. The server stand-in
+//              does no TLS, so nothing from it is needed.
+// ============================================================================
+
+#pragma once
+#include "esp_err.h"
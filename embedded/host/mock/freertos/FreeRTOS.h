@@ -0,0 +1,20 @@
+// ============================================================================
+// File: FreeRTOS.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the FreeRTOS base types of the ESP32 core.
+//              One tick is one millisecond, as configured on the board.
+// ============================================================================
+
+#pragma once
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) / portTICK_PERIOD_MS)
+#define pdPASS 1
+#define pdFAIL 0
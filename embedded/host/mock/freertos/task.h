@@ -0,0 +1,53 @@
+// ============================================================================
+// File: task.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the FreeRTOS task API. Created tasks are
+//              recorded with their core, priority and stack but not started,
+//              since task functions never return; tests drive the modules a
+//              task runs directly. Delays advance the host clock.
+// ============================================================================
+
+#pragma once
+#include <stddef.h>
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+
+/**
+ * A task as passed to xTaskCreatePinnedToCore().
+ */
+struct HostTask {
+  TaskFunction_t function;
+  const char* name;
+  uint32_t stackBytes;
+  void* parameter;
+  UBaseType_t priority;
+  BaseType_t core;
+};
+
+typedef HostTask* TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackBytes, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment);
+TickType_t xTaskGetTickCount();
+BaseType_t xTaskGetAffinity(TaskHandle_t task);
+
+/**
+ * Smallest unused stack in bytes (ESP32 flavor). Nothing runs on the host,
+ * so this is the whole stack.
+ */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+/**
+ * Number of tasks created so far.
+ */
+size_t hostTaskCount();
+
+/**
+ * Task created at position index, in creation order.
+ */
+const HostTask& hostTaskAt(size_t index);
@@ -0,0 +1,11 @@
+// ============================================================================
+// File: key.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Host stand-in for the private key that is not committed. A
+//              key.h next to Server.cpp takes precedence.
+// ============================================================================
+
+#pragma once
+#include "key-example.h"
@@ -0,0 +1,19 @@
+// ============================================================================
+// File: InstallationSketch.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Compiles installation.ino on the host the way the Arduino
+//              builder does: the core header first, then the prototypes it
+//              generates for the functions of the sketch, then the sketch.
+// ============================================================================
+
+#include <Arduino.h>
+
+// ----------------------------------------------------------------------------
+// Generated Prototypes
+// ----------------------------------------------------------------------------
+void setup();
+void loop();
+
+#include "installation.ino"
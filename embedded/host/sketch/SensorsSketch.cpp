@@ -0,0 +1,30 @@
+// ============================================================================
+// File: SensorsSketch.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Compiles sensors.ino on the host the way the Arduino builder
+//              does: the core header first, then the prototypes it generates
+//              for the functions of the sketch, then the sketch itself.
+// ============================================================================
+
+#include <Arduino.h>
+#include <BH1750.h>
+
+// ----------------------------------------------------------------------------
+// Generated Prototypes
+// ----------------------------------------------------------------------------
+void setup();
+void loop();
+void initSensors(BH1750::Mode lightMode);
+void recordReading();
+void readDht11();
+void readBh1750();
+void readWaterSensor();
+void readBmp180();
+void runSleepCycle();
+void uploadSleepReadings(bool resumed);
+void printStats();
+void echoReadings();
+
+#include "sensors.ino"
@@ -0,0 +1,290 @@
+// ============================================================================
+// File: DFPlayerManagerTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Drives the DFPlayer command queue over a scripted UART: one
+//              command in flight at a time, retries and degraded mode when
+//              acknowledgements are missing, volume ramps around track
+//              changes, frame resynchronization and the command counter.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "DFPlayerManager.h"
+#include "Metrics.h"
+
+// ----------------------------------------------------------------------------
+// Metrics Stand-In
+// ----------------------------------------------------------------------------
+static uint32_t countedMetrics[COUNTER_COUNT];
+
+void metricsCount(Counter counter) {
+  countedMetrics[counter]++;
+}
+
+void metricsObserve(Histogram histogram, uint32_t value) {
+  (void)histogram;
+  (void)value;
+}
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define FRAME_SIZE 10
+#define CMD_VOLUME 0x06
+#define CMD_LOOP_TRACK 0x08
+#define CMD_QUERY_STATUS 0x42
+#define REPLY_MODULE_ONLINE 0x3F
+#define REPLY_ERROR 0x40
+#define REPLY_ACK 0x41
+#define TICK_MS 10
+#define RX_PIN 16
+#define TX_PIN 17
+
+/**
+ * Command and parameter of a frame.
+ */
+struct Frame {
+  uint8_t cmd;
+  uint16_t param;
+
+  bool operator==(const Frame& other) const { return cmd == other.cmd && param == other.param; }
+};
+
+static std::ostream& operator<<(std::ostream& out, const Frame& frame) {
+  return out << "{0x" << std::hex << (int)frame.cmd << std::dec << ", " << frame.param << "}";
+}
+
+/**
+ * Encodes a frame as the module sends it.
+ */
+static std::vector<uint8_t> encodeFrame(uint8_t cmd, uint16_t param) {
+  std::vector<uint8_t> frame = { 0x7E, 0xFF, 0x06, cmd, 0x00, (uint8_t)(param >> 8), (uint8_t)param, 0, 0, 0xEF };
+  uint16_t sum = 0;
+  for (int i = 1; i < 7; i++) sum += frame[i];
+  uint16_t checksum = 0 - sum;
+  frame[7] = checksum >> 8;
+  frame[8] = checksum & 0xFF;
+  return frame;
+}
+
+class DFPlayerTest : public ::testing::Test {
+protected:
+  HardwareSerial uart;
+  unsigned long now = 0;
+  size_t seenBytes = 0;
+
+  void SetUp() override {
+    hostSetMillis(now);
+    initDFPlayer(&uart, RX_PIN, TX_PIN);
+    printDFPlayerStats();  // Clears the statistics of earlier tests
+    memset(countedMetrics, 0, sizeof(countedMetrics));
+  }
+
+  /**
+   * Frames the player wrote since the last call, with a valid checksum.
+   */
+  std::vector<Frame> newFrames() {
+    std::vector<Frame> frames;
+    const std::vector<uint8_t>& written = uart.written();
+    for (; seenBytes + FRAME_SIZE <= written.size(); seenBytes += FRAME_SIZE) {
+      const uint8_t* f = written.data() + seenBytes;
+      EXPECT_EQ(f[0], 0x7E);
+      EXPECT_EQ(f[4], 0x01) << "acknowledgement not requested";
+      EXPECT_EQ(f[9], 0xEF);
+      uint16_t sum = 0;
+      for (int i = 1; i < 7; i++) sum += f[i];
+      EXPECT_EQ((uint16_t)(sum + ((f[7] << 8) | f[8])), 0) << "bad checksum";
+      frames.push_back({ f[3], (uint16_t)((f[5] << 8) | f[6]) });
+    }
+    return frames;
+  }
+
+  void reply(uint8_t cmd, uint16_t param = 0) {
+    std::vector<uint8_t> frame = encodeFrame(cmd, param);
+    uart.hostFeed(frame.data(), frame.size());
+  }
+
+  /**
+   * Runs the player for ms in TICK_MS steps. With acknowledge, the module
+   * answers every frame on the next tick.
+   *
+   * @return Every frame sent meanwhile, retries included.
+   */
+  std::vector<Frame> run(unsigned long ms, bool acknowledge) {
+    std::vector<Frame> frames;
+    for (unsigned long end = now + ms; now < end; now += TICK_MS) {
+      updateDFPlayer(now);
+      for (const Frame& frame : newFrames()) {
+        frames.push_back(frame);
+        if (acknowledge) reply(REPLY_ACK);
+      }
+    }
+    return frames;
+  }
+
+  /**
+   * Brings the module online by acknowledging the probe.
+   */
+  void goOnline() {
+    ASSERT_EQ(run(TICK_MS, true), std::vector<Frame>({ { CMD_QUERY_STATUS, 0 } }));
+  }
+};
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST_F(DFPlayerTest, ProbesFirstAndStaysQuietWithoutATrack) {
+  std::vector<Frame> frames = run(1000, true);
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0], (Frame{ CMD_QUERY_STATUS, 0 }));
+  EXPECT_EQ(frames[1], (Frame{ CMD_VOLUME, DFPLAYER_VOLUME_INIT }));  // Nothing audible yet: set directly
+}
+
+TEST_F(DFPlayerTest, FirstTrackStartsSilentAndRampsUp) {
+  goOnline();
+  playTrack(TRACK_RAINSTORM);
+  std::vector<Frame> frames = run(2000, true);
+
+  std::vector<Frame> expected = { { CMD_VOLUME, 0 }, { CMD_LOOP_TRACK, TRACK_RAINSTORM } };
+  for (int volume = DFPLAYER_RAMP_STEP; volume <= DFPLAYER_VOLUME_INIT; volume += DFPLAYER_RAMP_STEP) {
+    expected.push_back({ CMD_VOLUME, (uint16_t)volume });
+  }
+  EXPECT_EQ(frames, expected);
+}
+
+TEST_F(DFPlayerTest, RampStepsAreSpacedAndWaitForTheAck) {
+  goOnline();
+  playTrack(TRACK_RAINSTORM);
+  run(2000, true);
+
+  setVolume(DFPLAYER_VOLUME_MAX);
+  std::vector<Frame> first = run(DFPLAYER_RAMP_STEP_MS, true);
+  ASSERT_EQ(first.size(), 1u);
+
+  // The next step follows DFPLAYER_RAMP_STEP_MS after the first
+  std::vector<Frame> second = run(TICK_MS, false);
+  ASSERT_EQ(second.size(), 1u);
+  EXPECT_EQ(second[0].param, first[0].param + DFPLAYER_RAMP_STEP);
+
+  // Unacknowledged: no further step, only the retry after the timeout
+  EXPECT_TRUE(run(DFPLAYER_ACK_TIMEOUT_MS - TICK_MS, false).empty());
+  EXPECT_EQ(run(TICK_MS, false), second);
+}
+
+TEST_F(DFPlayerTest, TrackChangeFadesOutSwitchesAndFadesIn) {
+  goOnline();
+  playTrack(TRACK_RAINSTORM);
+  run(2000, true);
+
+  playTrack(TRACK_SUMMER_CICADAS);
+  std::vector<Frame> frames = run(3000, true);
+
+  std::vector<Frame> expected;
+  for (int volume = DFPLAYER_VOLUME_INIT - DFPLAYER_RAMP_STEP; volume >= 0; volume -= DFPLAYER_RAMP_STEP) {
+    expected.push_back({ CMD_VOLUME, (uint16_t)volume });
+  }
+  expected.push_back({ CMD_LOOP_TRACK, TRACK_SUMMER_CICADAS });
+  for (int volume = DFPLAYER_RAMP_STEP; volume <= DFPLAYER_VOLUME_INIT; volume += DFPLAYER_RAMP_STEP) {
+    expected.push_back({ CMD_VOLUME, (uint16_t)volume });
+  }
+  EXPECT_EQ(frames, expected);
+}
+
+TEST_F(DFPlayerTest, SameTrackIsNotRestarted) {
+  goOnline();
+  playTrack(TRACK_RAINSTORM);
+  run(2000, true);
+  playTrack(TRACK_RAINSTORM);
+  EXPECT_TRUE(run(2000, true).empty());
+}
+
+TEST_F(DFPlayerTest, MissingAckIsRetriedThenDegrades) {
+  // Up to and including the tick that gives up on the module
+  std::vector<Frame> frames = run(DFPLAYER_ACK_TIMEOUT_MS * (DFPLAYER_MAX_RETRIES + 1) + TICK_MS, false);
+
+  // First attempt and DFPLAYER_MAX_RETRIES retries of the same probe
+  ASSERT_EQ(frames.size(), (size_t)DFPLAYER_MAX_RETRIES + 1);
+  for (const Frame& frame : frames) EXPECT_EQ(frame, (Frame{ CMD_QUERY_STATUS, 0 }));
+
+  // Degraded: requests are kept, nothing is sent until the next probe
+  playTrack(TRACK_BLIZZARD_WIND);
+  EXPECT_TRUE(run(DFPLAYER_PROBE_INTERVAL_MS - TICK_MS, false).empty());
+
+  frames = run(TICK_MS, false);
+  EXPECT_EQ(frames, std::vector<Frame>({ { CMD_QUERY_STATUS, 0 } }));
+}
+
+TEST_F(DFPlayerTest, ComesBackOnlineAndPlaysTheKeptRequest) {
+  run(DFPLAYER_ACK_TIMEOUT_MS * (DFPLAYER_MAX_RETRIES + 1), false);
+  playTrack(TRACK_BLIZZARD_WIND);
+
+  std::vector<Frame> frames = run(DFPLAYER_PROBE_INTERVAL_MS + 2000, true);
+  ASSERT_GE(frames.size(), 3u);
+  EXPECT_EQ(frames[0], (Frame{ CMD_QUERY_STATUS, 0 }));
+  EXPECT_EQ(frames[1], (Frame{ CMD_VOLUME, 0 }));
+  EXPECT_EQ(frames[2], (Frame{ CMD_LOOP_TRACK, TRACK_BLIZZARD_WIND }));
+  EXPECT_EQ(frames.back(), (Frame{ CMD_VOLUME, DFPLAYER_VOLUME_INIT }));
+}
+
+TEST_F(DFPlayerTest, ErrorReplyIsRetriedRightAway) {
+  run(TICK_MS, false);  // Probe sent
+  reply(REPLY_ERROR);
+  std::vector<Frame> frames = run(TICK_MS, false);
+  EXPECT_EQ(frames, std::vector<Frame>({ { CMD_QUERY_STATUS, 0 } }));
+}
+
+TEST_F(DFPlayerTest, ResynchronizesAndIgnoresCorruptFrames) {
+  run(TICK_MS, false);  // Probe sent
+
+  std::vector<uint8_t> corrupt = encodeFrame(REPLY_ACK, 0);
+  corrupt[8] ^= 0x01;
+  const uint8_t noise[] = { 0x00, 0x13, 0xEF };
+  uart.hostFeed(noise, sizeof(noise));
+  uart.hostFeed(corrupt.data(), corrupt.size());
+  run(TICK_MS, false);
+  playTrack(TRACK_RAINSTORM);
+  EXPECT_TRUE(run(DFPLAYER_ACK_TIMEOUT_MS - 3 * TICK_MS, false).empty());  // Still waiting for the ack
+
+  reply(REPLY_ACK);
+  std::vector<Frame> frames = run(TICK_MS * 2, true);
+  ASSERT_FALSE(frames.empty());
+  EXPECT_EQ(frames[0], (Frame{ CMD_VOLUME, 0 }));  // Online: the request is played
+}
+
+TEST_F(DFPlayerTest, ModuleResetRestoresTrackAndVolume) {
+  goOnline();
+  playTrack(TRACK_RAINSTORM);
+  run(2000, true);
+
+  reply(REPLY_MODULE_ONLINE);
+  std::vector<Frame> frames = run(2000, true);
+  ASSERT_GE(frames.size(), 3u);
+  EXPECT_EQ(frames[0], (Frame{ CMD_VOLUME, 0 }));
+  EXPECT_EQ(frames[1], (Frame{ CMD_LOOP_TRACK, TRACK_RAINSTORM }));
+  EXPECT_EQ(frames.back(), (Frame{ CMD_VOLUME, DFPLAYER_VOLUME_INIT }));
+}
+
+TEST_F(DFPlayerTest, VolumeIsClampedToTheModuleRange) {
+  goOnline();
+  playTrack(TRACK_RAINSTORM);
+  run(2000, true);
+
+  setVolume(200);
+  std::vector<Frame> frames = run(2000, true);
+  ASSERT_FALSE(frames.empty());
+  EXPECT_EQ(frames.back(), (Frame{ CMD_VOLUME, DFPLAYER_VOLUME_MAX }));
+
+  for (int i = 0; i < 2 * DFPLAYER_VOLUME_MAX; i++) volumeDown();
+  frames = run(3000, true);
+  ASSERT_FALSE(frames.empty());
+  EXPECT_EQ(frames.back(), (Frame{ CMD_VOLUME, DFPLAYER_VOLUME_MIN }));
+}
+
+TEST_F(DFPlayerTest, CommandCounterIncludesRetries) {
+  run(DFPLAYER_ACK_TIMEOUT_MS * (DFPLAYER_MAX_RETRIES + 1), false);
+  EXPECT_EQ(countedMetrics[COUNTER_DFPLAYER_COMMANDS], (uint32_t)DFPLAYER_MAX_RETRIES + 1);
+  EXPECT_EQ(countedMetrics[COUNTER_DFPLAYER_COMMANDS] * FRAME_SIZE, uart.written().size());
+}
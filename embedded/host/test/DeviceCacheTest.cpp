@@ -0,0 +1,172 @@
+// ============================================================================
+// File: DeviceCacheTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Checks the device cache: id order, eviction when full,
+//              fleets larger than the cache, ordering of snapshot and
+//              event updates, and staleness.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <climits>
+#include "DeviceCache.h"
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define START_MS 1000UL
+#define SNAPSHOT_PERIOD_MS 60000UL
+
+class DeviceCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    // The cache is a single static instance; age every entry out
+    deviceCacheRemoveStale(START_MS * 1000000UL);
+    ASSERT_EQ(deviceCacheCount(), 0u);
+  }
+
+  void TearDown() override {
+    deviceCacheRemoveStale(START_MS * 1000000UL);
+  }
+};
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST_F(DeviceCacheTest, KeepsEntriesInIdOrder) {
+  const int32_t ids[] = { 7, 2, 11, 5 };
+  for (int32_t id : ids) deviceCacheUpsert(id, START_MS);
+
+  ASSERT_EQ(deviceCacheCount(), 4u);
+  EXPECT_EQ(deviceCacheAt(0)->id, 2);
+  EXPECT_EQ(deviceCacheAt(1)->id, 5);
+  EXPECT_EQ(deviceCacheAt(2)->id, 7);
+  EXPECT_EQ(deviceCacheAt(3)->id, 11);
+  EXPECT_EQ(deviceCacheAt(4), nullptr);
+
+  EXPECT_EQ(deviceCacheFind(7)->id, 7);
+  EXPECT_EQ(deviceCacheFind(6), nullptr);
+}
+
+TEST_F(DeviceCacheTest, UpsertOfAKnownDeviceOnlyRefreshesIt) {
+  CachedDevice* entry = deviceCacheUpsert(3, START_MS);
+  deviceCacheSetValue(entry, SENSOR_ID_BH1750_LUX, 420.0f);
+
+  entry = deviceCacheUpsert(3, START_MS + 500);
+  EXPECT_EQ(deviceCacheCount(), 1u);
+  EXPECT_EQ(entry->refreshedAtMs, START_MS + 500);
+  EXPECT_FLOAT_EQ(deviceCacheValue(entry, SENSOR_ID_BH1750_LUX, 0), 420.0f);
+}
+
+TEST_F(DeviceCacheTest, FullCacheEvictsTheLeastRecentlyRefreshed) {
+  for (int32_t id = 1; id <= DEVICE_CACHE_CAPACITY; id++) deviceCacheUpsert(id, START_MS + id);
+  deviceCacheUpsert(1, START_MS + 100);  // Device 2 is now the oldest
+
+  deviceCacheUpsert(99, START_MS + 200);
+  EXPECT_EQ(deviceCacheCount(), (size_t)DEVICE_CACHE_CAPACITY);
+  EXPECT_EQ(deviceCacheFind(2), nullptr);
+  EXPECT_NE(deviceCacheFind(1), nullptr);
+  EXPECT_NE(deviceCacheFind(99), nullptr);
+  EXPECT_EQ(deviceCacheAt(DEVICE_CACHE_CAPACITY - 1)->id, 99);
+}
+
+TEST_F(DeviceCacheTest, EvictionAgeSurvivesMillisRollover) {
+  unsigned long beforeRollover = ULONG_MAX - 50;
+  for (int32_t id = 1; id <= DEVICE_CACHE_CAPACITY; id++) deviceCacheUpsert(id, beforeRollover);
+  for (int32_t id = 2; id <= DEVICE_CACHE_CAPACITY; id++) deviceCacheUpsert(id, 100);  // After the rollover
+
+  deviceCacheUpsert(50, 200);
+  EXPECT_EQ(deviceCacheFind(1), nullptr);
+  EXPECT_NE(deviceCacheFind(2), nullptr);
+  EXPECT_TRUE(deviceCacheIsFresh(deviceCacheFind(2), 200));
+}
+
+TEST_F(DeviceCacheTest, FleetLargerThanTheCacheStaysBounded) {
+  // Snapshots listing more devices than the cache holds keep the same
+  // devices instead of evicting the ones applied earlier in the snapshot
+  size_t fleet = 3 * DEVICE_CACHE_CAPACITY;
+  for (unsigned long now = START_MS; now < START_MS + 3 * SNAPSHOT_PERIOD_MS; now += SNAPSHOT_PERIOD_MS) {
+    size_t cached = 0;
+    for (size_t id = 1; id <= fleet; id++) {
+      if (deviceCacheUpsert((int32_t)id, now)) cached++;
+    }
+    deviceCacheRemoveStale(now);
+
+    EXPECT_EQ(cached, (size_t)DEVICE_CACHE_CAPACITY);
+    ASSERT_EQ(deviceCacheCount(), (size_t)DEVICE_CACHE_CAPACITY);
+    for (size_t i = 0; i < deviceCacheCount(); i++) {
+      EXPECT_EQ(deviceCacheAt(i)->id, (int32_t)(i + 1));
+      EXPECT_EQ(deviceCacheAt(i)->refreshedAtMs, now);
+    }
+  }
+  EXPECT_EQ(deviceCacheFind((int32_t)fleet), nullptr);
+}
+
+TEST_F(DeviceCacheTest, OlderReadingsDoNotOverwriteNewerOnes) {
+  CachedDevice* entry = deviceCacheUpsert(4, START_MS);
+  ASSERT_TRUE(deviceCacheBeginUpdate(entry, 120, 1740000120));
+  deviceCacheSetValue(entry, SENSOR_ID_DHT11_TEMPERATURE, 21.5f);
+
+  // A snapshot that was taken before the event arrives late
+  EXPECT_FALSE(deviceCacheBeginUpdate(entry, 118, 1740000100));
+  EXPECT_EQ(entry->readingId, 120u);
+
+  // The same reading again (snapshot after event) is harmless
+  EXPECT_TRUE(deviceCacheBeginUpdate(entry, 120, 1740000120));
+  EXPECT_EQ(entry->updatedAt, 1740000120u);
+}
+
+TEST_F(DeviceCacheTest, UnknownSensorsFallBack) {
+  CachedDevice* entry = deviceCacheUpsert(4, START_MS);
+  deviceCacheSetValue(entry, 0, 1.0f);
+  deviceCacheSetValue(entry, DEVICE_CACHE_SENSORS + 1, 1.0f);
+  EXPECT_EQ(entry->validMask, 0);
+
+  EXPECT_FLOAT_EQ(deviceCacheValue(entry, SENSOR_ID_BMP180_PRESSURE, -1.0f), -1.0f);
+  deviceCacheSetValue(entry, SENSOR_ID_BMP180_PRESSURE, 1013.25f);
+  EXPECT_FLOAT_EQ(deviceCacheValue(entry, SENSOR_ID_BMP180_PRESSURE, -1.0f), 1013.25f);
+  EXPECT_FLOAT_EQ(deviceCacheValue(entry, DEVICE_CACHE_SENSORS + 1, -1.0f), -1.0f);
+}
+
+TEST_F(DeviceCacheTest, FreshnessEndsExactlyAtTheMaximumAge) {
+  CachedDevice* entry = deviceCacheUpsert(1, START_MS);
+  EXPECT_TRUE(deviceCacheIsFresh(entry, START_MS + DEVICE_CACHE_MAX_AGE_MS));
+  EXPECT_FALSE(deviceCacheIsFresh(entry, START_MS + DEVICE_CACHE_MAX_AGE_MS + 1));
+}
+
+TEST_F(DeviceCacheTest, DevicesMissingFromSnapshotsAgeOut) {
+  deviceCacheUpsert(1, START_MS);
+  deviceCacheUpsert(2, START_MS);
+  deviceCacheUpsert(3, START_MS);
+
+  // Device 2 was deleted on the server and is no longer listed
+  unsigned long now = START_MS;
+  for (int snapshot = 0; snapshot < 3; snapshot++) {
+    now += SNAPSHOT_PERIOD_MS;
+    deviceCacheUpsert(1, now);
+    deviceCacheUpsert(3, now);
+    EXPECT_EQ(deviceCacheRemoveStale(now), 0u);
+  }
+
+  now += SNAPSHOT_PERIOD_MS;
+  deviceCacheUpsert(1, now);
+  deviceCacheUpsert(3, now);
+  EXPECT_EQ(deviceCacheRemoveStale(now), 1u);
+  EXPECT_EQ(deviceCacheFind(2), nullptr);
+  EXPECT_EQ(deviceCacheCount(), 2u);
+}
+
+TEST_F(DeviceCacheTest, UnchangedSnapshotKeepsEveryDevice) {
+  deviceCacheUpsert(1, START_MS);
+  deviceCacheUpsert(2, START_MS);
+
+  unsigned long now = START_MS;
+  for (int snapshot = 0; snapshot < 10; snapshot++) {
+    now += SNAPSHOT_PERIOD_MS;
+    deviceCacheRefreshAll(now);  // 304 Not Modified
+    EXPECT_EQ(deviceCacheRemoveStale(now), 0u);
+  }
+  EXPECT_EQ(deviceCacheCount(), 2u);
+}
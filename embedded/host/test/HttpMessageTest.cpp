@@ -0,0 +1,218 @@
+// ============================================================================
+// File: HttpMessageTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Checks request rendering and the incremental response parser
+//              of the sensor HTTPS client, with responses split at every
+//              possible byte boundary.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <string>
+#include "HttpMessage.h"
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define HEADER_RESERVE 256
+#define BODY_BUFFER_SIZE 64
+#define TEST_HOST "api.example"
+
+/**
+ * Parses a complete response, split into two feeds at the given offset.
+ */
+static HttpResponse parseSplit(const std::string& raw, size_t split, char* body, size_t capacity) {
+  HttpResponse response;
+  httpResponseBegin(response, body, capacity);
+  const uint8_t* data = (const uint8_t*)raw.data();
+  size_t first = min(split, raw.size());
+  httpResponseFeed(response, data, first);
+  httpResponseFeed(response, data + first, raw.size() - first);
+  return response;
+}
+
+/**
+ * Parses a complete response fed one byte at a time.
+ */
+static HttpResponse parseBytewise(const std::string& raw, char* body, size_t capacity) {
+  HttpResponse response;
+  httpResponseBegin(response, body, capacity);
+  for (char c : raw) httpResponseFeed(response, (const uint8_t*)&c, 1);
+  return response;
+}
+
+/**
+ * Renders a request and returns it as it would be written to the socket.
+ */
+static std::string render(const char* method, const char* path, const std::string& body, const char* etag = "") {
+  static char buffer[HEADER_RESERVE + BODY_BUFFER_SIZE];
+  memcpy(buffer + HEADER_RESERVE, body.data(), body.size());
+  size_t headerLength = httpRenderRequest(buffer, HEADER_RESERVE, TEST_HOST, method, path, body.size(),
+                                          "application/json", etag);
+  if (headerLength == HTTP_RENDER_FAILED) return "";
+  return std::string(buffer + HEADER_RESERVE - headerLength, headerLength + body.size());
+}
+
+// ----------------------------------------------------------------------------
+// Request Rendering
+// ----------------------------------------------------------------------------
+
+TEST(HttpMessage, RendersPostInFrontOfTheBody) {
+  std::string request = render("POST", "/api/reading", "{\"a\":1}");
+  EXPECT_EQ(request.rfind("POST /api/reading HTTP/1.1\r\nHost: " TEST_HOST "\r\n", 0), 0u);
+  EXPECT_NE(request.find("Content-Type: application/json\r\n"), std::string::npos);
+  EXPECT_NE(request.find("Content-Length: 7\r\n"), std::string::npos);
+  EXPECT_NE(request.find("Connection: keep-alive\r\n"), std::string::npos);
+
+  size_t headerEnd = request.find("\r\n\r\n");
+  ASSERT_NE(headerEnd, std::string::npos);
+  EXPECT_EQ(request.substr(headerEnd + 4), "{\"a\":1}");
+}
+
+TEST(HttpMessage, ConditionalGetCarriesTheValidator) {
+  std::string plain = render("GET", "/api/device?key=AA", "");
+  EXPECT_EQ(plain.find("If-None-Match"), std::string::npos);
+  EXPECT_EQ(plain.find("Content-Length"), std::string::npos);
+  EXPECT_EQ(plain.substr(plain.size() - 4), "\r\n\r\n");
+
+  std::string conditional = render("GET", "/api/device?key=AA", "", "\"v42\"");
+  EXPECT_NE(conditional.find("If-None-Match: \"v42\"\r\n"), std::string::npos);
+}
+
+TEST(HttpMessage, RejectsHeadersLongerThanTheReserve) {
+  std::string path(HEADER_RESERVE, 'x');
+  EXPECT_EQ(render("GET", path.c_str(), ""), "");
+}
+
+TEST(HttpMessage, EstimatesTlsRecordsPerWrite) {
+  EXPECT_EQ(httpTlsRecords(0), 0u);
+  EXPECT_EQ(httpTlsRecords(1), 1u);
+  EXPECT_EQ(httpTlsRecords(HTTP_TLS_RECORD_PAYLOAD), 1u);
+  EXPECT_EQ(httpTlsRecords(HTTP_TLS_RECORD_PAYLOAD + 1), 2u);
+}
+
+// ----------------------------------------------------------------------------
+// Response Parsing
+// ----------------------------------------------------------------------------
+
+TEST(HttpMessage, ContentLengthBodyAtEverySplit) {
+  std::string raw = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 15\r\n"
+                    "ETag: \"AbC1\"\r\n\r\n{\"processed\":3}";
+  for (size_t split = 0; split <= raw.size(); split++) {
+    SCOPED_TRACE(split);
+    char body[BODY_BUFFER_SIZE];
+    HttpResponse response = parseSplit(raw, split, body, sizeof(body));
+    EXPECT_EQ(response.state, HTTP_PARSE_DONE);
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.contentLength, 15);
+    EXPECT_TRUE(response.keepAlive);
+    EXPECT_STREQ(response.etag, "\"AbC1\"");
+    EXPECT_STREQ(body, "{\"processed\":3}");
+  }
+}
+
+TEST(HttpMessage, ChunkedBodyWithTrailersAtEverySplit) {
+  std::string raw = "HTTP/1.1 201 Created\r\nTransfer-Encoding: chunked\r\n\r\n"
+                    "5\r\n{\"id\"\r\nA;ext=1\r\n:123456789\r\n1\r\n}\r\n0\r\nX-Trailer: 1\r\n\r\n";
+  for (size_t split = 0; split <= raw.size(); split++) {
+    SCOPED_TRACE(split);
+    char body[BODY_BUFFER_SIZE];
+    HttpResponse response = parseSplit(raw, split, body, sizeof(body));
+    EXPECT_EQ(response.state, HTTP_PARSE_DONE);
+    EXPECT_EQ(response.status, 201);
+    EXPECT_TRUE(response.chunked);
+    EXPECT_STREQ(body, "{\"id\":123456789}");
+  }
+
+  char body[BODY_BUFFER_SIZE];
+  EXPECT_STREQ(parseBytewise(raw, body, sizeof(body)).body, "{\"id\":123456789}");
+}
+
+TEST(HttpMessage, StopsAtTheEndOfTheResponse) {
+  std::string raw = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nokHTTP/1.1";
+  char body[BODY_BUFFER_SIZE];
+  HttpResponse response;
+  httpResponseBegin(response, body, sizeof(body));
+  EXPECT_EQ(httpResponseFeed(response, (const uint8_t*)raw.data(), raw.size()), raw.size() - strlen("HTTP/1.1"));
+  EXPECT_TRUE(httpResponseFinished(response));
+  EXPECT_STREQ(body, "ok");
+}
+
+TEST(HttpMessage, NotModifiedHasNoBody) {
+  std::string raw = "HTTP/1.1 304 Not Modified\r\nETag: \"v42\"\r\nContent-Length: 99\r\n\r\n";
+  char body[BODY_BUFFER_SIZE];
+  HttpResponse response = parseBytewise(raw, body, sizeof(body));
+  EXPECT_EQ(response.state, HTTP_PARSE_DONE);
+  EXPECT_EQ(response.status, 304);
+  EXPECT_EQ(response.bodyLength, 0u);
+  EXPECT_STREQ(response.etag, "\"v42\"");
+}
+
+TEST(HttpMessage, SkipsInterimResponses) {
+  std::string raw = "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+  char body[BODY_BUFFER_SIZE];
+  HttpResponse response = parseBytewise(raw, body, sizeof(body));
+  EXPECT_EQ(response.state, HTTP_PARSE_DONE);
+  EXPECT_EQ(response.status, 200);
+  EXPECT_STREQ(body, "ok");
+}
+
+TEST(HttpMessage, TruncatesOversizedBodiesButConsumesThem) {
+  std::string payload(3 * BODY_BUFFER_SIZE, 'x');
+  std::string raw = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(payload.size()) + "\r\n\r\n" + payload;
+  char body[BODY_BUFFER_SIZE];
+  HttpResponse response = parseSplit(raw, raw.size() / 2, body, sizeof(body));
+  EXPECT_EQ(response.state, HTTP_PARSE_DONE);
+  EXPECT_TRUE(response.truncated);
+  EXPECT_TRUE(response.keepAlive);
+  EXPECT_EQ(response.bodyLength, (size_t)BODY_BUFFER_SIZE - 1);
+  EXPECT_EQ(strlen(body), (size_t)BODY_BUFFER_SIZE - 1);
+}
+
+TEST(HttpMessage, BodyUntilCloseEndsWithTheConnection) {
+  std::string raw = "HTTP/1.0 200 OK\r\n\r\npartial";
+  char body[BODY_BUFFER_SIZE];
+  HttpResponse response = parseBytewise(raw, body, sizeof(body));
+  EXPECT_FALSE(httpResponseFinished(response));
+  EXPECT_FALSE(response.keepAlive);
+
+  httpResponseClosed(response);
+  EXPECT_EQ(response.state, HTTP_PARSE_DONE);
+  EXPECT_STREQ(body, "partial");
+}
+
+TEST(HttpMessage, ConnectionCloseHeaderDisablesKeepAlive) {
+  std::string raw = "HTTP/1.1 200 OK\r\nConnection: Close\r\nContent-Length: 0\r\n\r\n";
+  char body[BODY_BUFFER_SIZE];
+  HttpResponse response = parseBytewise(raw, body, sizeof(body));
+  EXPECT_EQ(response.state, HTTP_PARSE_DONE);
+  EXPECT_FALSE(response.keepAlive);
+}
+
+TEST(HttpMessage, CloseBeforeTheBodyIsCompleteIsAnError) {
+  std::string raw = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nabc";
+  char body[BODY_BUFFER_SIZE];
+  HttpResponse response = parseBytewise(raw, body, sizeof(body));
+  httpResponseClosed(response);
+  EXPECT_EQ(response.state, HTTP_PARSE_ERROR);
+  EXPECT_TRUE(response.headersComplete);
+  EXPECT_EQ(response.status, 200);
+}
+
+TEST(HttpMessage, GarbageIsNotAResponse) {
+  char body[BODY_BUFFER_SIZE];
+  HttpResponse response = parseBytewise("<html>\r\n", body, sizeof(body));
+  EXPECT_EQ(response.state, HTTP_PARSE_ERROR);
+  EXPECT_FALSE(response.headersComplete);
+  EXPECT_FALSE(response.keepAlive);
+}
+
+TEST(HttpMessage, LongHeaderLinesAreTruncatedNotOverflowed) {
+  std::string raw = "HTTP/1.1 200 OK\r\nX-Long: " + std::string(4 * HTTP_LINE_BUFFER_SIZE, 'y') +
+                    "\r\nContent-Length: 2\r\n\r\nok";
+  char body[BODY_BUFFER_SIZE];
+  HttpResponse response = parseBytewise(raw, body, sizeof(body));
+  EXPECT_EQ(response.state, HTTP_PARSE_DONE);
+  EXPECT_STREQ(body, "ok");
+}
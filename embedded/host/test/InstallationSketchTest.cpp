@@ -0,0 +1,174 @@
+// ============================================================================
+// File: InstallationSketchTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Boots the installation sketch without a reachable API:
+//              setup() pins the three tasks to their cores and starts the
+//              HTTPS server, whose /index, /metrics and /ws routes answer
+//              local clients. The snapshot is then parsed from a scripted
+//              response stream.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <FastLED.h>
+#include <WiFiClientSecure.h>
+#include <esp_http_server.h>
+#include "Client.h"
+#include "DeviceCache.h"
+#include "LEDManager.h"
+#include "Server.h"
+#include "SharedState.h"
+#include "Tasks.h"
+
+void setup();
+
+// ----------------------------------------------------------------------------
+// Fixture
+// ----------------------------------------------------------------------------
+#define WS_CLIENT_FD 42
+#define INDEX_CLIENT_FD 43
+#define SHOWN_INDEX 2
+#define SHOWN_DEVICE_ID 11
+#define SNAPSHOT_DEVICE_ID 3
+#define UNKNOWN_SENSOR_ID 99
+
+/**
+ * Connection that answers the first request with a fixed response and
+ * closes once it was read, like an HTTP/1.0 server.
+ */
+class ReplyConnection : public HostConnection {
+public:
+  explicit ReplyConnection(const std::string& text) : reply(text) {}
+
+  bool connected() override { return position < reply.size(); }
+  int available() override { return requested ? (int)(reply.size() - position) : 0; }
+  int peek() override { return available() ? (uint8_t)reply[position] : -1; }
+
+  int read(uint8_t* buffer, size_t size) override {
+    size_t count = min(size, (size_t)available());
+    if (count == 0) return -1;
+    memcpy(buffer, reply.data() + position, count);
+    position += count;
+    return (int)count;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    (void)buffer;
+    requested = true;
+    return size;
+  }
+
+private:
+  std::string reply;
+  size_t position = 0;
+  bool requested = false;
+};
+
+class ReplyNetwork : public HostNetwork {
+public:
+  std::unique_ptr<HostConnection> connect(const char* host, uint16_t port, BearSSL::Session* session) override {
+    (void)host;
+    (void)port;
+    (void)session;
+    return std::make_unique<ReplyConnection>(reply);
+  }
+
+  std::string reply;
+};
+
+/**
+ * Runs setup() once per process; ctest starts every test on its own.
+ */
+class InstallationSketchTest : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    hostSetMillis(0);
+    setup();
+  }
+};
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST_F(InstallationSketchTest, SetupPinsTheTasksToTheirCores) {
+  ASSERT_EQ(hostTaskCount(), 3u);
+
+  const char* names[] = { "network", "led", "audio" };
+  const BaseType_t cores[] = { NETWORK_TASK_CORE, LED_TASK_CORE, AUDIO_TASK_CORE };
+  for (size_t i = 0; i < hostTaskCount(); i++) {
+    const HostTask& task = hostTaskAt(i);
+    EXPECT_STREQ(task.name, names[i]);
+    EXPECT_EQ(task.core, cores[i]);
+  }
+  EXPECT_EQ(hostTaskAt(0).stackBytes, (uint32_t)NETWORK_TASK_STACK_SIZE);
+}
+
+TEST_F(InstallationSketchTest, SetupRegistersTheLedStrip) {
+  EXPECT_NE(FastLED.hostController().leds, nullptr);
+  EXPECT_EQ(FastLED.hostController().count, NUM_LEDS);
+}
+
+TEST_F(InstallationSketchTest, IndexRouteReportsTheDisplayedIndex) {
+  EXPECT_EQ(hostHttpdHandlerCount(), 3u);
+  EXPECT_EQ(hostHttpdConfig().max_open_sockets, WS_MAX_CLIENTS + 1);
+
+  std::string body, type;
+  ASSERT_EQ(hostHttpdRequest(STATUS_ROUTE, HTTP_GET, INDEX_CLIENT_FD, &body, &type), ESP_OK);
+  EXPECT_EQ(body, "{\"index\": 0}");
+  EXPECT_EQ(type, "application/json");
+
+  displayedIndex.store(SHOWN_INDEX);
+  ASSERT_EQ(hostHttpdRequest(STATUS_ROUTE, HTTP_GET, INDEX_CLIENT_FD, &body), ESP_OK);
+  EXPECT_EQ(body, "{\"index\": 2}");
+}
+
+TEST_F(InstallationSketchTest, MetricsRouteListsTheTaskStacks) {
+  std::string body;
+  ASSERT_EQ(hostHttpdRequest("/metrics", HTTP_GET, INDEX_CLIENT_FD, &body), ESP_OK);
+  EXPECT_NE(body.find("atmos_task_stack_free_bytes{task=\"network\"}"), std::string::npos);
+  EXPECT_NE(body.find("atmos_task_stack_free_bytes{task=\"audio\"}"), std::string::npos);
+}
+
+TEST_F(InstallationSketchTest, WebSocketClientsReceiveUpdates) {
+  ASSERT_EQ(hostHttpdRequest(WS_ROUTE, HTTP_GET, WS_CLIENT_FD), ESP_OK);
+  EXPECT_TRUE(hostHttpdFramesSentTo(WS_CLIENT_FD).empty());  // Nothing shown yet
+
+  LocalUpdate update = {};
+  update.index = SHOWN_INDEX;
+  update.device.id = SHOWN_DEVICE_ID;
+  localUpdateState.write(update);
+  notifyLocalClients();
+  EXPECT_EQ(hostHttpdRunQueuedWork(), 1u);
+
+  ASSERT_EQ(hostHttpdFramesSentTo(WS_CLIENT_FD).size(), 1u);
+  EXPECT_EQ(hostHttpdFramesSentTo(WS_CLIENT_FD)[0].rfind("{\"index\":2,\"device\":11,", 0), 0u);
+
+  EXPECT_EQ(hostHttpdReceiveFrame(WS_CLIENT_FD, HTTPD_WS_TYPE_CLOSE, ""), ESP_OK);
+  EXPECT_FALSE(hostHttpdSessionOpen(WS_CLIENT_FD));
+}
+
+TEST_F(InstallationSketchTest, SnapshotIsParsedFromTheStream) {
+  ReplyNetwork network;
+  network.reply =
+      "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nETag: \"v1\"\r\n\r\n"
+      "[{\"id\": 3, \"name\": \"Roof\", \"reading_id\": 9, \"updated_at\": 1700000000,"
+      " \"values\": {\"1\": 21.5, \"2\": 40, \"99\": 1}}]";
+  hostSetNetwork(&network);
+  bool refreshed = refreshSnapshot();
+  hostSetNetwork(nullptr);
+
+  ASSERT_TRUE(refreshed);
+  CachedDevice* device = deviceCacheFind(SNAPSHOT_DEVICE_ID);
+  ASSERT_NE(device, nullptr);
+  EXPECT_EQ(device->readingId, 9u);
+  EXPECT_FLOAT_EQ(deviceCacheValue(device, 1, NAN), 21.5f);
+  EXPECT_FLOAT_EQ(deviceCacheValue(device, 2, NAN), 40.0f);
+  EXPECT_TRUE(isnan(deviceCacheValue(device, UNKNOWN_SENSOR_ID, NAN)));  // Filtered out while parsing
+
+  static FleetSnapshot fleet;
+  uint32_t version;
+  ASSERT_TRUE(fleetState.read(fleet, version));
+  EXPECT_EQ(fleet.count, 1u);
+}
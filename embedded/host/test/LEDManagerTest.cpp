@@ -0,0 +1,104 @@
+// ============================================================================
+// File: LEDManagerTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Renders the LED strip on the fake clock: a new scene reaches
+//              the strip with the first crossfade step, while frames in
+//              which no LED changed color skip show().
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <FastLED.h>
+#include "LEDManager.h"
+#include "Metrics.h"
+
+// ----------------------------------------------------------------------------
+// Metrics Stand-In
+// ----------------------------------------------------------------------------
+void metricsCount(Counter counter) {
+  (void)counter;
+}
+
+void metricsObserve(Histogram histogram, uint32_t value) {
+  (void)histogram;
+  (void)value;
+}
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define CALM_TEMP 21.0f
+#define DRY_WATER 0.0f          // No shimmer
+#define CALM_PRESSURE 1030.0f   // Slowest gradient, 24/256 of a phase step per frame
+#define WARM_TEMP 30.0f
+#define CALM_FRAMES 100
+#define CALM_PHASE_STEPS (CALM_FRAMES * 24 / 256 + 1)
+
+class LEDManagerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    hostSetMillis(0);
+    initLEDs();
+    setLedScene(CALM_TEMP, DRY_WATER, CALM_PRESSURE);
+  }
+
+  /**
+   * Renders frames until the crossfade into the current scene is done.
+   */
+  void finishCrossfade() {
+    for (unsigned long end = now + LED_CROSSFADE_MS + LED_FRAME_MS; now < end;) {
+      now += LED_FRAME_MS;
+      renderLedFrame(now);
+    }
+  }
+
+  unsigned long now = 0;
+};
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST_F(LEDManagerTest, NewSceneIsShownWithTheFirstStep) {
+  EXPECT_FALSE(renderLedFrame(now));  // The fade starts from the frame shown
+  EXPECT_EQ(FastLED.hostShowCount(), 0u);
+
+  now += LED_FRAME_MS;
+  EXPECT_TRUE(renderLedFrame(now));
+  EXPECT_EQ(FastLED.hostShowCount(), 1u);
+}
+
+TEST_F(LEDManagerTest, RepeatedSceneWithoutStepSkipsShow) {
+  now += LED_FRAME_MS;
+  renderLedFrame(now);
+  unsigned long shows = FastLED.hostShowCount();
+
+  setLedScene(CALM_TEMP, DRY_WATER, CALM_PRESSURE);  // Same scene, no new fade
+  EXPECT_FALSE(renderLedFrame(now));
+  EXPECT_EQ(FastLED.hostShowCount(), shows);
+}
+
+TEST_F(LEDManagerTest, UnchangedFramesSkipShow) {
+  finishCrossfade();
+  unsigned long shows = FastLED.hostShowCount();
+
+  unsigned long shown = 0;
+  for (int frame = 0; frame < CALM_FRAMES; frame++) {
+    now += LED_FRAME_MS;
+    if (renderLedFrame(now)) shown++;
+  }
+
+  EXPECT_EQ(FastLED.hostShowCount() - shows, shown);
+  EXPECT_LE(shown, (unsigned long)CALM_PHASE_STEPS);  // Only frames where the gradient moved
+}
+
+TEST_F(LEDManagerTest, SceneChangeAfterIdleIsShown) {
+  finishCrossfade();
+  unsigned long shows = FastLED.hostShowCount();
+
+  setLedScene(WARM_TEMP, DRY_WATER, CALM_PRESSURE);
+  now += LED_FRAME_MS;
+  EXPECT_TRUE(renderLedFrame(now));
+  EXPECT_EQ(FastLED.hostShowCount(), shows + 1);
+}
@@ -0,0 +1,133 @@
+// ============================================================================
+// File: PushProbeTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Checks the protocol logic of the push probe: client frames
+//              against the RFC 6455 examples, partial and invalid frames,
+//              the change time of an update and the latency estimate.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <string>
+#include "PushProbe.h"
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define BUFFER_SIZE 70000
+
+static const uint8_t RFC_MASK[WS_MASK_SIZE] = { 0x37, 0xfa, 0x21, 0x3d };
+
+// ----------------------------------------------------------------------------
+// Frames
+// ----------------------------------------------------------------------------
+
+TEST(PushProbe, EncodesTheMaskedHelloOfTheRfc) {
+  uint8_t out[32];
+  size_t length = wsEncodeFrame(WS_OPCODE_TEXT, (const uint8_t*)"Hello", 5, RFC_MASK, out, sizeof(out));
+
+  const uint8_t expected[] = { 0x81, 0x85, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d, 0x51, 0x58 };
+  ASSERT_EQ(length, sizeof(expected));
+  EXPECT_EQ(memcmp(out, expected, length), 0);
+}
+
+TEST(PushProbe, DecodesUnmaskedAndMaskedFrames) {
+  uint8_t unmasked[] = { 0x81, 0x05, 'H', 'e', 'l', 'l', 'o' };
+  WsFrame frame;
+  ASSERT_EQ(wsDecodeFrame(unmasked, sizeof(unmasked), frame), sizeof(unmasked));
+  EXPECT_EQ(frame.opcode, WS_OPCODE_TEXT);
+  EXPECT_TRUE(frame.final);
+  EXPECT_EQ(std::string((const char*)frame.payload, frame.length), "Hello");
+
+  uint8_t masked[] = { 0x81, 0x85, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d, 0x51, 0x58 };
+  ASSERT_EQ(wsDecodeFrame(masked, sizeof(masked), frame), sizeof(masked));
+  EXPECT_EQ(std::string((const char*)frame.payload, frame.length), "Hello");
+}
+
+TEST(PushProbe, ExtendedLengthsRoundTrip) {
+  static uint8_t payload[BUFFER_SIZE];
+  static uint8_t out[BUFFER_SIZE + WS_MAX_HEADER_SIZE];
+  for (size_t i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t)i;
+
+  const size_t lengths[] = { 0, 125, 126, 65535, 65536, BUFFER_SIZE };
+  for (size_t length : lengths) {
+    size_t encoded = wsEncodeFrame(WS_OPCODE_TEXT, payload, length, RFC_MASK, out, sizeof(out));
+    ASSERT_GT(encoded, length);
+
+    WsFrame frame;
+    ASSERT_EQ(wsDecodeFrame(out, encoded, frame), encoded) << length;
+    ASSERT_EQ(frame.length, length);
+    EXPECT_EQ(memcmp(frame.payload, payload, length), 0) << length;
+  }
+}
+
+TEST(PushProbe, IncompleteFramesWaitForMoreBytes) {
+  uint8_t out[300];
+  uint8_t payload[200] = {};
+  size_t encoded = wsEncodeFrame(WS_OPCODE_TEXT, payload, sizeof(payload), RFC_MASK, out, sizeof(out));
+
+  for (size_t available = 0; available < encoded; available++) {
+    uint8_t copy[300];
+    memcpy(copy, out, available);
+    WsFrame frame;
+    EXPECT_EQ(wsDecodeFrame(copy, available, frame), 0u) << available;
+  }
+}
+
+TEST(PushProbe, RejectsProtocolViolations) {
+  WsFrame frame;
+  uint8_t reserved[] = { 0xC1, 0x00 };  // Compression bit without the extension
+  EXPECT_EQ(wsDecodeFrame(reserved, sizeof(reserved), frame), WS_FRAME_INVALID);
+
+  uint8_t longPing[] = { 0x89, 0x7E, 0x00, 0x80 };  // Control frames carry at most 125 bytes
+  EXPECT_EQ(wsDecodeFrame(longPing, sizeof(longPing), frame), WS_FRAME_INVALID);
+
+  uint8_t fragmentedClose[] = { 0x08, 0x00 };
+  EXPECT_EQ(wsDecodeFrame(fragmentedClose, sizeof(fragmentedClose), frame), WS_FRAME_INVALID);
+}
+
+TEST(PushProbe, EncodeRefusesASmallBuffer) {
+  uint8_t out[10];
+  EXPECT_EQ(wsEncodeFrame(WS_OPCODE_TEXT, (const uint8_t*)"Hello", 5, RFC_MASK, out, sizeof(out)), 0u);
+}
+
+// ----------------------------------------------------------------------------
+// Updates and Latency
+// ----------------------------------------------------------------------------
+
+TEST(PushProbe, ReadsTheChangeTimeOfAnUpdate) {
+  std::string update = "{\"index\":2,\"device\":7,\"at\":123456,\"values\":{\"1\":21.50}}";
+  unsigned long changedAt = 0;
+  ASSERT_TRUE(pushChangedAt(update.data(), update.size(), changedAt));
+  EXPECT_EQ(changedAt, 123456ul);
+
+  std::string old = "{\"index\":2,\"device\":7,\"values\":{}}";
+  EXPECT_FALSE(pushChangedAt(old.data(), old.size(), changedAt));
+
+  std::string cut = "{\"index\":2,\"at\":";
+  EXPECT_FALSE(pushChangedAt(cut.data(), cut.size(), changedAt));
+}
+
+TEST(PushProbe, LatencyIsRelativeToTheFastestPush) {
+  // Host clock 5000 ms ahead of the installation
+  std::vector<PushSample> samples = {
+    { 5000 + 1000 + 20, 1000 },
+    { 5000 + 2000 + 20, 2000 },  // Second subscriber, same delay
+    { 5000 + 3000 + 60, 3000 },
+    { 5000 + 4000 + 120, 4000 },
+  };
+  LatencySummary summary = pushLatencies(samples, 16);
+
+  EXPECT_EQ(summary.samples, 4u);
+  EXPECT_DOUBLE_EQ(summary.minMs, 8);
+  EXPECT_DOUBLE_EQ(summary.medianMs, 8);
+  EXPECT_DOUBLE_EQ(summary.p95Ms, 108);
+  EXPECT_DOUBLE_EQ(summary.maxMs, 108);
+}
+
+TEST(PushProbe, NoSamplesGiveAnEmptySummary) {
+  LatencySummary summary = pushLatencies({}, 10);
+  EXPECT_EQ(summary.samples, 0u);
+  EXPECT_DOUBLE_EQ(summary.maxMs, 0);
+}
@@ -0,0 +1,213 @@
+// ============================================================================
+// File: QueueIndexTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Checks the segment bookkeeping of the reading queue:
+//              wraparound when full, partial acknowledgements across
+//              segment boundaries and the restore after a power loss.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include "QueueIndex.h"
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define SLOT_SIZE 128
+
+/**
+ * Pushes n readings and returns the last push.
+ */
+static QueuePush pushMany(QueueIndex& index, size_t n) {
+  QueuePush push = {};
+  for (size_t i = 0; i < n; i++) push = queueIndexPush(index);
+  return push;
+}
+
+/**
+ * Scan of a flash with valid metadata.
+ */
+static QueueScan scanWithMeta(uint32_t first, uint16_t headOffset, uint32_t oldest, uint32_t newest, uint32_t newestSize) {
+  return { true, first, headOffset, 7, oldest, newest, newestSize, SLOT_SIZE };
+}
+
+// ----------------------------------------------------------------------------
+// Push and Pop
+// ----------------------------------------------------------------------------
+
+TEST(QueueIndex, AppendsWithinASegmentWithoutTouchingTheMetadata) {
+  QueueIndex index = queueIndexEmpty(0);
+  for (uint16_t i = 0; i < QUEUE_SEGMENT_READINGS; i++) {
+    QueuePush push = queueIndexPush(index);
+    EXPECT_EQ(push.segment, 0u);
+    EXPECT_EQ(push.slot, i);
+    EXPECT_FALSE(push.indexChanged);
+    EXPECT_EQ(push.removeSegment, QUEUE_NO_SEGMENT);
+  }
+
+  QueuePush push = queueIndexPush(index);
+  EXPECT_EQ(push.segment, 1u);
+  EXPECT_EQ(push.slot, 0);
+  EXPECT_FALSE(push.indexChanged);
+  EXPECT_EQ(queueIndexCount(index), (size_t)QUEUE_SEGMENT_READINGS + 1);
+}
+
+TEST(QueueIndex, WrapsAroundByDroppingTheOldestSegment) {
+  QueueIndex index = queueIndexEmpty(0);
+  pushMany(index, QUEUE_CAPACITY);
+  EXPECT_EQ(queueIndexCount(index), (size_t)QUEUE_CAPACITY);
+  EXPECT_EQ(index.dropped, 0u);
+
+  QueuePush push = queueIndexPush(index);
+  EXPECT_TRUE(push.indexChanged);
+  EXPECT_EQ(push.removeSegment, 0u);
+  EXPECT_EQ(index.firstSegment, 1u);
+  EXPECT_EQ(index.dropped, (uint32_t)QUEUE_SEGMENT_READINGS);
+  EXPECT_EQ(queueIndexCount(index), (size_t)QUEUE_CAPACITY - QUEUE_SEGMENT_READINGS + 1);
+
+  // The next drop only happens once the new segment is full again
+  pushMany(index, QUEUE_SEGMENT_READINGS - 1);
+  EXPECT_EQ(index.dropped, (uint32_t)QUEUE_SEGMENT_READINGS);
+  push = queueIndexPush(index);
+  EXPECT_EQ(push.removeSegment, 1u);
+  EXPECT_EQ(index.dropped, 2u * QUEUE_SEGMENT_READINGS);
+}
+
+TEST(QueueIndex, OverflowOnlyCountsUnacknowledgedReadingsAsDropped) {
+  QueueIndex index = queueIndexEmpty(0);
+  pushMany(index, QUEUE_CAPACITY);
+  queueIndexPop(index, 5);
+
+  queueIndexPush(index);
+  EXPECT_EQ(index.dropped, (uint32_t)QUEUE_SEGMENT_READINGS - 5);
+  EXPECT_EQ(index.headOffset, 0);
+}
+
+TEST(QueueIndex, WrapsAroundManyTimesWithoutLosingOrder) {
+  QueueIndex index = queueIndexEmpty(0);
+  size_t total = 5 * QUEUE_CAPACITY + 3;
+  pushMany(index, total);
+
+  EXPECT_EQ(queueIndexCount(index) + index.dropped, total);
+  EXPECT_LE(index.lastSegment - index.firstSegment, (uint32_t)QUEUE_SEGMENTS - 1);
+
+  uint32_t segment;
+  uint16_t slot;
+  ASSERT_TRUE(queueIndexLocate(index, 0, segment, slot));
+  EXPECT_EQ((size_t)segment * QUEUE_SEGMENT_READINGS + slot, (size_t)index.dropped);
+}
+
+TEST(QueueIndex, PartialAcknowledgementAcrossSegments) {
+  QueueIndex index = queueIndexEmpty(0);
+  pushMany(index, 40);
+
+  EXPECT_EQ(queueIndexPop(index, 3), 0u);
+  EXPECT_EQ(index.headOffset, 3);
+  EXPECT_EQ(queueIndexCount(index), 37u);
+
+  // 13 more finish segment 0, 2 more reach into segment 1
+  EXPECT_EQ(queueIndexPop(index, 15), 1u);
+  EXPECT_EQ(index.headOffset, 2);
+  EXPECT_EQ(queueIndexCount(index), 22u);
+
+  uint32_t segment;
+  uint16_t slot;
+  ASSERT_TRUE(queueIndexLocate(index, 0, segment, slot));
+  EXPECT_EQ(segment, 1u);
+  EXPECT_EQ(slot, 2);
+  ASSERT_TRUE(queueIndexLocate(index, 21, segment, slot));
+  EXPECT_EQ(segment, 2u);
+  EXPECT_EQ(slot, 7);
+  EXPECT_FALSE(queueIndexLocate(index, 22, segment, slot));
+}
+
+TEST(QueueIndex, PopIsCappedAtTheQueueLength) {
+  QueueIndex index = queueIndexEmpty(0);
+  pushMany(index, 20);
+  EXPECT_EQ(queueIndexPop(index, 100), 1u);
+  EXPECT_EQ(queueIndexCount(index), 0u);
+  EXPECT_EQ(index.headOffset, 4);
+}
+
+TEST(QueueIndex, EmptyFullSegmentIsDeletedWhenTheNextOneStarts) {
+  QueueIndex index = queueIndexEmpty(0);
+  pushMany(index, QUEUE_SEGMENT_READINGS);
+  queueIndexPop(index, QUEUE_SEGMENT_READINGS);
+  EXPECT_EQ(index.firstSegment, 0u);
+
+  QueuePush push = queueIndexPush(index);
+  EXPECT_EQ(push.segment, 1u);
+  EXPECT_EQ(push.removeSegment, 0u);
+  EXPECT_TRUE(push.indexChanged);
+  EXPECT_EQ(index.dropped, 0u);
+  EXPECT_EQ(queueIndexCount(index), 1u);
+}
+
+// ----------------------------------------------------------------------------
+// Restore After Power Loss
+// ----------------------------------------------------------------------------
+
+TEST(QueueIndex, RestoresFromMetadataAndSegments) {
+  QueueIndex index = queueIndexRestore(scanWithMeta(4, 6, 4, 6, 3 * SLOT_SIZE));
+  EXPECT_EQ(index.firstSegment, 4u);
+  EXPECT_EQ(index.lastSegment, 6u);
+  EXPECT_EQ(index.headOffset, 6);
+  EXPECT_EQ(index.tailCount, 3);
+  EXPECT_EQ(index.dropped, 7u);
+  EXPECT_EQ(queueIndexCount(index), (size_t)(QUEUE_SEGMENT_READINGS - 6) + QUEUE_SEGMENT_READINGS + 3);
+}
+
+TEST(QueueIndex, MetadataAheadOfFilesMarksOlderSegmentsStale) {
+  // Power lost after the metadata was written, before segment 4 was deleted
+  QueueIndex index = queueIndexRestore(scanWithMeta(5, 0, 4, 6, SLOT_SIZE));
+  EXPECT_EQ(index.firstSegment, 5u);
+  EXPECT_EQ(queueIndexCount(index), (size_t)QUEUE_SEGMENT_READINGS + 1);
+}
+
+TEST(QueueIndex, FilesAheadOfMetadataResendInsteadOfLosing) {
+  // Segment 4 was deleted by an older firmware without a metadata update
+  QueueIndex index = queueIndexRestore(scanWithMeta(3, 9, 4, 4, 2 * SLOT_SIZE));
+  EXPECT_EQ(index.firstSegment, 4u);
+  EXPECT_EQ(index.headOffset, 0);
+  EXPECT_EQ(queueIndexCount(index), 2u);
+}
+
+TEST(QueueIndex, TornLastSlotIsCutOff) {
+  QueueIndex index = queueIndexRestore(scanWithMeta(0, 0, 0, 0, 5 * SLOT_SIZE + 40));
+  EXPECT_EQ(index.tailCount, 5);
+  EXPECT_EQ(queueIndexCount(index), 5u);
+}
+
+TEST(QueueIndex, MissingMetadataKeepsEverythingOnFlash) {
+  QueueScan scan = { false, 0, 0, 0, 12, 13, 4 * SLOT_SIZE, SLOT_SIZE };
+  QueueIndex index = queueIndexRestore(scan);
+  EXPECT_EQ(index.firstSegment, 12u);
+  EXPECT_EQ(index.dropped, 0u);
+  EXPECT_EQ(queueIndexCount(index), (size_t)QUEUE_SEGMENT_READINGS + 4);
+}
+
+TEST(QueueIndex, AcknowledgedHeadBeyondTailMeansEmpty) {
+  QueueIndex index = queueIndexRestore(scanWithMeta(2, QUEUE_SEGMENT_READINGS, 2, 2, 3 * SLOT_SIZE));
+  EXPECT_EQ(queueIndexCount(index), 0u);
+
+  QueuePush push = queueIndexPush(index);
+  EXPECT_EQ(push.segment, 2u);
+  EXPECT_EQ(push.slot, 3);
+}
+
+TEST(QueueIndex, NoSegmentsContinuesNumberingFromMetadata) {
+  QueueScan scan = { true, 9, 0, 3, QUEUE_NO_SEGMENT, 0, 0, SLOT_SIZE };
+  QueueIndex index = queueIndexRestore(scan);
+  EXPECT_EQ(index.firstSegment, 9u);
+  EXPECT_EQ(index.lastSegment, 9u);
+  EXPECT_EQ(index.dropped, 3u);
+  EXPECT_EQ(queueIndexCount(index), 0u);
+}
+
+TEST(QueueIndex, TooManySegmentsKeepTheNewest) {
+  QueueIndex index = queueIndexRestore(scanWithMeta(0, 0, 0, QUEUE_SEGMENTS + 1, SLOT_SIZE));
+  EXPECT_EQ(index.firstSegment, 2u);
+  EXPECT_EQ(index.dropped, 7u + 2 * QUEUE_SEGMENT_READINGS);
+  EXPECT_LE(queueIndexCount(index), (size_t)QUEUE_CAPACITY);
+}
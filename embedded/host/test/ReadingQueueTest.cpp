@@ -0,0 +1,181 @@
+// ============================================================================
+// File: ReadingQueueTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Runs the reading queue on the in-memory LittleFS: order and
+//              wraparound across reboots, partial acknowledgements, flash
+//              bytes per push, and a power cut at every flash operation of
+//              a push/acknowledge sequence.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <LittleFS.h>
+#include "ReadingQueue.h"
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define SEQUENCE_SENSOR_ID 1
+
+/**
+ * Pushes a reading that carries its sequence number as value.
+ */
+static bool pushSequence(uint32_t sequence) {
+  SensorData value = { SEQUENCE_SENSOR_ID, (float)sequence, 0, 0, 1 };
+  return pushReadingAt(&value, 1, sequence);
+}
+
+/**
+ * Returns the sequence numbers of all queued readings, oldest first.
+ */
+static std::vector<uint32_t> queuedSequences() {
+  static QueuedReading readings[QUEUE_CAPACITY];
+  size_t n = peekReadings(readings, QUEUE_CAPACITY);
+  std::vector<uint32_t> sequences;
+  for (size_t i = 0; i < n; i++) sequences.push_back(readings[i].capturedAt);
+  return sequences;
+}
+
+/**
+ * Simulates a reboot: power comes back and the queue is restored.
+ */
+static void reboot() {
+  LittleFS.hostRestorePower();
+  ASSERT_TRUE(initReadingQueue());
+}
+
+class ReadingQueueTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    LittleFS.hostFormat();
+    ASSERT_TRUE(initReadingQueue());
+  }
+};
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST_F(ReadingQueueTest, KeepsOrderAcrossReboots) {
+  for (uint32_t i = 1; i <= 40; i++) ASSERT_TRUE(pushSequence(i));
+  reboot();
+
+  std::vector<uint32_t> sequences = queuedSequences();
+  ASSERT_EQ(sequences.size(), 40u);
+  for (uint32_t i = 0; i < 40; i++) EXPECT_EQ(sequences[i], i + 1);
+}
+
+TEST_F(ReadingQueueTest, PartialAcknowledgementSurvivesReboot) {
+  for (uint32_t i = 1; i <= 40; i++) pushSequence(i);
+
+  QueuedReading batch[10];
+  ASSERT_EQ(peekReadings(batch, 10), 10u);
+  popReadings(7);  // Server processed 7 of the 10
+  reboot();
+
+  std::vector<uint32_t> sequences = queuedSequences();
+  ASSERT_EQ(sequences.size(), 33u);
+  EXPECT_EQ(sequences.front(), 8u);
+  EXPECT_EQ(sequences.back(), 40u);
+
+  popReadings(20);  // Crosses two segment boundaries
+  reboot();
+  sequences = queuedSequences();
+  ASSERT_EQ(sequences.size(), 13u);
+  EXPECT_EQ(sequences.front(), 28u);
+}
+
+TEST_F(ReadingQueueTest, WrapsAroundAndCountsDroppedReadings) {
+  uint32_t total = QUEUE_CAPACITY + 20;
+  for (uint32_t i = 1; i <= total; i++) ASSERT_TRUE(pushSequence(i));
+
+  // Two segments were dropped: at reading CAPACITY + 1 and CAPACITY + 17
+  EXPECT_EQ(droppedReadingCount(), 2u * QUEUE_SEGMENT_READINGS);
+  EXPECT_EQ(queuedReadingCount(), (size_t)total - 2 * QUEUE_SEGMENT_READINGS);
+
+  reboot();
+  std::vector<uint32_t> sequences = queuedSequences();
+  ASSERT_EQ(sequences.size(), (size_t)total - 2 * QUEUE_SEGMENT_READINGS);
+  EXPECT_EQ(sequences.front(), 2u * QUEUE_SEGMENT_READINGS + 1);
+  EXPECT_EQ(sequences.back(), total);
+  EXPECT_EQ(droppedReadingCount(), 2u * QUEUE_SEGMENT_READINGS);
+}
+
+TEST_F(ReadingQueueTest, PushProgramsAtMostOneSegment) {
+  size_t segmentBytes = QUEUE_SEGMENT_READINGS * sizeof(QueuedReading);
+  for (uint32_t i = 1; i <= QUEUE_CAPACITY + QUEUE_SEGMENT_READINGS; i++) {
+    ASSERT_TRUE(pushSequence(i));
+    EXPECT_LE(LittleFS.hostLastCommitBytes(), segmentBytes);
+  }
+}
+
+TEST_F(ReadingQueueTest, DiscardsTheLegacySingleFileQueue) {
+  File legacy = LittleFS.open(QUEUE_LEGACY_DATA_PATH, "w");
+  uint8_t data[64] = {};
+  legacy.write(data, sizeof(data));
+  legacy.close();
+
+  reboot();
+  EXPECT_FALSE(LittleFS.exists(QUEUE_LEGACY_DATA_PATH));
+  EXPECT_EQ(queuedReadingCount(), 0u);
+}
+
+/**
+ * Runs pushes and acknowledgements with the power cut after every possible
+ * number of flash operations. After the reboot the queue must hold a gap-free
+ * run of readings that still contains every unacknowledged one; only the
+ * operation in flight at the cut may or may not have happened.
+ */
+TEST_F(ReadingQueueTest, PowerLossAtEveryFlashOperation) {
+  struct Step {
+    bool push;
+    uint32_t count;
+  };
+  const Step steps[] = { { true, 20 }, { false, 5 }, { true, 10 }, { false, 20 }, { true, 3 }, { false, 8 } };
+
+  for (size_t cut = 0; cut < 80; cut++) {
+    SCOPED_TRACE(cut);
+    LittleFS.hostFormat();
+    ASSERT_TRUE(initReadingQueue());
+    LittleFS.hostCutPowerAfter(cut);
+
+    uint32_t pushed = 0;    // Pushes that fully reached flash
+    uint32_t acked = 0;     // Acknowledgements that fully reached flash
+    bool pushInFlight = false;
+    uint32_t ackInFlight = 0;
+
+    for (const Step& step : steps) {
+      for (uint32_t i = 0; i < step.count && LittleFS.hostPowered(); i++) {
+        if (step.push) {
+          pushSequence(pushed + 1);
+          if (LittleFS.hostPowered()) pushed++; else pushInFlight = true;
+        } else {
+          uint32_t n = min(step.count, pushed - acked);
+          popReadings(n);
+          if (LittleFS.hostPowered()) acked += n; else ackInFlight = n;
+          break;
+        }
+      }
+      if (!LittleFS.hostPowered()) break;
+    }
+
+    reboot();
+    std::vector<uint32_t> sequences = queuedSequences();
+    uint32_t newest = pushed + (pushInFlight ? 1 : 0);
+
+    for (size_t i = 1; i < sequences.size(); i++) ASSERT_EQ(sequences[i], sequences[i - 1] + 1);
+    if (sequences.empty()) {
+      EXPECT_GE(acked + ackInFlight, pushed);
+      continue;
+    }
+    EXPECT_GE(sequences.front(), acked + 1);
+    EXPECT_LE(sequences.front(), acked + ackInFlight + 1);
+    EXPECT_GE(sequences.back(), pushed);
+    EXPECT_LE(sequences.back(), newest);
+
+    // The restored queue keeps working
+    ASSERT_TRUE(pushSequence(sequences.back() + 1));
+    EXPECT_EQ(queuedSequences().back(), sequences.back() + 1);
+  }
+}
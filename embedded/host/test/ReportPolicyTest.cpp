@@ -0,0 +1,129 @@
+// ============================================================================
+// File: ReportPolicyTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Checks the send-on-delta policy: absolute and relative
+//              deadbands, the heartbeat, sensors without a rule and the
+//              window statistics carried over from suppressed values.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include "ReportPolicy.h"
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define SENSOR_TEMP 1
+#define SENSOR_LUX 3
+#define SENSOR_UNRULED 6
+#define HEARTBEAT_MS 300000UL
+
+static const ReportRule RULES[] = {
+  { SENSOR_TEMP, 0.5f, REPORT_NO_DEADBAND, HEARTBEAT_MS },
+  { SENSOR_LUX, 1.0f, 0.1f, HEARTBEAT_MS },
+};
+
+/**
+ * Runs one value through the policy and tells whether it was reported.
+ */
+static bool reports(int sensorId, float value, unsigned long now) {
+  SensorData in = { sensorId, value, value, value, 1 };
+  SensorData out[1];
+  return selectReportedValues(&in, 1, out, now) == 1;
+}
+
+class ReportPolicyTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    initReportPolicy(RULES, sizeof(RULES) / sizeof(RULES[0]));
+  }
+};
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST_F(ReportPolicyTest, FirstValueIsAlwaysReported) {
+  EXPECT_TRUE(reports(SENSOR_TEMP, 21.0f, 0));
+}
+
+TEST_F(ReportPolicyTest, AbsoluteDeadbandSuppressesSmallChanges) {
+  unsigned long suppressedBefore = suppressedValueCount();
+  ASSERT_TRUE(reports(SENSOR_TEMP, 21.0f, 0));
+
+  EXPECT_FALSE(reports(SENSOR_TEMP, 21.4f, 1000));
+  EXPECT_FALSE(reports(SENSOR_TEMP, 20.5f, 2000));
+  EXPECT_TRUE(reports(SENSOR_TEMP, 21.6f, 3000));
+  EXPECT_EQ(suppressedValueCount() - suppressedBefore, 2u);
+}
+
+TEST_F(ReportPolicyTest, DeadbandIsMeasuredFromLastReportedValue) {
+  ASSERT_TRUE(reports(SENSOR_TEMP, 21.0f, 0));
+  EXPECT_FALSE(reports(SENSOR_TEMP, 21.3f, 1000));
+  EXPECT_FALSE(reports(SENSOR_TEMP, 21.45f, 2000));
+  EXPECT_TRUE(reports(SENSOR_TEMP, 21.55f, 3000));
+}
+
+TEST_F(ReportPolicyTest, RelativeDeadbandScalesWithValue) {
+  ASSERT_TRUE(reports(SENSOR_LUX, 1000.0f, 0));
+  EXPECT_FALSE(reports(SENSOR_LUX, 1090.0f, 1000));
+  EXPECT_TRUE(reports(SENSOR_LUX, 1101.0f, 2000));
+
+  ASSERT_TRUE(reports(SENSOR_LUX, 5.0f, 3000));
+  EXPECT_FALSE(reports(SENSOR_LUX, 5.9f, 4000));
+  EXPECT_TRUE(reports(SENSOR_LUX, 6.1f, 5000));
+}
+
+TEST_F(ReportPolicyTest, HeartbeatResendsUnchangedValue) {
+  ASSERT_TRUE(reports(SENSOR_TEMP, 21.0f, 0));
+  EXPECT_FALSE(reports(SENSOR_TEMP, 21.0f, HEARTBEAT_MS - 1));
+  EXPECT_TRUE(reports(SENSOR_TEMP, 21.0f, HEARTBEAT_MS));
+  EXPECT_FALSE(reports(SENSOR_TEMP, 21.0f, HEARTBEAT_MS + 1));
+}
+
+TEST_F(ReportPolicyTest, SensorsWithoutRuleAreAlwaysReported) {
+  EXPECT_TRUE(reports(SENSOR_UNRULED, 1.0f, 0));
+  EXPECT_TRUE(reports(SENSOR_UNRULED, 1.0f, 1));
+}
+
+TEST_F(ReportPolicyTest, SelectsOnlyChangedValuesOfAReading) {
+  SensorData values[] = {
+    { SENSOR_TEMP, 21.0f, 0, 0, 1 },
+    { SENSOR_LUX, 100.0f, 0, 0, 1 },
+    { SENSOR_UNRULED, 3.0f, 0, 0, 1 },
+  };
+  SensorData out[3];
+  ASSERT_EQ(selectReportedValues(values, 3, out, 0), 3u);
+
+  values[1].value = 150.0f;
+  ASSERT_EQ(selectReportedValues(values, 3, out, 1000), 2u);
+  EXPECT_EQ(out[0].sensorId, SENSOR_LUX);
+  EXPECT_EQ(out[1].sensorId, SENSOR_UNRULED);
+}
+
+TEST_F(ReportPolicyTest, SuppressedWindowsAreMergedIntoNextReport) {
+  SensorData window = { SENSOR_TEMP, 21.0f, 20.8f, 21.2f, 4 };
+  SensorData out[1];
+  ASSERT_EQ(selectReportedValues(&window, 1, out, 0), 1u);
+
+  // The mean stays within the deadband, but one sample spiked
+  window = { SENSOR_TEMP, 21.2f, 20.9f, 27.0f, 5 };
+  ASSERT_EQ(selectReportedValues(&window, 1, out, 2000), 0u);
+  window = { SENSOR_TEMP, 21.3f, 19.5f, 21.4f, 3 };
+  ASSERT_EQ(selectReportedValues(&window, 1, out, 4000), 0u);
+
+  window = { SENSOR_TEMP, 22.0f, 21.8f, 22.1f, 4 };
+  ASSERT_EQ(selectReportedValues(&window, 1, out, 6000), 1u);
+  EXPECT_FLOAT_EQ(out[0].value, 22.0f);
+  EXPECT_FLOAT_EQ(out[0].min, 19.5f);
+  EXPECT_FLOAT_EQ(out[0].max, 27.0f);
+  EXPECT_EQ(out[0].count, 12u);
+
+  // Merged once: the following report only covers its own window
+  window = { SENSOR_TEMP, 23.0f, 22.9f, 23.1f, 2 };
+  ASSERT_EQ(selectReportedValues(&window, 1, out, 8000), 1u);
+  EXPECT_FLOAT_EQ(out[0].min, 22.9f);
+  EXPECT_FLOAT_EQ(out[0].max, 23.1f);
+  EXPECT_EQ(out[0].count, 2u);
+}
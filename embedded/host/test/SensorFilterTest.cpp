@@ -0,0 +1,201 @@
+// ============================================================================
+// File: SensorFilterTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Checks the fixed-point filters against double-precision
+//              references over long pseudo-random sample sequences, and the
+//              spike rejection rules of the DHT11 path.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <random>
+#include "SensorFilter.h"
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define SEQUENCE_LENGTH 20000
+#define ADC_MAX 1023
+#define CENTI_TOLERANCE 1  // One centi-unit, the resolution of the uploaded value
+
+/**
+ * ADC-like samples: a slow wave, gaussian noise and occasional spikes.
+ */
+static std::vector<int32_t> adcSequence(uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> noise(0.0, 8.0);
+  std::uniform_int_distribution<int> spike(0, 99);
+
+  std::vector<int32_t> samples;
+  for (int i = 0; i < SEQUENCE_LENGTH; i++) {
+    double value = 500.0 + 300.0 * sin(i / 400.0) + noise(generator);
+    if (spike(generator) == 0) value = spike(generator) < 50 ? 0 : ADC_MAX;
+    samples.push_back(toFixed((float)constrain(value, 0.0, (double)ADC_MAX)));
+  }
+  return samples;
+}
+
+/**
+ * Median of the last MEDIAN_WINDOW samples in double precision, using the
+ * same upper median for an even count as the filter.
+ */
+static double referenceMedian(const std::vector<int32_t>& samples, size_t end) {
+  size_t start = end >= MEDIAN_WINDOW ? end - MEDIAN_WINDOW : 0;
+  std::vector<double> window(samples.begin() + start, samples.begin() + end);
+  std::sort(window.begin(), window.end());
+  return window[window.size() / 2];
+}
+
+// ----------------------------------------------------------------------------
+// Conversion
+// ----------------------------------------------------------------------------
+
+TEST(SensorFilter, ToFixedRoundsToNearestCentiUnit) {
+  EXPECT_EQ(toFixed(21.0f), 2100);
+  EXPECT_EQ(toFixed(21.004f), 2100);
+  EXPECT_EQ(toFixed(21.006f), 2101);
+  EXPECT_EQ(toFixed(-3.456f), -346);
+  EXPECT_EQ(toFixed(1013.25f), 101325);
+}
+
+// ----------------------------------------------------------------------------
+// Median
+// ----------------------------------------------------------------------------
+
+TEST(SensorFilter, MedianMatchesReferenceExactly) {
+  std::vector<int32_t> samples = adcSequence(1);
+  MedianFilter filter = {};
+  for (size_t i = 0; i < samples.size(); i++) {
+    ASSERT_EQ(medianFilterAdd(filter, samples[i]), referenceMedian(samples, i + 1)) << "sample " << i;
+  }
+}
+
+TEST(SensorFilter, MedianRemovesSingleSpikes) {
+  MedianFilter filter = {};
+  for (int i = 0; i < MEDIAN_WINDOW; i++) medianFilterAdd(filter, 50000);
+  EXPECT_EQ(medianFilterAdd(filter, 102300), 50000);
+  EXPECT_EQ(medianFilterAdd(filter, 0), 50000);
+}
+
+// ----------------------------------------------------------------------------
+// EMA
+// ----------------------------------------------------------------------------
+
+TEST(SensorFilter, EmaStaysWithinOneCentiUnitOfReference) {
+  for (uint8_t shift = 1; shift <= 4; shift++) {
+    SCOPED_TRACE((int)shift);
+    std::vector<int32_t> samples = adcSequence(shift);
+    EmaFilter filter = { shift, false, 0 };
+    double reference = samples[0];
+    double worst = 0;
+
+    for (size_t i = 0; i < samples.size(); i++) {
+      if (i > 0) reference += (samples[i] - reference) / (1 << shift);
+      int32_t value = emaFilterAdd(filter, samples[i]);
+      worst = max(worst, fabs(value - reference));
+    }
+    EXPECT_LE(worst, CENTI_TOLERANCE);
+  }
+}
+
+TEST(SensorFilter, EmaConvergesToAConstantInput) {
+  EmaFilter filter = { 2, false, 0 };
+  emaFilterAdd(filter, 0);
+  int32_t value = 0;
+  for (int i = 0; i < 100; i++) value = emaFilterAdd(filter, 102300);
+  EXPECT_NEAR(value, 102300, CENTI_TOLERANCE);
+
+  for (int i = 0; i < 100; i++) value = emaFilterAdd(filter, -500);
+  EXPECT_NEAR(value, -500, CENTI_TOLERANCE);
+}
+
+// ----------------------------------------------------------------------------
+// Window
+// ----------------------------------------------------------------------------
+
+TEST(SensorFilter, WindowStatsMatchReference) {
+  std::vector<int32_t> samples = adcSequence(7);
+  size_t windowSize = 20;
+
+  for (size_t start = 0; start + windowSize <= samples.size(); start += windowSize) {
+    WindowStats window = {};
+    double sum = 0;
+    int32_t low = INT32_MAX;
+    int32_t high = INT32_MIN;
+    for (size_t i = start; i < start + windowSize; i++) {
+      windowAdd(window, samples[i]);
+      sum += samples[i];
+      low = min(low, samples[i]);
+      high = max(high, samples[i]);
+    }
+
+    SensorData out = { 4, 0, 0, 0, 0 };
+    ASSERT_TRUE(windowFlush(window, out));
+    EXPECT_EQ(out.sensorId, 4);
+    EXPECT_EQ(out.count, windowSize);
+    EXPECT_NEAR(out.value, sum / windowSize / FILTER_SCALE, 1e-4);
+    EXPECT_FLOAT_EQ(out.min, low / FILTER_SCALE);
+    EXPECT_FLOAT_EQ(out.max, high / FILTER_SCALE);
+  }
+}
+
+TEST(SensorFilter, EmptyWindowLeavesLastValue) {
+  WindowStats window = {};
+  SensorData out = { 1, 21.5f, 21.0f, 22.0f, 3 };
+  EXPECT_FALSE(windowFlush(window, out));
+  EXPECT_FLOAT_EQ(out.value, 21.5f);
+  EXPECT_EQ(out.count, 3);
+}
+
+TEST(SensorFilter, FlushStartsANewWindow) {
+  WindowStats window = {};
+  windowAdd(window, 100);
+  windowAdd(window, 300);
+  SensorData out = {};
+  ASSERT_TRUE(windowFlush(window, out));
+
+  windowAdd(window, 1000);
+  ASSERT_TRUE(windowFlush(window, out));
+  EXPECT_FLOAT_EQ(out.value, 10.0f);
+  EXPECT_FLOAT_EQ(out.min, 10.0f);
+  EXPECT_EQ(out.count, 1);
+}
+
+// ----------------------------------------------------------------------------
+// Spike Rejection
+// ----------------------------------------------------------------------------
+
+TEST(SensorFilter, SpikeFilterRejectsSingleJumps) {
+  SpikeFilter filter = { 300, false, 0, 0 };
+  EXPECT_TRUE(spikeFilterAccept(filter, 2100));
+  EXPECT_FALSE(spikeFilterAccept(filter, 2500));
+  EXPECT_TRUE(spikeFilterAccept(filter, 2150));
+  EXPECT_TRUE(spikeFilterAccept(filter, 2450));
+}
+
+TEST(SensorFilter, SpikeFilterAcceptsPersistentSteps) {
+  SpikeFilter filter = { 300, false, 0, 0 };
+  ASSERT_TRUE(spikeFilterAccept(filter, 2100));
+  for (int i = 0; i < SPIKE_REJECT_LIMIT; i++) EXPECT_FALSE(spikeFilterAccept(filter, 3000));
+  EXPECT_TRUE(spikeFilterAccept(filter, 3000));
+  EXPECT_TRUE(spikeFilterAccept(filter, 3050));
+}
+
+TEST(SensorFilter, DhtPathSkipsNanAndSpikes) {
+  // Same steps as readDht11(): NaN is dropped before the spike filter
+  const float temps[] = { 21.0f, NAN, 21.2f, 85.0f, 21.1f, NAN, 21.3f };
+  SpikeFilter filter = { 300, false, 0, 0 };
+  WindowStats window = {};
+  for (float temp : temps) {
+    if (isnan(temp)) continue;
+    int32_t fixed = toFixed(temp);
+    if (spikeFilterAccept(filter, fixed)) windowAdd(window, fixed);
+  }
+
+  SensorData out = {};
+  ASSERT_TRUE(windowFlush(window, out));
+  EXPECT_EQ(out.count, 4);
+  EXPECT_NEAR(out.value, 21.15f, 1e-4);
+  EXPECT_FLOAT_EQ(out.max, 21.3f);
+}
@@ -0,0 +1,189 @@
+// ============================================================================
+// File: SensorsSketchTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Boots the sensors sketch against a scripted API: setup()
+//              registers the station and turns the WiFi LED on, the loop
+//              samples the mocked sensors and uploads the queued readings
+//              as one batch over the kept-alive connection.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <Adafruit_BMP085.h>
+#include <BH1750.h>
+#include <DHT.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include "Client.h"
+#include "ReadingQueue.h"
+
+void setup();
+void loop();
+
+// ----------------------------------------------------------------------------
+// Scripted API
+// ----------------------------------------------------------------------------
+#define WIFI_LED_PIN 12
+#define WATER_PIN A0
+#define REGISTERED_DEVICE_ID 7
+#define BATCH_WAIT_MS 40000  // Past UPLOAD_MAX_INTERVAL_MS
+#define HEADER_END "\r\n\r\n"
+#define CONTENT_LENGTH_HEADER "Content-Length: "
+
+/**
+ * Request as seen by the API.
+ */
+struct ApiRequest {
+  std::string method;
+  std::string path;
+  std::string body;
+};
+
+/**
+ * Connection to the scripted API. Every complete request is answered right
+ * away with a keep-alive JSON response.
+ */
+class ApiConnection : public HostConnection {
+public:
+  explicit ApiConnection(std::vector<ApiRequest>& log) : requests(log) {}
+
+  bool connected() override { return true; }
+  int available() override { return (int)(reply.size() - position); }
+  int peek() override { return position < reply.size() ? (uint8_t)reply[position] : -1; }
+
+  int read(uint8_t* buffer, size_t size) override {
+    size_t count = min(size, reply.size() - position);
+    if (count == 0) return -1;
+    memcpy(buffer, reply.data() + position, count);
+    position += count;
+    return (int)count;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    pending.append((const char*)buffer, size);
+    answerCompleteRequests();
+    return size;
+  }
+
+private:
+  void answerCompleteRequests() {
+    for (;;) {
+      size_t headerEnd = pending.find(HEADER_END);
+      if (headerEnd == std::string::npos) return;
+
+      size_t bodyLength = 0;
+      size_t lengthAt = pending.find(CONTENT_LENGTH_HEADER);
+      if (lengthAt != std::string::npos && lengthAt < headerEnd) {
+        bodyLength = strtoul(pending.c_str() + lengthAt + strlen(CONTENT_LENGTH_HEADER), nullptr, 10);
+      }
+      size_t bodyStart = headerEnd + strlen(HEADER_END);
+      if (pending.size() < bodyStart + bodyLength) return;
+
+      ApiRequest request;
+      size_t space = pending.find(' ');
+      request.method = pending.substr(0, space);
+      request.path = pending.substr(space + 1, pending.find(' ', space + 1) - space - 1);
+      request.body = pending.substr(bodyStart, bodyLength);
+      pending.erase(0, bodyStart + bodyLength);
+
+      respond(request);
+      requests.push_back(request);
+    }
+  }
+
+  void respond(const ApiRequest& request) {
+    std::string body = "{}";
+    if (request.method == "PUT") {
+      body = "{\"id\":" + std::to_string(REGISTERED_DEVICE_ID) + "}";
+    } else if (request.path == API_READING_BATCH_PATH) {
+      body = "{\"processed\":" + std::to_string(queuedReadingCount()) + "}";
+    }
+
+    reply += "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: keep-alive\r\nContent-Length: " +
+             std::to_string(body.size()) + "\r\n\r\n" + body;
+  }
+
+  std::vector<ApiRequest>& requests;
+  std::string pending;
+  std::string reply;
+  size_t position = 0;
+};
+
+class ApiNetwork : public HostNetwork {
+public:
+  std::unique_ptr<HostConnection> connect(const char* host, uint16_t port, BearSSL::Session* session) override {
+    (void)session;
+    lastHost = host;
+    lastPort = port;
+    connections++;
+    return std::make_unique<ApiConnection>(requests);
+  }
+
+  std::vector<ApiRequest> requests;
+  std::string lastHost;
+  uint16_t lastPort = 0;
+  int connections = 0;
+};
+
+// ----------------------------------------------------------------------------
+// Fixture
+// ----------------------------------------------------------------------------
+
+/**
+ * Runs setup() once per process; ctest starts every test on its own.
+ */
+class SensorsSketchTest : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    hostSetMillis(0);
+    LittleFS.hostFormat();
+    DHT::hostSetReading(21.5f, 40.0f);
+    BH1750::hostSetLux(120.0f);
+    Adafruit_BMP085::hostSetReading(19.0f, 101325);
+    hostSetAnalog(WATER_PIN, 300);
+
+    hostSetNetwork(&network);
+    setup();
+  }
+
+  static void TearDownTestSuite() {
+    hostSetNetwork(nullptr);
+  }
+
+  static ApiNetwork network;
+};
+
+ApiNetwork SensorsSketchTest::network;
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST_F(SensorsSketchTest, SetupRegistersTheStationAndTurnsTheLedOn) {
+  EXPECT_EQ(deviceId, REGISTERED_DEVICE_ID);
+  EXPECT_EQ(hostPinMode(WIFI_LED_PIN), OUTPUT);
+  EXPECT_EQ(digitalRead(WIFI_LED_PIN), HIGH);
+  EXPECT_STREQ(hostNtpServer(), NTP_SERVER);
+
+  ASSERT_FALSE(network.requests.empty());
+  EXPECT_EQ(network.requests[0].method, "PUT");
+  EXPECT_EQ(network.requests[0].path, std::string(API_DEVICES_PATH) + "?key=" + HOST_MAC_ADDRESS);
+  EXPECT_EQ(network.lastHost, API_HOST);
+  EXPECT_EQ(network.lastPort, API_PORT);
+}
+
+TEST_F(SensorsSketchTest, LoopUploadsTheSampledReadingsAsOneBatch) {
+  unsigned long until = millis() + BATCH_WAIT_MS;
+  while (millis() < until) loop();
+
+  const ApiRequest* batch = nullptr;
+  for (const ApiRequest& request : network.requests) {
+    if (request.method == "POST" && request.path == API_READING_BATCH_PATH) batch = &request;
+  }
+  ASSERT_NE(batch, nullptr);
+  EXPECT_FALSE(batch->body.empty());
+  EXPECT_EQ(queuedReadingCount(), 0u);
+  EXPECT_EQ(network.connections, 1);  // Registration and upload share the kept-alive connection
+}
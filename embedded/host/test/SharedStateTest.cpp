@@ -0,0 +1,197 @@
+// ============================================================================
+// File: SharedStateTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Runs the lock-free channels between two threads: the seqlock
+//              reader must never see a torn value, not even when a read
+//              gives up, and the queue must deliver every item in order.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <thread>
+#include "SharedState.h"
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+#define WRITE_COUNT 20000
+#define QUEUE_ITEMS 100000
+
+/**
+ * Value that is torn whenever its words differ.
+ */
+struct Stamped {
+  uint32_t words[2048];  // Large enough that copies overlap often
+};
+
+static Stamped stamped(uint32_t value) {
+  Stamped s;
+  for (uint32_t& word : s.words) word = value;
+  return s;
+}
+
+/**
+ * True if all words of a value carry the same stamp.
+ */
+template <typename T>
+static bool consistent(const T& s) {
+  for (uint32_t word : s.words) {
+    if (word != s.words[0]) return false;
+  }
+  return true;
+}
+
+/**
+ * Value whose copy lets a write slip in halfway, the way a preempted
+ * reader would see it on the ESP32. Deterministic even on a single core.
+ */
+struct Interrupted {
+  uint32_t words[16];
+
+  static Seqlock<Interrupted>* lock;
+  static int interruptions;  // Copies that are still interrupted
+  static uint32_t nextValue;
+
+  Interrupted& operator=(const Interrupted& other) {
+    size_t half = sizeof(words) / 2;
+    memcpy(words, other.words, half);
+    if (interruptions > 0 && this != &other) {
+      interruptions--;
+      Interrupted value;
+      for (uint32_t& word : value.words) word = nextValue;
+      nextValue++;
+      int pending = interruptions;
+      interruptions = 0;  // The write's own copy runs uninterrupted
+      lock->write(value);
+      interruptions = pending;
+    }
+    memcpy((uint8_t*)words + half, (const uint8_t*)other.words + half, sizeof(words) - half);
+    return *this;
+  }
+};
+
+Seqlock<Interrupted>* Interrupted::lock = nullptr;
+int Interrupted::interruptions = 0;
+uint32_t Interrupted::nextValue = 1;
+
+// ----------------------------------------------------------------------------
+// Seqlock
+// ----------------------------------------------------------------------------
+
+TEST(SharedState, SeqlockReadsTheLastWrite) {
+  static Seqlock<Stamped> lock;
+  Stamped out = stamped(0);
+  uint32_t version = 0;
+
+  lock.write(stamped(7));
+  ASSERT_TRUE(lock.read(out, version));
+  EXPECT_EQ(out.words[0], 7u);
+  EXPECT_EQ(version, lock.version());
+  EXPECT_EQ(version % 2, 0u);
+
+  lock.write(stamped(8));
+  EXPECT_NE(lock.version(), version);
+}
+
+TEST(SharedState, GivingUpLeavesTheOutputUntouched) {
+  static Seqlock<Interrupted> lock;
+  Interrupted::lock = &lock;
+  Interrupted initial;
+  for (uint32_t& word : initial.words) word = 0;
+  lock.write(initial);
+
+  Interrupted out;
+  for (uint32_t& word : out.words) word = 42;
+  uint32_t version = 0;
+
+  // Every attempt overlaps a write
+  Interrupted::interruptions = SEQLOCK_MAX_RETRIES;
+  EXPECT_FALSE(lock.read(out, version));
+  EXPECT_TRUE(consistent(out));
+  EXPECT_EQ(out.words[0], 42u);
+  EXPECT_EQ(version, 0u);
+
+  // Two attempts overlap a write, the third gets the newest value
+  Interrupted::interruptions = 2;
+  ASSERT_TRUE(lock.read(out, version));
+  EXPECT_TRUE(consistent(out));
+  EXPECT_EQ(out.words[0], Interrupted::nextValue - 1);
+  EXPECT_EQ(version, lock.version());
+  Interrupted::interruptions = 0;
+}
+
+TEST(SharedState, SeqlockNeverHandsOutATornCopy) {
+  static Seqlock<Stamped> lock;
+  lock.write(stamped(0));
+  std::atomic<bool> done{ false };
+
+  std::thread writer([&] {
+    for (uint32_t i = 1; i <= WRITE_COUNT; i++) lock.write(stamped(i));
+    done.store(true);
+  });
+
+  Stamped out = stamped(0);
+  uint32_t last = 0;
+  size_t reads = 0;
+  size_t failures = 0;
+  while (!done.load()) {
+    uint32_t version;
+    Stamped before = out;
+    bool ok = lock.read(out, version);
+    reads++;
+
+    ASSERT_TRUE(consistent(out)) << "read " << reads << (ok ? " succeeded" : " gave up");
+    if (!ok) {
+      failures++;
+      ASSERT_EQ(memcmp(&out, &before, sizeof(out)), 0) << "a failed read changed the output";
+      continue;
+    }
+    ASSERT_GE(out.words[0], last);  // Values only move forward
+    last = out.words[0];
+  }
+  writer.join();
+
+  uint32_t version;
+  ASSERT_TRUE(lock.read(out, version));
+  EXPECT_EQ(out.words[0], (uint32_t)WRITE_COUNT);
+  RecordProperty("reads", (int)reads);
+  RecordProperty("failed_reads", (int)failures);
+}
+
+// ----------------------------------------------------------------------------
+// SPSC Queue
+// ----------------------------------------------------------------------------
+
+TEST(SharedState, QueueHoldsExactlyItsCapacity) {
+  SpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; i++) EXPECT_TRUE(queue.push(i));
+  EXPECT_FALSE(queue.push(4));
+
+  int item;
+  ASSERT_TRUE(queue.pop(item));
+  EXPECT_EQ(item, 0);
+  EXPECT_TRUE(queue.push(4));
+}
+
+TEST(SharedState, QueueDeliversEveryItemInOrderAcrossThreads) {
+  static SpscQueue<int, AUDIO_QUEUE_SIZE> queue;
+
+  std::thread producer([&] {
+    for (int i = 0; i < QUEUE_ITEMS; i++) {
+      while (!queue.push(i)) std::this_thread::yield();
+    }
+  });
+
+  int expected = 0;
+  while (expected < QUEUE_ITEMS) {
+    int item;
+    if (!queue.pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(item, expected);
+    expected++;
+  }
+  producer.join();
+}
@@ -0,0 +1,151 @@
+// ============================================================================
+// File: SoundscapeEquivalenceTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Checks that the built-in soundscape table picks the same
+//              track as the if/else cascade it replaced, on a grid that
+//              holds every threshold, the values right next to it, values
+//              in between and NaN for a missing sensor.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "Soundscape.h"
+
+// ----------------------------------------------------------------------------
+// Reference: playBasedOnSensorData() before the table
+// ----------------------------------------------------------------------------
+#define TRACK_RAINSTORM 1
+#define TRACK_BLIZZARD_WIND 2
+#define TRACK_COLD_WINTER_DAY 3
+#define TRACK_COLD_SUNSET_WIND 4
+#define TRACK_MILD_STORM_WIND 5
+#define TRACK_SPRING_MORNING_BIRDS 6
+#define TRACK_MILD_DAY_BREEZE 7
+#define TRACK_SPRING_EVENING_CHILL 8
+#define TRACK_CALM_NIGHT_CRICKETS 9
+#define TRACK_HUMID_STORM_BUILD 10
+#define TRACK_WARM_MORNING_BIRDS 11
+#define TRACK_SUMMER_CICADAS 12
+#define TRACK_SUMMER_NIGHT_CRICKETS 13
+#define TRACK_DEFAULT TRACK_SPRING_MORNING_BIRDS
+
+#define RAIN_THRESHOLD 500.0f
+#define TEMP_VERY_COLD_THRESHOLD 5.0f
+#define TEMP_MILD_DAY_THRESHOLD 25.0f
+#define TEMP_WARM_MIN 20.0f
+#define TEMP_HOT_MIN 28.0f
+#define PRESSURE_LOW 1000.0f
+#define PRESSURE_MILD 1015.0f
+#define LUX_NIGHT_MAX 50.0f
+#define LUX_SUNSET_MAX 200.0f
+#define LUX_DAY_MIN 400.0f
+#define LUX_DAY_MAX 1000.0f
+#define HUMIDITY_HIGH 80.0f
+
+/**
+ * The original cascade, returning the track instead of playing it.
+ */
+static uint8_t referenceTrack(float temp, float hum, float lux, float water, float pressure) {
+  uint8_t trackToPlay = TRACK_DEFAULT;
+
+  if (water > RAIN_THRESHOLD) {
+    trackToPlay = TRACK_RAINSTORM;
+  } else if (temp < TEMP_VERY_COLD_THRESHOLD && pressure < PRESSURE_LOW) {
+    trackToPlay = TRACK_BLIZZARD_WIND;
+  } else if (temp < TEMP_VERY_COLD_THRESHOLD && pressure >= PRESSURE_LOW && lux <= LUX_SUNSET_MAX) {
+    trackToPlay = TRACK_COLD_SUNSET_WIND;
+  } else if (temp < TEMP_VERY_COLD_THRESHOLD && pressure >= PRESSURE_LOW) {
+    trackToPlay = TRACK_COLD_WINTER_DAY;
+  } else if (temp <= TEMP_WARM_MIN && lux < LUX_NIGHT_MAX) {
+    trackToPlay = TRACK_CALM_NIGHT_CRICKETS;
+  } else if (temp < TEMP_WARM_MIN && pressure < PRESSURE_LOW) {
+    trackToPlay = TRACK_MILD_STORM_WIND;
+  } else if (temp < TEMP_WARM_MIN && pressure >= PRESSURE_LOW && lux > LUX_DAY_MIN) {
+    trackToPlay = TRACK_SPRING_MORNING_BIRDS;
+  } else if (temp < TEMP_WARM_MIN && lux < LUX_SUNSET_MAX && lux >= LUX_NIGHT_MAX) {
+    trackToPlay = TRACK_SPRING_EVENING_CHILL;
+  } else if (temp < TEMP_MILD_DAY_THRESHOLD && pressure <= PRESSURE_MILD && hum < HUMIDITY_HIGH) {
+    trackToPlay = TRACK_MILD_DAY_BREEZE;
+  } else if (temp < TEMP_HOT_MIN && pressure < PRESSURE_LOW && hum > HUMIDITY_HIGH) {
+    trackToPlay = TRACK_HUMID_STORM_BUILD;
+  } else if (temp >= TEMP_WARM_MIN && temp < TEMP_HOT_MIN && lux >= LUX_SUNSET_MAX && lux < LUX_DAY_MAX) {
+    trackToPlay = TRACK_WARM_MORNING_BIRDS;
+  } else if (temp >= TEMP_HOT_MIN && lux > LUX_DAY_MAX) {
+    trackToPlay = TRACK_SUMMER_CICADAS;
+  } else if (temp >= TEMP_HOT_MIN && lux < LUX_SUNSET_MAX) {
+    trackToPlay = TRACK_SUMMER_NIGHT_CRICKETS;
+  }
+
+  return trackToPlay;
+}
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+/**
+ * Grid for one input: every threshold and its float neighbours, points
+ * between and beyond the thresholds, and NaN.
+ */
+static std::vector<float> grid(std::vector<float> thresholds, float low, float high) {
+  std::vector<float> values = { low, high, NAN };
+  float previous = low;
+  for (float threshold : thresholds) {
+    values.push_back(nextafterf(threshold, -INFINITY));
+    values.push_back(threshold);
+    values.push_back(nextafterf(threshold, INFINITY));
+    values.push_back((previous + threshold) / 2);
+    previous = threshold;
+  }
+  values.push_back((previous + high) / 2);
+  return values;
+}
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST(SoundscapeEquivalence, DefaultTableMatchesTheCascade) {
+  SoundscapeTable table;
+  soundscapeLoadDefaults(table);
+
+  std::vector<float> temps = grid({ TEMP_VERY_COLD_THRESHOLD, TEMP_WARM_MIN, TEMP_MILD_DAY_THRESHOLD, TEMP_HOT_MIN }, -30, 45);
+  std::vector<float> hums = grid({ HUMIDITY_HIGH }, 0, 100);
+  std::vector<float> luxes = grid({ LUX_NIGHT_MAX, LUX_SUNSET_MAX, LUX_DAY_MIN, LUX_DAY_MAX }, 0, 60000);
+  std::vector<float> waters = grid({ RAIN_THRESHOLD }, 0, 1024);
+  std::vector<float> pressures = grid({ PRESSURE_LOW, PRESSURE_MILD }, 950, 1050);
+
+  size_t checked = 0;
+  size_t tracksSeen[TRACK_SUMMER_NIGHT_CRICKETS + 1] = {};
+  for (float temp : temps) {
+    for (float hum : hums) {
+      for (float lux : luxes) {
+        for (float water : waters) {
+          for (float pressure : pressures) {
+            float inputs[SOUND_INPUT_COUNT];
+            inputs[SOUND_INPUT_TEMP] = temp;
+            inputs[SOUND_INPUT_HUM] = hum;
+            inputs[SOUND_INPUT_LUX] = lux;
+            inputs[SOUND_INPUT_WATER] = water;
+            inputs[SOUND_INPUT_PRESSURE] = pressure;
+
+            uint8_t expected = referenceTrack(temp, hum, lux, water, pressure);
+            ASSERT_EQ(soundscapeSelect(table, inputs), expected)
+              << "temp=" << temp << " hum=" << hum << " lux=" << lux << " water=" << water << " pressure=" << pressure;
+            tracksSeen[expected]++;
+            checked++;
+          }
+        }
+      }
+    }
+  }
+
+  // The grid reaches every track, so no rule goes unchecked
+  for (int track = TRACK_RAINSTORM; track <= TRACK_SUMMER_NIGHT_CRICKETS; track++) {
+    EXPECT_GT(tracksSeen[track], 0u) << "track " << track;
+  }
+  RecordProperty("combinations", (int)checked);
+}
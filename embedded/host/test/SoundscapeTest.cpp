@@ -0,0 +1,70 @@
+// ============================================================================
+// File: SoundscapeTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Checks how soundscape rules are compiled: name lookup,
+//              predicate sharing, rule order and the table limits.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include "Soundscape.h"
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST(Soundscape, MapsApiNames) {
+  EXPECT_EQ(soundInputFromName("temp"), SOUND_INPUT_TEMP);
+  EXPECT_EQ(soundInputFromName("pressure"), SOUND_INPUT_PRESSURE);
+  EXPECT_EQ(soundInputFromName("wind"), SOUND_UNKNOWN);
+  EXPECT_EQ(soundInputFromName(nullptr), SOUND_UNKNOWN);
+  EXPECT_EQ(soundOpFromName("le"), SOUND_OP_LE);
+  EXPECT_EQ(soundOpFromName("eq"), SOUND_UNKNOWN);
+}
+
+TEST(Soundscape, SharedComparisonsAreCompiledOnce) {
+  SoundscapeTable table;
+  soundscapeBegin(table, 1, 6);
+
+  SoundCondition cold[] = { { SOUND_INPUT_TEMP, SOUND_OP_LT, 5.0f } };
+  SoundCondition coldAndDark[] = { { SOUND_INPUT_TEMP, SOUND_OP_LT, 5.0f }, { SOUND_INPUT_LUX, SOUND_OP_LT, 50.0f } };
+  ASSERT_TRUE(soundscapeAddRule(table, 2, coldAndDark, 2));
+  ASSERT_TRUE(soundscapeAddRule(table, 3, cold, 1));
+
+  EXPECT_EQ(table.predicateCount, 2);
+  EXPECT_EQ(table.ruleCount, 2);
+}
+
+TEST(Soundscape, FirstMatchingRuleWins) {
+  SoundscapeTable table;
+  soundscapeBegin(table, 1, 6);
+
+  SoundCondition cold[] = { { SOUND_INPUT_TEMP, SOUND_OP_LT, 5.0f } };
+  SoundCondition coldAndDark[] = { { SOUND_INPUT_TEMP, SOUND_OP_LT, 5.0f }, { SOUND_INPUT_LUX, SOUND_OP_LT, 50.0f } };
+  soundscapeAddRule(table, 2, coldAndDark, 2);
+  soundscapeAddRule(table, 3, cold, 1);
+
+  float darkCold[SOUND_INPUT_COUNT] = { 0.0f, 50.0f, 10.0f, 0.0f, 1013.0f };
+  float brightCold[SOUND_INPUT_COUNT] = { 0.0f, 50.0f, 500.0f, 0.0f, 1013.0f };
+  float warm[SOUND_INPUT_COUNT] = { 20.0f, 50.0f, 500.0f, 0.0f, 1013.0f };
+  EXPECT_EQ(soundscapeSelect(table, darkCold), 2);
+  EXPECT_EQ(soundscapeSelect(table, brightCold), 3);
+  EXPECT_EQ(soundscapeSelect(table, warm), 6);
+}
+
+TEST(Soundscape, RejectsRulesBeyondTheLimits) {
+  SoundscapeTable table;
+  soundscapeBegin(table, 1, 6);
+
+  for (int i = 0; i < SOUNDSCAPE_MAX_PREDICATES; i++) {
+    SoundCondition condition = { SOUND_INPUT_TEMP, SOUND_OP_LT, (float)i };
+    ASSERT_TRUE(soundscapeAddRule(table, 1, &condition, 1) || i >= SOUNDSCAPE_MAX_RULES);
+  }
+  EXPECT_EQ(table.ruleCount, SOUNDSCAPE_MAX_RULES);
+
+  soundscapeBegin(table, 1, 6);
+  SoundCondition many[SOUNDSCAPE_MAX_PREDICATES + 1];
+  for (int i = 0; i <= SOUNDSCAPE_MAX_PREDICATES; i++) many[i] = { SOUND_INPUT_HUM, SOUND_OP_GT, (float)i };
+  EXPECT_FALSE(soundscapeAddRule(table, 1, many, SOUNDSCAPE_MAX_PREDICATES + 1));
+}
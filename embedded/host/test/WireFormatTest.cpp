@@ -0,0 +1,80 @@
+// ============================================================================
+// File: WireFormatTest.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Checks the binary reading frame byte by byte against the
+//              layout documented in WireFormat.h.
+// ============================================================================
+
+#include <gtest/gtest.h>
+#include "WireFormat.h"
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+/**
+ * Reads a little-endian unsigned integer of the given width.
+ */
+static uint32_t readLittleEndian(const uint8_t* p, size_t width) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < width; i++) value |= (uint32_t)p[i] << (i * 8);
+  return value;
+}
+
+// ----------------------------------------------------------------------------
+// Tests
+// ----------------------------------------------------------------------------
+
+TEST(WireFormat, EncodesHeaderReadingsAndValues) {
+  QueuedReading readings[2] = {};
+  readings[0].capturedAt = 1740000000;
+  readings[0].count = 1;
+  readings[0].values[0] = { 3, 412.5f, 0, 0, 1 };
+  readings[1].capturedAt = 1740000002;
+  readings[1].count = 1;
+  readings[1].values[0] = { 1, -2.25f, -3.5f, -1.0f, 20 };
+
+  uint8_t frame[WIRE_FRAME_MAX_SIZE(2)];
+  size_t size = encodeReadingBatch(frame, sizeof(frame), 7, 0x01020304, readings, 2);
+
+  ASSERT_EQ(size, (size_t)WIRE_HEADER_SIZE + 2 * (WIRE_READING_HEADER_SIZE + WIRE_VALUE_SIZE) + WIRE_WINDOW_SIZE);
+  EXPECT_EQ(frame[0], WIRE_FORMAT_VERSION);
+  EXPECT_EQ(readLittleEndian(frame + 1, 2), 7u);
+  EXPECT_EQ(readLittleEndian(frame + 3, 4), 0x01020304u);
+  EXPECT_EQ(frame[7], 2);
+
+  const uint8_t* p = frame + WIRE_HEADER_SIZE;
+  EXPECT_EQ(readLittleEndian(p, 4), 1740000000u);
+  EXPECT_EQ(p[4], 1);
+  p += WIRE_READING_HEADER_SIZE;
+  EXPECT_EQ(p[0], 3);
+  EXPECT_EQ(readLittleEndian(p + 1, 2), 1u);
+  EXPECT_EQ((int32_t)readLittleEndian(p + 3, 4), 41250);
+  p += WIRE_VALUE_SIZE;
+
+  EXPECT_EQ(readLittleEndian(p, 4), 1740000002u);
+  p += WIRE_READING_HEADER_SIZE;
+  EXPECT_EQ(p[0], 1);
+  EXPECT_EQ(readLittleEndian(p + 1, 2), 20u);
+  EXPECT_EQ((int32_t)readLittleEndian(p + 3, 4), -225);
+  EXPECT_EQ((int32_t)readLittleEndian(p + 7, 4), -350);
+  EXPECT_EQ((int32_t)readLittleEndian(p + 11, 4), -100);
+}
+
+TEST(WireFormat, RejectsBufferSmallerThanWorstCase) {
+  QueuedReading reading = {};
+  reading.count = 1;
+  reading.values[0] = { 1, 20.0f, 0, 0, 1 };
+
+  uint8_t frame[WIRE_FRAME_MAX_SIZE(1)];
+  EXPECT_EQ(encodeReadingBatch(frame, sizeof(frame) - 1, 1, 0, &reading, 1), (size_t)WIRE_ENCODE_FAILED);
+  EXPECT_NE(encodeReadingBatch(frame, sizeof(frame), 1, 0, &reading, 1), (size_t)WIRE_ENCODE_FAILED);
+}
+
+TEST(WireFormat, EmptyBatchIsHeaderOnly) {
+  uint8_t frame[WIRE_HEADER_SIZE];
+  EXPECT_EQ(encodeReadingBatch(frame, sizeof(frame), 1, 9, nullptr, 0), (size_t)WIRE_HEADER_SIZE);
+  EXPECT_EQ(frame[7], 0);
+}
@@ -0,0 +1,183 @@
+// ============================================================================
+// File: PushProbe.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Protocol logic of the push probe: client WebSocket frames
+//              (RFC 6455), the change time of an installation update and
+//              the push latency estimate.
+// ============================================================================
+
+#include "PushProbe.h"
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define FIN_BIT 0x80
+#define RESERVED_BITS 0x70
+#define OPCODE_MASK 0x0F
+#define MASK_BIT 0x80
+#define LENGTH_MASK 0x7F
+#define LENGTH_16_BIT 126
+#define LENGTH_64_BIT 127
+#define SHORT_LENGTH_MAX 125
+#define CONTROL_OPCODE_MIN 0x8
+#define BYTE_BITS 8
+#define CHANGED_AT_KEY "\"at\":"
+#define PERCENTILE_95 0.95
+
+// ----------------------------------------------------------------------------
+// WebSocket Frames
+// ----------------------------------------------------------------------------
+
+/**
+ * wsEncodeFrame(opcode, payload, length, mask, out, size)
+ * -------------------------------------------------------
+ * Encodes a single, final client frame.
+ *
+ * @param opcode WS_OPCODE_TEXT, WS_OPCODE_PING, ...
+ * @param payload Payload bytes, not masked.
+ * @param length Payload length.
+ * @param mask Masking key, random per frame.
+ * @param out Buffer of at least WS_MAX_HEADER_SIZE + length bytes.
+ * @param size Size of out.
+ * @return Length of the frame, 0 if out is too small.
+ */
+size_t wsEncodeFrame(uint8_t opcode, const uint8_t* payload, size_t length, const uint8_t mask[WS_MASK_SIZE], uint8_t* out,
+                     size_t size) {
+  size_t header = 2 + (length > SHORT_LENGTH_MAX ? (length > UINT16_MAX ? 8 : 2) : 0) + WS_MASK_SIZE;
+  if (header + length > size) return 0;
+
+  size_t pos = 0;
+  out[pos++] = FIN_BIT | (opcode & OPCODE_MASK);
+  if (length <= SHORT_LENGTH_MAX) {
+    out[pos++] = MASK_BIT | (uint8_t)length;
+  } else if (length <= UINT16_MAX) {
+    out[pos++] = MASK_BIT | LENGTH_16_BIT;
+    out[pos++] = (uint8_t)(length >> BYTE_BITS);
+    out[pos++] = (uint8_t)length;
+  } else {
+    out[pos++] = MASK_BIT | LENGTH_64_BIT;
+    for (int shift = 7 * BYTE_BITS; shift >= 0; shift -= BYTE_BITS) out[pos++] = (uint8_t)((uint64_t)length >> shift);
+  }
+
+  memcpy(out + pos, mask, WS_MASK_SIZE);
+  pos += WS_MASK_SIZE;
+  for (size_t i = 0; i < length; i++) out[pos + i] = payload[i] ^ mask[i % WS_MASK_SIZE];
+  return pos + length;
+}
+
+/**
+ * wsDecodeFrame(buffer, available, frame)
+ * ---------------------------------------
+ * Decodes the frame at the start of buffer. Server frames are normally not
+ * masked; masked ones are unmasked in place.
+ *
+ * @param buffer Received bytes.
+ * @param available Number of received bytes.
+ * @param frame Filled in when a whole frame is available.
+ * @return Bytes the frame takes, 0 if it is not complete yet, or
+ *         WS_FRAME_INVALID if the stream violates the protocol.
+ */
+size_t wsDecodeFrame(uint8_t* buffer, size_t available, WsFrame& frame) {
+  if (available < 2) return 0;
+  if (buffer[0] & RESERVED_BITS) return WS_FRAME_INVALID;  // No extensions were negotiated
+
+  frame.final = buffer[0] & FIN_BIT;
+  frame.opcode = buffer[0] & OPCODE_MASK;
+  bool masked = buffer[1] & MASK_BIT;
+  uint64_t length = buffer[1] & LENGTH_MASK;
+  size_t pos = 2;
+
+  if (length == LENGTH_16_BIT || length == LENGTH_64_BIT) {
+    size_t bytes = length == LENGTH_16_BIT ? 2 : 8;
+    if (available < pos + bytes) return 0;
+    length = 0;
+    for (size_t i = 0; i < bytes; i++) length = (length << BYTE_BITS) | buffer[pos++];
+  }
+  if (frame.opcode >= CONTROL_OPCODE_MIN && (length > SHORT_LENGTH_MAX || !frame.final)) return WS_FRAME_INVALID;
+
+  const uint8_t* mask = buffer + pos;
+  if (masked) pos += WS_MASK_SIZE;
+  if (length > available || available - length < pos) return 0;
+
+  uint8_t* payload = buffer + pos;
+  if (masked) {
+    for (size_t i = 0; i < length; i++) payload[i] ^= mask[i % WS_MASK_SIZE];
+  }
+  frame.payload = payload;
+  frame.length = (size_t)length;
+  return pos + (size_t)length;
+}
+
+// ----------------------------------------------------------------------------
+// Installation Updates
+// ----------------------------------------------------------------------------
+
+/**
+ * pushChangedAt(json, length, changedAtMs)
+ * ----------------------------------------
+ * Reads the "at" field the installation adds to every update: its millis()
+ * when the displayed device or reading changed.
+ *
+ * @param json Payload of a text frame, not terminated.
+ * @param length Payload length.
+ * @param changedAtMs Set to the change time.
+ * @return False if the update has no change time.
+ */
+bool pushChangedAt(const char* json, size_t length, unsigned long& changedAtMs) {
+  size_t keyLength = strlen(CHANGED_AT_KEY);
+  for (size_t i = 0; i + keyLength < length; i++) {
+    if (memcmp(json + i, CHANGED_AT_KEY, keyLength) != 0) continue;
+
+    unsigned long value = 0;
+    size_t pos = i + keyLength;
+    if (pos >= length || json[pos] < '0' || json[pos] > '9') return false;
+    for (; pos < length && json[pos] >= '0' && json[pos] <= '9'; pos++) value = value * 10 + (json[pos] - '0');
+    changedAtMs = value;
+    return true;
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------------
+// Latency
+// ----------------------------------------------------------------------------
+
+/**
+ * pushLatencies(samples, minRttMs)
+ * --------------------------------
+ * The installation and the host clocks are unrelated, so arrival minus
+ * change time is the latency plus an unknown offset. The smallest of these
+ * differences is taken as a push that went out without delay and took
+ * half the fastest ping round trip; every sample is measured against it.
+ * A delay that every push shares cancels out, so this measures how much
+ * slower pushes get than the fastest one, not an absolute latency.
+ *
+ * @param samples Updates received by all subscribers.
+ * @param minRttMs Fastest ping round trip.
+ * @return Latency distribution; all zero without samples.
+ */
+LatencySummary pushLatencies(const std::vector<PushSample>& samples, double minRttMs) {
+  LatencySummary summary = {};
+  summary.samples = samples.size();
+  if (samples.empty()) return summary;
+
+  std::vector<double> offsets;
+  offsets.reserve(samples.size());
+  for (const PushSample& sample : samples) offsets.push_back(sample.arrivalMs - (double)sample.changedAtMs);
+  std::sort(offsets.begin(), offsets.end());
+
+  double fastest = offsets.front();
+  for (double& offset : offsets) offset = offset - fastest + minRttMs / 2;
+
+  size_t last = offsets.size() - 1;
+  summary.minMs = offsets.front();
+  summary.medianMs = offsets[last / 2];
+  summary.p95Ms = offsets[(size_t)std::ceil(last * PERCENTILE_95)];
+  summary.maxMs = offsets.back();
+  return summary;
+}
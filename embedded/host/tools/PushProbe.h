@@ -0,0 +1,84 @@
+// ============================================================================
+// File: PushProbe.h
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Declares the protocol logic of the push probe: WebSocket
+//              framing for the client side, reading the change time from
+//              an installation update and estimating the push latency.
+// ============================================================================
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_PING 0x9
+#define WS_OPCODE_PONG 0xA
+#define WS_MASK_SIZE 4
+#define WS_MAX_HEADER_SIZE 14  // 2 bytes, 8 bytes extended length, mask
+#define WS_FRAME_INVALID ((size_t)-1)
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+/**
+ * A decoded frame. The payload points into the receive buffer and is
+ * already unmasked.
+ */
+struct WsFrame {
+  uint8_t opcode;
+  bool final;
+  const uint8_t* payload;
+  size_t length;
+};
+
+/**
+ * One update as a subscriber received it.
+ */
+struct PushSample {
+  double arrivalMs;          // Host clock
+  unsigned long changedAtMs;  // Installation millis() of the change
+};
+
+/**
+ * Push latency over all samples, in milliseconds.
+ */
+struct LatencySummary {
+  size_t samples;
+  double minMs;
+  double medianMs;
+  double p95Ms;
+  double maxMs;
+};
+
+// ----------------------------------------------------------------------------
+// Function Declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * Encodes a client frame; clients must mask their payload.
+ */
+size_t wsEncodeFrame(uint8_t opcode, const uint8_t* payload, size_t length, const uint8_t mask[WS_MASK_SIZE], uint8_t* out,
+                     size_t size);
+
+/**
+ * Decodes the frame at the start of buffer, unmasking it in place.
+ */
+size_t wsDecodeFrame(uint8_t* buffer, size_t available, WsFrame& frame);
+
+/**
+ * Reads the "at" field of an installation update.
+ */
+bool pushChangedAt(const char* json, size_t length, unsigned long& changedAtMs);
+
+/**
+ * Estimates the push latency of every sample.
+ */
+LatencySummary pushLatencies(const std::vector<PushSample>& samples, double minRttMs);
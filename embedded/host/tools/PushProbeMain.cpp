@@ -0,0 +1,391 @@
+// ============================================================================
+// File: PushProbeMain.cpp
+// Author: Yanis Deplazes
+// License: MIT License
+// Copyright (c) 2025 Yanis Deplazes
+// Description: Test client for the installation's local WebSocket route.
+//              Opens subscribers one by one until the installation refuses
+//              one, printing the free heap after each, then listens and
+//              reports the push latency and how far apart the subscribers
+//              received the same update.
+//
+//   push_probe <installation-ip> [port] [subscribers] [seconds]
+// ============================================================================
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "PushProbe.h"
+
+// ----------------------------------------------------------------------------
+// Constants & Macros
+// ----------------------------------------------------------------------------
+#define DEFAULT_PORT "443"
+#define DEFAULT_SUBSCRIBERS 8
+#define DEFAULT_SECONDS 60
+#define WS_PATH "/ws"
+#define METRICS_PATH "/metrics"
+#define HEAP_METRIC "\natmos_heap_free_bytes "
+#define WS_MIN_FREE_HEAP 40000  // Same as Server.h: the installation refuses clients below it
+#define HANDSHAKE_KEY "dGhlIHNhbXBsZSBub25jZQ=="
+#define HANDSHAKE_END "\r\n\r\n"
+#define SWITCHING_PROTOCOLS " 101 "
+#define RESPONSE_TIMEOUT_MS 5000
+#define ACCEPT_WAIT_MS 1500  // A refused client is closed right after the handshake
+#define PING_COUNT 5
+#define READ_CHUNK 1024
+#define FRAME_BUFFER_SIZE 256
+#define NO_HEAP -1L
+#define MS_PER_SECOND 1000
+
+// ----------------------------------------------------------------------------
+// Types
+// ----------------------------------------------------------------------------
+
+/**
+ * One TLS connection; a subscriber once the handshake is done.
+ */
+struct Connection {
+  int fd = -1;
+  SSL* ssl = nullptr;
+  bool open = false;
+  std::vector<uint8_t> buffer;     // Received, not yet decoded
+  std::vector<PushSample> samples;  // Updates that arrived while listening
+  double pongAtMs = 0;
+};
+
+enum SubscribeResult {
+  SUBSCRIBE_ACCEPTED,
+  SUBSCRIBE_REFUSED,
+  SUBSCRIBE_FAILED
+};
+
+static std::mt19937 maskSource{ std::random_device{}() };
+
+// ----------------------------------------------------------------------------
+// Connections
+// ----------------------------------------------------------------------------
+
+static double nowMs() {
+  using namespace std::chrono;
+  return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Opens a TCP connection and runs the TLS handshake. The installation's
+ * certificate is self-signed, so it is not verified.
+ */
+static bool connectTls(SSL_CTX* ctx, const char* host, const char* port, Connection& conn) {
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(host, port, &hints, &addresses) != 0) return false;
+
+  for (addrinfo* address = addresses; address && conn.fd < 0; address = address->ai_next) {
+    conn.fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (conn.fd >= 0 && connect(conn.fd, address->ai_addr, address->ai_addrlen) != 0) {
+      close(conn.fd);
+      conn.fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+  if (conn.fd < 0) return false;
+
+  conn.ssl = SSL_new(ctx);
+  SSL_set_fd(conn.ssl, conn.fd);
+  SSL_set_tlsext_host_name(conn.ssl, host);
+  conn.open = SSL_connect(conn.ssl) == 1;
+  return conn.open;
+}
+
+static void closeConnection(Connection& conn) {
+  if (conn.ssl) {
+    if (conn.open) SSL_shutdown(conn.ssl);
+    SSL_free(conn.ssl);
+  }
+  if (conn.fd >= 0) close(conn.fd);
+  conn.ssl = nullptr;
+  conn.fd = -1;
+  conn.open = false;
+}
+
+static bool writeAll(Connection& conn, const void* data, size_t length) {
+  return conn.open && SSL_write(conn.ssl, data, (int)length) == (int)length;
+}
+
+/**
+ * Appends whatever arrives within timeoutMs to the buffer.
+ *
+ * @return Bytes read, 0 on timeout, -1 once the connection is closed.
+ */
+static int readSome(Connection& conn, int timeoutMs) {
+  if (!conn.open) return -1;
+  if (SSL_pending(conn.ssl) == 0) {
+    pollfd entry = { conn.fd, POLLIN, 0 };
+    if (poll(&entry, 1, timeoutMs) <= 0) return 0;
+  }
+
+  uint8_t chunk[READ_CHUNK];
+  int count = SSL_read(conn.ssl, chunk, sizeof(chunk));
+  if (count <= 0) {
+    conn.open = false;
+    return -1;
+  }
+  conn.buffer.insert(conn.buffer.end(), chunk, chunk + count);
+  return count;
+}
+
+/**
+ * Reads the free heap from the installation's /metrics route.
+ *
+ * @return Free heap in bytes, NO_HEAP if it could not be read.
+ */
+static long fetchFreeHeap(SSL_CTX* ctx, const char* host, const char* port) {
+  Connection conn;
+  if (!connectTls(ctx, host, port, conn)) {
+    closeConnection(conn);
+    return NO_HEAP;
+  }
+
+  std::string request = std::string("GET ") + METRICS_PATH + " HTTP/1.0\r\nHost: " + host + HANDSHAKE_END;
+  writeAll(conn, request.data(), request.size());
+  while (readSome(conn, RESPONSE_TIMEOUT_MS) > 0) continue;
+  closeConnection(conn);
+
+  std::string response(conn.buffer.begin(), conn.buffer.end());
+  size_t pos = response.find(HEAP_METRIC);
+  return pos == std::string::npos ? NO_HEAP : strtol(response.c_str() + pos + strlen(HEAP_METRIC), nullptr, 10);
+}
+
+// ----------------------------------------------------------------------------
+// WebSocket
+// ----------------------------------------------------------------------------
+
+static bool sendFrame(Connection& conn, uint8_t opcode, const uint8_t* payload, size_t length) {
+  uint8_t mask[WS_MASK_SIZE];
+  for (uint8_t& byte : mask) byte = (uint8_t)maskSource();
+
+  uint8_t frame[FRAME_BUFFER_SIZE];
+  size_t frameLength = wsEncodeFrame(opcode, payload, length, mask, frame, sizeof(frame));
+  return frameLength > 0 && writeAll(conn, frame, frameLength);
+}
+
+/**
+ * Decodes every complete frame in the buffer. Text frames become samples
+ * if record is set, pings are answered and a close ends the connection.
+ *
+ * @return Number of text frames.
+ */
+static size_t processFrames(Connection& conn, double arrivalMs, bool record) {
+  size_t updates = 0;
+  size_t pos = 0;
+  for (;;) {
+    WsFrame frame;
+    size_t used = wsDecodeFrame(conn.buffer.data() + pos, conn.buffer.size() - pos, frame);
+    if (used == 0) break;
+    if (used == WS_FRAME_INVALID) {
+      fprintf(stderr, "Invalid frame, closing subscriber\n");
+      conn.open = false;
+      break;
+    }
+
+    if (frame.opcode == WS_OPCODE_TEXT) {
+      updates++;
+      PushSample sample = { arrivalMs, 0 };
+      if (record && pushChangedAt((const char*)frame.payload, frame.length, sample.changedAtMs)) {
+        conn.samples.push_back(sample);
+      }
+    } else if (frame.opcode == WS_OPCODE_PING) {
+      sendFrame(conn, WS_OPCODE_PONG, frame.payload, frame.length);
+    } else if (frame.opcode == WS_OPCODE_PONG) {
+      conn.pongAtMs = arrivalMs;
+    } else if (frame.opcode == WS_OPCODE_CLOSE) {
+      conn.open = false;
+    }
+    pos += used;
+  }
+  conn.buffer.erase(conn.buffer.begin(), conn.buffer.begin() + pos);
+  return updates;
+}
+
+/**
+ * Connects a subscriber. The installation completes the handshake before
+ * it decides, so a refused subscriber shows as a close within
+ * ACCEPT_WAIT_MS; an accepted one gets the current update instead.
+ */
+static SubscribeResult subscribe(SSL_CTX* ctx, const char* host, const char* port, Connection& conn) {
+  if (!connectTls(ctx, host, port, conn)) return SUBSCRIBE_FAILED;
+
+  std::string request = std::string("GET ") + WS_PATH + " HTTP/1.1\r\nHost: " + host
+                        + "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: " + HANDSHAKE_KEY
+                        + "\r\nSec-WebSocket-Version: 13" + HANDSHAKE_END;
+  if (!writeAll(conn, request.data(), request.size())) return SUBSCRIBE_FAILED;
+
+  size_t headerEnd = std::string::npos;
+  double deadline = nowMs() + RESPONSE_TIMEOUT_MS;
+  while (headerEnd == std::string::npos && nowMs() < deadline) {
+    if (readSome(conn, RESPONSE_TIMEOUT_MS) < 0) return SUBSCRIBE_REFUSED;
+    headerEnd = std::string(conn.buffer.begin(), conn.buffer.end()).find(HANDSHAKE_END);
+  }
+  if (headerEnd == std::string::npos) return SUBSCRIBE_FAILED;
+
+  std::string status(conn.buffer.begin(), conn.buffer.begin() + headerEnd);
+  if (status.find(SWITCHING_PROTOCOLS) == std::string::npos) return SUBSCRIBE_REFUSED;
+  conn.buffer.erase(conn.buffer.begin(), conn.buffer.begin() + headerEnd + strlen(HANDSHAKE_END));
+
+  deadline = nowMs() + ACCEPT_WAIT_MS;
+  while (nowMs() < deadline) {
+    if (processFrames(conn, nowMs(), false) > 0) return SUBSCRIBE_ACCEPTED;  // Replay of the current update
+    if (!conn.open) return SUBSCRIBE_REFUSED;
+    if (readSome(conn, (int)(deadline - nowMs()) + 1) < 0) return SUBSCRIBE_REFUSED;
+  }
+  return SUBSCRIBE_ACCEPTED;  // Nothing shown yet, but still open
+}
+
+/**
+ * Fastest of PING_COUNT ping round trips.
+ *
+ * @return Round trip in ms, 0 if no pong came back.
+ */
+static double measureRtt(Connection& conn) {
+  double fastest = 0;
+  for (int i = 0; i < PING_COUNT && conn.open; i++) {
+    conn.pongAtMs = 0;
+    double sentAt = nowMs();
+    if (!sendFrame(conn, WS_OPCODE_PING, nullptr, 0)) break;
+
+    while (conn.pongAtMs == 0 && conn.open && nowMs() - sentAt < RESPONSE_TIMEOUT_MS) {
+      if (readSome(conn, RESPONSE_TIMEOUT_MS) > 0) processFrames(conn, nowMs(), true);
+    }
+    double rtt = conn.pongAtMs - sentAt;
+    if (conn.pongAtMs > 0 && (fastest == 0 || rtt < fastest)) fastest = rtt;
+  }
+  return fastest;
+}
+
+/**
+ * Receives updates on every subscriber for the given time.
+ */
+static void listen(std::vector<Connection>& subscribers, int seconds) {
+  double end = nowMs() + (double)seconds * MS_PER_SECOND;
+  while (nowMs() < end) {
+    std::vector<pollfd> entries;
+    for (Connection& conn : subscribers) entries.push_back({ conn.open ? conn.fd : -1, POLLIN, 0 });
+    if (poll(entries.data(), entries.size(), (int)(end - nowMs()) + 1) <= 0) continue;
+
+    double arrival = nowMs();
+    for (size_t i = 0; i < subscribers.size(); i++) {
+      Connection& conn = subscribers[i];
+      if (!(entries[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+      do {
+        if (readSome(conn, 0) <= 0) break;
+      } while (SSL_pending(conn.ssl) > 0);
+      processFrames(conn, arrival, true);
+      if (!conn.open) printf("Subscriber %zu was closed\n", i + 1);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Main
+// ----------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <installation-ip> [port] [subscribers] [seconds]\n", argv[0]);
+    return 1;
+  }
+  const char* host = argv[1];
+  const char* port = argc > 2 ? argv[2] : DEFAULT_PORT;
+  int wanted = argc > 3 ? atoi(argv[3]) : DEFAULT_SUBSCRIBERS;
+  int seconds = argc > 4 ? atoi(argv[4]) : DEFAULT_SECONDS;
+
+  SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+  SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+
+  // Subscriber limit
+  long heapBefore = fetchFreeHeap(ctx, host, port);
+  printf("Free heap without subscribers: %ld bytes\n", heapBefore);
+
+  std::vector<Connection> subscribers;
+  long heapLast = heapBefore;
+  for (int i = 0; i < wanted; i++) {
+    Connection conn;
+    SubscribeResult result = subscribe(ctx, host, port, conn);
+    if (result != SUBSCRIBE_ACCEPTED) {
+      printf("Subscriber %d %s\n", i + 1, result == SUBSCRIBE_REFUSED ? "refused" : "failed to connect");
+      closeConnection(conn);
+      break;
+    }
+    subscribers.push_back(std::move(conn));
+
+    long heap = fetchFreeHeap(ctx, host, port);
+    printf("Subscriber %d accepted, free heap %ld bytes\n", i + 1, heap);
+    if (heap != NO_HEAP) heapLast = heap;
+  }
+
+  printf("Concurrent subscribers: %zu\n", subscribers.size());
+  if (!subscribers.empty() && heapBefore != NO_HEAP && heapLast < heapBefore) {
+    long perSubscriber = (heapBefore - heapLast) / (long)subscribers.size();
+    long more = heapLast > WS_MIN_FREE_HEAP ? (heapLast - WS_MIN_FREE_HEAP) / perSubscriber : 0;
+    printf("Heap per subscriber: %ld bytes, room for %ld more before the heap limit\n", perSubscriber, more);
+  }
+  if (subscribers.empty()) {
+    SSL_CTX_free(ctx);
+    return 1;
+  }
+
+  // Push latency
+  double minRtt = 0;
+  for (Connection& conn : subscribers) {
+    double rtt = measureRtt(conn);
+    if (rtt > 0 && (minRtt == 0 || rtt < minRtt)) minRtt = rtt;
+  }
+  printf("Fastest ping round trip: %.1f ms\n", minRtt);
+
+  printf("Listening for %d s...\n", seconds);
+  listen(subscribers, seconds);
+
+  std::vector<PushSample> samples;
+  std::map<unsigned long, std::pair<double, double>> arrivals;  // First and last arrival of every update
+  for (const Connection& conn : subscribers) {
+    for (const PushSample& sample : conn.samples) {
+      samples.push_back(sample);
+      auto found = arrivals.find(sample.changedAtMs);
+      if (found == arrivals.end()) {
+        arrivals[sample.changedAtMs] = { sample.arrivalMs, sample.arrivalMs };
+      } else {
+        found->second.first = std::min(found->second.first, sample.arrivalMs);
+        found->second.second = std::max(found->second.second, sample.arrivalMs);
+      }
+    }
+  }
+
+  LatencySummary latency = pushLatencies(samples, minRtt);
+  printf("Updates received: %zu (%zu distinct)\n", latency.samples, arrivals.size());
+  printf("Push latency ms: min %.1f, median %.1f, p95 %.1f, max %.1f\n", latency.minMs, latency.medianMs, latency.p95Ms,
+         latency.maxMs);
+
+  double spread = 0;
+  for (const auto& update : arrivals) spread = std::max(spread, update.second.second - update.second.first);
+  printf("Largest gap between subscribers receiving the same update: %.1f ms\n", spread);
+
+  for (Connection& conn : subscribers) {
+    sendFrame(conn, WS_OPCODE_CLOSE, nullptr, 0);
+    closeConnection(conn);
+  }
+  SSL_CTX_free(ctx);
+  return 0;
+}
@@ -0,0 +1,139 @@
+<?php
+
+/**
+ * Cascading Delete Test
+ *
+ * Reading and sensordata are partitioned and have no foreign keys, so
+ * deleting a device, reading or sensor must remove the rows that belong to
+ * it itself. Fills a scratch schema, deletes one record of each through the
+ * model the API uses and checks that no orphaned rows are left while the
+ * rows of the other records stay untouched.
+ *
+ * Usage: DB_NAME=atmos_bench php bench/cascade_delete.php
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+// The web server executes every PHP file, so refuse anything but the CLI
+if (PHP_SAPI !== "cli") {
+    http_response_code(404);
+    exit;
+}
+
+require_once __DIR__ . "/../vendor/autoload.php";
+
+use Api\Bench\BenchDatabase;
+use Api\Models\Model;
+
+const DEVICES = 3;
+const READINGS = 300;
+const DELETED_DEVICE = 2;
+const DELETED_SENSOR = 6;
+
+/**
+ * @var array Counts that must be 0 after every delete: rows pointing at a
+ *            device, reading or sensor that no longer exists.
+ */
+const ORPHANS = [
+    "sensordata without reading" => "SELECT COUNT(*) FROM `sensordata` sd
+        LEFT JOIN `reading` r ON sd.reading_id = r.id WHERE r.id IS NULL",
+    "sensordata without sensor" => "SELECT COUNT(*) FROM `sensordata` sd
+        LEFT JOIN `sensor` s ON sd.sensor_id = s.id WHERE s.id IS NULL",
+    "reading without device" => "SELECT COUNT(*) FROM `reading` r
+        LEFT JOIN `device` d ON r.device_id = d.id WHERE d.id IS NULL",
+    "sensorrollup without device" => "SELECT COUNT(*) FROM `sensorrollup` sr
+        LEFT JOIN `device` d ON sr.device_id = d.id WHERE d.id IS NULL",
+    "sensorrollup without sensor" => "SELECT COUNT(*) FROM `sensorrollup` sr
+        LEFT JOIN `sensor` s ON sr.sensor_id = s.id WHERE s.id IS NULL",
+    "devicelatest without reading" => "SELECT COUNT(*) FROM `devicelatest` dl
+        LEFT JOIN `reading` r ON dl.reading_id = r.id WHERE r.id IS NULL",
+    "devicelatest without device" => "SELECT COUNT(*) FROM `devicelatest` dl
+        LEFT JOIN `device` d ON dl.device_id = d.id WHERE d.id IS NULL",
+];
+
+/**
+ * Returns the single number a query selects.
+ */
+function scalar(mysqli $db, string $sql): int
+{
+    return (int) $db->query($sql)->fetch_row()[0];
+}
+
+/**
+ * Counts the rows of every table, so unrelated rows can be compared.
+ */
+function tableCounts(mysqli $db): array
+{
+    $counts = [];
+    foreach (["device", "sensor", "reading", "sensordata", "sensorrollup", "devicelatest"] as $table) {
+        $counts[$table] = scalar($db, "SELECT COUNT(*) FROM `" . $table . "`");
+    }
+    return $counts;
+}
+
+/**
+ * Returns a failure for every kind of row that points at a deleted record.
+ */
+function orphanFailures(mysqli $db, string $after): array
+{
+    $failures = [];
+    foreach (ORPHANS as $name => $sql) {
+        $count = scalar($db, $sql);
+        if ($count !== 0) {
+            $failures[] = sprintf("%s: %d %s", $after, $count, $name);
+        }
+    }
+    return $failures;
+}
+
+try {
+    $checks = [];
+    $orphans = [];
+    $bench = new BenchDatabase();
+    $db = $bench->connection();
+    $bench->reset(DEVICES);
+    $bench->fill(READINGS * BenchDatabase::SENSORS, DEVICES);
+    $bench->backfillLatest();
+    $bench->backfillRollups();
+
+    // A reading that is the latest of its device, so devicelatest points at it
+    $readingId = scalar($db, "SELECT MAX(`reading_id`) FROM `devicelatest` WHERE `device_id` = 1");
+    $before = tableCounts($db);
+    $checks["reading " . $readingId . " deleted"] = (new Model("reading"))->delete($readingId);
+    $after = tableCounts($db);
+    $checks["delete reading: other readings kept"] = $after["reading"] === $before["reading"] - 1;
+    $checks["delete reading: only its " . BenchDatabase::SENSORS . " sensordata rows removed"] =
+        $after["sensordata"] === $before["sensordata"] - BenchDatabase::SENSORS;
+    $orphans = array_merge($orphans, orphanFailures($db, "delete reading"));
+
+    $before = tableCounts($db);
+    $deviceReadings = scalar($db, "SELECT COUNT(*) FROM `reading` WHERE `device_id` = " . DELETED_DEVICE);
+    $checks["device " . DELETED_DEVICE . " deleted"] = (new Model("device"))->delete(DELETED_DEVICE);
+    $after = tableCounts($db);
+    $checks["delete device: other devices' readings kept"] =
+        $after["reading"] === $before["reading"] - $deviceReadings;
+    $checks["delete device: other devices' sensordata kept"] =
+        $after["sensordata"] === $before["sensordata"] - $deviceReadings * BenchDatabase::SENSORS;
+    $checks["delete device: other rollups kept"] =
+        scalar($db, "SELECT COUNT(*) FROM `sensorrollup` WHERE `device_id` = 1") > 0;
+    $orphans = array_merge($orphans, orphanFailures($db, "delete device"));
+
+    $before = tableCounts($db);
+    $checks["sensor " . DELETED_SENSOR . " deleted"] = (new Model("sensor"))->delete(DELETED_SENSOR);
+    $after = tableCounts($db);
+    $checks["delete sensor: other sensors' sensordata kept"] =
+        $after["sensordata"] === $before["sensordata"] - intdiv($before["sensordata"], BenchDatabase::SENSORS);
+    $checks["delete sensor: readings kept"] = $after["reading"] === $before["reading"];
+    $orphans = array_merge($orphans, orphanFailures($db, "delete sensor"));
+} catch (RuntimeException | mysqli_sql_exception $e) {
+    fwrite(STDERR, "Test failed: " . $e->getMessage() . PHP_EOL);
+    exit(1);
+}
+
+$failures = array_merge(array_keys(array_filter($checks, fn($passed) => !$passed)), $orphans);
+foreach ($failures as $failure) {
+    printf("FAIL  %s\n", $failure);
+}
+printf("%d checks and the orphan queries after 3 deletes, %d failed\n", count($checks), count($failures));
+exit(empty($failures) ? 0 : 1);
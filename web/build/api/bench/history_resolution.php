@@ -0,0 +1,146 @@
+<?php
+
+/**
+ * History Resolution Check
+ *
+ * Checks the bucket size HistoryController picks at the boundaries: the
+ * finest rollup whose bucket count fits the requested points, and merged
+ * days once even days do not fit. Then checks how a range that reaches
+ * past the oldest bucket of a rollup is split between the rollups. Needs
+ * no database.
+ *
+ * Usage: php bench/history_resolution.php
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+// The web server executes every PHP file, so refuse anything but the CLI
+if (PHP_SAPI !== "cli") {
+    http_response_code(404);
+    exit;
+}
+
+require_once __DIR__ . "/../vendor/autoload.php";
+
+use Api\Controllers\HistoryController;
+
+const MINUTE = 60;
+const HOUR = 3600;
+const DAY = 86400;
+
+// Midnight UTC, a bucket start of the minute, hour and day rollups
+const START = 1735689600;
+
+// [from, to, points, expected bucket size]
+const CASES = [
+    // 200 minute buckets fit 200 points, one more minute does not
+    [START, START + 200 * MINUTE - 1, 200, MINUTE],
+    [START, START + 200 * MINUTE, 200, HOUR],
+    // The same length unaligned touches one more bucket
+    [START + 30, START + 200 * MINUTE + 29, 200, HOUR],
+    // 1000 hour buckets fit the maximum points, one more hour does not
+    [START, START + 1000 * HOUR - 1, 1000, HOUR],
+    [START, START + 1000 * HOUR, 1000, DAY],
+    // A single point over a day still needs days
+    [START, START + DAY - 1, 1, DAY],
+    [START, START, 1, MINUTE],
+    // A year at the maximum points stays within it
+    [START, START + 365 * DAY, 1000, DAY],
+    // Ten years merge days into the smallest multiple that fits
+    [START, START + 3650 * DAY, 1000, 4 * DAY],
+    [START, START + 1000 * DAY - 1, 1000, DAY],
+    [START, START + 1000 * DAY, 1000, 2 * DAY],
+    // Merged buckets start at multiples of their size, so 30 days starting
+    // mid-bucket need one day more
+    [START, START + 30 * DAY - 1, 1, 31 * DAY],
+];
+
+// [from, to, points, oldest bucket per resolution, expected segments]
+const SEGMENT_CASES = [
+    // Everything still in the minute rollup
+    [
+        START, START + 2 * HOUR - 1, 200, [60 => START - DAY, 3600 => START - DAY, 86400 => START - DAY],
+        [[START, START + 2 * HOUR - 1, MINUTE]],
+    ],
+    // Minutes expired for the first half hour: the first full hour comes
+    // from the hour rollup
+    [
+        START, START + 2 * HOUR - 1, 200, [60 => START + 30 * MINUTE, 3600 => START - DAY, 86400 => START - DAY],
+        [[START, START + HOUR - 1, HOUR], [START + HOUR, START + 2 * HOUR - 1, MINUTE]],
+    ],
+    // Minutes cover no full hour of the range
+    [
+        START, START + 2 * HOUR - 1, 200, [60 => START + 90 * MINUTE, 3600 => START - DAY, 86400 => START - DAY],
+        [[START, START + 2 * HOUR - 1, HOUR]],
+    ],
+    // All three rollups, each for the part only it still holds
+    [
+        START,
+        START + 2 * DAY - 1,
+        3000,
+        [60 => START + DAY + 6 * HOUR + 15 * MINUTE, 3600 => START + 12 * HOUR, 86400 => START],
+        [
+            [START, START + DAY - 1, DAY],
+            [START + DAY, START + DAY + 7 * HOUR - 1, HOUR],
+            [START + DAY + 7 * HOUR, START + 2 * DAY - 1, MINUTE],
+        ],
+    ],
+    // Empty finer rollups leave the whole range to the day rollup
+    [
+        START, START + 2 * HOUR - 1, 200, [60 => null, 3600 => null, 86400 => START - DAY],
+        [[START, START + 2 * HOUR - 1, DAY]],
+    ],
+    // Merged days are never split
+    [
+        START, START + 3650 * DAY, 1000, [60 => START + 3000 * DAY, 3600 => START + 3000 * DAY, 86400 => START],
+        [[START, START + 3650 * DAY, 4 * DAY]],
+    ],
+];
+
+$failures = 0;
+$total = count(CASES) + count(SEGMENT_CASES);
+foreach (CASES as [$from, $to, $points, $expected]) {
+    $bucketSize = HistoryController::pickBucketSize($from, $to, $points);
+    $buckets = intdiv($to, $bucketSize) - intdiv($from, $bucketSize) + 1;
+
+    if ($bucketSize !== $expected || $buckets > $points) {
+        $failures++;
+        printf(
+            "FAIL  range %d s, %d points: bucket %d s (%d buckets), expected %d s\n",
+            $to - $from + 1,
+            $points,
+            $bucketSize,
+            $buckets,
+            $expected
+        );
+    }
+}
+
+foreach (SEGMENT_CASES as [$from, $to, $points, $oldest, $expected]) {
+    $segments = HistoryController::planSegments(
+        $from,
+        $to,
+        HistoryController::pickBucketSize($from, $to, $points),
+        function (int $resolution) use ($oldest): ?int {
+            return $oldest[$resolution];
+        }
+    );
+    $actual = array_map(function (array $segment): array {
+        return [$segment["from"], $segment["to"], $segment["resolution"]];
+    }, $segments);
+
+    if ($actual !== $expected) {
+        $failures++;
+        printf(
+            "FAIL  range %d s, %d points: segments %s, expected %s\n",
+            $to - $from + 1,
+            $points,
+            json_encode($actual),
+            json_encode($expected)
+        );
+    }
+}
+
+printf("%d of %d cases passed\n", $total - $failures, $total);
+exit($failures === 0 ? 0 : 1);
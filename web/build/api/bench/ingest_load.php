@@ -0,0 +1,116 @@
+<?php
+
+/**
+ * Ingest Load Test
+ *
+ * Posts multi-device bodies to POST /reading-with-sensordata/ingest one
+ * after the other, so a single PHP-FPM worker handles them, and reports the
+ * request latency and the sensor values stored per second. Every request
+ * covers all devices, so it also publishes one event per device; since the
+ * events are sent after the response, they must not show in the latency.
+ *
+ * It writes real readings: point it at a development installation whose
+ * devices 1 to N exist.
+ *
+ * Usage: php bench/ingest_load.php [devices] [readings per device] [seconds]
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+// The web server executes every PHP file, so refuse anything but the CLI
+if (PHP_SAPI !== "cli") {
+    http_response_code(404);
+    exit;
+}
+
+const SENSORS = 6;
+const DEFAULT_DEVICES = 10;
+const DEFAULT_READINGS_PER_DEVICE = 10;
+const DEFAULT_SECONDS = 30;
+const TARGET_VALUES_PER_SECOND = 10000;
+
+/**
+ * Builds one ingest body with the given readings per device.
+ */
+function ingestBody(int $devices, int $readingsPerDevice, int $capturedAt): string
+{
+    $readings = [];
+    for ($reading = 0; $reading < $readingsPerDevice; $reading++) {
+        for ($deviceId = 1; $deviceId <= $devices; $deviceId++) {
+            $values = [];
+            for ($sensorId = 1; $sensorId <= SENSORS; $sensorId++) {
+                $values[] = ["sensor_id" => $sensorId, "value" => mt_rand(0, 10000) / 100];
+            }
+            $readings[] = [
+                "device_id"   => $deviceId,
+                "captured_at" => $capturedAt - $readingsPerDevice + $reading,
+                "sensor_data" => $values,
+            ];
+        }
+    }
+    return json_encode(["readings" => $readings]);
+}
+
+/**
+ * Returns the value at a fraction of the sorted durations.
+ */
+function percentile(array $sorted, float $fraction): float
+{
+    return $sorted[min(count($sorted) - 1, (int) floor(count($sorted) * $fraction))];
+}
+
+$devices = count($argv) > 1 ? max(1, (int) $argv[1]) : DEFAULT_DEVICES;
+$readingsPerDevice = count($argv) > 2 ? max(1, (int) $argv[2]) : DEFAULT_READINGS_PER_DEVICE;
+$seconds = count($argv) > 3 ? max(1, (int) $argv[3]) : DEFAULT_SECONDS;
+$url = (getenv("API_URL") ?: "http://nginx/api") . "/reading-with-sensordata/ingest";
+
+$durations = [];
+$stored = 0;
+$failed = 0;
+$start = hrtime(true);
+$end = $start + $seconds * 1e9;
+
+while (hrtime(true) < $end) {
+    $context = stream_context_create([
+        "http" => [
+            "method"        => "POST",
+            "header"        => "Content-Type: application/json",
+            "content"       => ingestBody($devices, $readingsPerDevice, time()),
+            "ignore_errors" => true,
+        ],
+    ]);
+
+    $requestStart = hrtime(true);
+    $body = @file_get_contents($url, false, $context);
+    $durations[] = (hrtime(true) - $requestStart) / 1e6;
+
+    $response = $body === false ? null : json_decode($body, true);
+    if (!isset($response["inserted"])) {
+        $failed++;
+        continue;
+    }
+    $stored += $response["inserted"] * SENSORS;
+}
+
+$elapsed = (hrtime(true) - $start) / 1e9;
+sort($durations);
+$valuesPerSecond = $stored / $elapsed;
+
+printf(
+    "%d devices x %d readings x %d values per request, %d requests, %d failed\n",
+    $devices,
+    $readingsPerDevice,
+    SENSORS,
+    count($durations),
+    $failed
+);
+printf(
+    "latency  p50 %.1f ms  p95 %.1f ms  max %.1f ms\n",
+    percentile($durations, 0.5),
+    percentile($durations, 0.95),
+    end($durations)
+);
+printf("stored   %.0f sensor values/s (target %d)\n", $valuesPerSecond, TARGET_VALUES_PER_SECOND);
+
+exit($failed === 0 && $valuesPerSecond >= TARGET_VALUES_PER_SECOND ? 0 : 1);
@@ -0,0 +1,90 @@
+<?php
+
+/**
+ * Latest Readings Benchmark
+ *
+ * Compares the former LatestDeviceReadings view, which searched the whole
+ * history with a correlated subquery, with the devicelatest table that is
+ * upserted on every reading. For each size the scratch schema is rebuilt
+ * with that many sensordata rows.
+ *
+ * Usage: DB_NAME=atmos_bench php bench/latest_readings.php [rows ...]
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+// The web server executes every PHP file, so refuse anything but the CLI
+if (PHP_SAPI !== "cli") {
+    http_response_code(404);
+    exit;
+}
+
+require_once __DIR__ . "/../vendor/autoload.php";
+
+use Api\Bench\BenchDatabase;
+
+const DEFAULT_ROWS = [1000000, 10000000, 50000000];
+const DEVICES = 10;
+const RUNS = 5;
+const TIMEOUT_SECONDS = 600;
+
+// LatestDeviceReadings before devicelatest existed
+const OLD_VIEW = "SELECT d.id AS device_id, d.name AS device_name, sd.sensor_id, s.name AS sensor_name,
+                         s.unit AS sensor_unit, sd.value, sd.reading_id, r.timestamp
+                  FROM `sensordata` sd
+                  JOIN `reading` r ON sd.reading_id = r.id
+                  JOIN `device` d ON r.device_id = d.id
+                  JOIN `sensor` s ON sd.sensor_id = s.id
+                  WHERE sd.id = (
+                      SELECT sd2.id
+                      FROM `sensordata` sd2
+                      JOIN `reading` r2 ON sd2.reading_id = r2.id
+                      WHERE r2.device_id = r.device_id AND sd2.sensor_id = sd.sensor_id
+                      ORDER BY r2.timestamp DESC, sd2.id DESC
+                      LIMIT 1
+                  )
+                  ORDER BY r.timestamp DESC";
+
+// LatestDeviceReadings now
+const NEW_VIEW = "SELECT d.id AS device_id, d.name AS device_name, dl.sensor_id, s.name AS sensor_name,
+                         s.unit AS sensor_unit, dl.value, dl.reading_id, dl.timestamp
+                  FROM `devicelatest` dl
+                  JOIN `device` d ON dl.device_id = d.id
+                  JOIN `sensor` s ON dl.sensor_id = s.id
+                  ORDER BY dl.timestamp DESC";
+
+// Second query of GET /api/snapshot
+const SNAPSHOT = "SELECT `device_id`, `sensor_id`, `reading_id`, `value`, UNIX_TIMESTAMP(`timestamp`) AS updated_at
+                  FROM `devicelatest`";
+
+/**
+ * Formats a duration, or the timeout if the query did not finish.
+ */
+function formatMs(?float $ms): string
+{
+    return $ms === null ? "> " . TIMEOUT_SECONDS . " s" : sprintf("%.2f ms", $ms);
+}
+
+$sizes = count($argv) > 1 ? array_map("intval", array_slice($argv, 1)) : DEFAULT_ROWS;
+
+try {
+    $bench = new BenchDatabase();
+    printf("%12s  %14s  %14s  %14s  %10s\n", "sensordata", "old view", "devicelatest", "snapshot", "speedup");
+
+    foreach ($sizes as $rows) {
+        $bench->reset(DEVICES);
+        $bench->fill($rows, DEVICES);
+        $bench->backfillLatest();
+
+        $old = $bench->time(OLD_VIEW, RUNS, TIMEOUT_SECONDS);
+        $new = $bench->time(NEW_VIEW, RUNS, TIMEOUT_SECONDS);
+        $snapshot = $bench->time(SNAPSHOT, RUNS, TIMEOUT_SECONDS);
+
+        $speedup = $old === null || $new === null || $new == 0 ? "-" : sprintf("%.0fx", $old / $new);
+        printf("%12d  %14s  %14s  %14s  %10s\n", $rows, formatMs($old), formatMs($new), formatMs($snapshot), $speedup);
+    }
+} catch (RuntimeException | mysqli_sql_exception $e) {
+    fwrite(STDERR, "Benchmark failed: " . $e->getMessage() . PHP_EOL);
+    exit(1);
+}
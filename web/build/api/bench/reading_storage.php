@@ -0,0 +1,159 @@
+<?php
+
+/**
+ * Reading Storage Benchmark
+ *
+ * Simulates a year of readings from 100 stations, one month at a time, once
+ * in unpartitioned tables and once partitioned by month as in db.sql. After
+ * every month it measures the insert throughput of the reading routes (one
+ * transaction per reading with its sensordata rows) and the data and index
+ * size of reading and sensordata. At the end it expires the oldest month,
+ * with DELETE for the unpartitioned tables and DROP PARTITION otherwise.
+ *
+ * Usage: DB_NAME=atmos_bench php bench/reading_storage.php [interval seconds]
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+// The web server executes every PHP file, so refuse anything but the CLI
+if (PHP_SAPI !== "cli") {
+    http_response_code(404);
+    exit;
+}
+
+require_once __DIR__ . "/../vendor/autoload.php";
+
+use Api\Bench\BenchDatabase;
+
+const STATIONS = 100;
+const MONTHS = 12;
+const DEFAULT_INTERVAL = 600;
+const INSERTS = 2000;
+const TIMEOUT_SECONDS = 3600;
+
+/**
+ * Builds the statements that partition reading and sensordata by month,
+ * named like the partitions of the maintenance job.
+ */
+function partitionStatements(int $firstMonth): array
+{
+    $year = (int) gmdate("Y", $firstMonth);
+    $month = (int) gmdate("n", $firstMonth);
+
+    $definitions = [];
+    for ($offset = 0; $offset < MONTHS; $offset++) {
+        $start = gmmktime(0, 0, 0, $month + $offset, 1, $year);
+        $bound = gmmktime(0, 0, 0, $month + $offset + 1, 1, $year);
+        $definitions[] = "PARTITION p" . gmdate("Ym", $start) . " VALUES LESS THAN (" . $bound . ")";
+    }
+    $definitions[] = "PARTITION p_future VALUES LESS THAN MAXVALUE";
+    $partitions = "(" . implode(", ", $definitions) . ")";
+
+    return [
+        "ALTER TABLE `reading` PARTITION BY RANGE (UNIX_TIMESTAMP(`timestamp`)) " . $partitions,
+        "ALTER TABLE `sensordata` PARTITION BY RANGE (`captured_at`) " . $partitions,
+    ];
+}
+
+/**
+ * Inserts readings the way the reading routes do, one transaction each,
+ * at the given time, and returns the readings per second.
+ */
+function insertThroughput(mysqli $db, int $at): float
+{
+    $reading = $db->prepare("INSERT INTO `reading` (`device_id`, `timestamp`) VALUES (?, FROM_UNIXTIME(?))");
+    $sensorData = $db->prepare(
+        "INSERT INTO `sensordata` (`reading_id`, `sensor_id`, `captured_at`, `value`) VALUES "
+        . implode(", ", array_fill(0, BenchDatabase::SENSORS, "(?, ?, ?, ?)"))
+    );
+
+    $start = hrtime(true);
+    for ($i = 0; $i < INSERTS; $i++) {
+        $deviceId = $i % STATIONS + 1;
+        $db->begin_transaction();
+        $reading->bind_param("ii", $deviceId, $at);
+        $reading->execute();
+
+        $params = [];
+        for ($sensorId = 1; $sensorId <= BenchDatabase::SENSORS; $sensorId++) {
+            array_push($params, $db->insert_id, $sensorId, $at, mt_rand(0, 10000) / 100);
+        }
+        $sensorData->bind_param(str_repeat("iiid", BenchDatabase::SENSORS), ...$params);
+        $sensorData->execute();
+        $db->commit();
+    }
+    return INSERTS / ((hrtime(true) - $start) / 1e9);
+}
+
+/**
+ * Formats a size in MB.
+ */
+function formatMb(int $bytes): string
+{
+    return sprintf("%.1f MB", $bytes / 1048576);
+}
+
+$interval = count($argv) > 1 ? max(1, (int) $argv[1]) : DEFAULT_INTERVAL;
+$firstMonth = gmmktime(0, 0, 0, (int) gmdate("n") - MONTHS, 1, (int) gmdate("Y"));
+
+$layouts = [
+    "unpartitioned" => [],
+    "monthly"       => partitionStatements($firstMonth),
+];
+
+try {
+    $bench = new BenchDatabase();
+    $db = $bench->connection();
+    printf("%d stations, one reading every %d s, %d inserts per measurement\n", STATIONS, $interval, INSERTS);
+
+    foreach ($layouts as $layout => $alterations) {
+        $bench->reset(STATIONS, $alterations);
+        printf("\n%s\n%6s  %12s  %12s  %12s  %12s  %12s\n", $layout, "month", "sensordata", "inserts/s", "data", "index", "index/row");
+
+        $rows = 0;
+        for ($offset = 0; $offset < MONTHS; $offset++) {
+            $from = gmmktime(0, 0, 0, (int) gmdate("n", $firstMonth) + $offset, 1, (int) gmdate("Y", $firstMonth));
+            $to = gmmktime(0, 0, 0, (int) gmdate("n", $firstMonth) + $offset + 1, 1, (int) gmdate("Y", $firstMonth));
+            $rows += $bench->fillSpan($from, $to, STATIONS, $interval) * BenchDatabase::SENSORS;
+
+            $throughput = insertThroughput($db, $to - 1);
+            $rows += INSERTS * BenchDatabase::SENSORS;
+
+            $reading = $bench->tableSize("reading");
+            $sensorData = $bench->tableSize("sensordata");
+            $index = $reading["index"] + $sensorData["index"];
+            printf(
+                "%6s  %12d  %12.0f  %12s  %12s  %10.1f B\n",
+                gmdate("Y-m", $from),
+                $rows,
+                $throughput,
+                formatMb($reading["data"] + $sensorData["data"]),
+                formatMb($index),
+                $index / $rows
+            );
+        }
+
+        // Expire the oldest month the way each layout can
+        $bound = gmmktime(0, 0, 0, (int) gmdate("n", $firstMonth) + 1, 1, (int) gmdate("Y", $firstMonth));
+        $expire = empty($alterations)
+            ? [
+                "DELETE FROM `sensordata` WHERE `captured_at` < " . $bound,
+                "DELETE FROM `reading` WHERE `timestamp` < FROM_UNIXTIME(" . $bound . ")",
+            ]
+            : [
+                "ALTER TABLE `sensordata` DROP PARTITION p" . gmdate("Ym", $firstMonth),
+                "ALTER TABLE `reading` DROP PARTITION p" . gmdate("Ym", $firstMonth),
+            ];
+        $durations = array_map(function ($statement) use ($bench) {
+            return $bench->time($statement, 1, TIMEOUT_SECONDS);
+        }, $expire);
+        printf(
+            "expire oldest month: %s\n",
+            in_array(null, $durations, true) ? "> " . TIMEOUT_SECONDS . " s" : sprintf("%.0f ms", array_sum($durations))
+        );
+    }
+} catch (RuntimeException | mysqli_sql_exception $e) {
+    fwrite(STDERR, "Benchmark failed: " . $e->getMessage() . PHP_EOL);
+    exit(1);
+}
@@ -13,6 +13,7 @@
 namespace Api\Controllers;
 
 use Api\Models\Model;
+use Api\Models\TableVersion;
 
 /**
  * Generic Controller Class
@@ -23,6 +24,9 @@ class Controller
     /** @var Model Model instance. */
     protected Model $model;
 
+    /** @var string Lowercase table name, used for its version counter. */
+    protected string $table;
+
     /**
      * Initializes the controller with a specific model.
      *
@@ -31,6 +35,7 @@ class Controller
     public function __construct(string $table)
     {
         $this->model = new Model($table);
+        $this->table = strtolower($table);
     }
 
     /**
@@ -66,6 +71,7 @@ class Controller
             : $this->model->create($data);     // Single insert
 
         if ($result) {
+            $this->bumpVersion();
             $this->sendJsonResponse(["message" => "Created successfully"], 201);
         } else {
             $this->sendJsonResponse(["error" => "Creation failed"], 500);
@@ -81,23 +87,36 @@ class Controller
     public function update(int $id): void
     {
         $data = $this->getJsonRequestBody();
-        $this->model->update($id, $data)
+        $this->model->update($id, $data) && $this->bumpVersion()
             ? $this->sendJsonResponse(["message" => "Updated successfully"])
             : $this->sendJsonResponse(["error" => "Update failed"], 500);
     }
 
     /**
-     * Deletes a record.
+     * Deletes a record and the rows that belong to it.
      *
      * @param int $id The ID of the record.
      */
     public function delete(int $id): void
     {
-        $this->model->delete($id)
+        $dependents = array_keys(Model::DEPENDENT_ROWS[$this->table] ?? []);
+        $this->model->delete($id) && $this->bumpVersion(...$dependents)
             ? $this->sendJsonResponse(["message" => "Deleted successfully"])
             : $this->sendJsonResponse(["error" => "Deletion failed"], 500);
     }
 
+    /**
+     * Marks the table as changed, so cached GET responses are revalidated.
+     *
+     * @param string ...$others Further tables the write changed.
+     * @return bool Always true, so it can be chained after a successful write.
+     */
+    private function bumpVersion(string ...$others): bool
+    {
+        (new TableVersion())->bump($this->table, ...$others);
+        return true;
+    }
+
     /**
      * Sends a JSON response with the specified status code.
      *
@@ -0,0 +1,84 @@
+<?php
+
+/**
+ * DeviceController Class
+ *
+ * Resolves devices by their hardware key (MAC address), so stations can
+ * look up or register themselves without downloading the device list.
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+namespace Api\Controllers;
+
+use Api\Models\Model;
+use Api\Models\TableVersion;
+
+/**
+ * Device Controller Class
+ * Provides the idempotent lookup and registration of a device by key.
+ */
+class DeviceController
+{
+    /** @var string Name prefix for devices registered without a name. */
+    private const DEFAULT_NAME_PREFIX = "Weather Station";
+
+    /** @var Model */
+    private Model $deviceModel;
+
+    /**
+     * Initializes the controller with the device model.
+     */
+    public function __construct()
+    {
+        $this->deviceModel = new Model("device");
+    }
+
+    /**
+     * Looks up the id of the device with the given key.
+     *
+     * @param string $key Device key (MAC address).
+     * @return array API response.
+     */
+    public function findByKey(string $key): array
+    {
+        $device = $this->deviceModel->getByKey($key);
+
+        return $device
+            ? ["id" => (int) $device["id"]]
+            : ["error" => "Not found", "status" => 404];
+    }
+
+    /**
+     * Returns the id of the device with the given key, registering it first
+     * if it does not exist yet. Repeating the request returns the same id.
+     *
+     * @param string $key Device key (MAC address).
+     * @param string|null $name Name for a new device, defaults to one derived from the key.
+     * @return array API response.
+     */
+    public function upsertByKey(string $key, ?string $name): array
+    {
+        $device = $this->deviceModel->getByKey($key);
+        if ($device) {
+            return ["id" => (int) $device["id"], "created" => false];
+        }
+
+        $id = $this->deviceModel->create([
+            "key"  => $key,
+            "name" => $name ?? self::DEFAULT_NAME_PREFIX . " " . $key,
+        ]);
+        if ($id) {
+            (new TableVersion())->bump("device");
+            return ["id" => $id, "created" => true, "status" => 201];
+        }
+
+        // Either a concurrent request registered the key first, or the name is taken
+        $device = $this->deviceModel->getByKey($key);
+
+        return $device
+            ? ["id" => (int) $device["id"], "created" => false]
+            : ["error" => "Device name already in use", "status" => 409];
+    }
+}
@@ -13,6 +13,8 @@
 namespace Api\Controllers;
 
 use Api\Models\Model;
+use Api\Models\EventPublisher;
+use Api\Models\TableVersion;
 use Api\Models\Database; // ⬅️ import the DB singleton
 use mysqli;
 use mysqli_sql_exception;
@@ -24,23 +26,54 @@ use mysqli_sql_exception;
  */
 class ReadingWithSensorDataController
 {
+    /** @var int Maximum number of readings accepted per batch request. */
+    private const MAX_BATCH_READINGS = 100;
+
+    /** @var int Maximum number of readings accepted per ingest request. */
+    private const MAX_INGEST_READINGS = 1000;
+
+    /** @var int Maximum rows per multi-row statement, well below the placeholder limit. */
+    private const INSERT_CHUNK_ROWS = 1000;
+
+    /** @var int innodb_autoinc_lock_mode that does not keep multi-row ids consecutive. */
+    private const AUTOINC_LOCK_MODE_INTERLEAVED = 2;
+
+    /** @var string Push-stream channel the installation subscribes to. */
+    private const READINGS_CHANNEL = "readings";
+
+    /** @var string Inserts a reading; its timestamp is also stored on every value as captured_at. */
+    private const INSERT_READING = "INSERT INTO `reading` (`device_id`, `timestamp`) VALUES (?, FROM_UNIXTIME(?))";
+
+    /** @var string[] Tables written by every reading route. */
+    private const WRITTEN_TABLES = ["reading", "sensordata", "devicelatest", "sensorrollup"];
+
+    /** @var int[] Rollup bucket sizes in seconds: minute, hour and day. */
+    private const ROLLUP_RESOLUTIONS = [60, 3600, 86400];
+
+    /** @var string Keeps the newer of two values: later timestamp, then higher reading id. */
+    private const LATEST_IS_NEWER = "(VALUES(`timestamp`), VALUES(`reading_id`)) > (`timestamp`, `reading_id`)";
+
     /** @var mysqli MySQLi database connection */
     private mysqli $db;
 
-    /** @var Model */
-    private Model $readingModel;
-
     /** @var Model */
     private Model $sensorDataModel;
 
+    /** @var EventPublisher */
+    private EventPublisher $publisher;
+
+    /** @var TableVersion */
+    private TableVersion $versions;
+
     /**
      * Initializes the controller with a specific database models.
      */
     public function __construct()
     {
         $this->db = Database::getInstance()->getConnection();
-        $this->readingModel = new Model("reading");
         $this->sensorDataModel = new Model("sensordata");
+        $this->publisher = new EventPublisher();
+        $this->versions = new TableVersion();
     }
 
     /**
@@ -51,43 +84,508 @@ class ReadingWithSensorDataController
      */
     public function createWithSensorData(array $payload): array
     {
+        if (!$this->isValidReading($payload)) {
+            return ["error" => "Invalid sensor data", "status" => 400];
+        }
+
+        $item = [
+            "device_id"   => $payload["device_id"],
+            "captured_at" => time(),
+            "sensor_data" => $payload["sensor_data"],
+        ];
+
         try {
             $this->db->begin_transaction();
+            // Partitioned tables have no foreign keys, so check the device here
+            if (empty($this->loadKnownDevices([$item["device_id"]]))) {
+                $this->db->rollback();
+                return ["error" => "Unknown device", "status" => 404];
+            }
+            $readingIds = $this->insertReadings([$item]);
+            $this->db->commit();
+        } catch (mysqli_sql_exception $e) {
+            $this->db->rollBack();
+            return ["error" => "Database error: " . $e->getMessage(), "status" => 500];
+        }
 
-            // Step 1: Insert into reading
-            $readingInsert = ["device_id" => $payload["device_id"]];
-            $readingId = $this->readingModel->create($readingInsert);
+        $this->versions->bump(...self::WRITTEN_TABLES);
+        $this->publishReadings([$item], $readingIds);
 
-            if (!$readingId) {
+        return [
+            "message"     => "Created successfully",
+        ];
+    }
+
+    /**
+     * Creates a batch of readings for one device in a single transaction.
+     *
+     * Readings are processed in order. Malformed readings are skipped but still
+     * count as processed, so the device can drop them from its queue. At most
+     * MAX_BATCH_READINGS are processed per request; the response reports how
+     * many were processed so the device only acknowledges that prefix.
+     *
+     * @param array $payload Input data from the client.
+     * @return array API response.
+     */
+    public function createBatchWithSensorData(array $payload): array
+    {
+        $readings = array_slice($payload["readings"], 0, self::MAX_BATCH_READINGS);
+
+        $items = [];
+        foreach ($readings as $reading) {
+            if ($this->isValidReading($reading)) {
+                $items[] = [
+                    "device_id"   => $payload["device_id"],
+                    "captured_at" => $this->capturedAt($reading),
+                    "sensor_data" => $reading["sensor_data"],
+                ];
+            }
+        }
+
+        try {
+            $this->db->begin_transaction();
+            if (empty($this->loadKnownDevices([$payload["device_id"]]))) {
                 $this->db->rollback();
-                return ["error" => "Failed to create reading", "status" => 500];
+                return ["error" => "Unknown device", "status" => 404];
             }
+            $readingIds = $this->insertReadings($items);
+            $this->db->commit();
+        } catch (mysqli_sql_exception $e) {
+            $this->db->rollback();
+            return ["error" => "Database error: " . $e->getMessage(), "status" => 500];
+        }
 
-            // Step 2: Prepare sensor data with reading_id
-            $sensorData = array_map(function ($entry) use ($readingId) {
-                return [
-                    "reading_id" => $readingId,
-                    "sensor_id" => $entry["sensor_id"],
-                    "value"      => $entry["value"]
-                ];
-            }, $payload["sensor_data"]);
+        $this->versions->bump(...self::WRITTEN_TABLES);
+        $this->publishReadings($items, $readingIds);
 
-            // Step 3: Bulk insert
-            $success = $this->sensorDataModel->createBulk($sensorData);
+        return [
+            "message"   => "Created successfully",
+            "processed" => count($readings),
+            "inserted"  => count($items),
+        ];
+    }
 
-            if (!$success) {
-                $this->db->rollBack();
-                return ["error" => "Failed to insert sensor data", "status" => 500];
+    /**
+     * Creates readings of any number of devices in a single transaction, e.g.
+     * from a gateway that collects several stations.
+     *
+     * Every reading gets its own status in "results", in request order:
+     * "created" with its reading_id, "invalid" for a malformed reading or
+     * "unknown_device" if its device does not exist. Rejected readings do not
+     * affect the others. At most MAX_INGEST_READINGS are accepted per request.
+     *
+     * @param array $payload Input data from the client.
+     * @return array API response.
+     */
+    public function ingest(array $payload): array
+    {
+        $readings = $payload["readings"];
+        if (count($readings) > self::MAX_INGEST_READINGS) {
+            return ["error" => "At most " . self::MAX_INGEST_READINGS . " readings per request", "status" => 413];
+        }
+
+        try {
+            $this->db->begin_transaction();
+
+            $deviceIds = [];
+            foreach ($readings as $reading) {
+                if ($this->isValidDeviceReading($reading)) {
+                    $deviceIds[] = $reading["device_id"];
+                }
             }
+            $knownDevices = $this->loadKnownDevices($deviceIds);
 
-            $this->db->commit();
+            $items = [];
+            $results = [];
+            foreach ($readings as $index => $reading) {
+                if (!$this->isValidDeviceReading($reading)) {
+                    $results[$index] = ["status" => "invalid"];
+                } elseif (!isset($knownDevices[$reading["device_id"]])) {
+                    $results[$index] = ["status" => "unknown_device"];
+                } else {
+                    $items[$index] = [
+                        "device_id"   => $reading["device_id"],
+                        "captured_at" => $this->capturedAt($reading),
+                        "sensor_data" => $reading["sensor_data"],
+                    ];
+                }
+            }
 
-            return [
-                "message"     => "Created successfully",
-            ];
+            $readingIds = array_combine(array_keys($items), $this->insertReadings(array_values($items)));
+            $this->db->commit();
         } catch (mysqli_sql_exception $e) {
-            $this->db->rollBack();
+            $this->db->rollback();
             return ["error" => "Database error: " . $e->getMessage(), "status" => 500];
         }
+
+        foreach ($readingIds as $index => $readingId) {
+            $results[$index] = ["status" => "created", "reading_id" => $readingId];
+        }
+        ksort($results);
+        $this->versions->bump(...self::WRITTEN_TABLES);
+        $this->publishReadings(array_values($items), array_values($readingIds));
+
+        return [
+            "message"  => "Processed successfully",
+            "inserted" => count($items),
+            "rejected" => count($readings) - count($items),
+            "results"  => array_values($results),
+        ];
+    }
+
+    /**
+     * Inserts readings with their sensor data, latest values and rollups
+     * inside the caller's transaction. Every step uses multi-row statements
+     * of at most INSERT_CHUNK_ROWS rows, so the number of round trips depends
+     * on the size of the request, not on the number of readings in it.
+     *
+     * @param array $items Valid readings, each with device_id, captured_at
+     *                     (Unix seconds) and sensor_data.
+     * @return int[] The reading id of every item, in the same order.
+     * @throws mysqli_sql_exception If a statement fails.
+     */
+    private function insertReadings(array $items): array
+    {
+        if (empty($items)) {
+            return [];
+        }
+
+        $idStep = $this->consecutiveIdStep();
+        $readingIds = [];
+        foreach (array_chunk($items, self::INSERT_CHUNK_ROWS) as $chunk) {
+            array_push($readingIds, ...$this->insertReadingRows($chunk, $idStep));
+        }
+
+        $sensorData = [];
+        $latest = [];
+        $capturedAtByReading = [];
+        foreach ($items as $index => $item) {
+            $readingId = $readingIds[$index];
+            $capturedAt = $item["captured_at"];
+            $capturedAtByReading[$readingId] = $capturedAt;
+
+            foreach ($item["sensor_data"] as $entry) {
+                $sensorData[] = $this->toSensorDataRow($readingId, $capturedAt, $entry);
+
+                $key = $item["device_id"] . ":" . $entry["sensor_id"];
+                if (!isset($latest[$key]) || $capturedAt >= $latest[$key]["captured_at"]) {
+                    $latest[$key] = [
+                        "device_id"   => $item["device_id"],
+                        "sensor_id"   => $entry["sensor_id"],
+                        "reading_id"  => $readingId,
+                        "value"       => (float) $entry["value"],
+                        "captured_at" => $capturedAt,
+                    ];
+                }
+            }
+        }
+
+        foreach (array_chunk($sensorData, self::INSERT_CHUNK_ROWS) as $chunk) {
+            if (!$this->sensorDataModel->createBulk($chunk)) {
+                throw new mysqli_sql_exception("Failed to insert sensor data");
+            }
+        }
+        foreach (array_chunk($latest, self::INSERT_CHUNK_ROWS) as $chunk) {
+            $this->upsertLatest($chunk);
+        }
+        foreach (array_chunk($capturedAtByReading, self::INSERT_CHUNK_ROWS, true) as $chunk) {
+            $this->updateRollups($chunk);
+        }
+
+        return $readingIds;
+    }
+
+    /**
+     * Inserts reading rows and returns their ids. With consecutive ids, all
+     * rows go into one statement and the ids follow from the first one;
+     * otherwise every row is inserted on its own.
+     *
+     * @param array $items Readings, each with device_id and captured_at.
+     * @param int|null $idStep Distance between consecutive ids, or null if a
+     *                         multi-row insert may get interleaved ids.
+     * @return int[] The id of every reading, in the same order.
+     * @throws mysqli_sql_exception If a statement fails.
+     */
+    private function insertReadingRows(array $items, ?int $idStep): array
+    {
+        $readingIds = [];
+
+        if ($idStep === null) {
+            $stmt = $this->db->prepare(self::INSERT_READING);
+            foreach ($items as $item) {
+                $stmt->bind_param("ii", $item["device_id"], $item["captured_at"]);
+                $stmt->execute();
+                $readingIds[] = $stmt->insert_id;
+            }
+            return $readingIds;
+        }
+
+        $params = [];
+        foreach ($items as $item) {
+            array_push($params, $item["device_id"], $item["captured_at"]);
+        }
+
+        $stmt = $this->db->prepare(
+            "INSERT INTO `reading` (`device_id`, `timestamp`) VALUES "
+            . implode(", ", array_fill(0, count($items), "(?, FROM_UNIXTIME(?))"))
+        );
+        $stmt->bind_param(str_repeat("i", count($params)), ...$params);
+        $stmt->execute();
+
+        if ($stmt->affected_rows !== count($items)) {
+            throw new mysqli_sql_exception("Failed to create readings");
+        }
+        for ($row = 0; $row < count($items); $row++) {
+            $readingIds[] = $stmt->insert_id + $row * $idStep;
+        }
+        return $readingIds;
+    }
+
+    /**
+     * Checks whether a multi-row insert assigns consecutive auto-increment
+     * ids. InnoDB guarantees that unless the lock mode is "interleaved".
+     *
+     * @return int|null The increment between ids, or null if not guaranteed.
+     * @throws mysqli_sql_exception If the query fails.
+     */
+    private function consecutiveIdStep(): ?int
+    {
+        $row = $this->db->query(
+            "SELECT @@innodb_autoinc_lock_mode AS `lock_mode`, @@auto_increment_increment AS `step`"
+        )->fetch_assoc();
+
+        return (int) $row["lock_mode"] === self::AUTOINC_LOCK_MODE_INTERLEAVED ? null : (int) $row["step"];
+    }
+
+    /**
+     * Looks up which of the given devices exist.
+     *
+     * @param int[] $deviceIds The device ids referenced by the request.
+     * @return array The existing ids as keys.
+     * @throws mysqli_sql_exception If the query fails.
+     */
+    private function loadKnownDevices(array $deviceIds): array
+    {
+        $deviceIds = array_values(array_unique($deviceIds));
+        if (empty($deviceIds)) {
+            return [];
+        }
+
+        $stmt = $this->db->prepare(
+            "SELECT `id` FROM `device` WHERE `id` IN (" . implode(", ", array_fill(0, count($deviceIds), "?")) . ")"
+        );
+        $stmt->bind_param(str_repeat("i", count($deviceIds)), ...$deviceIds);
+        $stmt->execute();
+
+        $known = [];
+        foreach ($stmt->get_result()->fetch_all(MYSQLI_ASSOC) as $row) {
+            $known[(int) $row["id"]] = true;
+        }
+        return $known;
+    }
+
+    /**
+     * Upserts the newest value per device and sensor into devicelatest, in one statement
+     * inside the caller's transaction. A row is only replaced by a newer one,
+     * so a delayed batch with old timestamps keeps the current values.
+     *
+     * The assignments run left to right: `value` and `reading_id` are
+     * compared against the old row, `timestamp` goes last. Once `reading_id`
+     * was replaced, the comparison only holds for a later timestamp, which is
+     * exactly when it still has to change.
+     *
+     * @param array $latest One entry per device and sensor: device_id,
+     *                      sensor_id, reading_id, value and captured_at
+     *                      (Unix seconds, the timestamp of the reading).
+     * @throws mysqli_sql_exception If the statement fails.
+     */
+    private function upsertLatest(array $latest): void
+    {
+        if (empty($latest)) {
+            return;
+        }
+
+        $placeholders = [];
+        $types = "";
+        $params = [];
+        foreach ($latest as $entry) {
+            $placeholders[] = "(?, ?, ?, ?, FROM_UNIXTIME(?))";
+            $types .= "iiidi";
+            array_push($params, $entry["device_id"], $entry["sensor_id"], $entry["reading_id"], $entry["value"], $entry["captured_at"]);
+        }
+
+        $stmt = $this->db->prepare(
+            "INSERT INTO `devicelatest` (`device_id`, `sensor_id`, `reading_id`, `value`, `timestamp`)
+             VALUES " . implode(", ", $placeholders) . "
+             ON DUPLICATE KEY UPDATE
+                `value` = IF(" . self::LATEST_IS_NEWER . ", VALUES(`value`), `value`),
+                `reading_id` = IF(" . self::LATEST_IS_NEWER . ", VALUES(`reading_id`), `reading_id`),
+                `timestamp` = IF(" . self::LATEST_IS_NEWER . ", VALUES(`timestamp`), `timestamp`)"
+        );
+        $stmt->bind_param($types, ...$params);
+        $stmt->execute();
+    }
+
+    /**
+     * Adds the values of the given readings to the minute, hour and day
+     * rollups, in one statement inside the caller's transaction. Buckets are
+     * aligned to Unix time (UTC) and keep min, max, sum and count, so merging
+     * a new value never needs the raw rows of the bucket.
+     *
+     * @param array $capturedAtByReading captured_at per reading inserted by
+     *                                   this request; the range limits both
+     *                                   lookups to the partitions written.
+     * @throws mysqli_sql_exception If the statement fails.
+     */
+    private function updateRollups(array $capturedAtByReading): void
+    {
+        if (empty($capturedAtByReading)) {
+            return;
+        }
+
+        $readingIds = array_keys($capturedAtByReading);
+
+        $resolutions = implode(" UNION ALL ", array_map(function ($seconds) {
+            return "SELECT " . $seconds . " AS `resolution`";
+        }, self::ROLLUP_RESOLUTIONS));
+        $placeholders = implode(", ", array_fill(0, count($readingIds), "?"));
+
+        $stmt = $this->db->prepare(
+            "INSERT INTO `sensorrollup`
+                (`device_id`, `sensor_id`, `resolution`, `bucket_start`, `min_value`, `max_value`, `sum_value`, `sample_count`)
+             SELECT
+                r.`device_id`,
+                sd.`sensor_id`,
+                res.`resolution`,
+                sd.`captured_at` DIV res.`resolution` * res.`resolution` AS `bucket`,
+                MIN(COALESCE(sd.`min_value`, sd.`value`)),
+                MAX(COALESCE(sd.`max_value`, sd.`value`)),
+                SUM(sd.`value`),
+                COUNT(*)
+             FROM `sensordata` sd
+             JOIN `reading` r ON r.`id` = sd.`reading_id`
+             CROSS JOIN (" . $resolutions . ") res
+             WHERE sd.`captured_at` BETWEEN ? AND ? AND sd.`reading_id` IN (" . $placeholders . ")
+                AND r.`timestamp` BETWEEN FROM_UNIXTIME(?) AND FROM_UNIXTIME(?)
+             GROUP BY r.`device_id`, sd.`sensor_id`, res.`resolution`, `bucket`
+             ON DUPLICATE KEY UPDATE
+                `sensorrollup`.`min_value` = LEAST(`sensorrollup`.`min_value`, VALUES(`min_value`)),
+                `sensorrollup`.`max_value` = GREATEST(`sensorrollup`.`max_value`, VALUES(`max_value`)),
+                `sensorrollup`.`sum_value` = `sensorrollup`.`sum_value` + VALUES(`sum_value`),
+                `sensorrollup`.`sample_count` = `sensorrollup`.`sample_count` + VALUES(`sample_count`)"
+        );
+        $from = min($capturedAtByReading);
+        $to = max($capturedAtByReading);
+        $params = array_merge([$from, $to], $readingIds, [$from, $to]);
+        $stmt->bind_param(str_repeat("i", count($params)), ...$params);
+        $stmt->execute();
+    }
+
+    /**
+     * Publishes a compact "new reading" event per device with its newest
+     * reading id and the latest value of each sensor. Runs after the commit,
+     * so subscribers never see data that is not in the database yet, and the
+     * events are only sent once the response is out. "ts" is
+     * the server time in milliseconds and lets subscribers measure the
+     * ingest-to-display latency.
+     *
+     * @param array $items The stored readings, each with device_id and sensor_data.
+     * @param int[] $readingIds The reading id of every item, in the same order.
+     */
+    private function publishReadings(array $items, array $readingIds): void
+    {
+        $events = [];
+        foreach ($items as $index => $item) {
+            $deviceId = $item["device_id"];
+            $values = $events[$deviceId]["values"] ?? [];
+            foreach ($item["sensor_data"] as $entry) {
+                $values[$entry["sensor_id"]] = (float) $entry["value"];
+            }
+            $events[$deviceId] = ["reading_id" => $readingIds[$index], "values" => $values];
+        }
+
+        foreach ($events as $deviceId => $event) {
+            $this->publisher->publish(self::READINGS_CHANNEL, [
+                "device_id"  => $deviceId,
+                "reading_id" => $event["reading_id"],
+                "ts"         => (int) round(microtime(true) * 1000),
+                "values"     => (object) $event["values"],
+            ]);
+        }
+    }
+
+    /**
+     * Maps a sensor value from the payload to a sensordata row. Every row has
+     * the same columns so they can be inserted in one statement; the window
+     * statistics are NULL for single samples. Values are cast so they are
+     * bound with their column types.
+     *
+     * @param int $readingId The reading the value belongs to.
+     * @param int $capturedAt Timestamp of the reading (Unix seconds), which
+     *                        selects the partition of the row.
+     * @param array $entry A single sensor value from the payload.
+     * @return array The row to insert.
+     */
+    private function toSensorDataRow(int $readingId, int $capturedAt, array $entry): array
+    {
+        $hasWindow = isset($entry["min"], $entry["max"], $entry["count"])
+            && is_numeric($entry["min"]) && is_numeric($entry["max"]) && is_int($entry["count"]);
+
+        return [
+            "reading_id"   => $readingId,
+            "sensor_id"    => $entry["sensor_id"],
+            "captured_at"  => $capturedAt,
+            "value"        => (float) $entry["value"],
+            "min_value"    => $hasWindow ? (float) $entry["min"] : null,
+            "max_value"    => $hasWindow ? (float) $entry["max"] : null,
+            "sample_count" => $hasWindow ? $entry["count"] : null
+        ];
+    }
+
+    /**
+     * Returns the capture time of a batch entry, or the server time if it
+     * has none.
+     *
+     * @param array $reading A single reading from the batch payload.
+     * @return int Unix seconds.
+     */
+    private function capturedAt(array $reading): int
+    {
+        return isset($reading["captured_at"]) && is_int($reading["captured_at"]) && $reading["captured_at"] > 0
+            ? $reading["captured_at"]
+            : time();
+    }
+
+    /**
+     * Checks that an ingest entry names its device and is a valid reading.
+     *
+     * @param mixed $reading A single reading from the ingest payload.
+     * @return bool True if the reading can be inserted.
+     */
+    private function isValidDeviceReading($reading): bool
+    {
+        return is_array($reading) && isset($reading["device_id"]) && is_int($reading["device_id"])
+            && $this->isValidReading($reading);
+    }
+
+    /**
+     * Checks that a batch entry carries a non-empty list of sensor values.
+     *
+     * @param mixed $reading A single reading from the batch payload.
+     * @return bool True if the reading can be inserted.
+     */
+    private function isValidReading($reading): bool
+    {
+        if (!is_array($reading) || !isset($reading["sensor_data"]) || !is_array($reading["sensor_data"])) {
+            return false;
+        }
+
+        foreach ($reading["sensor_data"] as $entry) {
+            if (!isset($entry["sensor_id"], $entry["value"]) || !is_int($entry["sensor_id"]) || !is_numeric($entry["value"])) {
+                return false;
+            }
+        }
+
+        return !empty($reading["sensor_data"]);
     }
 }
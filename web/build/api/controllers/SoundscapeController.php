@@ -0,0 +1,92 @@
+<?php
+
+/**
+ * SoundscapeController Class
+ *
+ * Builds the weather-to-soundscape rule table of the installation from the
+ * sound_* rows of the Setting table, so tracks and thresholds can be changed
+ * without reflashing the device.
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+namespace Api\Controllers;
+
+use Api\Models\Database;
+use mysqli;
+use mysqli_sql_exception;
+
+/**
+ * Soundscape Controller Class
+ * Groups the sound rule settings into an ordered, versioned rule table.
+ */
+class SoundscapeController
+{
+    /** @var string Key of the track played when no rule matches. */
+    private const DEFAULT_TRACK_KEY = "sound_default_track";
+
+    /** @var string Rule setting keys: sound_<rule>_track or sound_<rule>_<input>_<op>. */
+    private const RULE_KEY_PATTERN = "/^sound_(\d+)_(?:(track)|(temp|hum|lux|water|pressure)_(lt|le|gt|ge))$/";
+
+    /** @var mysqli MySQLi database connection */
+    private mysqli $db;
+
+    /**
+     * Initializes the controller with the database connection.
+     */
+    public function __construct()
+    {
+        $this->db = Database::getInstance()->getConnection();
+    }
+
+    /**
+     * Returns the rules in the order they are evaluated. The first rule whose
+     * conditions all hold selects the track. Each condition is
+     * [input, op, threshold]. Rules without a track are left out. The version
+     * is a checksum of the table and changes whenever a sound setting does.
+     *
+     * @return array API response.
+     */
+    public function getSoundscape(): array
+    {
+        try {
+            $result = $this->db->query(
+                "SELECT `key`, COALESCE(`value`, `default_value`) AS value
+                 FROM `setting`
+                 WHERE `key` LIKE 'sound\\_%'"
+            );
+
+            $defaultTrack = 0;
+            $rules = [];
+            foreach ($result->fetch_all(MYSQLI_ASSOC) as $row) {
+                if ($row["key"] === self::DEFAULT_TRACK_KEY) {
+                    $defaultTrack = (int) $row["value"];
+                    continue;
+                }
+
+                if (!preg_match(self::RULE_KEY_PATTERN, $row["key"], $match)) {
+                    continue;
+                }
+
+                $rule = (int) $match[1];
+                $rules[$rule] ??= ["track" => null, "when" => []];
+                if ($match[2] === "track") {
+                    $rules[$rule]["track"] = (int) $row["value"];
+                } else {
+                    $rules[$rule]["when"][] = [$match[3], $match[4], (float) $row["value"]];
+                }
+            }
+
+            ksort($rules);
+            $soundscape = [
+                "default_track" => $defaultTrack,
+                "rules"         => array_values(array_filter($rules, fn($rule) => $rule["track"] !== null)),
+            ];
+
+            return ["version" => crc32(json_encode($soundscape))] + $soundscape;
+        } catch (mysqli_sql_exception $e) {
+            return ["error" => "Database error: " . $e->getMessage(), "status" => 500];
+        }
+    }
+}
@@ -0,0 +1,99 @@
+<?php
+
+/**
+ * EventPublisher Class
+ *
+ * Publishes small JSON events to the nginx push-stream module, which fans
+ * them out to the WebSocket and EventSource subscribers of a channel. Events
+ * are sent after the response, so the client never waits for them.
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+namespace Api\Models;
+
+/**
+ * Event Publisher Class
+ * Queues events and posts them to the internal push-stream publisher
+ * endpoint once the response has been sent.
+ */
+class EventPublisher
+{
+    /** @var float Publishing must never hold up the PHP-FPM worker for long. */
+    private const TIMEOUT_SECONDS = 0.2;
+
+    /** @var string Internal publisher endpoint, not reachable from outside. */
+    private string $url;
+
+    /** @var array[] Events waiting for the end of the request, as [channel, body]. */
+    private array $pending = [];
+
+    /**
+     * Initializes the publisher with the endpoint from the environment.
+     */
+    public function __construct()
+    {
+        $this->url = getenv("PUSH_STREAM_PUBLISH_URL") ?: "http://nginx:8080/publish";
+    }
+
+    /**
+     * Queues an event for a channel. The queue is sent once the response
+     * has been finished, so a slow or unreachable publisher never delays it.
+     *
+     * @param string $channel The push-stream channel.
+     * @param array $event The event, encoded as JSON.
+     */
+    public function publish(string $channel, array $event): void
+    {
+        if (empty($this->pending)) {
+            register_shutdown_function([$this, "flush"]);
+        }
+        $this->pending[] = [$channel, json_encode($event)];
+    }
+
+    /**
+     * Finishes the response under PHP-FPM and sends the queued events.
+     * Registered as shutdown function by the first publish of a request.
+     */
+    public function flush(): void
+    {
+        if (function_exists("fastcgi_finish_request")) {
+            fastcgi_finish_request();
+        }
+
+        foreach ($this->pending as [$channel, $body]) {
+            $this->send($channel, $body);
+        }
+        $this->pending = [];
+    }
+
+    /**
+     * Posts one event. Failures are logged and otherwise ignored, since
+     * subscribers resynchronise on their own.
+     *
+     * @param string $channel The push-stream channel.
+     * @param string $body The JSON encoded event.
+     * @return bool True if the event was accepted.
+     */
+    private function send(string $channel, string $body): bool
+    {
+        $context = stream_context_create([
+            "http" => [
+                "method"        => "POST",
+                "header"        => "Content-Type: application/json",
+                "content"       => $body,
+                "timeout"       => self::TIMEOUT_SECONDS,
+                "ignore_errors" => true,
+            ],
+        ]);
+
+        $result = @file_get_contents($this->url . "?id=" . urlencode($channel), false, $context);
+        if ($result === false) {
+            error_log("Publishing event to channel '$channel' failed");
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -21,6 +21,32 @@ use mysqli;
  */
 class Model
 {
+    /**
+     * @var array Statements deleting the rows that belong to a record, per
+     *            table and keyed by the table they delete from. reading and
+     *            sensordata are partitioned, so no foreign key cascades to
+     *            them; sensorrollup has none either.
+     */
+    public const DEPENDENT_ROWS = [
+        "device" => [
+            "sensordata"   => "DELETE `sensordata` FROM `sensordata`
+                               JOIN `reading` ON `sensordata`.`reading_id` = `reading`.`id`
+                               WHERE `reading`.`device_id` = ?",
+            "reading"      => "DELETE FROM `reading` WHERE `device_id` = ?",
+            "sensorrollup" => "DELETE FROM `sensorrollup` WHERE `device_id` = ?",
+            "devicelatest" => "DELETE FROM `devicelatest` WHERE `device_id` = ?",
+        ],
+        "reading" => [
+            "sensordata"   => "DELETE FROM `sensordata` WHERE `reading_id` = ?",
+            "devicelatest" => "DELETE FROM `devicelatest` WHERE `reading_id` = ?",
+        ],
+        "sensor" => [
+            "sensordata"   => "DELETE FROM `sensordata` WHERE `sensor_id` = ?",
+            "sensorrollup" => "DELETE FROM `sensorrollup` WHERE `sensor_id` = ?",
+            "devicelatest" => "DELETE FROM `devicelatest` WHERE `sensor_id` = ?",
+        ],
+    ];
+
     /** @var mysqli Database connection instance. */
     protected mysqli $connection;
 
@@ -59,6 +85,17 @@ class Model
         return $this->fetchSingle("SELECT * FROM `{$this->table}` WHERE id = ?", "i", [$id]);
     }
 
+    /**
+     * Retrieves a single record by its unique key column.
+     *
+     * @param string $key The key of the record.
+     * @return array|null Returns the record as an associative array, or null if not found.
+     */
+    public function getByKey(string $key): ?array
+    {
+        return $this->fetchSingle("SELECT * FROM `{$this->table}` WHERE `key` = ?", "s", [$key]);
+    }
+
     /**
      * Inserts a new record into the table.
      *
@@ -73,8 +110,8 @@ class Model
 
         $columns = implode(", ", array_map(fn($col) => "`$col`", array_keys($data)));
         $placeholders = implode(", ", array_fill(0, count($data), "?"));
-        $types = str_repeat("s", count($data));
         $values = array_values($data);
+        $types = $this->bindTypes($values);
 
         $query = "INSERT INTO `{$this->table}` ($columns) VALUES ($placeholders)";
 
@@ -120,8 +157,7 @@ class Model
             }
         }
 
-        // Determine types dynamically (assuming all are strings for simplicity)
-        $types = str_repeat("s", count($values));
+        $types = $this->bindTypes($values);
 
         $query = "INSERT INTO `{$this->table}` ($columnsList) VALUES $placeholders";
 
@@ -143,14 +179,31 @@ class Model
     }
 
     /**
-     * Deletes a record from the database.
+     * Deletes a record from the database together with its rows in
+     * DEPENDENT_ROWS, in one transaction.
      *
      * @param int $id The ID of the record to delete.
      * @return bool Returns true if the deletion was successful.
      */
     public function delete(int $id): bool
     {
-        return $this->execute("DELETE FROM `{$this->table}` WHERE id = ?", "i", [$id]);
+        $statements = array_values(self::DEPENDENT_ROWS[strtolower($this->table)] ?? []);
+        $statements[] = "DELETE FROM `{$this->table}` WHERE id = ?";
+
+        try {
+            $this->connection->begin_transaction();
+            foreach ($statements as $query) {
+                $stmt = $this->connection->prepare($query);
+                $stmt->bind_param("i", $id);
+                $stmt->execute();
+            }
+            $this->connection->commit();
+            return true;
+        } catch (\mysqli_sql_exception $e) {
+            $this->connection->rollback();
+            error_log("SQL Error: " . $e->getMessage());
+            return false;
+        }
     }
 
     /**
@@ -190,6 +243,22 @@ class Model
         }
     }
 
+    /**
+     * Derives the bind types from the values, so integers and decimals are
+     * sent in binary instead of being converted from strings by the server.
+     *
+     * @param array $values The parameters to bind.
+     * @return string The types for bind_param.
+     */
+    private function bindTypes(array $values): string
+    {
+        $types = "";
+        foreach ($values as $value) {
+            $types .= is_int($value) ? "i" : (is_float($value) ? "d" : "s");
+        }
+        return $types;
+    }
+
     /**
      * Executes a prepared query and fetches a single record.
      *
@@ -228,8 +297,8 @@ class Model
 
         $columns = implode(", ", array_map(fn($col) => "`$col`", array_keys($data)));
         $placeholders = implode(", ", array_fill(0, count($data), "?"));
-        $types = str_repeat("s", count($data));
         $values = array_values($data);
+        $types = $this->bindTypes($values);
 
         if (str_starts_with($queryPrefix, "UPDATE")) {
             $setClause = implode(", ", array_map(fn($col) => "`$col` = ?", array_keys($data)));
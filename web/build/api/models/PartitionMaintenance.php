@@ -0,0 +1,224 @@
+<?php
+
+/**
+ * PartitionMaintenance Class
+ *
+ * Keeps the monthly partitions of the reading tables ahead of time and drops
+ * the ones that fell out of the retention window. Run once a day.
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+namespace Api\Models;
+
+use mysqli;
+
+/**
+ * Partition Maintenance Class
+ * Adds upcoming monthly partitions and drops expired ones.
+ */
+class PartitionMaintenance
+{
+    /** @var int Months created in advance, so inserts never land in the catch-all partition. */
+    private const MONTHS_AHEAD = 2;
+
+    /** @var int Seconds per day, used for the retention settings. */
+    private const SECONDS_PER_DAY = 86400;
+
+    /**
+     * @var array Partitioned tables: the partition prefixes, the value in
+     *            front of the month bound (RANGE COLUMNS only) and the
+     *            retention setting of each prefix.
+     */
+    private const TABLES = [
+        "reading" => [
+            ["prefix" => "p", "column" => null, "retention" => "retention_raw_days"],
+        ],
+        "sensordata" => [
+            ["prefix" => "p", "column" => null, "retention" => "retention_raw_days"],
+        ],
+        "sensorrollup" => [
+            ["prefix" => "p60_", "column" => 60, "retention" => "retention_minute_days"],
+            ["prefix" => "p3600_", "column" => 3600, "retention" => "retention_hour_days"],
+            ["prefix" => "p86400_", "column" => 86400, "retention" => "retention_day_days"],
+        ],
+    ];
+
+    /** @var mysqli MySQLi database connection */
+    private mysqli $db;
+
+    /**
+     * Initializes the maintenance job with the database connection.
+     */
+    public function __construct()
+    {
+        $this->db = Database::getInstance()->getConnection();
+    }
+
+    /**
+     * Adds the partitions for the current and the next months and drops the
+     * ones that only hold expired data. Safe to run repeatedly.
+     *
+     * @param int $now Current time (Unix seconds).
+     * @return string[] The statements that were executed.
+     */
+    public function run(int $now): array
+    {
+        $executed = [];
+        $retention = $this->loadRetention();
+
+        foreach (self::TABLES as $table => $groups) {
+            foreach ($groups as $group) {
+                $partitions = $this->loadPartitions($table, $group["prefix"]);
+
+                $statement = $this->buildAddStatement($table, $group, $partitions, $now);
+                if ($statement !== null) {
+                    $this->db->query($statement);
+                    $executed[] = $statement;
+                }
+
+                $days = $retention[$group["retention"]] ?? 0;
+                $statement = $this->buildDropStatement($table, $partitions, $now - $days * self::SECONDS_PER_DAY);
+                if ($days > 0 && $statement !== null) {
+                    $this->db->query($statement);
+                    $executed[] = $statement;
+                    (new TableVersion())->bump($table);
+                }
+            }
+        }
+
+        return $executed;
+    }
+
+    /**
+     * Reads the retention settings in days; 0 keeps the data forever.
+     *
+     * @return array Days per setting key.
+     */
+    private function loadRetention(): array
+    {
+        $result = $this->db->query(
+            "SELECT `key`, COALESCE(`value`, `default_value`) AS `days`
+             FROM `setting`
+             WHERE `key` LIKE 'retention\\_%'"
+        );
+
+        $retention = [];
+        foreach ($result->fetch_all(MYSQLI_ASSOC) as $row) {
+            $retention[$row["key"]] = (int) $row["days"];
+        }
+        return $retention;
+    }
+
+    /**
+     * Lists the monthly partitions of one prefix with their upper bound,
+     * ordered by bound. The catch-all partition is left out.
+     *
+     * @param string $table The partitioned table.
+     * @param string $prefix The partition name prefix.
+     * @return array Upper bound (Unix seconds) per partition name.
+     */
+    private function loadPartitions(string $table, string $prefix): array
+    {
+        $stmt = $this->db->prepare(
+            "SELECT `PARTITION_NAME`, `PARTITION_DESCRIPTION`
+             FROM information_schema.PARTITIONS
+             WHERE `TABLE_SCHEMA` = DATABASE() AND LOWER(`TABLE_NAME`) = LOWER(?)
+             ORDER BY `PARTITION_ORDINAL_POSITION`"
+        );
+        $stmt->bind_param("s", $table);
+        $stmt->execute();
+
+        $partitions = [];
+        foreach ($stmt->get_result()->fetch_all(MYSQLI_ASSOC) as $row) {
+            $name = $row["PARTITION_NAME"];
+            if ($name === $this->futurePartition($prefix) || !preg_match("/^" . preg_quote($prefix, "/") . "\\d{6}$/", $name)) {
+                continue;
+            }
+            // RANGE COLUMNS lists the resolution in front of the bound
+            $bounds = explode(",", $row["PARTITION_DESCRIPTION"]);
+            $partitions[$name] = (int) trim(end($bounds));
+        }
+        return $partitions;
+    }
+
+    /**
+     * Builds the statement that splits the partitions for the current and
+     * the next months off the catch-all partition.
+     *
+     * @param string $table The partitioned table.
+     * @param array $group The partition group from TABLES.
+     * @param array $partitions The existing partitions of the group.
+     * @param int $now Current time (Unix seconds).
+     * @return string|null The statement, or null if nothing is missing.
+     */
+    private function buildAddStatement(string $table, array $group, array $partitions, int $now): ?string
+    {
+        $highest = empty($partitions) ? 0 : max($partitions);
+        $year = (int) gmdate("Y", $now);
+        $month = (int) gmdate("n", $now);
+
+        $definitions = [];
+        for ($offset = 0; $offset <= self::MONTHS_AHEAD; $offset++) {
+            $start = gmmktime(0, 0, 0, $month + $offset, 1, $year);
+            $bound = gmmktime(0, 0, 0, $month + $offset + 1, 1, $year);
+            if ($bound <= $highest) {
+                continue;
+            }
+            $definitions[] = $group["prefix"] . gmdate("Ym", $start) . " VALUES LESS THAN (" . $this->boundValue($group, (string) $bound) . ")";
+        }
+
+        if (empty($definitions)) {
+            return null;
+        }
+
+        $future = $this->futurePartition($group["prefix"]);
+        $definitions[] = $future . " VALUES LESS THAN (" . $this->boundValue($group, "MAXVALUE") . ")";
+        return "ALTER TABLE `" . $table . "` REORGANIZE PARTITION " . $future . " INTO (" . implode(", ", $definitions) . ")";
+    }
+
+    /**
+     * Builds the statement that drops the partitions which only hold rows
+     * older than the cutoff. Retention is therefore applied in whole months.
+     *
+     * @param string $table The partitioned table.
+     * @param array $partitions The existing partitions of the group.
+     * @param int $cutoff Rows before this time (Unix seconds) are expired.
+     * @return string|null The statement, or null if nothing expired.
+     */
+    private function buildDropStatement(string $table, array $partitions, int $cutoff): ?string
+    {
+        $expired = array_keys(array_filter($partitions, function ($bound) use ($cutoff) {
+            return $bound <= $cutoff;
+        }));
+
+        if (empty($expired)) {
+            return null;
+        }
+        return "ALTER TABLE `" . $table . "` DROP PARTITION " . implode(", ", $expired);
+    }
+
+    /**
+     * Formats a partition bound, with the resolution in front for RANGE COLUMNS.
+     *
+     * @param array $group The partition group from TABLES.
+     * @param string $bound The upper bound or MAXVALUE.
+     * @return string The value list of VALUES LESS THAN.
+     */
+    private function boundValue(array $group, string $bound): string
+    {
+        return $group["column"] === null ? $bound : $group["column"] . ", " . $bound;
+    }
+
+    /**
+     * Returns the name of the catch-all partition of a prefix.
+     *
+     * @param string $prefix The partition name prefix.
+     * @return string The partition name.
+     */
+    private function futurePartition(string $prefix): string
+    {
+        return rtrim($prefix, "_") . "_future";
+    }
+}
@@ -13,6 +13,7 @@
 namespace Api\Routes;
 
 use Api\Controllers\Controller;
+use Api\Models\TableVersion;
 use Api\Views\View;
 
 /**
@@ -21,6 +22,41 @@ use Api\Views\View;
  */
 class Api
 {
+    /** @var string Content type of the compact binary reading format. */
+    private const BINARY_READING_CONTENT_TYPE = "application/vnd.atmos.reading";
+
+    /** @var int Current version of the binary reading format (per-value window stats). */
+    private const BINARY_READING_VERSION = 2;
+
+    /** @var int Previous version of the binary reading format (value only). */
+    private const BINARY_READING_VERSION_V1 = 1;
+
+    /** @var int Maximum length of a device key (Device.key column). */
+    private const DEVICE_KEY_MAX_LENGTH = 50;
+
+    /** @var int Maximum length of a device name (Device.name column). */
+    private const DEVICE_NAME_MAX_LENGTH = 100;
+
+    /** @var int Range of a history request without from/to (one day). */
+    private const HISTORY_DEFAULT_RANGE = 86400;
+
+    /** @var int Points of a history request without points. */
+    private const HISTORY_DEFAULT_POINTS = 200;
+
+    /** @var int Upper limit for the points of a history request. */
+    private const HISTORY_MAX_POINTS = 1000;
+
+    /** @var string[] Tables the snapshot is built from. */
+    private const SNAPSHOT_TABLES = ["device", "devicelatest"];
+
+    /** @var string[] Tables the soundscape is built from. */
+    private const SOUNDSCAPE_TABLES = ["setting"];
+
+    /** @var array Tables each view is built from. */
+    private const VIEW_TABLES = [
+        "LatestDeviceReadings" => ["devicelatest", "device", "sensor"],
+    ];
+
     /** @var string The requested HTTP method. */
     private string $requestMethod;
 
@@ -95,13 +131,45 @@ class Api
             return;
         }
 
-        if ($this->id !== null && !ctype_digit($this->id)) {
-            $this->sendResponse(["error" => "Invalid ID format"], 400);
+        if ($this->resource === "reading-with-sensordata" && $this->requestMethod === "POST") {
+            if ($this->isBinaryReadingRequest()) {
+                $this->handleBinaryReadingBatch();
+            } elseif ($this->id === "ingest") {
+                $this->handleReadingIngest();
+            } else {
+                $this->id === "batch" ? $this->handleReadingBatch() : $this->handleReadingWithSensorData();
+            }
             return;
         }
 
-        if ($this->resource === "reading-with-sensordata" && $this->requestMethod === "POST") {
-            $this->handleReadingWithSensorData();
+        if ($this->resource === "snapshot" && $this->requestMethod === "GET") {
+            $this->respondIfNotModified(self::SNAPSHOT_TABLES);
+            $controller = new \Api\Controllers\SnapshotController();
+            $result = $controller->getSnapshot();
+            $this->sendResponse($result, $result["status"] ?? 200);
+            return;
+        }
+
+        if ($this->resource === "soundscape" && $this->requestMethod === "GET") {
+            $this->respondIfNotModified(self::SOUNDSCAPE_TABLES);
+            $controller = new \Api\Controllers\SoundscapeController();
+            $result = $controller->getSoundscape();
+            $this->sendResponse($result, $result["status"] ?? 200);
+            return;
+        }
+
+        if ($this->resource === "history" && $this->requestMethod === "GET") {
+            $this->handleHistory();
+            return;
+        }
+
+        if ($this->resource === "device" && $this->id === null && isset($_GET["key"])) {
+            $this->handleDeviceByKey();
+            return;
+        }
+
+        if ($this->id !== null && !ctype_digit($this->id)) {
+            $this->sendResponse(["error" => "Invalid ID format"], 400);
             return;
         }
 
@@ -119,6 +187,10 @@ class Api
         }
 
         $viewName = $this->pathParts[2];
+        if (isset(self::VIEW_TABLES[$viewName])) {
+            $this->respondIfNotModified(self::VIEW_TABLES[$viewName]);
+        }
+
         $deviceId = $_GET["device_id"] ?? null;
         $viewModel = new View();
 
@@ -134,6 +206,10 @@ class Api
      */
     private function handleTableRequest(): void
     {
+        if ($this->requestMethod === "GET") {
+            $this->respondIfNotModified([strtolower($this->resource)]);
+        }
+
         $controller = new Controller($this->resource);
 
         switch ($this->requestMethod) {
@@ -169,6 +245,71 @@ class Api
 
 
 
+    /**
+     * Sets the validators of a GET response built from the given tables and
+     * answers 304 right away if the client's copy is still current, after a
+     * single primary key lookup of the versions instead of building the
+     * response. The versions are read before the data, so a response is
+     * never tagged newer than its content.
+     *
+     * Last-Modified has a resolution of one second and is only sent once that
+     * second is over; a later write in the same second would otherwise keep
+     * the same value.
+     *
+     * @param string[] $tables The tables the response is built from.
+     */
+    private function respondIfNotModified(array $tables): void
+    {
+        $versions = new TableVersion();
+        $etag = $versions->etag($tables);
+        if ($etag === null) {
+            return;
+        }
+
+        $lastModified = $versions->lastModified($tables);
+        $sendLastModified = $lastModified > 0 && $lastModified < time();
+
+        header("ETag: " . $etag);
+        header("Cache-Control: no-cache");
+        if ($sendLastModified) {
+            header("Last-Modified: " . gmdate("D, d M Y H:i:s", $lastModified) . " GMT");
+        }
+
+        if (isset($_SERVER["HTTP_IF_NONE_MATCH"])) {
+            $notModified = $this->matchesEtag($_SERVER["HTTP_IF_NONE_MATCH"], $etag);
+        } else {
+            $since = isset($_SERVER["HTTP_IF_MODIFIED_SINCE"]) ? strtotime($_SERVER["HTTP_IF_MODIFIED_SINCE"]) : false;
+            $notModified = $sendLastModified && $since !== false && $lastModified <= $since;
+        }
+
+        if ($notModified) {
+            http_response_code(304);
+            exit;
+        }
+    }
+
+    /**
+     * Compares an If-None-Match header with the current ETag. As required for
+     * If-None-Match, weak validators (W/) match their strong counterpart.
+     *
+     * @param string $header The If-None-Match header.
+     * @param string $etag The current ETag.
+     * @return bool True if one of the listed ETags, or "*", matches.
+     */
+    private function matchesEtag(string $header, string $etag): bool
+    {
+        foreach (explode(",", $header) as $candidate) {
+            $candidate = trim($candidate);
+            if (stripos($candidate, "W/") === 0) {
+                $candidate = substr($candidate, 2);
+            }
+            if ($candidate === "*" || $candidate === $etag) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     /**
      * Sends a JSON response with an HTTP status code.
      *
@@ -205,4 +346,289 @@ class Api
 
         $this->sendResponse($result, $result["status"] ?? 200);
     }
+
+    /**
+     * Handles a batch of readings captured by one device, e.g. a backlog
+     * uploaded from the device's flash queue.
+     * Expects JSON body with:
+     * { device_id: int, readings: [ {captured_at?, sensor_data: [ {sensor_id, value}, ... ]}, ... ] }
+     */
+    private function handleReadingBatch(): void
+    {
+        $payload = json_decode(file_get_contents("php://input"), true);
+
+        if (
+            !isset($payload["device_id"]) ||
+            !is_int($payload["device_id"]) ||
+            !isset($payload["readings"]) ||
+            !is_array($payload["readings"])
+        ) {
+            $this->sendResponse(["error" => "Invalid or missing payload fields"], 400);
+            return;
+        }
+
+        $controller = new \Api\Controllers\ReadingWithSensorDataController();
+        $result = $controller->createBatchWithSensorData($payload);
+
+        $this->sendResponse($result, $result["status"] ?? 200);
+    }
+
+    /**
+     * Handles readings of many devices in one request, e.g. from a gateway.
+     * Expects JSON body with:
+     * { readings: [ {device_id, captured_at?, sensor_data: [ {sensor_id, value}, ... ]}, ... ] }
+     */
+    private function handleReadingIngest(): void
+    {
+        $payload = json_decode(file_get_contents("php://input"), true);
+
+        if (!isset($payload["readings"]) || !is_array($payload["readings"]) || !array_is_list($payload["readings"])) {
+            $this->sendResponse(["error" => "Invalid or missing payload fields"], 400);
+            return;
+        }
+
+        $controller = new \Api\Controllers\ReadingWithSensorDataController();
+        $result = $controller->ingest($payload);
+
+        $this->sendResponse($result, $result["status"] ?? 200);
+    }
+
+    /**
+     * Handles the lookup (GET) and idempotent registration (PUT) of a device
+     * by its key, e.g. /device?key=AA:BB:CC:DD:EE:FF. Both return only the id.
+     * PUT accepts an optional JSON body with: { name: string }
+     */
+    private function handleDeviceByKey(): void
+    {
+        $key = $_GET["key"];
+        if (!is_string($key) || $key === "" || strlen($key) > self::DEVICE_KEY_MAX_LENGTH) {
+            $this->sendResponse(["error" => "Invalid device key"], 400);
+            return;
+        }
+
+        if ($this->requestMethod === "GET") {
+            $this->respondIfNotModified(["device"]);
+        }
+
+        $controller = new \Api\Controllers\DeviceController();
+
+        switch ($this->requestMethod) {
+            case "GET":
+                $result = $controller->findByKey($key);
+                break;
+            case "PUT":
+                $payload = json_decode(file_get_contents("php://input"), true);
+                $name = is_array($payload) && isset($payload["name"]) && is_string($payload["name"]) ? $payload["name"] : null;
+                if ($name !== null && ($name === "" || strlen($name) > self::DEVICE_NAME_MAX_LENGTH)) {
+                    $this->sendResponse(["error" => "Invalid device name"], 400);
+                    return;
+                }
+                $result = $controller->upsertByKey($key, $name);
+                break;
+            default:
+                $this->sendResponse(["error" => "Method not allowed"], 405);
+                return;
+        }
+
+        $this->sendResponse($result, $result["status"] ?? 200);
+    }
+
+    /**
+     * Handles a history request, e.g.
+     * /history?device_id=1&sensor_id=2&from=1741564800&to=1741651200&points=200.
+     * device_id and sensor_id are required; the range defaults to the last
+     * day and points to HISTORY_DEFAULT_POINTS.
+     */
+    private function handleHistory(): void
+    {
+        $deviceId = $this->queryInt("device_id");
+        $sensorId = $this->queryInt("sensor_id");
+        $to = $this->queryInt("to") ?? time();
+        $from = $this->queryInt("from") ?? $to - self::HISTORY_DEFAULT_RANGE;
+        $points = $this->queryInt("points") ?? self::HISTORY_DEFAULT_POINTS;
+
+        if ($deviceId === null || $sensorId === null) {
+            $this->sendResponse(["error" => "device_id and sensor_id are required"], 400);
+            return;
+        }
+
+        if ($from >= $to || $points < 1 || $points > self::HISTORY_MAX_POINTS) {
+            $this->sendResponse(["error" => "Invalid range or number of points"], 400);
+            return;
+        }
+
+        $controller = new \Api\Controllers\HistoryController();
+        $result = $controller->getHistory($deviceId, $sensorId, $from, $to, $points);
+
+        $this->sendResponse($result, $result["status"] ?? 200);
+    }
+
+    /**
+     * Reads a non-negative integer query parameter.
+     *
+     * @param string $name The parameter name.
+     * @return int|null The value, or null if it is missing or not a number.
+     */
+    private function queryInt(string $name): ?int
+    {
+        $value = $_GET[$name] ?? null;
+        return is_string($value) && ctype_digit($value) ? (int) $value : null;
+    }
+
+    /**
+     * Checks whether the request body uses the compact binary reading format.
+     *
+     * @return bool True for binary reading uploads.
+     */
+    private function isBinaryReadingRequest(): bool
+    {
+        $contentType = strtolower(trim(explode(";", $_SERVER["CONTENT_TYPE"] ?? "")[0]));
+        return $contentType === self::BINARY_READING_CONTENT_TYPE;
+    }
+
+    /**
+     * Handles a batch of readings sent in the compact binary format.
+     * The frame is decoded into the same payload the JSON batch route uses.
+     */
+    private function handleBinaryReadingBatch(): void
+    {
+        $payload = $this->decodeBinaryReadings(file_get_contents("php://input"));
+
+        if ($payload === null) {
+            $this->sendResponse(["error" => "Invalid binary payload"], 400);
+            return;
+        }
+
+        $controller = new \Api\Controllers\ReadingWithSensorDataController();
+        $result = $controller->createBatchWithSensorData($payload);
+        $result["sequence"] = $payload["sequence"];
+
+        $this->sendResponse($result, $result["status"] ?? 200);
+    }
+
+    /**
+     * Decodes a binary reading frame (little-endian):
+     *   u8 version | u16 device_id | u32 sequence | u8 reading_count
+     *   per reading: u32 captured_at | u8 value_count
+     *   per value:   u8 sensor_id | i32 value in centi-units (version 1)
+     *                u8 sensor_id | u16 count | i32 value [| i32 min | i32 max] (version 2)
+     *
+     * @param string $body Raw request body.
+     * @return array|null Batch payload, or null if the frame is malformed.
+     */
+    private function decodeBinaryReadings(string $body): ?array
+    {
+        $length = strlen($body);
+        if ($length < 8) {
+            return null;
+        }
+
+        $header = unpack("Cversion/vdevice_id/Vsequence/Ccount", $body);
+        $version = $header["version"];
+        if ($version !== self::BINARY_READING_VERSION && $version !== self::BINARY_READING_VERSION_V1) {
+            return null;
+        }
+
+        $offset = 8;
+        $readings = [];
+
+        for ($i = 0; $i < $header["count"]; $i++) {
+            if ($offset + 5 > $length) {
+                return null;
+            }
+
+            $reading = unpack("Vcaptured_at/Cvalues", $body, $offset);
+            $offset += 5;
+
+            $sensorData = [];
+            for ($j = 0; $j < $reading["values"]; $j++) {
+                $entry = $version === self::BINARY_READING_VERSION_V1
+                    ? $this->decodeBinaryValueV1($body, $offset)
+                    : $this->decodeBinaryValue($body, $offset);
+
+                if ($entry === null) {
+                    return null;
+                }
+                $sensorData[] = $entry;
+            }
+
+            $readings[] = [
+                "captured_at" => $reading["captured_at"],
+                "sensor_data" => $sensorData,
+            ];
+        }
+
+        return $offset === $length ? [
+            "device_id" => $header["device_id"],
+            "sequence"  => $header["sequence"],
+            "readings"  => $readings,
+        ] : null;
+    }
+
+    /**
+     * Decodes one version 1 value: u8 sensor_id | i32 value.
+     *
+     * @param string $body The raw request body.
+     * @param int $offset Read position, advanced past the value.
+     * @return array|null The sensor data entry, or null if the body is truncated.
+     */
+    private function decodeBinaryValueV1(string $body, int &$offset): ?array
+    {
+        if ($offset + 5 > strlen($body)) {
+            return null;
+        }
+
+        $value = unpack("Csensor_id/Vvalue", $body, $offset);
+        $offset += 5;
+
+        return ["sensor_id" => $value["sensor_id"], "value" => $this->fromCentiUnits($value["value"])];
+    }
+
+    /**
+     * Decodes one version 2 value: u8 sensor_id | u16 count | i32 value,
+     * followed by i32 min | i32 max when the value aggregates several samples.
+     *
+     * @param string $body The raw request body.
+     * @param int $offset Read position, advanced past the value.
+     * @return array|null The sensor data entry, or null if the body is truncated.
+     */
+    private function decodeBinaryValue(string $body, int &$offset): ?array
+    {
+        $length = strlen($body);
+        if ($offset + 7 > $length) {
+            return null;
+        }
+
+        $value = unpack("Csensor_id/vcount/Vvalue", $body, $offset);
+        $offset += 7;
+
+        $entry = ["sensor_id" => $value["sensor_id"], "value" => $this->fromCentiUnits($value["value"])];
+        if ($value["count"] <= 1) {
+            return $entry;
+        }
+
+        if ($offset + 8 > $length) {
+            return null;
+        }
+
+        $window = unpack("Vmin/Vmax", $body, $offset);
+        $offset += 8;
+
+        $entry["min"] = $this->fromCentiUnits($window["min"]);
+        $entry["max"] = $this->fromCentiUnits($window["max"]);
+        $entry["count"] = $value["count"];
+        return $entry;
+    }
+
+    /**
+     * Reinterprets an unsigned 32-bit value as signed centi-units.
+     *
+     * @param int $raw The value as returned by unpack("V").
+     * @return float The value in its natural unit.
+     */
+    private function fromCentiUnits(int $raw): float
+    {
+        $centi = $raw >= 0x80000000 ? $raw - 0x100000000 : $raw;
+        return $centi / 100;
+    }
 }
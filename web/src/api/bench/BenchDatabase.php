@@ -0,0 +1,302 @@
+<?php
+
+/**
+ * BenchDatabase Class
+ *
+ * Scratch database for the command line benchmarks in this directory. It
+ * creates the reading tables with the keys of docs/assets/web/db.sql and
+ * fills them with synthetic history. Uses the MariaDB sequence engine
+ * (seq_1_to_N), so millions of rows are generated inside the server.
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+namespace Api\Bench;
+
+use Api\Models\Database;
+use mysqli;
+use mysqli_sql_exception;
+use RuntimeException;
+
+/**
+ * Bench Database Class
+ * Creates, fills and measures the tables of a dedicated benchmark schema.
+ */
+class BenchDatabase
+{
+    /** @var string Benchmarks drop tables, so DB_NAME must end with this. */
+    private const NAME_SUFFIX = "_bench";
+
+    /** @var int Sensors per reading, as on a sensor station. */
+    public const SENSORS = 6;
+
+    /** @var int Readings generated per INSERT ... SELECT. */
+    private const CHUNK_READINGS = 100000;
+
+    /** @var int Error code of a statement stopped by max_statement_time. */
+    private const ER_STATEMENT_TIMEOUT = 1969;
+
+    /** @var array Table definitions in creation order, keys as in db.sql. */
+    private const SCHEMA = [
+        "device" => "CREATE TABLE `device` (
+            `id` INT AUTO_INCREMENT PRIMARY KEY,
+            `key` VARCHAR(50) UNIQUE NOT NULL,
+            `name` VARCHAR(100) UNIQUE NOT NULL
+        )",
+        "sensor" => "CREATE TABLE `sensor` (
+            `id` INT AUTO_INCREMENT PRIMARY KEY,
+            `key` VARCHAR(50) UNIQUE NOT NULL,
+            `name` VARCHAR(100) NOT NULL,
+            `unit` VARCHAR(10) NOT NULL
+        )",
+        "reading" => "CREATE TABLE `reading` (
+            `id` INT AUTO_INCREMENT,
+            `device_id` INT NOT NULL,
+            `timestamp` TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+            PRIMARY KEY (`id`, `timestamp`),
+            KEY `idx_device_timestamp` (`device_id`, `timestamp`)
+        )",
+        "sensordata" => "CREATE TABLE `sensordata` (
+            `id` INT AUTO_INCREMENT,
+            `reading_id` INT NOT NULL,
+            `sensor_id` INT NOT NULL,
+            `captured_at` INT UNSIGNED NOT NULL,
+            `value` DECIMAL(7,2) NOT NULL,
+            `min_value` DECIMAL(7,2) NULL,
+            `max_value` DECIMAL(7,2) NULL,
+            `sample_count` SMALLINT UNSIGNED NULL,
+            PRIMARY KEY (`id`, `captured_at`),
+            KEY `idx_sensor_data_reading` (`reading_id`),
+            KEY `idx_sensor_data_sensor` (`sensor_id`)
+        )",
+        "devicelatest" => "CREATE TABLE `devicelatest` (
+            `device_id` INT NOT NULL,
+            `sensor_id` INT NOT NULL,
+            `reading_id` INT NOT NULL,
+            `value` DECIMAL(7,2) NOT NULL,
+            `timestamp` TIMESTAMP NOT NULL,
+            PRIMARY KEY (`device_id`, `sensor_id`)
+        )",
+        "sensorrollup" => "CREATE TABLE `sensorrollup` (
+            `device_id` INT NOT NULL,
+            `sensor_id` INT NOT NULL,
+            `resolution` INT UNSIGNED NOT NULL,
+            `bucket_start` INT UNSIGNED NOT NULL,
+            `min_value` DECIMAL(7,2) NOT NULL,
+            `max_value` DECIMAL(7,2) NOT NULL,
+            `sum_value` DECIMAL(14,2) NOT NULL,
+            `sample_count` INT UNSIGNED NOT NULL,
+            PRIMARY KEY (`device_id`, `sensor_id`, `resolution`, `bucket_start`)
+        )",
+    ];
+
+    /** @var mysqli MySQLi database connection */
+    private mysqli $db;
+
+    /**
+     * Connects to the benchmark schema.
+     *
+     * @throws RuntimeException If DB_NAME does not name a benchmark schema.
+     */
+    public function __construct()
+    {
+        $name = getenv("DB_NAME") ?: "";
+        if (!str_ends_with($name, self::NAME_SUFFIX)) {
+            throw new RuntimeException("Set DB_NAME to a scratch schema ending in " . self::NAME_SUFFIX);
+        }
+        $this->db = Database::getInstance()->getConnection();
+    }
+
+    /**
+     * Gets the MySQLi connection of the benchmark schema.
+     *
+     * @return mysqli The active database connection.
+     */
+    public function connection(): mysqli
+    {
+        return $this->db;
+    }
+
+    /**
+     * Drops and recreates the reading tables, then adds the devices and the
+     * sensors. Extra statements run after creation, e.g. to try other keys.
+     *
+     * @param int $devices Number of devices.
+     * @param string[] $alterations Statements applied to the fresh tables.
+     */
+    public function reset(int $devices, array $alterations = []): void
+    {
+        foreach (array_reverse(array_keys(self::SCHEMA)) as $table) {
+            $this->db->query("DROP TABLE IF EXISTS `" . $table . "`");
+        }
+        foreach (self::SCHEMA as $definition) {
+            $this->db->query($definition);
+        }
+        foreach ($alterations as $statement) {
+            $this->db->query($statement);
+        }
+
+        $this->db->query(
+            "INSERT INTO `device` (`id`, `key`, `name`)
+             SELECT seq, CONCAT('bench_', seq), CONCAT('Bench ', seq) FROM seq_1_to_" . $devices
+        );
+        $this->db->query(
+            "INSERT INTO `sensor` (`id`, `key`, `name`, `unit`)
+             SELECT seq, CONCAT('sensor_', seq), CONCAT('Sensor ', seq), 'u' FROM seq_1_to_" . self::SENSORS
+        );
+    }
+
+    /**
+     * Adds readings of SENSORS values each, one per second and spread
+     * round-robin over the devices, ending now.
+     *
+     * @param int $sensorDataRows Rows wanted in sensordata, rounded up to whole readings.
+     * @param int $devices Number of devices.
+     * @return int Number of readings added.
+     */
+    public function fill(int $sensorDataRows, int $devices): int
+    {
+        $readings = intdiv($sensorDataRows + self::SENSORS - 1, self::SENSORS);
+        $this->generate(1, $readings, $devices, time() - $readings, 1, 1);
+        return $readings;
+    }
+
+    /**
+     * Appends the readings of every device reporting once per interval, from
+     * the start of the span up to its end (exclusive).
+     *
+     * @param int $from Start of the span (Unix seconds).
+     * @param int $to End of the span (Unix seconds).
+     * @param int $devices Number of devices.
+     * @param int $interval Seconds between two readings of a device.
+     * @return int Number of readings added.
+     */
+    public function fillSpan(int $from, int $to, int $devices, int $interval): int
+    {
+        $readings = intdiv($to - $from + $interval - 1, $interval) * $devices;
+        $firstId = (int) $this->db->query("SELECT COALESCE(MAX(`id`), 0) + 1 FROM `reading`")->fetch_row()[0];
+        $this->generate($firstId, $readings, $devices, $from - $interval, $devices, $interval);
+        return $readings;
+    }
+
+    /**
+     * Inserts readings with consecutive ids and their sensordata rows in
+     * chunks. Reading n (counted from 1) belongs to device n % devices + 1
+     * and is taken at start + ceil(n / perStep) * interval.
+     *
+     * @param int $firstId Id of the first reading.
+     * @param int $readings Number of readings.
+     * @param int $devices Number of devices.
+     * @param int $start Time before the first reading (Unix seconds).
+     * @param int $perStep Readings sharing one timestamp.
+     * @param int $interval Seconds between two timestamps.
+     */
+    private function generate(int $firstId, int $readings, int $devices, int $start, int $perStep, int $interval): void
+    {
+        $offset = $firstId - 1;
+        $time = $start . " + (seq - " . $offset . " + " . ($perStep - 1) . ") DIV " . $perStep . " * " . $interval;
+
+        for ($first = $firstId; $first < $firstId + $readings; $first += self::CHUNK_READINGS) {
+            $last = min($first + self::CHUNK_READINGS, $firstId + $readings) - 1;
+            $this->db->query(
+                "INSERT INTO `reading` (`id`, `device_id`, `timestamp`)
+                 SELECT seq, (seq - " . $offset . ") % " . $devices . " + 1, FROM_UNIXTIME(" . $time . ")
+                 FROM seq_" . $first . "_to_" . $last
+            );
+            $this->db->query(
+                "INSERT INTO `sensordata` (`reading_id`, `sensor_id`, `captured_at`, `value`)
+                 SELECT r.seq, s.seq, " . str_replace("seq", "r.seq", $time) . ", ROUND(RAND() * 100, 2)
+                 FROM seq_" . $first . "_to_" . $last . " r
+                 CROSS JOIN seq_1_to_" . self::SENSORS . " s"
+            );
+        }
+    }
+
+    /**
+     * Fills devicelatest from the history with the backfill of db.sql.
+     */
+    public function backfillLatest(): void
+    {
+        $this->db->query(
+            "INSERT IGNORE INTO `devicelatest` (`device_id`, `sensor_id`, `reading_id`, `value`, `timestamp`)
+             SELECT device_id, sensor_id, reading_id, value, timestamp
+             FROM (
+                 SELECT r.device_id, sd.sensor_id, sd.reading_id, sd.value, r.timestamp,
+                        ROW_NUMBER() OVER (PARTITION BY r.device_id, sd.sensor_id ORDER BY r.timestamp DESC, sd.id DESC) AS position
+                 FROM `sensordata` sd
+                 JOIN `reading` r ON sd.reading_id = r.id
+             ) ranked
+             WHERE position = 1"
+        );
+    }
+
+    /**
+     * Fills sensorrollup from the history with the backfill of db.sql.
+     */
+    public function backfillRollups(): void
+    {
+        $this->db->query(
+            "INSERT INTO `sensorrollup` (`device_id`, `sensor_id`, `resolution`, `bucket_start`,
+                                         `min_value`, `max_value`, `sum_value`, `sample_count`)
+             SELECT r.device_id, sd.sensor_id, res.resolution,
+                    UNIX_TIMESTAMP(r.timestamp) DIV res.resolution * res.resolution AS bucket,
+                    MIN(sd.value), MAX(sd.value), SUM(sd.value), COUNT(*)
+             FROM `sensordata` sd
+             JOIN `reading` r ON sd.reading_id = r.id
+             CROSS JOIN (SELECT 60 AS resolution UNION ALL SELECT 3600 UNION ALL SELECT 86400) res
+             GROUP BY r.device_id, sd.sensor_id, res.resolution, bucket"
+        );
+    }
+
+    /**
+     * Runs a statement several times and reads its whole result.
+     *
+     * @param string $sql Statement to time.
+     * @param int $runs Number of runs.
+     * @param int $timeoutSeconds Runs are stopped after this long.
+     * @return float|null Median duration in ms, or null if a run timed out.
+     */
+    public function time(string $sql, int $runs, int $timeoutSeconds): ?float
+    {
+        $durations = [];
+        for ($run = 0; $run < $runs; $run++) {
+            $start = hrtime(true);
+            try {
+                $result = $this->db->query("SET STATEMENT max_statement_time = " . $timeoutSeconds . " FOR " . $sql);
+            } catch (mysqli_sql_exception $e) {
+                if ($e->getCode() === self::ER_STATEMENT_TIMEOUT) {
+                    return null;
+                }
+                throw $e;
+            }
+            if ($result instanceof \mysqli_result) {
+                $result->fetch_all();
+                $result->free();
+            }
+            $durations[] = (hrtime(true) - $start) / 1e6;
+        }
+
+        sort($durations);
+        return $durations[intdiv(count($durations), 2)];
+    }
+
+    /**
+     * Reads the on-disk size of a table after refreshing its statistics.
+     *
+     * @param string $table Table name.
+     * @return array ["data" => bytes, "index" => bytes]
+     */
+    public function tableSize(string $table): array
+    {
+        $this->db->query("ANALYZE TABLE `" . $table . "`")->fetch_all();
+        $statement = $this->db->prepare(
+            "SELECT `data_length`, `index_length` FROM information_schema.TABLES
+             WHERE `table_schema` = DATABASE() AND `table_name` = ?"
+        );
+        $statement->bind_param("s", $table);
+        $statement->execute();
+        $row = $statement->get_result()->fetch_assoc();
+        return ["data" => (int) $row["data_length"], "index" => (int) $row["index_length"]];
+    }
+}
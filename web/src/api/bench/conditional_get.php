@@ -0,0 +1,148 @@
+<?php
+
+/**
+ * Conditional GET Test
+ *
+ * Shows what the validators save in a steady-state installation, where
+ * nothing changes between two polls. Every polled route is requested once
+ * without validators and once with the ETag of the previous response. The
+ * conditional request must be answered with 304. The response bytes
+ * (headers and body) and the round-trip times are then scaled to the
+ * requests the firmware sends per hour.
+ *
+ * Usage: php bench/conditional_get.php [sensor stations]
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+// The web server executes every PHP file, so refuse anything but the CLI
+if (PHP_SAPI !== "cli") {
+    http_response_code(404);
+    exit;
+}
+
+const RUNS = 20;
+const DEFAULT_STATIONS = 10;
+
+/**
+ * @var array Polled routes with the requests per hour of one client, from
+ *            the intervals in the firmware: the installation refreshes the
+ *            snapshot every 50 s and the soundscape every 10 min, every
+ *            sensor station revalidates the device list every minute.
+ */
+const ROUTES = [
+    ["path" => "/snapshot", "per_hour" => 72, "client" => "installation"],
+    ["path" => "/soundscape", "per_hour" => 6, "client" => "installation"],
+    ["path" => "/device", "per_hour" => 60, "client" => "station"],
+];
+
+/**
+ * Sends a GET request and returns the status, the response size and the
+ * round-trip time.
+ *
+ * @param string $url The URL to request.
+ * @param string|null $etag The ETag to send as If-None-Match.
+ * @return array ["status", "bytes", "ms", "etag"]
+ */
+function request(string $url, ?string $etag): array
+{
+    $context = stream_context_create([
+        "http" => [
+            "method"        => "GET",
+            "header"        => $etag === null ? "" : "If-None-Match: " . $etag,
+            "ignore_errors" => true,
+        ],
+    ]);
+
+    $start = hrtime(true);
+    $body = @file_get_contents($url, false, $context);
+    $ms = (hrtime(true) - $start) / 1e6;
+    if ($body === false) {
+        throw new RuntimeException("Request to " . $url . " failed");
+    }
+
+    $status = 0;
+    $bytes = strlen($body) + 2;
+    $responseEtag = null;
+    foreach ($http_response_header as $line) {
+        $bytes += strlen($line) + 2;
+        if (preg_match("#^HTTP/\\S+ (\\d{3})#", $line, $match)) {
+            $status = (int) $match[1];
+        } elseif (stripos($line, "ETag:") === 0) {
+            $responseEtag = trim(substr($line, 5));
+        }
+    }
+    return ["status" => $status, "bytes" => $bytes, "ms" => $ms, "etag" => $responseEtag];
+}
+
+/**
+ * Requests a route RUNS times and returns the median bytes and time.
+ */
+function measure(string $url, ?string $etag, int $expectedStatus): array
+{
+    $bytes = [];
+    $durations = [];
+    for ($run = 0; $run < RUNS; $run++) {
+        $response = request($url, $etag);
+        if ($response["status"] !== $expectedStatus) {
+            throw new RuntimeException($url . " answered " . $response["status"] . " instead of " . $expectedStatus);
+        }
+        $bytes[] = $response["bytes"];
+        $durations[] = $response["ms"];
+    }
+    sort($bytes);
+    sort($durations);
+    return ["bytes" => $bytes[intdiv(RUNS, 2)], "ms" => $durations[intdiv(RUNS, 2)]];
+}
+
+$stations = count($argv) > 1 ? max(1, (int) $argv[1]) : DEFAULT_STATIONS;
+$api = getenv("API_URL") ?: "http://nginx/api";
+
+try {
+    printf("%-28s  %10s  %10s  %10s  %10s\n", "route", "full", "304", "full ms", "304 ms");
+
+    $full = ["bytes" => 0, "ms" => 0.0];
+    $conditional = ["bytes" => 0, "ms" => 0.0];
+    foreach (ROUTES as $route) {
+        $url = $api . $route["path"];
+        $etag = request($url, null)["etag"];
+        if ($etag === null) {
+            throw new RuntimeException($url . " sends no ETag");
+        }
+
+        $plain = measure($url, null, 200);
+        $revalidated = measure($url, $etag, 304);
+        printf(
+            "%-28s  %8d B  %8d B  %10.2f  %10.2f\n",
+            $route["path"],
+            $plain["bytes"],
+            $revalidated["bytes"],
+            $plain["ms"],
+            $revalidated["ms"]
+        );
+
+        $perHour = $route["per_hour"] * ($route["client"] === "station" ? $stations : 1);
+        $full["bytes"] += $plain["bytes"] * $perHour;
+        $full["ms"] += $plain["ms"] * $perHour;
+        $conditional["bytes"] += $revalidated["bytes"] * $perHour;
+        $conditional["ms"] += $revalidated["ms"] * $perHour;
+    }
+
+    printf("\nPer hour with one installation and %d stations:\n", $stations);
+    printf(
+        "  %.1f KB instead of %.1f KB (%.0f%% saved)\n",
+        $conditional["bytes"] / 1024,
+        $full["bytes"] / 1024,
+        100 * (1 - $conditional["bytes"] / $full["bytes"])
+    );
+    printf(
+        "  %.2f s instead of %.2f s of request time (%.0f%% saved)\n",
+        $conditional["ms"] / 1000,
+        $full["ms"] / 1000,
+        100 * (1 - $conditional["ms"] / $full["ms"])
+    );
+} catch (RuntimeException $e) {
+    fwrite(STDERR, "Test failed: " . $e->getMessage() . PHP_EOL);
+    exit(1);
+}
@@ -0,0 +1,238 @@
+<?php
+
+/**
+ * HistoryController Class
+ *
+ * Serves the history of one sensor of a device from the minute, hour and
+ * day rollups, so charts never have to load raw readings.
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+namespace Api\Controllers;
+
+use Api\Models\Database;
+use mysqli;
+use mysqli_sql_exception;
+
+/**
+ * History Controller Class
+ * Picks the rollup resolution for a time range and returns its buckets.
+ */
+class HistoryController
+{
+    /** @var int[] Rollup bucket sizes in seconds, coarsest first. */
+    private const RESOLUTIONS = [86400, 3600, 60];
+
+    /** @var mysqli MySQLi database connection */
+    private mysqli $db;
+
+    /**
+     * Initializes the controller with the database connection.
+     */
+    public function __construct()
+    {
+        $this->db = Database::getInstance()->getConnection();
+    }
+
+    /**
+     * Returns the buckets of the finest rollup that yields at most the
+     * requested number of points for the range. Ranges too long even for
+     * days get days merged into larger buckets. Expired rollups are dropped
+     * per resolution, so the part of the range older than the oldest bucket
+     * of a rollup is served from the next coarser one; "segments" lists the
+     * bucket size used for each part. Each point holds the bucket start
+     * (Unix seconds) and min, max, avg and count of the values stored in it.
+     * The queries are primary key range scans, so their cost depends on the
+     * points returned, not on how much history exists.
+     *
+     * @param int $deviceId The device to return the history of.
+     * @param int $sensorId The sensor to return the history of.
+     * @param int $from Start of the range (Unix seconds, inclusive).
+     * @param int $to End of the range (Unix seconds, inclusive).
+     * @param int $points Number of points the client wants to draw.
+     * @return array API response.
+     */
+    public function getHistory(int $deviceId, int $sensorId, int $from, int $to, int $points): array
+    {
+        $bucketSize = self::pickBucketSize($from, $to, $points);
+
+        try {
+            $oldestBucket = function (int $resolution) use ($deviceId, $sensorId): ?int {
+                return $this->oldestBucket($deviceId, $sensorId, $resolution);
+            };
+            $segments = self::planSegments($from, $to, $bucketSize, $oldestBucket);
+
+            $data = [];
+            foreach ($segments as $segment) {
+                $resolution = min($segment["resolution"], self::RESOLUTIONS[0]);
+                $buckets = $this->fetchBuckets(
+                    $deviceId,
+                    $sensorId,
+                    $resolution,
+                    $segment["resolution"],
+                    $segment["from"],
+                    $segment["to"]
+                );
+                $data = array_merge($data, $buckets);
+            }
+
+            return [
+                "device_id"  => $deviceId,
+                "sensor_id"  => $sensorId,
+                "resolution" => empty($segments) ? $bucketSize : end($segments)["resolution"],
+                "from"       => $from,
+                "to"         => $to,
+                "segments"   => $segments,
+                "points"     => $data,
+            ];
+        } catch (mysqli_sql_exception $e) {
+            return ["error" => "Database error: " . $e->getMessage(), "status" => 500];
+        }
+    }
+
+    /**
+     * Returns the start of the oldest bucket a rollup still holds for the
+     * sensor, a single primary key lookup.
+     *
+     * @param int $deviceId The device to look up.
+     * @param int $sensorId The sensor to look up.
+     * @param int $resolution Rollup bucket size in seconds.
+     * @return int|null Bucket start (Unix seconds), or null if the rollup is empty.
+     * @throws mysqli_sql_exception If the query fails.
+     */
+    private function oldestBucket(int $deviceId, int $sensorId, int $resolution): ?int
+    {
+        $stmt = $this->db->prepare(
+            "SELECT MIN(`bucket_start`) AS `oldest` FROM `sensorrollup`
+             WHERE `device_id` = ? AND `sensor_id` = ? AND `resolution` = ?"
+        );
+        $stmt->bind_param("iii", $deviceId, $sensorId, $resolution);
+        $stmt->execute();
+
+        $oldest = $stmt->get_result()->fetch_assoc()["oldest"] ?? null;
+        return $oldest === null ? null : (int) $oldest;
+    }
+
+    /**
+     * Loads the buckets of one rollup resolution that overlap the range,
+     * merged into buckets of bucketSize if that is larger.
+     *
+     * @param int $deviceId The device to return the history of.
+     * @param int $sensorId The sensor to return the history of.
+     * @param int $resolution Rollup to read, bucket size in seconds.
+     * @param int $bucketSize Size of the returned buckets, a multiple of the resolution.
+     * @param int $from Start of the range (Unix seconds, inclusive).
+     * @param int $to End of the range (Unix seconds, inclusive).
+     * @return array Points ordered by bucket start.
+     * @throws mysqli_sql_exception If the query fails.
+     */
+    private function fetchBuckets(int $deviceId, int $sensorId, int $resolution, int $bucketSize, int $from, int $to): array
+    {
+        $bucketFrom = intdiv($from, $bucketSize) * $bucketSize;
+
+        $stmt = $this->db->prepare(
+            "SELECT `bucket_start` DIV ? * ? AS `bucket`, MIN(`min_value`) AS `min_value`, MAX(`max_value`) AS `max_value`,
+                    SUM(`sum_value`) / SUM(`sample_count`) AS `avg_value`, SUM(`sample_count`) AS `sample_count`
+             FROM `sensorrollup`
+             WHERE `device_id` = ? AND `sensor_id` = ? AND `resolution` = ? AND `bucket_start` BETWEEN ? AND ?
+             GROUP BY `bucket`
+             ORDER BY `bucket`"
+        );
+        $stmt->bind_param("iiiiiii", $bucketSize, $bucketSize, $deviceId, $sensorId, $resolution, $bucketFrom, $to);
+        $stmt->execute();
+
+        $data = [];
+        foreach ($stmt->get_result()->fetch_all(MYSQLI_ASSOC) as $row) {
+            $data[] = [
+                "t"     => (int) $row["bucket"],
+                "min"   => (float) $row["min_value"],
+                "max"   => (float) $row["max_value"],
+                "avg"   => round((float) $row["avg_value"], 2),
+                "count" => (int) $row["sample_count"],
+            ];
+        }
+
+        return $data;
+    }
+
+    /**
+     * Splits the range into the parts served by each rollup, newest part
+     * from the finest. Where a rollup no longer holds the older part of the
+     * range, the next coarser one takes over at the first of its bucket
+     * boundaries the finer one still covers, so no bucket is counted twice.
+     *
+     * @param int $from Start of the range (Unix seconds, inclusive).
+     * @param int $to End of the range (Unix seconds, inclusive).
+     * @param int $bucketSize Bucket size picked for the range.
+     * @param callable $oldestBucket Returns the oldest bucket start of a
+     *                               resolution, or null if it is empty.
+     * @return array Segments ["from", "to", "resolution"], oldest first.
+     */
+    public static function planSegments(int $from, int $to, int $bucketSize, callable $oldestBucket): array
+    {
+        $finest = array_search(min($bucketSize, self::RESOLUTIONS[0]), self::RESOLUTIONS, true);
+        $segments = [];
+        $end = $to;
+        for ($index = $finest; $index >= 0 && $end >= $from; $index--) {
+            $start = $from;
+            if ($index > 0) {
+                $oldest = $oldestBucket(self::RESOLUTIONS[$index]);
+                if ($oldest === null) {
+                    continue;
+                }
+                $coarser = self::RESOLUTIONS[$index - 1];
+                $start = max($from, intdiv($oldest + $coarser - 1, $coarser) * $coarser);
+                if ($start > $end) {
+                    continue;
+                }
+            }
+
+            $size = $index === $finest ? $bucketSize : self::RESOLUTIONS[$index];
+            array_unshift($segments, ["from" => $start, "to" => $end, "resolution" => $size]);
+            $end = $start - 1;
+        }
+        return $segments;
+    }
+
+    /**
+     * Picks the finest rollup resolution with at most the requested number
+     * of buckets in the range. If even the coarsest has more, its buckets
+     * are merged into the smallest multiple of it that fits.
+     *
+     * @param int $from Start of the range (Unix seconds, inclusive).
+     * @param int $to End of the range (Unix seconds, inclusive).
+     * @param int $points Requested number of points, at least 1.
+     * @return int Bucket size in seconds.
+     */
+    public static function pickBucketSize(int $from, int $to, int $points): int
+    {
+        foreach (array_reverse(self::RESOLUTIONS) as $resolution) {
+            if (self::bucketCount($from, $to, $resolution) <= $points) {
+                return $resolution;
+            }
+        }
+
+        $coarsest = self::RESOLUTIONS[0];
+        $bucketSize = $coarsest * max(1, intdiv(self::bucketCount($from, $to, $coarsest), $points));
+        while (self::bucketCount($from, $to, $bucketSize) > $points) {
+            $bucketSize += $coarsest;
+        }
+        return $bucketSize;
+    }
+
+    /**
+     * Counts the buckets of a size that overlap the range; buckets start at
+     * multiples of their size.
+     *
+     * @param int $from Start of the range (Unix seconds, inclusive).
+     * @param int $to End of the range (Unix seconds, inclusive).
+     * @param int $bucketSize Bucket size in seconds.
+     * @return int Number of buckets.
+     */
+    private static function bucketCount(int $from, int $to, int $bucketSize): int
+    {
+        return intdiv($to, $bucketSize) - intdiv($from, $bucketSize) + 1;
+    }
+}
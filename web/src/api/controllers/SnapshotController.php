@@ -0,0 +1,82 @@
+<?php
+
+/**
+ * SnapshotController Class
+ *
+ * Builds a compact snapshot of the latest sensor values of every device,
+ * so the installation can refresh its whole cache with one request.
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+namespace Api\Controllers;
+
+use Api\Models\Database;
+use mysqli;
+use mysqli_sql_exception;
+
+/**
+ * Snapshot Controller Class
+ * Groups the rows of the DeviceLatest table by device.
+ */
+class SnapshotController
+{
+    /** @var mysqli MySQLi database connection */
+    private mysqli $db;
+
+    /**
+     * Initializes the controller with the database connection.
+     */
+    public function __construct()
+    {
+        $this->db = Database::getInstance()->getConnection();
+    }
+
+    /**
+     * Returns one entry per device, ordered by id, with the latest value of
+     * each sensor keyed by sensor_id. Devices without readings are included
+     * with empty values, so the list also serves as the device list.
+     *
+     * @return array API response.
+     */
+    public function getSnapshot(): array
+    {
+        try {
+            $devices = [];
+            $result = $this->db->query("SELECT `id` FROM `device` ORDER BY `id`");
+            foreach ($result->fetch_all(MYSQLI_ASSOC) as $row) {
+                $devices[(int) $row["id"]] = [
+                    "id"         => (int) $row["id"],
+                    "reading_id" => null,
+                    "updated_at" => null,
+                    "values"     => [],
+                ];
+            }
+
+            $result = $this->db->query(
+                "SELECT `device_id`, `sensor_id`, `reading_id`, `value`, UNIX_TIMESTAMP(`timestamp`) AS updated_at
+                 FROM `devicelatest`"
+            );
+            foreach ($result->fetch_all(MYSQLI_ASSOC) as $row) {
+                $deviceId = (int) $row["device_id"];
+                if (!isset($devices[$deviceId])) {
+                    continue;
+                }
+
+                $device = &$devices[$deviceId];
+                $device["values"][$row["sensor_id"]] = (float) $row["value"];
+                $device["reading_id"] = max($device["reading_id"] ?? 0, (int) $row["reading_id"]);
+                $device["updated_at"] = max($device["updated_at"] ?? 0, (int) $row["updated_at"]);
+                unset($device);
+            }
+
+            return array_map(function ($device) {
+                $device["values"] = (object) $device["values"];
+                return $device;
+            }, array_values($devices));
+        } catch (mysqli_sql_exception $e) {
+            return ["error" => "Database error: " . $e->getMessage(), "status" => 500];
+        }
+    }
+}
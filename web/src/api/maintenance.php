@@ -0,0 +1,34 @@
+<?php
+
+/**
+ * Maintenance Entry Point
+ *
+ * Runs the daily partition maintenance from the command line: adds the
+ * upcoming monthly partitions and drops the expired ones.
+ *
+ * Usage: php maintenance.php
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+// The web server executes every PHP file, so refuse anything but the CLI
+if (PHP_SAPI !== "cli") {
+    http_response_code(404);
+    exit;
+}
+
+require_once __DIR__ . "/vendor/autoload.php";
+
+use Api\Models\PartitionMaintenance;
+
+try {
+    $statements = (new PartitionMaintenance())->run(time());
+} catch (mysqli_sql_exception $e) {
+    fwrite(STDERR, "Partition maintenance failed: " . $e->getMessage() . PHP_EOL);
+    exit(1);
+}
+
+foreach ($statements as $statement) {
+    echo $statement . PHP_EOL;
+}
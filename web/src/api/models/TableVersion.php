@@ -0,0 +1,186 @@
+<?php
+
+/**
+ * TableVersion Class
+ *
+ * Keeps a version counter per table in the tableversion table, so ETags are
+ * checked with one primary key lookup instead of building the response, and
+ * every PHP worker and container sees the same validators. Every API write
+ * bumps the counters of the tables it changed after its commit; triggers
+ * bump device, sensor and setting on any change, e.g. from phpMyAdmin.
+ *
+ * @author Yanis Deplazes
+ * @date 10.03.2025
+ */
+
+namespace Api\Models;
+
+use mysqli;
+use mysqli_sql_exception;
+
+/**
+ * Table Version Class
+ * Reads and bumps per-table version counters and builds validators from them.
+ */
+class TableVersion
+{
+    /** @var string[] Tables with a counter; other names never create a row. */
+    private const TABLES = ["device", "devicelatest", "reading", "sensor", "sensordata", "sensorrollup", "setting"];
+
+    /**
+     * @var int Upper bound of a new counter. It starts at a random value, so
+     *          a counter that is deleted and recreated never repeats an old ETag.
+     */
+    private const INITIAL_VERSION_MAX = 0xFFFFFFFFFFFF;
+
+    /** @var mysqli MySQLi database connection */
+    private mysqli $db;
+
+    /** @var array Counters read so far, as table => ["version", "updated_at"]. */
+    private array $counters = [];
+
+    /**
+     * Initializes the counters with the database connection.
+     */
+    public function __construct()
+    {
+        $this->db = Database::getInstance()->getConnection();
+    }
+
+    /**
+     * Builds a strong ETag from the versions of the tables a response is
+     * built from. It changes whenever one of them was written.
+     *
+     * @param string[] $tables The tables the response depends on.
+     * @return string|null The quoted ETag, or null if a table has no counter.
+     */
+    public function etag(array $tables): ?string
+    {
+        $counters = $this->load($tables);
+
+        $parts = [];
+        foreach ($tables as $table) {
+            if (!isset($counters[$table])) {
+                return null;
+            }
+            $parts[] = $table . ":" . $counters[$table]["version"];
+        }
+
+        return '"' . hash("xxh64", implode(",", $parts)) . '"';
+    }
+
+    /**
+     * Returns when the tables were last written.
+     *
+     * @param string[] $tables The tables the response depends on.
+     * @return int Unix seconds of the newest counter, 0 if none is known.
+     */
+    public function lastModified(array $tables): int
+    {
+        $lastModified = 0;
+        foreach ($this->load($tables) as $counter) {
+            $lastModified = max($lastModified, $counter["updated_at"]);
+        }
+        return $lastModified;
+    }
+
+    /**
+     * Increments the counters of the given tables in one statement. Call
+     * after the commit, so a response is never tagged with a version newer
+     * than its data. A failure is logged, since the write itself succeeded.
+     *
+     * @param string ...$tables The tables that were written.
+     */
+    public function bump(string ...$tables): void
+    {
+        $tables = array_values(array_intersect(array_unique($tables), self::TABLES));
+        if (empty($tables)) {
+            return;
+        }
+
+        try {
+            $this->upsert($tables, "`version` = `version` + 1");
+        } catch (mysqli_sql_exception $e) {
+            error_log("Table versions cannot be bumped: " . $e->getMessage());
+        }
+        foreach ($tables as $table) {
+            unset($this->counters[$table]);
+        }
+    }
+
+    /**
+     * Reads the counters of the given tables, creating missing ones.
+     *
+     * @param string[] $tables The table names.
+     * @return array The counters of the tables that have one.
+     */
+    private function load(array $tables): array
+    {
+        $tables = array_values(array_intersect(array_unique($tables), self::TABLES));
+        $missing = array_values(array_diff($tables, array_keys($this->counters)));
+
+        try {
+            if (!empty($missing)) {
+                $this->select($missing);
+            }
+            $missing = array_values(array_diff($missing, array_keys($this->counters)));
+            if (!empty($missing)) {
+                // Only for a database set up before the seed rows of db.sql
+                $this->upsert($missing, "`version` = `version`");
+                $this->select($missing);
+            }
+        } catch (mysqli_sql_exception $e) {
+            error_log("Table versions cannot be read: " . $e->getMessage());
+        }
+
+        return array_intersect_key($this->counters, array_flip($tables));
+    }
+
+    /**
+     * Reads counters into the cache of this instance.
+     *
+     * @param string[] $tables The table names.
+     * @throws mysqli_sql_exception If the query fails.
+     */
+    private function select(array $tables): void
+    {
+        $stmt = $this->db->prepare(
+            "SELECT `name`, `version`, UNIX_TIMESTAMP(`updated_at`) AS `updated_at`
+             FROM `tableversion`
+             WHERE `name` IN (" . implode(", ", array_fill(0, count($tables), "?")) . ")"
+        );
+        $stmt->bind_param(str_repeat("s", count($tables)), ...$tables);
+        $stmt->execute();
+
+        foreach ($stmt->get_result()->fetch_all(MYSQLI_ASSOC) as $row) {
+            $this->counters[$row["name"]] = [
+                "version"    => (int) $row["version"],
+                "updated_at" => (int) $row["updated_at"],
+            ];
+        }
+    }
+
+    /**
+     * Creates the counters of the given tables at a random version, or
+     * applies the update to the ones that exist.
+     *
+     * @param string[] $tables The table names.
+     * @param string $update The assignment for existing counters.
+     * @throws mysqli_sql_exception If the statement fails.
+     */
+    private function upsert(array $tables, string $update): void
+    {
+        $params = [];
+        foreach ($tables as $table) {
+            array_push($params, $table, random_int(1, self::INITIAL_VERSION_MAX));
+        }
+
+        $stmt = $this->db->prepare(
+            "INSERT INTO `tableversion` (`name`, `version`) VALUES "
+            . implode(", ", array_fill(0, count($tables), "(?, ?)"))
+            . " ON DUPLICATE KEY UPDATE " . $update
+        );
+        $stmt->bind_param(str_repeat("si", count($tables)), ...$params);
+        $stmt->execute();
+    }
+}